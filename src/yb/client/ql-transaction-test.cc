@@ -13,12 +13,14 @@
 //
 //
 
+#include "yb/client/client.h"
 #include "yb/client/error.h"
 #include "yb/client/schema.h"
 #include "yb/client/session.h"
 #include "yb/client/table.h"
 #include "yb/client/table_alterer.h"
 #include "yb/client/transaction.h"
+#include "yb/client/transaction_manager.h"
 #include "yb/client/transaction_rpc.h"
 #include "yb/client/txn-test-base.h"
 #include "yb/client/yb_op.h"
@@ -34,6 +36,7 @@
 
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/transaction_coordinator.h"
 
@@ -43,6 +46,7 @@
 #include "yb/tserver/tserver_service.pb.h"
 
 #include "yb/util/async_util.h"
+#include "yb/util/metrics.h"
 #include "yb/util/random_util.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/size_literals.h"
@@ -62,6 +66,7 @@ DECLARE_bool(TEST_fail_in_apply_if_no_metadata);
 DECLARE_bool(TEST_master_fail_transactional_tablet_lookups);
 DECLARE_bool(TEST_transaction_allow_rerequest_status);
 DECLARE_bool(delete_intents_sst_files);
+DECLARE_bool(enable_transaction_heartbeat_batching);
 DECLARE_bool(enable_load_balancing);
 DECLARE_bool(fail_on_out_of_range_clock_skew);
 DECLARE_bool(flush_rocksdb_on_shutdown);
@@ -75,6 +80,9 @@ DECLARE_uint64(aborted_intent_cleanup_ms);
 DECLARE_uint64(max_clock_skew_usec);
 DECLARE_uint64(transaction_heartbeat_usec);
 
+METRIC_DECLARE_counter(transaction_heartbeat_rpcs_saved);
+METRIC_DECLARE_counter(transaction_heartbeats_batched);
+
 namespace yb {
 namespace client {
 
@@ -441,6 +449,53 @@ TEST_F(QLTransactionTest, Heartbeat) {
   AssertNoRunningTransactions();
 }
 
+// Checks that batched heartbeats keep multiple transactions alive longer than transaction timeout.
+TEST_F(QLTransactionTest, BatchedHeartbeat) {
+  constexpr size_t kTransactions = 10;
+
+  ANNOTATE_UNPROTECTED_WRITE(FLAGS_enable_transaction_heartbeat_batching) = true;
+
+  // Heartbeat batching metrics are registered only when client has metric entity.
+  MetricRegistry metric_registry;
+  auto metric_entity = METRIC_ENTITY_server.Instantiate(&metric_registry, "batched-heartbeat");
+  YBClientBuilder builder;
+  builder.set_metric_entity(metric_entity);
+  auto client = ASSERT_RESULT(cluster_->CreateClient(&builder));
+  TransactionManager transaction_manager(client.get(), clock_, client::LocalTabletFilter());
+
+  std::vector<YBTransactionPtr> transactions;
+  for (size_t i = 0; i != kTransactions; ++i) {
+    auto txn = std::make_shared<YBTransaction>(&transaction_manager);
+    ASSERT_OK(txn->Init(GetIsolationLevel()));
+    auto session = CreateSession(txn);
+    ASSERT_OK(WriteRows(session, i));
+    transactions.push_back(std::move(txn));
+  }
+  std::this_thread::sleep_for(GetTransactionTimeout() * 2);
+  for (auto& txn : transactions) {
+    ASSERT_OK(txn->CommitFuture().get());
+  }
+  transactions.clear();
+  VerifyData(kTransactions);
+  AssertNoRunningTransactions();
+
+  auto heartbeats_batched =
+      METRIC_transaction_heartbeats_batched.Instantiate(metric_entity)->value();
+  auto rpcs_saved = METRIC_transaction_heartbeat_rpcs_saved.Instantiate(metric_entity)->value();
+  int64_t unreplicated_heartbeats = 0;
+  for (const auto& peer : ListTabletPeers(cluster_.get(), ListPeersFilter::kAll)) {
+    auto tablet = peer->shared_tablet();
+    if (tablet) {
+      unreplicated_heartbeats += tablet->metrics()->unreplicated_transaction_heartbeats->value();
+    }
+  }
+  LOG(INFO) << "Heartbeats batched: " << heartbeats_batched << ", RPCs saved: " << rpcs_saved
+            << ", unreplicated heartbeats: " << unreplicated_heartbeats;
+  ASSERT_GT(heartbeats_batched, 0);
+  ASSERT_GT(rpcs_saved, 0);
+  ASSERT_GT(unreplicated_heartbeats, 0);
+}
+
 TEST_F(QLTransactionTest, Expire) {
   SetDisableHeartbeatInTests(true);
   auto txn = CreateTransaction();
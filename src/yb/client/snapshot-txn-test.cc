@@ -49,6 +49,7 @@
 #include "yb/util/debug/long_operation_tracker.h"
 #include "yb/util/enums.h"
 #include "yb/util/lockfree.h"
+#include "yb/util/metrics.h"
 #include "yb/util/opid.h"
 #include "yb/util/random_util.h"
 #include "yb/util/result.h"
@@ -63,6 +64,7 @@ using namespace std::literals;
 
 DECLARE_bool(TEST_disallow_lmp_failures);
 DECLARE_bool(enable_multi_raft_heartbeat_batcher);
+DECLARE_bool(enable_multi_raft_update_batching);
 DECLARE_bool(fail_on_out_of_range_clock_skew);
 DECLARE_bool(ycql_consistent_transactional_paging);
 DECLARE_int32(TEST_inject_load_transaction_delay_ms);
@@ -75,6 +77,8 @@ DECLARE_uint64(max_clock_skew_usec);
 DECLARE_uint64(max_transactions_in_status_request);
 DECLARE_uint64(clock_skew_force_crash_bound_usec);
 
+METRIC_DECLARE_counter(multi_raft_update_rpcs_saved);
+
 extern double TEST_delay_create_transaction_probability;
 
 namespace yb {
@@ -362,6 +366,29 @@ TEST_F(SnapshotTxnTest, BankAccounts) {
   TestBankAccounts({}, 30s, RegularBuildVsSanitizers(10, 1) /* minimal_updates_per_second */);
 }
 
+class SnapshotTxnMultiRaftUpdateBatchingTest : public SnapshotTxnTest {
+ protected:
+  void SetUp() override {
+    ANNOTATE_UNPROTECTED_WRITE(FLAGS_enable_multi_raft_update_batching) = true;
+    SnapshotTxnTest::SetUp();
+  }
+};
+
+// Check that coalescing of UpdateConsensus requests from different tablets does not break
+// consistency.
+TEST_F_EX(SnapshotTxnTest, BankAccountsWithMultiRaftUpdateBatching,
+          SnapshotTxnMultiRaftUpdateBatchingTest) {
+  TestBankAccounts({}, 30s, RegularBuildVsSanitizers(10, 1) /* minimal_updates_per_second */);
+
+  int64_t rpcs_saved = 0;
+  for (size_t i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    rpcs_saved += METRIC_multi_raft_update_rpcs_saved.Instantiate(
+        cluster_->mini_tablet_server(i)->server()->metric_entity())->value();
+  }
+  LOG(INFO) << "UpdateConsensus RPCs saved by batching: " << rpcs_saved;
+  ASSERT_GT(rpcs_saved, 0);
+}
+
 TEST_F(SnapshotTxnTest, BankAccountsPartitioned) {
   TestBankAccounts(
       BankAccountsOptions{BankAccountsOption::kNetworkPartition}, 150s,
@@ -71,6 +71,7 @@ DEFINE_uint64(transaction_heartbeat_usec, 500000 * yb::kTimeMultiplier,
               "Interval of transaction heartbeat in usec.");
 DEFINE_bool(transaction_disable_heartbeat_in_tests, false, "Disable heartbeat during test.");
 DECLARE_uint64(max_clock_skew_usec);
+DECLARE_bool(enable_transaction_heartbeat_batching);
 
 DEFINE_bool(auto_promote_nonlocal_transactions_to_global, true,
             "Automatically promote transactions touching data outside of region to global.");
@@ -1537,6 +1538,23 @@ class YBTransaction::Impl final : public internal::TxnBatcherIf {
       timeout = TransactionRpcTimeout();
     }
 
+    if (status == TransactionStatus::PENDING &&
+        GetAtomicFlag(&FLAGS_enable_transaction_heartbeat_batching)) {
+      internal::RemoteTabletPtr status_tablet;
+      {
+        SharedLock<std::shared_mutex> lock(mutex_);
+        status_tablet = !send_to_new_tablet && old_status_tablet_ ? old_status_tablet_
+                                                                  : status_tablet_;
+      }
+      manager_->SendHeartbeat(
+          status_tablet, metadata_.transaction_id,
+          [this, transaction, send_to_new_tablet](const Status& status) {
+            HeartbeatDone(status, /* request= */ {}, /* response= */ {},
+                          TransactionStatus::PENDING, transaction, send_to_new_tablet);
+          });
+      return;
+    }
+
     rpc::RpcCommandPtr rpc;
     {
       SharedLock<std::shared_mutex> lock(mutex_);
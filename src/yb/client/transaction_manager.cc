@@ -18,15 +18,27 @@
 #include "yb/client/client.h"
 #include "yb/client/meta_cache.h"
 #include "yb/client/table.h"
+#include "yb/client/transaction_rpc.h"
 #include "yb/client/yb_table_name.h"
 
+#include "yb/common/wire_protocol.h"
+
+#include "yb/gutil/casts.h"
+
 #include "yb/master/catalog_manager.h"
 
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc.h"
+#include "yb/rpc/scheduler.h"
 #include "yb/rpc/tasks_pool.h"
 
 #include "yb/server/server_base_options.h"
 
+#include "yb/tserver/tserver_service.pb.h"
+
+#include "yb/util/flag_tags.h"
 #include "yb/util/format.h"
+#include "yb/util/metrics.h"
 #include "yb/util/status_format.h"
 #include "yb/util/status_log.h"
 #include "yb/util/string_util.h"
@@ -38,6 +50,34 @@ DEFINE_uint64(transaction_manager_workers_limit, 50,
 DEFINE_uint64(transaction_manager_queue_limit, 500,
               "Max number of tasks used by transaction manager");
 
+DEFINE_bool(enable_transaction_heartbeat_batching, false,
+            "Send heartbeats of PENDING transactions to the same status tablet in a single "
+            "UpdateTransactionHeartbeats RPC. Should be enabled only when all tservers support "
+            "this RPC.");
+TAG_FLAG(enable_transaction_heartbeat_batching, advanced);
+
+DEFINE_uint64(transaction_heartbeat_batch_window_usec, 50000,
+              "Time during which heartbeats to the same status tablet are collected into a "
+              "single batch.");
+TAG_FLAG(transaction_heartbeat_batch_window_usec, advanced);
+
+DEFINE_uint64(transaction_heartbeat_max_batch_size, 1000,
+              "Max number of transaction heartbeats sent in a single batch.");
+TAG_FLAG(transaction_heartbeat_max_batch_size, advanced);
+
+DECLARE_uint64(transaction_heartbeat_usec);
+
+METRIC_DEFINE_counter(server, transaction_heartbeats_batched,
+                      "Transaction heartbeats sent in batches",
+                      yb::MetricUnit::kRequests,
+                      "Number of transaction heartbeats sent in UpdateTransactionHeartbeats RPCs");
+
+METRIC_DEFINE_counter(server, transaction_heartbeat_rpcs_saved,
+                      "Transaction heartbeat RPCs saved by batching",
+                      yb::MetricUnit::kRequests,
+                      "Number of transaction heartbeat RPCs that were not sent, because heartbeats "
+                      "were batched");
+
 namespace yb {
 namespace client {
 
@@ -226,6 +266,171 @@ class InvokeCallbackTask {
 };
 } // namespace
 
+// Collects PENDING heartbeats of transactions, and sends heartbeats to the same status tablet
+// in a single UpdateTransactionHeartbeats RPC.
+class HeartbeatBatcher : public std::enable_shared_from_this<HeartbeatBatcher> {
+ public:
+  HeartbeatBatcher(YBClient* client, const scoped_refptr<ClockBase>& clock, rpc::Rpcs* rpcs)
+      : client_(client), clock_(clock), rpcs_(*rpcs) {
+    auto metric_entity = client->metric_entity();
+    if (metric_entity) {
+      heartbeats_batched_ = METRIC_transaction_heartbeats_batched.Instantiate(metric_entity);
+      rpcs_saved_ = METRIC_transaction_heartbeat_rpcs_saved.Instantiate(metric_entity);
+    }
+  }
+
+  void Add(const internal::RemoteTabletPtr& status_tablet,
+           const TransactionId& transaction_id,
+           TransactionHeartbeatCallback callback) {
+    std::vector<Heartbeat> to_send;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (closed_) {
+        lock.unlock();
+        callback(STATUS(Aborted, "Transaction manager shutting down"));
+        return;
+      }
+      auto it = batches_.find(status_tablet->tablet_id());
+      if (it == batches_.end()) {
+        it = batches_.emplace(status_tablet->tablet_id(), Batch()).first;
+        it->second.status_tablet = status_tablet;
+        it->second.flush_task_id = client_->messenger()->scheduler().Schedule(
+            [weak_self = std::weak_ptr<HeartbeatBatcher>(shared_from_this()),
+             tablet_id = status_tablet->tablet_id()](
+                const Status& status) {
+              auto self = weak_self.lock();
+              if (self && status.ok()) {
+                self->Flush(tablet_id);
+              }
+            },
+            std::chrono::microseconds(FLAGS_transaction_heartbeat_batch_window_usec));
+      }
+      auto& heartbeats = it->second.heartbeats;
+      heartbeats.push_back(Heartbeat {
+        .transaction_id = transaction_id,
+        .callback = std::move(callback),
+      });
+      if (heartbeats.size() >= FLAGS_transaction_heartbeat_max_batch_size) {
+        to_send.swap(heartbeats);
+      }
+    }
+    if (!to_send.empty()) {
+      Send(status_tablet, std::move(to_send));
+    }
+  }
+
+  void Shutdown() {
+    std::unordered_map<TabletId, Batch> batches;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      batches.swap(batches_);
+    }
+    auto status = STATUS(Aborted, "Transaction manager shutting down");
+    for (auto& id_and_batch : batches) {
+      client_->messenger()->scheduler().Abort(id_and_batch.second.flush_task_id);
+      for (auto& heartbeat : id_and_batch.second.heartbeats) {
+        heartbeat.callback(status);
+      }
+    }
+  }
+
+ private:
+  struct Heartbeat {
+    TransactionId transaction_id;
+    TransactionHeartbeatCallback callback;
+  };
+
+  struct Batch {
+    internal::RemoteTabletPtr status_tablet;
+    std::vector<Heartbeat> heartbeats;
+    rpc::ScheduledTaskId flush_task_id = rpc::kInvalidTaskId;
+  };
+
+  struct SentBatch {
+    std::vector<Heartbeat> heartbeats;
+    rpc::Rpcs::Handle handle;
+  };
+
+  void Flush(const TabletId& tablet_id) {
+    internal::RemoteTabletPtr status_tablet;
+    std::vector<Heartbeat> to_send;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = batches_.find(tablet_id);
+      if (it == batches_.end()) {
+        return;
+      }
+      status_tablet = std::move(it->second.status_tablet);
+      to_send = std::move(it->second.heartbeats);
+      batches_.erase(it);
+    }
+    if (!to_send.empty()) {
+      Send(status_tablet, std::move(to_send));
+    }
+  }
+
+  void Send(const internal::RemoteTabletPtr& status_tablet, std::vector<Heartbeat> heartbeats) {
+    tserver::UpdateTransactionHeartbeatsRequestPB req;
+    req.set_tablet_id(status_tablet->tablet_id());
+    req.set_propagated_hybrid_time(clock_->Now().ToUint64());
+    req.mutable_transaction_id()->Reserve(narrow_cast<int>(heartbeats.size()));
+    for (const auto& heartbeat : heartbeats) {
+      req.add_transaction_id(heartbeat.transaction_id.data(), heartbeat.transaction_id.size());
+    }
+    VLOG(4) << "Sending " << heartbeats.size() << " heartbeats to " << status_tablet->tablet_id();
+    IncrementCounterBy(heartbeats_batched_, heartbeats.size());
+    IncrementCounterBy(rpcs_saved_, heartbeats.size() - 1);
+
+    auto sent = std::make_shared<SentBatch>();
+    sent->heartbeats = std::move(heartbeats);
+    sent->handle = rpcs_.InvalidHandle();
+    auto rpc = UpdateTransactionHeartbeats(
+        CoarseMonoClock::now() + std::chrono::microseconds(FLAGS_transaction_heartbeat_usec),
+        status_tablet.get(), client_, &req,
+        [self = shared_from_this(), sent](
+            const Status& status, const tserver::UpdateTransactionHeartbeatsResponsePB& resp) {
+          self->Done(sent.get(), status, resp);
+        });
+    rpcs_.RegisterAndStart(rpc, &sent->handle);
+  }
+
+  void Done(SentBatch* sent, const Status& status,
+            const tserver::UpdateTransactionHeartbeatsResponsePB& resp) {
+    if (resp.has_propagated_hybrid_time()) {
+      clock_->Update(HybridTime(resp.propagated_hybrid_time()));
+    }
+    const auto num_heartbeats = sent->heartbeats.size();
+    if (status.ok() && resp.transaction_status_size() != narrow_cast<int>(num_heartbeats)) {
+      LOG(DFATAL) << "Wrong number of heartbeat statuses: " << resp.transaction_status_size()
+                  << ", expected: " << num_heartbeats;
+    }
+    for (size_t i = 0; i != num_heartbeats; ++i) {
+      auto& heartbeat = sent->heartbeats[i];
+      if (!status.ok()) {
+        heartbeat.callback(status);
+      } else if (narrow_cast<int>(i) < resp.transaction_status_size()) {
+        heartbeat.callback(StatusFromPB(resp.transaction_status(narrow_cast<int>(i))));
+      } else {
+        heartbeat.callback(STATUS(IllegalState, "Missing heartbeat status"));
+      }
+    }
+    // Unregister after invoking callbacks, since shutdown waits for all registered RPCs.
+    rpcs_.Unregister(&sent->handle);
+  }
+
+  YBClient* const client_;
+  scoped_refptr<ClockBase> clock_;
+  rpc::Rpcs& rpcs_;
+
+  std::mutex mutex_;
+  bool closed_ GUARDED_BY(mutex_) = false;
+  std::unordered_map<TabletId, Batch> batches_ GUARDED_BY(mutex_);
+
+  scoped_refptr<Counter> heartbeats_batched_;
+  scoped_refptr<Counter> rpcs_saved_;
+};
+
 class TransactionManager::Impl {
  public:
   explicit Impl(YBClient* client, const scoped_refptr<ClockBase>& clock,
@@ -237,7 +442,8 @@ class TransactionManager::Impl {
             "TransactionManager", FLAGS_transaction_manager_queue_limit,
             FLAGS_transaction_manager_workers_limit),
         tasks_pool_(FLAGS_transaction_manager_queue_limit),
-        invoke_callback_tasks_(FLAGS_transaction_manager_queue_limit) {
+        invoke_callback_tasks_(FLAGS_transaction_manager_queue_limit),
+        heartbeat_batcher_(std::make_shared<HeartbeatBatcher>(client, clock, &rpcs_)) {
     CHECK(clock);
   }
 
@@ -276,6 +482,12 @@ class TransactionManager::Impl {
     }
   }
 
+  void SendHeartbeat(const internal::RemoteTabletPtr& status_tablet,
+                     const TransactionId& transaction_id,
+                     TransactionHeartbeatCallback callback) {
+    heartbeat_batcher_->Add(status_tablet, transaction_id, std::move(callback));
+  }
+
   const scoped_refptr<ClockBase>& clock() const {
     return clock_;
   }
@@ -301,6 +513,7 @@ class TransactionManager::Impl {
   }
 
   void Shutdown() {
+    heartbeat_batcher_->Shutdown();
     rpcs_.Shutdown();
     thread_pool_.Shutdown();
   }
@@ -323,6 +536,7 @@ class TransactionManager::Impl {
   yb::rpc::TasksPool<LoadStatusTabletsTask> tasks_pool_;
   yb::rpc::TasksPool<InvokeCallbackTask> invoke_callback_tasks_;
   yb::rpc::Rpcs rpcs_;
+  std::shared_ptr<HeartbeatBatcher> heartbeat_batcher_;
 };
 
 TransactionManager::TransactionManager(
@@ -341,6 +555,12 @@ void TransactionManager::PickStatusTablet(
   impl_->PickStatusTablet(std::move(callback), locality);
 }
 
+void TransactionManager::SendHeartbeat(
+    const internal::RemoteTabletPtr& status_tablet, const TransactionId& transaction_id,
+    TransactionHeartbeatCallback callback) {
+  impl_->SendHeartbeat(status_tablet, transaction_id, std::move(callback));
+}
+
 YBClient* TransactionManager::client() const {
   return impl_->client();
 }
@@ -23,6 +23,7 @@
 
 #include "yb/common/clock.h"
 #include "yb/common/hybrid_time.h"
+#include "yb/common/transaction.h"
 #include "yb/common/transaction.pb.h"
 
 #include "yb/rpc/rpc_fwd.h"
@@ -31,6 +32,7 @@ namespace yb {
 namespace client {
 
 typedef std::function<void(const Result<std::string>&)> PickStatusTabletCallback;
+typedef std::function<void(const Status&)> TransactionHeartbeatCallback;
 
 // TransactionManager manages multiple transactions. It lives at the YQL engine layer.
 class TransactionManager {
@@ -48,6 +50,12 @@ class TransactionManager {
 
   void PickStatusTablet(PickStatusTabletCallback callback, TransactionLocality locality);
 
+  // Sends PENDING heartbeat of the transaction to its status tablet. Heartbeats to the same status
+  // tablet are collected during a short window and sent in a single RPC.
+  void SendHeartbeat(const internal::RemoteTabletPtr& status_tablet,
+                     const TransactionId& transaction_id,
+                     TransactionHeartbeatCallback callback);
+
   rpc::Rpcs& rpcs();
   YBClient* client() const;
 
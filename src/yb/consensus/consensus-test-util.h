@@ -492,20 +492,22 @@ class TestPeerMapManager {
 class LocalTestPeerProxy : public TestPeerProxy {
  public:
   LocalTestPeerProxy(std::string peer_uuid, ThreadPool* pool,
-                     TestPeerMapManager* peers)
+                     TestPeerMapManager* peers, rpc::Messenger* messenger = nullptr)
       : TestPeerProxy(pool),
         peer_uuid_(std::move(peer_uuid)),
         peers_(peers),
+        messenger_(messenger),
         miss_comm_(false) {}
 
+  // Several update requests could be in flight when requests are pipelined, so the callback is
+  // passed along with the request instead of being registered per method.
   void UpdateAsync(const ConsensusRequestPB* request,
                    RequestTriggerMode trigger_mode,
                    ConsensusResponsePB* response,
                    rpc::RpcController* controller,
                    const rpc::ResponseCallback& callback) override {
-    RegisterCallback(kUpdate, callback);
-    CHECK_OK(pool_->SubmitFunc(
-        std::bind(&LocalTestPeerProxy::SendUpdateRequest, this, *request, response)));
+    SubmitWithLatency(std::bind(
+        &LocalTestPeerProxy::SendUpdateRequest, this, *request, response, callback));
   }
 
   void RequestConsensusVoteAsync(const VoteRequestPB* request,
@@ -538,13 +540,7 @@ class LocalTestPeerProxy : public TestPeerProxy {
                              const Response& response_temp,
                              Response* final_response,
                              Method method) {
-    bool miss_comm_copy;
-    {
-      std::lock_guard<simple_spinlock> lock(lock_);
-      miss_comm_copy = miss_comm_;
-      miss_comm_ = false;
-    }
-    if (PREDICT_FALSE(miss_comm_copy)) {
+    if (PREDICT_FALSE(TakeMissComm())) {
       VLOG(2) << this << ": injecting fault on " << request->ShortDebugString();
       SetResponseError(STATUS(IOError, "Artificial error caused by communication "
           "failure injection."), final_response);
@@ -555,7 +551,8 @@ class LocalTestPeerProxy : public TestPeerProxy {
   }
 
   void SendUpdateRequest(ConsensusRequestPB request,
-                         ConsensusResponsePB* response) {
+                         ConsensusResponsePB* response,
+                         const rpc::ResponseCallback& callback) {
     // Give the other peer a clean response object to write to.
     ConsensusResponsePB other_peer_resp;
     std::shared_ptr<RaftConsensus> peer;
@@ -576,11 +573,15 @@ class LocalTestPeerProxy : public TestPeerProxy {
     }
 
     response->CopyFrom(other_peer_resp);
-    RespondOrMissResponse(&request, other_peer_resp, response, kUpdate);
+    if (PREDICT_FALSE(TakeMissComm())) {
+      VLOG(2) << this << ": injecting fault on " << request.ShortDebugString();
+      SetResponseError(STATUS(IOError, "Artificial error caused by communication "
+          "failure injection."), response);
+    }
+    SubmitWithLatency(callback);
   }
 
 
-
   void SendVoteRequest(const VoteRequestPB* request,
                        VoteResponsePB* response) {
 
@@ -618,10 +619,47 @@ class LocalTestPeerProxy : public TestPeerProxy {
     return peer_uuid_;
   }
 
+  // Emulates network latency for update requests, the delay is applied to both the request
+  // and the response. Requires proxy to be created with messenger.
+  void SetOneWayLatency(MonoDelta latency) {
+    CHECK_NOTNULL(messenger_);
+    std::lock_guard<simple_spinlock> lock(lock_);
+    one_way_latency_ = latency;
+  }
+
  private:
+  bool TakeMissComm() {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    bool result = miss_comm_;
+    miss_comm_ = false;
+    return result;
+  }
+
+  template <class F>
+  void SubmitWithLatency(const F& f) {
+    MonoDelta latency;
+    {
+      std::lock_guard<simple_spinlock> lock(lock_);
+      latency = one_way_latency_;
+    }
+    if (!latency.Initialized() || latency == MonoDelta::kZero) {
+      WARN_NOT_OK(pool_->SubmitFunc(f), "Submit failed");
+      return;
+    }
+    auto* pool = pool_;
+    messenger_->scheduler().Schedule([pool, f](const Status& status) {
+      // Task is aborted only during messenger shutdown, when pool could be already shutting down.
+      if (status.ok()) {
+        WARN_NOT_OK(pool->SubmitFunc(f), "Submit failed");
+      }
+    }, latency.ToSteadyDuration());
+  }
+
   const std::string peer_uuid_;
   TestPeerMapManager* const peers_;
+  rpc::Messenger* const messenger_;
   bool miss_comm_;
+  MonoDelta one_way_latency_;
 };
 
 class LocalTestPeerProxyFactory : public PeerProxyFactory {
@@ -635,7 +673,7 @@ class LocalTestPeerProxyFactory : public PeerProxyFactory {
 
   PeerProxyPtr NewProxy(const consensus::RaftPeerPB& peer_pb) override {
     auto new_proxy = std::make_unique<LocalTestPeerProxy>(
-        peer_pb.permanent_uuid(), pool_.get(), peers_);
+        peer_pb.permanent_uuid(), pool_.get(), peers_, messenger_.get());
     proxies_.push_back(new_proxy.get());
     return new_proxy;
   }
@@ -83,6 +83,7 @@ DEFINE_int32(max_wait_for_processresponse_before_closing_ms,
              "finish before returning proceding to close the Peer and return");
 TAG_FLAG(max_wait_for_processresponse_before_closing_ms, advanced);
 
+DECLARE_int32(consensus_max_in_flight_requests_per_peer);
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 DECLARE_bool(enable_multi_raft_heartbeat_batcher);
@@ -127,6 +128,8 @@ Peer::Peer(
       queue_(queue),
       multi_raft_batcher_(std::move(multi_raft_batcher)),
       raft_pool_token_(raft_pool_token),
+      max_in_flight_requests_(std::max(FLAGS_consensus_max_in_flight_requests_per_peer, 1)),
+      last_sent_commit_index_(kMinimumOpIdIndex),
       consensus_(consensus),
       messenger_(messenger) {}
 
@@ -156,7 +159,8 @@ Status Peer::Init() {
 Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
   // If the peer is currently sending, return Status::OK().
   // If there are new requests in the queue we'll get them on ProcessResponse().
-  auto performing_update_lock = LockPerformingUpdate(std::try_to_lock);
+  auto performing_update_lock = max_in_flight_requests_ > 1
+      ? LockForPipelinedSend() : LockPerformingUpdate(std::try_to_lock);
   if (!performing_update_lock.owns_lock()) {
     return Status::OK();
   }
@@ -198,7 +202,49 @@ Status Peer::SignalRequest(RequestTriggerMode trigger_mode) {
   return status;
 }
 
+std::unique_lock<AtomicTryMutex> Peer::LockForPipelinedSend() {
+  // The flag is set before trying to lock, so the current holder would see it after unlocking.
+  send_requested_.store(true, std::memory_order_seq_cst);
+  auto performing_update_lock = LockPerformingUpdate(std::try_to_lock);
+  if (performing_update_lock.owns_lock()) {
+    send_requested_.store(false, std::memory_order_release);
+  }
+  return performing_update_lock;
+}
+
 void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
+  auto retain_self = shared_from_this();
+  DoSendNextRequest(trigger_mode);
+
+  // In pipelined mode performing_update_mutex_ is released right after the request is sent, so
+  // other threads could request sending while we were holding it.
+  while (max_in_flight_requests_ > 1 && send_requested_.load(std::memory_order_seq_cst)) {
+    auto performing_update_lock = LockForPipelinedSend();
+    if (!performing_update_lock.owns_lock()) {
+      break;
+    }
+    performing_update_lock.release();
+    DoSendNextRequest(RequestTriggerMode::kNonEmptyOnly);
+  }
+}
+
+Peer::InFlightRequest* Peer::AcquireInFlightRequestUnlocked() {
+  if (regular_request_in_flight_) {
+    return nullptr;
+  }
+  if (!free_in_flight_requests_.empty()) {
+    auto* result = free_in_flight_requests_.back();
+    free_in_flight_requests_.pop_back();
+    return result;
+  }
+  if (in_flight_requests_.size() >= max_in_flight_requests_) {
+    return nullptr;
+  }
+  in_flight_requests_.push_back(std::make_unique<InFlightRequest>());
+  return in_flight_requests_.back().get();
+}
+
+void Peer::DoSendNextRequest(RequestTriggerMode trigger_mode) {
   auto retain_self = shared_from_this();
   DCHECK(performing_update_mutex_.is_locked()) << "Cannot send request";
 
@@ -207,13 +253,37 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   if (!processing_lock.owns_lock()) {
     return;
   }
+
+  // In pipelined mode each request in flight uses its own instance of request and response.
+  InFlightRequest* in_flight_request = nullptr;
+  if (max_in_flight_requests_ > 1) {
+    in_flight_request = AcquireInFlightRequestUnlocked();
+    if (!in_flight_request) {
+      // Will send request after receiving response.
+      return;
+    }
+  }
+  const auto release_in_flight_request = ScopeExit(
+      [this, &in_flight_request, &processing_lock] {
+    if (!in_flight_request) {
+      return;
+    }
+    if (processing_lock.owns_lock()) {
+      free_in_flight_requests_.push_back(in_flight_request);
+    } else {
+      std::lock_guard<simple_spinlock> lock(peer_lock_);
+      free_in_flight_requests_.push_back(in_flight_request);
+    }
+  });
+  auto& request = in_flight_request ? in_flight_request->request : update_request_;
+
   // Since there's a couple of return paths from this function, setup a cleanup, in case we fill in
-  // ops inside update_request_, but do not get to use them.
+  // ops inside request, but do not get to use them.
   bool needs_cleanup = true;
-  const auto scope_exit = ScopeExit([&needs_cleanup, this](){
+  const auto scope_exit = ScopeExit([&needs_cleanup, &request, this](){
     if (needs_cleanup) {
-      // Since we will not be using update_request_, we should cleanup the reserved ops.
-      CleanRequestOps(&update_request_);
+      // Since we will not be using request, we should cleanup the reserved ops.
+      CleanRequestOps(&request);
     }
   });
 
@@ -221,17 +291,27 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   bool needs_remote_bootstrap = false;
   bool last_exchange_successful = false;
   PeerMemberType member_type = PeerMemberType::UNKNOWN_MEMBER_TYPE;
-  int64_t commit_index_before = update_request_.has_committed_op_id() ?
-      update_request_.committed_op_id().index() : kMinimumOpIdIndex;
+  int64_t commit_index_before;
+  if (in_flight_request) {
+    commit_index_before = last_sent_commit_index_;
+  } else {
+    commit_index_before = update_request_.has_committed_op_id() ?
+        update_request_.committed_op_id().index() : kMinimumOpIdIndex;
+  }
+  int64_t pipelined_request_id = 0;
   ReplicateMsgsHolder msgs_holder;
   Status s = queue_->RequestForPeer(
-      peer_pb_.permanent_uuid(), &update_request_, &msgs_holder, &needs_remote_bootstrap,
-      &member_type, &last_exchange_successful);
-  int64_t commit_index_after = update_request_.has_committed_op_id() ?
-      update_request_.committed_op_id().index() : kMinimumOpIdIndex;
+      peer_pb_.permanent_uuid(), &request, &msgs_holder, &needs_remote_bootstrap,
+      &member_type, &last_exchange_successful,
+      in_flight_request ? &pipelined_request_id : nullptr);
+  int64_t commit_index_after = request.has_committed_op_id() ?
+      request.committed_op_id().index() : kMinimumOpIdIndex;
 
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX(INFO) << "Could not obtain request from queue for peer: " << s;
+    if (pipelined_request_id) {
+      queue_->RequestWasNotSent(peer_pb_.permanent_uuid(), pipelined_request_id);
+    }
     return;
   }
 
@@ -269,7 +349,10 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
       auto uuid = peer_pb_.permanent_uuid();
       // Remove these here, before we drop the locks.
       needs_cleanup = false;
-      CleanRequestOps(&update_request_);
+      CleanRequestOps(&request);
+      if (pipelined_request_id) {
+        queue_->RequestWasNotSent(uuid, pipelined_request_id);
+      }
       processing_lock.unlock();
       performing_update_lock.unlock();
       consensus::ChangeConfigRequestPB req;
@@ -300,19 +383,19 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
     }
   }
 
-  if (update_request_.tablet_id().empty()) {
-    update_request_.set_tablet_id(tablet_id_);
-    update_request_.set_caller_uuid(leader_uuid_);
-    update_request_.set_dest_uuid(peer_pb_.permanent_uuid());
+  if (request.tablet_id().empty()) {
+    request.set_tablet_id(tablet_id_);
+    request.set_caller_uuid(leader_uuid_);
+    request.set_dest_uuid(peer_pb_.permanent_uuid());
   }
 
-  const bool req_is_heartbeat = update_request_.ops_size() == 0 &&
+  const bool req_is_heartbeat = request.ops_size() == 0 &&
                                 commit_index_after <= commit_index_before;
 
   // If the queue is empty, check if we were told to send a status-only message (which is what
   // happens during heartbeats). If not, just return.
   if (PREDICT_FALSE(req_is_heartbeat && trigger_mode == RequestTriggerMode::kNonEmptyOnly)) {
-    queue_->RequestWasNotSent(peer_pb_.permanent_uuid());
+    queue_->RequestWasNotSent(peer_pb_.permanent_uuid(), pipelined_request_id);
     return;
   }
 
@@ -331,7 +414,7 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   // Heartbeat batching allows for network layer savings by reducing CPU cycles
   // spent on computing state, context switching (sending/receiving RPC's)
   // and serializing/deserializing protobufs.
-  if (req_is_heartbeat && multi_raft_batcher_
+  if (req_is_heartbeat && multi_raft_batcher_ && !in_flight_request
       && FLAGS_enable_multi_raft_heartbeat_batcher) {
     auto performing_heartbeat_lock = LockPerformingHeartbeat(std::try_to_lock);
     if (!performing_heartbeat_lock.owns_lock()) {
@@ -358,8 +441,45 @@ void Peer::SendNextRequest(RequestTriggerMode trigger_mode) {
   // and this new request in the same order they were received by the remote peer.
   // TODO: Remove batched but unsent heartbeats (in the respective MultiRaftBatcher) in this case
   minimum_viable_heartbeat_ = cur_heartbeat_id_ + 1;
+
+  if (in_flight_request) {
+    auto* sent_request = in_flight_request;
+    // Request is in flight now, so it should not be released on exit.
+    in_flight_request = nullptr;
+    sent_request->id = pipelined_request_id;
+    if (!pipelined_request_id) {
+      regular_request_in_flight_ = true;
+    }
+    last_sent_commit_index_ = commit_index_after;
+    num_in_flight_requests_.fetch_add(1, std::memory_order_acq_rel);
+    processing_lock.unlock();
+    // Request is sent while performing_update_mutex_ is held, so pipelined requests reach the peer
+    // in the same order as their ops.
+    sent_request->controller.set_invoke_callback_mode(rpc::InvokeCallbackMode::kThreadPoolHigh);
+    proxy_->UpdateAsync(
+        &sent_request->request, trigger_mode, &sent_request->response, &sent_request->controller,
+        std::bind(&Peer::ProcessInFlightResponse, retain_self, sent_request));
+    if (pipelined_request_id && !req_is_heartbeat) {
+      // There could be more ops to send, than fit into a single request.
+      send_requested_.store(true, std::memory_order_seq_cst);
+    }
+    // The next request could be sent without waiting for response to this one.
+    performing_update_lock.unlock();
+    return;
+  }
+
   processing_lock.unlock();
   performing_update_lock.release();
+  // Small requests that carry entries could be coalesced with requests of other tablets
+  // replicated to the same tserver.
+  if (!req_is_heartbeat && multi_raft_batcher_ &&
+      MultiRaftHeartbeatBatcher::ShouldBatchUpdate(update_request_)) {
+    // The batch is serialized later, so ops should be kept alive until response is received.
+    multi_raft_batcher_->AddUpdateToBatch(
+        &update_request_, &update_response_, std::move(msgs_holder),
+        std::bind(&Peer::ProcessUpdateResponse, retain_self, _1));
+    return;
+  }
   controller_.set_invoke_callback_mode(rpc::InvokeCallbackMode::kThreadPoolHigh);
   proxy_->UpdateAsync(&update_request_, trigger_mode, &update_response_, &controller_,
                       std::bind(&Peer::ProcessResponse, retain_self));
@@ -376,7 +496,8 @@ std::unique_lock<simple_spinlock> Peer::StartProcessingUnlocked() {
 }
 
 bool Peer::ProcessResponseWithStatus(const Status& status,
-                                     ConsensusResponsePB* response) {
+                                     ConsensusResponsePB* response,
+                                     int64_t pipelined_request_id) {
   if (!status.ok()) {
     if (status.IsRemoteError()) {
       // Most controller errors are caused by network issues or corner cases like shutdown and
@@ -386,7 +507,7 @@ bool Peer::ProcessResponseWithStatus(const Status& status,
       // remote is responsive.
       queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
     }
-    ProcessResponseError(status);
+    ProcessResponseError(status, pipelined_request_id);
     return false;
   }
 
@@ -402,7 +523,7 @@ bool Peer::ProcessResponseWithStatus(const Status& status,
         Substitute("Leader communication with peer $0 received error $1, will try to "
                    "evict peer", peer_pb_.permanent_uuid(),
                    response->error().ShortDebugString()));
-    ProcessResponseError(StatusFromPB(response->error().status()));
+    ProcessResponseError(StatusFromPB(response->error().status()), pipelined_request_id);
     return false;
   }
 
@@ -419,7 +540,7 @@ bool Peer::ProcessResponseWithStatus(const Status& status,
         peer_pb_.permanent_uuid(),
         Format("Tablet in peer $0 is in FAILED state, will try to evict peer",
                peer_pb_.permanent_uuid()));
-    ProcessResponseError(StatusFromPB(response->error().status()));
+    ProcessResponseError(StatusFromPB(response->error().status()), pipelined_request_id);
   }
 
   // Response should be either error or status.
@@ -435,21 +556,25 @@ bool Peer::ProcessResponseWithStatus(const Status& status,
     // Again, let the queue know that the remote is still responsive, since we will not be sending
     // this error response through to the queue.
     queue_->NotifyPeerIsResponsiveDespiteError(peer_pb_.permanent_uuid());
-    ProcessResponseError(StatusFromPB(response->error().status()));
+    ProcessResponseError(StatusFromPB(response->error().status()), pipelined_request_id);
     return false;
   }
 
   failed_attempts_ = 0;
-  return queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), *response);
+  return queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), *response, pipelined_request_id);
 }
 
 void Peer::ProcessResponse() {
-  DCHECK(performing_update_mutex_.is_locked()) << "Got a response when nothing was pending.";
   auto status = controller_.status();
   if (status.ok()) {
     status = controller_.thread_pool_failure();
   }
   controller_.Reset();
+  ProcessUpdateResponse(status);
+}
+
+void Peer::ProcessUpdateResponse(const Status& status) {
+  DCHECK(performing_update_mutex_.is_locked()) << "Got a response when nothing was pending.";
   CleanRequestOps(&update_request_);
 
   auto performing_update_lock = LockPerformingUpdate(std::adopt_lock);
@@ -466,6 +591,40 @@ void Peer::ProcessResponse() {
   }
 }
 
+void Peer::ProcessInFlightResponse(InFlightRequest* in_flight_request) {
+  auto se = ScopeExit([this] {
+    num_in_flight_requests_.fetch_sub(1, std::memory_order_acq_rel);
+  });
+  auto status = in_flight_request->controller.status();
+  if (status.ok()) {
+    status = in_flight_request->controller.thread_pool_failure();
+  }
+  in_flight_request->controller.Reset();
+  CleanRequestOps(&in_flight_request->request);
+
+  {
+    auto processing_lock = StartProcessingUnlocked();
+    if (!processing_lock.owns_lock()) {
+      return;
+    }
+    bool more_pending = ProcessResponseWithStatus(
+        status, &in_flight_request->response, in_flight_request->id);
+    if (!in_flight_request->id) {
+      regular_request_in_flight_ = false;
+    }
+    free_in_flight_requests_.push_back(in_flight_request);
+    if (!more_pending) {
+      return;
+    }
+  }
+
+  auto performing_update_lock = LockForPipelinedSend();
+  if (performing_update_lock.owns_lock()) {
+    performing_update_lock.release();
+    SendNextRequest(RequestTriggerMode::kAlwaysSend);
+  }
+}
+
 void Peer::ProcessHeartbeatResponse(const Status& status) {
   DCHECK(performing_heartbeat_mutex_.is_locked()) << "Got a heartbeat when nothing was pending.";
   DCHECK(heartbeat_request_.ops_size() == 0) << "Got a heartbeat with a non-zero number of ops.";
@@ -537,8 +696,12 @@ void Peer::ProcessRemoteBootstrapResponse() {
   }
 }
 
-void Peer::ProcessResponseError(const Status& status) {
-  DCHECK(performing_update_mutex_.is_locked() || performing_heartbeat_mutex_.is_locked());
+void Peer::ProcessResponseError(const Status& status, int64_t pipelined_request_id) {
+  DCHECK(performing_update_mutex_.is_locked() || performing_heartbeat_mutex_.is_locked() ||
+         max_in_flight_requests_ > 1);
+  if (pipelined_request_id) {
+    queue_->PipelinedRequestFailed(peer_pb_.permanent_uuid(), pipelined_request_id);
+  }
   failed_attempts_++;
   YB_LOG_WITH_PREFIX_EVERY_N_SECS(WARNING, 5) << "Couldn't send request. "
       << " Status: " << status.ToString() << ". Retrying in the next heartbeat period."
@@ -580,6 +743,22 @@ void Peer::Close() {
     LOG_WITH_PREFIX(INFO) << "Closing peer";
   }
 
+  // In pipelined mode performing_update_mutex_ is not held while requests are in flight, so wait
+  // for their responses here.
+  if (num_in_flight_requests_.load(std::memory_order_acquire) > 0) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    FLAGS_max_wait_for_processresponse_before_closing_ms * 1ms;
+    BackoffWaiter waiter(deadline, 100ms);
+    while (num_in_flight_requests_.load(std::memory_order_acquire) > 0) {
+      if (!waiter.Wait()) {
+        LOG_WITH_PREFIX(WARNING)
+            << "Timed out waiting for responses to pipelined requests. Number of requests in "
+            << "flight: " << num_in_flight_requests_.load(std::memory_order_acquire);
+        break;
+      }
+    }
+  }
+
   auto retain_self = shared_from_this();
 
   queue_->UntrackPeer(peer_pb_.permanent_uuid());
@@ -125,6 +125,13 @@ namespace consensus {
 //        v                               v
 //  SignalRequest()                    return
 //
+// When consensus_max_in_flight_requests_per_peer is greater than 1, peer works in pipelined mode.
+// In this mode 'processing' covers only assembling and sending of a request, so the next request
+// could be sent before the response to the previous one is received, until the number of requests
+// in flight reaches the limit. The queue decides whether the request is pipelined, see
+// PeerMessageQueue::RequestForPeer(). A regular request is sent only when there are no other
+// regular requests in flight.
+//
 class Peer;
 typedef std::shared_ptr<Peer> PeerPtr;
 
@@ -186,12 +193,17 @@ class Peer : public std::enable_shared_from_this<Peer> {
   // requires IO or may block.
   void ProcessResponse();
 
+  // Handles response to the regular update request, that was sent either directly or as part of
+  // multi-Raft update batch.
+  void ProcessUpdateResponse(const Status& status);
+
   // Signals that a heartbeat response was received from the peer.
   void ProcessHeartbeatResponse(const Status& status);
 
   // Returns true if there are more pending ops to process, false otherwise.
   bool ProcessResponseWithStatus(const Status& status,
-                                 ConsensusResponsePB* response);
+                                 ConsensusResponsePB* response,
+                                 int64_t pipelined_request_id = 0);
 
   // Fetch the desired remote bootstrap request from the queue and send it to the peer. The callback
   // goes to ProcessRemoteBootstrapResponse().
@@ -204,7 +216,23 @@ class Peer : public std::enable_shared_from_this<Peer> {
   void ProcessRemoteBootstrapResponse();
 
   // Signals there was an error sending the request to the peer.
-  void ProcessResponseError(const Status& status);
+  void ProcessResponseError(const Status& status, int64_t pipelined_request_id = 0);
+
+  struct InFlightRequest;
+
+  // Assembles and sends the next request, the caller should hold performing_update_mutex_.
+  void DoSendNextRequest(RequestTriggerMode trigger_mode);
+
+  // Signals that a response to the request sent in pipelined mode was received.
+  void ProcessInFlightResponse(InFlightRequest* in_flight_request);
+
+  // Returns request that could be used to send a request in pipelined mode, or nullptr if there
+  // are too many requests in flight.
+  InFlightRequest* AcquireInFlightRequestUnlocked();
+
+  // Tries to acquire performing_update_mutex_ in pipelined mode. When it is held by another
+  // thread, that thread will try to send a request after releasing it.
+  std::unique_lock<AtomicTryMutex> LockForPipelinedSend();
 
   // Returns true if the peer is closed and the calling function should return.
   std::unique_lock<simple_spinlock> StartProcessingUnlocked();
@@ -259,6 +287,36 @@ class Peer : public std::enable_shared_from_this<Peer> {
 
   rpc::RpcController controller_;
 
+  // Request sent in pipelined mode.
+  struct InFlightRequest {
+    ConsensusRequestPB request;
+    ConsensusResponsePB response;
+    rpc::RpcController controller;
+    // Id assigned by the queue, 0 when the request is a regular one.
+    int64_t id = 0;
+  };
+
+  // Maximum number of requests in flight, pipelined mode is used when it is greater than 1.
+  const size_t max_in_flight_requests_;
+
+  // All requests allocated for pipelined mode, and ones that are not in flight now.
+  // Protected by peer_lock_.
+  std::vector<std::unique_ptr<InFlightRequest>> in_flight_requests_;
+  std::vector<InFlightRequest*> free_in_flight_requests_;
+
+  // Whether a regular request is in flight in pipelined mode. Protected by peer_lock_.
+  bool regular_request_in_flight_ = false;
+
+  // Commit index sent in the last request in pipelined mode.
+  int64_t last_sent_commit_index_;
+
+  // Number of requests sent in pipelined mode, whose responses were not processed yet. Close()
+  // waits for them.
+  std::atomic<size_t> num_in_flight_requests_{0};
+
+  // Set when a request should be sent in pipelined mode, but performing_update_mutex_ was held.
+  std::atomic<bool> send_requested_{false};
+
   // Held if there is an outstanding request.  This is used in order to ensure that we only have a
   // single request outstanding at a time, and to wait for the outstanding requests at Close().
   AtomicTryMutex performing_update_mutex_;
@@ -36,6 +36,7 @@
 
 #include <algorithm>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -83,6 +84,13 @@ DEFINE_uint64(consensus_max_batch_size_bytes, 4_MB,
 TAG_FLAG(consensus_max_batch_size_bytes, advanced);
 TAG_FLAG(consensus_max_batch_size_bytes, runtime);
 
+DEFINE_int32(consensus_max_in_flight_requests_per_peer, 1,
+             "Maximum number of UpdateConsensus requests, that leader could have in flight to a "
+             "single peer. Values greater than 1 enable pipelined replication to peers that are in "
+             "sync with the leader, so replication throughput over links with high round trip time "
+             "is not limited by consensus_max_batch_size_bytes per round trip.");
+TAG_FLAG(consensus_max_in_flight_requests_per_peer, advanced);
+
 DEFINE_int32(follower_unavailable_considered_failed_sec, 900,
              "Seconds that a leader is unable to successfully heartbeat to a "
              "follower after which the follower is considered to be failed and "
@@ -196,6 +204,15 @@ std::string PeerMessageQueue::TrackedPeer::ToString() const {
 void PeerMessageQueue::TrackedPeer::ResetLeaderLeases() {
   leader_lease_expiration.Reset();
   leader_ht_lease_expiration.Reset();
+  ResetPipeline();
+}
+
+void PeerMessageQueue::TrackedPeer::ResetPipeline() {
+  pipelined_requests.clear();
+}
+
+int64_t PeerMessageQueue::TrackedPeer::NextIndexToSend() const {
+  return pipelined_requests.empty() ? next_index : std::max(next_index, pipeline_next_index);
 }
 
 void PeerMessageQueue::TrackedPeer::ResetLastRequest() {
@@ -480,7 +497,8 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ReplicateMsgsHolder* msgs_holder,
                                         bool* needs_remote_bootstrap,
                                         PeerMemberType* member_type,
-                                        bool* last_exchange_successful) {
+                                        bool* last_exchange_successful,
+                                        int64_t* pipelined_request_id) {
   static constexpr uint64_t kSendUnboundedLogOps = std::numeric_limits<uint64_t>::max();
   DCHECK(request->ops().empty()) << request->ShortDebugString();
 
@@ -491,6 +509,7 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   int64_t previously_sent_index;
   uint64_t num_log_ops_to_send;
   HybridTime propagated_safe_time;
+  int64_t request_id = 0;
 
   // Should be before now_ht, i.e. not greater than propagated_hybrid_time.
   if (context_) {
@@ -510,6 +529,21 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     HybridTime now_ht;
 
     is_new = peer->is_new;
+    // Requests are pipelined only when the last exchange with the peer was successful, so it is
+    // known that the peer has ops that we are going to send after.
+    const bool pipelined =
+        pipelined_request_id && !is_new && peer->is_last_exchange_successful &&
+        !peer->needs_remote_bootstrap && FLAGS_consensus_max_in_flight_requests_per_peer > 1;
+    if (pipelined) {
+      if (peer->pipelined_requests.empty()) {
+        peer->pipeline_next_index = peer->next_index;
+      }
+      request_id = ++peer->last_pipelined_request_id;
+    }
+    if (pipelined_request_id) {
+      *pipelined_request_id = request_id;
+    }
+
     if (!is_new) {
       now_ht = clock_->Now();
 
@@ -530,9 +564,19 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
 
       // Because of coarse clocks we subtract 2ms, to be sure that our local version of lease
       // does not expire after it expires at follower.
-      peer->leader_lease_expiration.last_sent =
+      auto leader_lease_expiration =
           CoarseMonoClock::Now() + leader_lease_duration_ms * 1ms - kCoarseClockPrecision * 2;
-      peer->leader_ht_lease_expiration.last_sent = ht_lease_expiration_micros;
+      if (request_id) {
+        peer->pipelined_requests.push_back(TrackedPeer::PipelinedRequest {
+          .id = request_id,
+          .first_index = peer->NextIndexToSend(),
+          .leader_lease_expiration = leader_lease_expiration,
+          .leader_ht_lease_expiration = ht_lease_expiration_micros,
+        });
+      } else {
+        peer->leader_lease_expiration.last_sent = leader_lease_expiration;
+        peer->leader_ht_lease_expiration.last_sent = ht_lease_expiration_micros;
+      }
     } else {
       now_ht = clock_->Now();
       request->clear_leader_lease_duration_ms();
@@ -580,7 +624,12 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     *needs_remote_bootstrap = peer->needs_remote_bootstrap;
 
     previously_sent_index = peer->next_index - 1;
-    if (FLAGS_enable_consensus_exponential_backoff && peer->last_num_messages_sent >= 0) {
+    if (request_id) {
+      // Pipelined request continues after ops of the previous one, and does not wait for it to
+      // be acknowledged, so backoff is not applied.
+      previously_sent_index = peer->NextIndexToSend() - 1;
+      num_log_ops_to_send = kSendUnboundedLogOps;
+    } else if (FLAGS_enable_consensus_exponential_backoff && peer->last_num_messages_sent >= 0) {
       // Previous request to peer has not been acked. Reduce number of entries to be sent
       // in this attempt using exponential backoff. Note that to_index is inclusive.
       num_log_ops_to_send = GetNumMessagesToSendWithBackoff(peer->last_num_messages_sent);
@@ -590,7 +639,9 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
       num_log_ops_to_send = kSendUnboundedLogOps;
     }
 
-    peer->current_retransmissions++;
+    if (!request_id) {
+      peer->current_retransmissions++;
+    }
 
     if (peer->member_type == PeerMemberType::VOTER) {
       is_voter = true;
@@ -656,7 +707,14 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
         return STATUS(NotFound, "Peer not tracked.");
       }
 
-      peer->last_num_messages_sent = result->messages.size();
+      if (!request_id) {
+        peer->last_num_messages_sent = result->messages.size();
+      } else if (!result->messages.empty() && !peer->pipelined_requests.empty() &&
+                 peer->pipelined_requests.back().id == request_id) {
+        // Pipeline could be reset while we were reading ops, in this case following requests
+        // start from next_index.
+        peer->pipeline_next_index = result->messages.back()->id().index() + 1;
+      }
     }
 
     ScopedTrackedConsumption consumption;
@@ -1186,7 +1244,8 @@ void PeerMessageQueue::NotifyPeerIsResponsiveDespiteError(const std::string& pee
   peer->last_successful_communication_time = MonoTime::Now();
 }
 
-void PeerMessageQueue::RequestWasNotSent(const std::string& peer_uuid) {
+void PeerMessageQueue::RequestWasNotSent(
+    const std::string& peer_uuid, int64_t pipelined_request_id) {
   LockGuard scoped_lock(queue_lock_);
   DCHECK_NE(State::kQueueConstructed, queue_state_.state);
 
@@ -1196,12 +1255,49 @@ void PeerMessageQueue::RequestWasNotSent(const std::string& peer_uuid) {
     return;
   }
 
+  if (pipelined_request_id) {
+    // Request was not sent, so its ops should be sent by the next request.
+    auto& requests = peer->pipelined_requests;
+    auto it = std::find_if(
+        requests.begin(), requests.end(),
+        [pipelined_request_id](const auto& request) { return request.id == pipelined_request_id; });
+    if (it == requests.end()) {
+      return;
+    }
+    if (std::next(it) == requests.end()) {
+      peer->pipeline_next_index = it->first_index;
+      requests.erase(it);
+    } else {
+      // Following requests were sent without ops of this one, so they don't match the peer's log.
+      peer->ResetPipeline();
+    }
+    return;
+  }
+
   peer->ResetLastRequest();
 }
 
+void PeerMessageQueue::PipelinedRequestFailed(
+    const std::string& peer_uuid, int64_t pipelined_request_id) {
+  LockGuard scoped_lock(queue_lock_);
+  TrackedPeer* peer = FindPtrOrNull(peers_map_, peer_uuid);
+  if (PREDICT_FALSE(queue_state_.state != State::kQueueOpen || peer == nullptr)) {
+    return;
+  }
+
+  VLOG_WITH_PREFIX_UNLOCKED(1)
+      << "Pipelined request " << pipelined_request_id << " to " << peer_uuid << " failed, "
+      << "resending ops starting from " << peer->next_index;
+  peer->ResetPipeline();
+  // The next request will be a regular one, so replication will be pipelined again after the peer
+  // acknowledges it.
+  peer->is_last_exchange_successful = false;
+}
+
 
 bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
-                                        const ConsensusResponsePB& response) {
+                                        const ConsensusResponsePB& response,
+                                        int64_t pipelined_request_id) {
   DCHECK(response.IsInitialized()) << "Error: Uninitialized: "
       << response.InitializationErrorString() << ". Response: " << response.ShortDebugString();
 
@@ -1251,6 +1347,24 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
     // Application level errors should be handled elsewhere
     DCHECK(!response.has_error());
 
+    // Find the pipelined request, that this response belongs to. It could be missing when the
+    // pipeline was reset after the request was sent.
+    std::optional<TrackedPeer::PipelinedRequest> pipelined_request;
+    if (pipelined_request_id) {
+      auto& requests = peer->pipelined_requests;
+      auto it = std::find_if(
+          requests.begin(), requests.end(),
+          [pipelined_request_id](const auto& request) {
+            return request.id == pipelined_request_id;
+          });
+      if (it != requests.end()) {
+        pipelined_request = *it;
+        requests.erase(it);
+      }
+    }
+    // Responses could be processed out of order, when there are other requests in flight.
+    const bool could_be_reordered = pipelined_request_id || !peer->pipelined_requests.empty();
+
     // Take a snapshot of the current peer status.
     TrackedPeer previous = *peer;
 
@@ -1303,6 +1417,8 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
 
       if (PREDICT_FALSE(status.has_error())) {
         peer->is_last_exchange_successful = false;
+        // Ops of the pipelined requests that are still in flight don't match the peer's log.
+        peer->ResetPipeline();
         switch (status.error().code()) {
           case ConsensusErrorPB::PRECEDING_ENTRY_DIDNT_MATCH: {
             DCHECK(status.has_last_received());
@@ -1332,6 +1448,14 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       }
     }
 
+    if (could_be_reordered && previous.last_received > peer->last_received &&
+        previous.is_last_exchange_successful) {
+      // Response to an earlier request was processed after the response to a later one. Peer
+      // does not lose ops received from the current leader, so keep the latest known state.
+      peer->last_received = previous.last_received;
+      peer->next_index = previous.next_index;
+    }
+
     peer->is_last_exchange_successful = true;
     peer->num_sst_files = response.num_sst_files();
 
@@ -1352,7 +1476,7 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
 
     // If our log has the next request for the peer or if the peer's committed index is lower than
     // our own, set 'more_pending' to true.
-    result = log_cache_.HasOpBeenWritten(peer->next_index) ||
+    result = log_cache_.HasOpBeenWritten(peer->NextIndexToSend()) ||
         (peer->last_known_committed_idx < queue_state_.committed_op_id.index);
 
     mode_copy = queue_state_.mode;
@@ -1366,8 +1490,15 @@ bool PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
         }
       }
 
-      peer->leader_lease_expiration.OnReplyFromFollower();
-      peer->leader_ht_lease_expiration.OnReplyFromFollower();
+      if (!pipelined_request_id) {
+        peer->leader_lease_expiration.OnReplyFromFollower();
+        peer->leader_ht_lease_expiration.OnReplyFromFollower();
+      } else if (pipelined_request) {
+        auto& lease = peer->leader_lease_expiration.last_received;
+        lease = std::max(lease, pipelined_request->leader_lease_expiration);
+        auto& ht_lease = peer->leader_ht_lease_expiration.last_received;
+        ht_lease = std::max(ht_lease, pipelined_request->leader_ht_lease_expiration);
+      }
 
       majority_replicated.op_id = queue_state_.majority_replicated_op_id;
       majority_replicated.leader_lease_expiration = LeaderLeaseExpirationWatermark();
@@ -33,6 +33,7 @@
 #ifndef YB_CONSENSUS_CONSENSUS_QUEUE_H_
 #define YB_CONSENSUS_CONSENSUS_QUEUE_H_
 
+#include <deque>
 #include <iosfwd>
 #include <map>
 #include <set>
@@ -107,8 +108,10 @@ struct FollowerWatermark {
 // This also takes care of pushing requests to peers as new operations are added, and notifying
 // RaftConsensus when the commit index advances.
 //
-// TODO Currently this class is able to track one outstanding operation per peer. If we want to have
-// more than one outstanding RPC we need to modify it.
+// By default there is one outstanding request per peer. When
+// consensus_max_in_flight_requests_per_peer is greater than 1, requests to a peer that is in sync
+// with the leader are pipelined, i.e. the next batch is sent right after the previous one, without
+// waiting for its response. See TrackedPeer::pipelined_requests.
 class PeerMessageQueue {
  public:
   struct TrackedPeer {
@@ -143,6 +146,14 @@ class PeerMessageQueue {
 
     void ResetLastRequest();
 
+    // Forgets requests sent in pipelined mode, so next request resends all ops starting from
+    // next_index. Responses to forgotten requests are processed as regular responses, but don't
+    // extend the leader lease.
+    void ResetPipeline();
+
+    // Returns index of the next op that should be sent to the peer.
+    int64_t NextIndexToSend() const;
+
     // UUID of the peer.
     const std::string uuid;
 
@@ -196,6 +207,32 @@ class PeerMessageQueue {
     // Member type of this peer in the config.
     PeerMemberType member_type = PeerMemberType::UNKNOWN_MEMBER_TYPE;
 
+    // Request that was sent to the peer in pipelined mode, and was not responded yet.
+    struct PipelinedRequest {
+      int64_t id;
+
+      // Index of the first op that could be sent in this request, i.e. the next index to send
+      // before it was assembled.
+      int64_t first_index;
+
+      // Leader leases, sent in this request. Since responses to pipelined requests could be
+      // processed in any order, each of them extends the lease only up to the value sent in the
+      // corresponding request.
+      CoarseTimePoint leader_lease_expiration;
+      MicrosTime leader_ht_lease_expiration;
+    };
+
+    // Pipelined requests in the order they were sent.
+    std::deque<PipelinedRequest> pipelined_requests;
+
+    // Id of the last pipelined request.
+    int64_t last_pipelined_request_id = 0;
+
+    // Index of the next op to send in pipelined mode, i.e. the op following the last op sent in
+    // pipelined_requests. Valid only when pipelined_requests is not empty, otherwise next_index is
+    // used.
+    int64_t pipeline_next_index = kInvalidOpIdIndex;
+
     uint64_t num_sst_files = 0;
 
     std::optional<CloudInfoPB> cloud_info;
@@ -292,13 +329,21 @@ class PeerMessageQueue {
   // not delete the entries. The simplest way is to pass the same instance of ConsensusRequestPB to
   // RequestForPeer(): the buffer will replace the old entries with new ones without de-allocating
   // the old ones if they are still required.
+  //
+  // When 'pipelined_request_id' is specified, the caller is able to keep several requests to this
+  // peer in flight. If the peer is in sync with the leader, the request is assembled after the ops
+  // of the previous pipelined requests, and its id is stored in 'pipelined_request_id'. Otherwise
+  // it is set to 0 and the request is a regular one, that starts after the last op acknowledged by
+  // the peer. The id should be passed to ResponseFromPeer(), PipelinedRequestFailed() or
+  // RequestWasNotSent().
   virtual Status RequestForPeer(
       const std::string& uuid,
       ConsensusRequestPB* request,
       ReplicateMsgsHolder* msgs_holder,
       bool* needs_remote_bootstrap,
       PeerMemberType* member_type = nullptr,
-      bool* last_exchange_successful = nullptr);
+      bool* last_exchange_successful = nullptr,
+      int64_t* pipelined_request_id = nullptr);
 
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
@@ -320,9 +365,15 @@ class PeerMessageQueue {
   // Updates the request queue with the latest response of a peer, returns whether this peer has
   // more requests pending.
   virtual bool ResponseFromPeer(const std::string& peer_uuid,
-                                const ConsensusResponsePB& response);
+                                const ConsensusResponsePB& response,
+                                int64_t pipelined_request_id = 0);
+
+  void RequestWasNotSent(const std::string& peer_uuid, int64_t pipelined_request_id = 0);
 
-  void RequestWasNotSent(const std::string& peer_uuid);
+  // Notifies the queue that pipelined request was not delivered to the peer, or its response
+  // could not be processed. Following pipelined requests would not match the peer's log, so
+  // the queue restarts replication from the last op acknowledged by the peer.
+  void PipelinedRequestFailed(const std::string& peer_uuid, int64_t pipelined_request_id);
 
   // Closes the queue, peers are still allowed to call UntrackPeer() and ResponseFromPeer() but no
   // additional peers can be tracked or messages queued.
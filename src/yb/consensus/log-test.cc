@@ -34,6 +34,8 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 #include <boost/function.hpp>
@@ -111,6 +113,64 @@ class LogTest : public LogTestBase {
     return Status::OK();
   }
 
+  // Writes batches of compressible entries to the log using specified codec, and checks that they
+  // are read back.
+  void TestCompression(LogEntryCompressionPB codec) {
+    constexpr int kNumBatches = 50;
+    constexpr int kEntriesPerBatch = 10;
+
+    options_.compression_codec = codec;
+    BuildLog();
+
+    OpIdPB op_id = MakeOpId(1, 1);
+    const std::string payload(1000, 'x');
+    for (int batch = 0; batch != kNumBatches; ++batch) {
+      ReplicateMsgs replicates;
+      for (int i = 0; i != kEntriesPerBatch; ++i) {
+        auto replicate = std::make_shared<ReplicateMsg>();
+        replicate->mutable_id()->CopyFrom(op_id);
+        replicate->set_op_type(NO_OP);
+        replicate->set_hybrid_time(clock_->Now().ToUint64());
+        replicate->mutable_noop_request()->set_payload_for_tests(payload + std::to_string(i));
+        op_id.set_index(op_id.index() + 1);
+        replicates.push_back(replicate);
+      }
+      Synchronizer s;
+      ASSERT_OK(log_->AsyncAppendReplicates(
+          replicates, yb::OpId(), RestartSafeCoarseTimePoint::FromUInt64(1),
+          s.AsStatusCallback()));
+      ASSERT_OK(s.Wait());
+    }
+    // Small batch, that is not reduced by compression.
+    ASSERT_OK(AppendNoOp(&op_id));
+    ASSERT_OK(log_->Close());
+
+    std::unique_ptr<LogReader> reader;
+    ASSERT_OK(LogReader::Open(fs_manager_->env(), nullptr, "Log reader: ", tablet_wal_path_,
+                              nullptr, nullptr, &reader));
+    SegmentSequence segments;
+    ASSERT_OK(reader->GetSegmentsSnapshot(&segments));
+    int64_t expected_index = 1;
+    for (const auto& segment : segments) {
+      if (codec == LOG_ENTRY_NO_COMPRESSION) {
+        ASSERT_FALSE(segment->header().has_compression_codec());
+      } else {
+        ASSERT_EQ(codec, segment->header().compression_codec());
+      }
+      auto read_entries = segment->ReadEntries();
+      ASSERT_OK(read_entries.status);
+      for (const auto& entry : read_entries.entries) {
+        ASSERT_EQ(expected_index, entry->replicate().id().index());
+        if (expected_index <= kNumBatches * kEntriesPerBatch) {
+          ASSERT_EQ(payload + std::to_string((expected_index - 1) % kEntriesPerBatch),
+                    entry->replicate().noop_request().payload_for_tests());
+        }
+        ++expected_index;
+      }
+    }
+    ASSERT_EQ(kNumBatches * kEntriesPerBatch + 2, expected_index);
+  }
+
   Status AppendNewEmptySegmentToReader(int sequence_number,
                                        int first_repl_index,
                                        LogReader* reader) {
@@ -355,6 +415,20 @@ TEST_F(LogTest, TestFsyncDataSize) {
   LOG(INFO)<< "Wrote " << size << " batches to log";
 }
 
+TEST_F(LogTest, TestNoCompression) {
+  TestCompression(LOG_ENTRY_NO_COMPRESSION);
+}
+
+TEST_F(LogTest, TestLZ4Compression) {
+  TestCompression(LOG_ENTRY_LZ4);
+}
+
+#if defined(ZSTD)
+TEST_F(LogTest, TestZstdCompression) {
+  TestCompression(LOG_ENTRY_ZSTD);
+}
+#endif
+
 // Regression test for part of KUDU-735:
 // if a log is not preallocated, we should properly track its on-disk size as we append to
 // it.
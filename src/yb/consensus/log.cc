@@ -865,7 +865,8 @@ Status Log::DoAppend(LogEntryBatch* entry_batch,
 
     // If the size of this entry overflows the current segment, get a new one.
     if (allocation_state() == SegmentAllocationState::kAllocationNotStarted) {
-      if (active_segment_->Size() + entry_batch_bytes + kEntryHeaderSize > cur_max_segment_size_) {
+      if (active_segment_->Size() + entry_batch_bytes + active_segment_->entry_header_size() >
+              cur_max_segment_size_) {
         LOG_WITH_PREFIX(INFO) << "Max segment size " << cur_max_segment_size_ << " reached. "
                               << "Starting new segment allocation.";
         RETURN_NOT_OK(AsyncAllocateSegment());
@@ -1741,6 +1742,9 @@ Status Log::SwitchToAllocatedSegment() {
   header.set_minor_version(kLogMinorVersion);
   header.set_sequence_number(active_segment_sequence_number_);
   header.set_unused_tablet_id(tablet_id_);
+  if (options_.compression_codec != LOG_ENTRY_NO_COMPRESSION) {
+    header.set_compression_codec(options_.compression_codec);
+  }
 
   // Set up the new footer. This will be maintained as the segment is written.
   footer_builder_.Clear();
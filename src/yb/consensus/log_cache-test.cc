@@ -65,6 +65,7 @@ using std::atomic;
 using std::shared_ptr;
 using std::thread;
 
+DECLARE_bool(enable_log_cache_compression);
 DECLARE_int32(log_cache_size_limit_mb);
 DECLARE_int32(global_log_cache_size_limit_mb);
 DECLARE_int32(global_log_cache_size_limit_percentage);
@@ -364,6 +365,38 @@ TEST_F(LogCacheTest, TestMemoryLimit) {
   ASSERT_EQ(cache_->BytesUsed(), 0);
 }
 
+// When compression is enabled, old ops should be compressed instead of being evicted, and still be
+// readable from the cache.
+TEST_F(LogCacheTest, TestCompressInsteadOfEvict) {
+  FLAGS_enable_log_cache_compression = true;
+  FLAGS_log_cache_size_limit_mb = 1;
+  CloseAndReopenCache(MinimumOpId());
+
+  const int kPayloadSize = 400_KB;
+  const int kNumOps = 5;
+  ASSERT_OK(AppendReplicateMessagesToCache(1, kNumOps, kPayloadSize));
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+
+  // Zero filled payload is highly compressible, so all ops should fit into the limit.
+  ASSERT_EQ(kNumOps, cache_->num_cached_ops());
+  ASSERT_LE(cache_->BytesUsed(), 1_MB);
+  ASSERT_GT(cache_->metrics_.compressed_ops->value(), 0);
+
+  auto read_result = ASSERT_RESULT(cache_->ReadOps(0, 8_MB));
+  ASSERT_EQ(kNumOps, read_result.messages.size());
+  for (int i = 0; i != kNumOps; ++i) {
+    const auto& msg = *read_result.messages[i];
+    ASSERT_EQ(OpIdStrForIndex(i + 1), OpIdToString(msg.id()));
+    ASSERT_EQ(kPayloadSize, msg.noop_request().payload_for_tests().size());
+  }
+  ASSERT_EQ(0, cache_->metrics_.disk_reads->value());
+
+  // Compressed ops are evicted as usual.
+  cache_->EvictThroughOp(kNumOps);
+  ASSERT_EQ(0, cache_->num_cached_ops());
+  ASSERT_EQ(0, cache_->BytesUsed());
+}
+
 TEST_F(LogCacheTest, TestGlobalMemoryLimitMB) {
   ANNOTATE_UNPROTECTED_WRITE(FLAGS_global_log_cache_size_limit_mb) = 4;
   ANNOTATE_UNPROTECTED_WRITE(FLAGS_global_log_cache_size_limit_percentage) = 100;
@@ -43,6 +43,7 @@
 #include "yb/consensus/opid_util.h"
 
 #include "yb/gutil/bind.h"
+#include "yb/gutil/casts.h"
 #include "yb/gutil/map-util.h"
 #include "yb/gutil/strings/human_readable.h"
 
@@ -76,6 +77,16 @@ DEFINE_int32(global_log_cache_size_limit_percentage, 5,
              "entries across all tablets. Default is 5.");
 TAG_FLAG(global_log_cache_size_limit_percentage, advanced);
 
+DEFINE_bool(enable_log_cache_compression, false,
+            "When log cache exceeds its memory limit, compress the oldest entries, that could "
+            "still be needed by lagging followers or CDC, before evicting them. Compressed entries "
+            "are decompressed on read.");
+TAG_FLAG(enable_log_cache_compression, advanced);
+
+DEFINE_int32(log_cache_compression_min_entry_bytes, 512,
+             "Log cache entries smaller than this value are not compressed.");
+TAG_FLAG(log_cache_compression_min_entry_bytes, advanced);
+
 DEFINE_test_flag(bool, log_cache_skip_eviction, false,
                  "Don't evict log entries in tests.");
 
@@ -90,6 +101,12 @@ METRIC_DEFINE_gauge_int64(tablet, log_cache_size, "Log Cache Memory Usage",
 METRIC_DEFINE_counter(tablet, log_cache_disk_reads, "Log Cache Disk Reads",
                       yb::MetricUnit::kEntries,
                       "Amount of operations read from disk.");
+METRIC_DEFINE_counter(tablet, log_cache_compressed_ops, "Log Cache Compressed Operations",
+                      yb::MetricUnit::kEntries,
+                      "Number of log cache entries that were compressed instead of being evicted.");
+METRIC_DEFINE_counter(tablet, log_cache_compression_bytes_saved,
+                      "Log Cache Compression Bytes Saved", yb::MetricUnit::kBytes,
+                      "Amount of log cache memory saved by compression of entries.");
 
 DECLARE_bool(get_changes_honor_deadline);
 
@@ -100,6 +117,30 @@ namespace {
 
 const std::string kParentMemTrackerId = "log_cache"s;
 
+// LZ4 is used because entries are decompressed on the replication path.
+constexpr auto kLogCacheCompressionCodec = log::LOG_ENTRY_LZ4;
+
+Result<ReplicateMsgPtr> DecompressMsg(
+    const yb::OpId& op_id, OperationType op_type, size_t uncompressed_size,
+    const faststring& data) {
+  faststring buffer;
+  RETURN_NOT_OK(log::DecompressEntryBatch(
+      kLogCacheCompressionCodec, Slice(data), uncompressed_size, &buffer));
+  auto msg = std::make_shared<ReplicateMsg>();
+  if (!msg->ParseFromArray(buffer.data(), narrow_cast<int>(buffer.size()))) {
+    return STATUS_FORMAT(Corruption, "Failed to parse compressed log cache entry $0", op_id);
+  }
+  return msg;
+}
+
+}
+
+yb::OpId LogCache::CacheEntry::op_id() const {
+  return msg ? yb::OpId::FromPB(msg->id()) : compressed->op_id;
+}
+
+OperationType LogCache::CacheEntry::op_type() const {
+  return msg ? msg->op_type() : compressed->op_type;
 }
 
 typedef vector<const ReplicateMsg*>::const_iterator MsgIter;
@@ -302,7 +343,7 @@ Result<yb::OpId> LogCache::LookupOpId(int64_t op_index) const {
     }
     auto iter = cache_.find(op_index);
     if (iter != cache_.end()) {
-      return yb::OpId::FromPB(iter->second.msg->id());
+      return iter->second.op_id();
     }
   }
 
@@ -314,13 +355,17 @@ namespace {
 
 // Calculate the total byte size that will be used on the wire to replicate this message as part of
 // a consensus update request. This accounts for the length delimiting and tagging of the message.
-int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
+int64_t TotalByteSizeForMessage(size_t serialized_size) {
   auto msg_size = google::protobuf::internal::WireFormatLite::LengthDelimitedSize(
-    msg.ByteSize());
+    serialized_size);
   msg_size += 1; // for the type tag
   return msg_size;
 }
 
+int64_t TotalByteSizeForMessage(const ReplicateMsg& msg) {
+  return TotalByteSizeForMessage(msg.ByteSizeLong());
+}
+
 Status UpdateResultHeaderSchemaFromSegment(
     log::LogReader* log_reader, const int64_t segment_seq_num, ReadOpsResult* result) {
   const auto segment_result = log_reader->GetSegmentBySequenceNumber(segment_seq_num);
@@ -356,6 +401,8 @@ Result<ReadOpsResult> LogCache::ReadOps(int64_t after_op_index,
                                << ", to_op_index: " << to_op_index
                                << ", max_size_bytes: " << max_size_bytes;
   ReadOpsResult result;
+  // Positions in result.messages, that should be filled by decompressed entries.
+  std::vector<std::pair<size_t, std::shared_ptr<const CompressedMsg>>> compressed_entries;
   int64_t starting_op_segment_seq_num;
   result.preceding_op = VERIFY_RESULT(LookupOpId(after_op_index));
 
@@ -441,12 +488,26 @@ Result<ReadOpsResult> LogCache::ReadOps(int64_t after_op_index,
         if (to_op_index > 0 && next_index > to_op_index) {
           break;
         }
-        const ReplicateMsgPtr& msg = iter->second.msg;
-        int64_t index = msg->id().index();
+        int64_t index = iter->first;
         if (index != next_index) {
           continue;
         }
 
+        const auto& entry = iter->second;
+        if (!entry.msg) {
+          // Compressed entries are decompressed after the lock is released.
+          auto current_message_size = TotalByteSizeForMessage(entry.compressed->uncompressed_size);
+          remaining_space -= current_message_size;
+          if (remaining_space < 0 && !result.messages.empty()) {
+            break;
+          }
+          compressed_entries.emplace_back(result.messages.size(), entry.compressed);
+          result.messages.emplace_back();
+          next_index++;
+          continue;
+        }
+
+        const ReplicateMsgPtr& msg = entry.msg;
         auto current_message_size = TotalByteSizeForMessage(*msg);
         remaining_space -= current_message_size;
         if (remaining_space < 0 && !result.messages.empty()) {
@@ -463,10 +524,21 @@ Result<ReadOpsResult> LogCache::ReadOps(int64_t after_op_index,
     }
   }
   result.have_more_messages = HaveMoreMessages(remaining_space < 0);
+  l.unlock();
+
+  for (const auto& [position, compressed] : compressed_entries) {
+    result.messages[position] = VERIFY_RESULT(DecompressMsg(
+        compressed->op_id, compressed->op_type, compressed->uncompressed_size, compressed->data));
+  }
   return result;
 }
 
 size_t LogCache::EvictThroughOp(int64_t index, int64_t bytes_to_evict) {
+  if (bytes_to_evict != std::numeric_limits<int64_t>::max()) {
+    // Eviction is caused by memory pressure, so entries could be still needed by lagging peers.
+    return CompressOrEvict(index, bytes_to_evict);
+  }
+
   // Capture the evicted messages and release the memory outside of lock.
   ReplicateMsgVector evicted_messages;
   size_t bytes_evicted = 0;
@@ -478,6 +550,116 @@ size_t LogCache::EvictThroughOp(int64_t index, int64_t bytes_to_evict) {
   return bytes_evicted;
 }
 
+size_t LogCache::CompressOrEvict(int64_t stop_after_index, int64_t bytes_to_free) {
+  size_t bytes_freed = 0;
+  if (FLAGS_enable_log_cache_compression) {
+    bytes_freed = CompressSome(stop_after_index, bytes_to_free);
+    if (implicit_cast<int64_t>(bytes_freed) >= bytes_to_free) {
+      return bytes_freed;
+    }
+  }
+
+  // Capture the evicted messages and release the memory outside of lock.
+  ReplicateMsgVector evicted_messages;
+  std::lock_guard<simple_spinlock> lock(lock_);
+  return bytes_freed + EvictSomeUnlocked(
+      stop_after_index, bytes_to_free - bytes_freed, &evicted_messages);
+}
+
+size_t LogCache::CompressSome(int64_t stop_after_index, int64_t bytes_to_free) {
+  struct Candidate {
+    int64_t index;
+    ReplicateMsgPtr msg;
+    std::shared_ptr<CompressedMsg> compressed;
+  };
+  std::vector<Candidate> candidates;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    // Compression usually saves only part of the entry size, so take more candidates.
+    int64_t candidates_size = 0;
+    for (const auto& [index, entry] : cache_) {
+      if (index == 0) {
+        continue;
+      }
+      if (index > stop_after_index || index >= min_pinned_op_index_ ||
+          candidates_size >= 2 * bytes_to_free) {
+        break;
+      }
+      // Schema changes are not compressed, since they are used to fill header_schema in ReadOps.
+      if (!entry.msg || entry.incompressible ||
+          entry.mem_usage < FLAGS_log_cache_compression_min_entry_bytes ||
+          entry.msg->op_type() == consensus::OperationType::CHANGE_METADATA_OP) {
+        continue;
+      }
+      candidates.push_back(Candidate {
+        .index = index,
+        .msg = entry.msg,
+        .compressed = nullptr,
+      });
+      candidates_size += entry.mem_usage;
+    }
+  }
+  if (candidates.empty()) {
+    return 0;
+  }
+
+  faststring serialized;
+  for (auto& candidate : candidates) {
+    const auto& msg = *candidate.msg;
+    serialized.resize(msg.ByteSizeLong());
+    msg.SerializeWithCachedSizesToArray(serialized.data());
+    auto compressed = std::make_shared<CompressedMsg>();
+    if (log::CompressEntryBatch(kLogCacheCompressionCodec, Slice(serialized), &compressed->data)) {
+      compressed->op_id = yb::OpId::FromPB(msg.id());
+      compressed->op_type = msg.op_type();
+      compressed->uncompressed_size = serialized.size();
+      compressed->data.shrink_to_fit();
+      candidate.compressed = std::move(compressed);
+    }
+  }
+
+  int64_t bytes_saved = 0;
+  size_t num_compressed = 0;
+  {
+    std::lock_guard<simple_spinlock> lock(lock_);
+    for (const auto& candidate : candidates) {
+      auto it = cache_.find(candidate.index);
+      // Entry could be evicted or replaced while we were compressing it.
+      if (it == cache_.end() || it->second.msg != candidate.msg) {
+        continue;
+      }
+      auto& entry = it->second;
+      if (!candidate.compressed) {
+        entry.incompressible = true;
+        continue;
+      }
+      int64_t new_mem_usage = sizeof(CompressedMsg) + candidate.compressed->data.capacity();
+      if (new_mem_usage >= entry.mem_usage) {
+        entry.incompressible = true;
+        continue;
+      }
+      auto saved = entry.mem_usage - new_mem_usage;
+      if (entry.tracked) {
+        tracker_->Release(saved);
+      }
+      metrics_.size->DecrementBy(saved);
+      entry.mem_usage = new_mem_usage;
+      entry.compressed = candidate.compressed;
+      // Message is released outside of the lock, since candidates still reference it.
+      entry.msg = nullptr;
+      bytes_saved += saved;
+      ++num_compressed;
+    }
+  }
+
+  metrics_.compressed_ops->IncrementBy(num_compressed);
+  metrics_.compression_bytes_saved->IncrementBy(bytes_saved);
+  VLOG_WITH_PREFIX_UNLOCKED(1)
+      << "Compressed " << num_compressed << " log cache entries, saved "
+      << HumanReadableNumBytes::ToString(bytes_saved);
+  return bytes_saved;
+}
+
 size_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_evict,
     ReplicateMsgVector* evicted_messages) {
   DCHECK(lock_.is_locked());
@@ -493,9 +675,8 @@ size_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_ev
   int64_t bytes_evicted = 0;
   for (auto iter = cache_.begin(); iter != cache_.end();) {
     const CacheEntry& entry = iter->second;
-    const ReplicateMsgPtr& msg = entry.msg;
-    VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << msg->id();
-    int64_t msg_index = msg->id().index();
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "considering for eviction: " << entry.op_id();
+    int64_t msg_index = iter->first;
     if (msg_index == 0) {
       // Always keep our special '0' op.
       ++iter;
@@ -506,11 +687,13 @@ size_t LogCache::EvictSomeUnlocked(int64_t stop_after_index, int64_t bytes_to_ev
       break;
     }
 
-    VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << msg->id();
+    VLOG_WITH_PREFIX_UNLOCKED(2) << "Evicting cache. Removing: " << entry.op_id();
     AccountForMessageRemovalUnlocked(entry);
     bytes_evicted += entry.mem_usage;
 
-    evicted_messages->push_back(msg);
+    if (entry.msg) {
+      evicted_messages->push_back(entry.msg);
+    }
     cache_.erase(iter++);
 
     if (bytes_evicted >= bytes_to_evict) {
@@ -591,12 +774,13 @@ void LogCache::DumpToStrings(vector<string>* lines) const {
   lines->push_back(ToStringUnlocked());
   lines->push_back("Messages:");
   for (const auto& entry : cache_) {
-    const ReplicateMsgPtr msg = entry.second.msg;
+    const auto op_id = entry.second.op_id();
     lines->push_back(
-      Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4",
-                 counter++, msg->id().term(), msg->id().index(),
-                 OperationType_Name(msg->op_type()),
-                 msg->ByteSize()));
+      Substitute("Message[$0] $1.$2 : REPLICATE. Type: $3, Size: $4$5",
+                 counter++, op_id.term, op_id.index,
+                 OperationType_Name(entry.second.op_type()),
+                 entry.second.mem_usage,
+                 entry.second.msg ? "" : " (compressed)"));
   }
 }
 
@@ -610,12 +794,12 @@ void LogCache::DumpToHtml(std::ostream& out) const {
 
   int counter = 0;
   for (const auto& entry : cache_) {
-    const ReplicateMsgPtr msg = entry.second.msg;
+    const auto op_id = entry.second.op_id();
     out << Substitute("<tr><th>$0</th><th>$1.$2</th><td>REPLICATE $3</td>"
                       "<td>$4</td><td>$5</td></tr>",
-                      counter++, msg->id().term(), msg->id().index(),
-                      OperationType_Name(msg->op_type()),
-                      msg->ByteSize(), msg->id().ShortDebugString()) << endl;
+                      counter++, op_id.term, op_id.index,
+                      OperationType_Name(entry.second.op_type()),
+                      entry.second.mem_usage, entry.second.msg ? "cached" : "compressed") << endl;
   }
   out << "</table>";
 }
@@ -625,16 +809,14 @@ void LogCache::TrackOperationsMemory(const OpIds& op_ids) {
     return;
   }
 
-  // Capture the evicted messages and release the memory outside of lock.
-  ReplicateMsgVector evicted_messages;
-
+  int64_t need_to_free = 0;
   {
     std::lock_guard<simple_spinlock> lock(lock_);
 
     size_t mem_required = 0;
     for (const auto& op_id : op_ids) {
       auto it = cache_.find(op_id.index);
-      if (it != cache_.end() && it->second.msg->id().term() == op_id.term) {
+      if (it != cache_.end() && it->second.op_id().term == op_id.term) {
         mem_required += it->second.mem_usage;
         it->second.tracked = true;
       }
@@ -647,7 +829,7 @@ void LogCache::TrackOperationsMemory(const OpIds& op_ids) {
     // Try to consume the memory. If it can't be consumed, we may need to evict.
     if (!tracker_->TryConsume(mem_required)) {
       auto spare = tracker_->SpareCapacity();
-      auto need_to_free = mem_required - spare;
+      need_to_free = mem_required - spare;
       VLOG_WITH_PREFIX_UNLOCKED(1)
           << "Memory limit would be exceeded trying to append "
           << HumanReadableNumBytes::ToString(mem_required)
@@ -656,12 +838,14 @@ void LogCache::TrackOperationsMemory(const OpIds& op_ids) {
           << "): attempting to evict some operations...";
 
       tracker_->Consume(mem_required);
-
-      // TODO: we should also try to evict from other tablets - probably better to evict really old
-      // ops from another tablet than evict recent ops from this one.
-      EvictSomeUnlocked(min_pinned_op_index_, need_to_free, &evicted_messages);
     }
   }
+
+  if (need_to_free > 0) {
+    // TODO: we should also try to evict from other tablets - probably better to evict really old
+    // ops from another tablet than evict recent ops from this one.
+    CompressOrEvict(std::numeric_limits<int64_t>::max(), need_to_free);
+  }
 }
 
 int64_t LogCache::num_cached_ops() const {
@@ -673,7 +857,9 @@ int64_t LogCache::num_cached_ops() const {
 LogCache::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
   : INSTANTIATE_METRIC(num_ops, 0),
     INSTANTIATE_METRIC(size, 0),
-    INSTANTIATE_METRIC(disk_reads) {
+    INSTANTIATE_METRIC(disk_reads),
+    INSTANTIATE_METRIC(compressed_ops),
+    INSTANTIATE_METRIC(compression_bytes_saved) {
 }
 #undef INSTANTIATE_METRIC
 
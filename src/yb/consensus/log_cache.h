@@ -56,6 +56,7 @@
 
 #include "yb/gutil/macros.h"
 
+#include "yb/util/faststring.h"
 #include "yb/util/metrics_fwd.h"
 #include "yb/util/locks.h"
 #include "yb/util/monotime.h"
@@ -90,6 +91,11 @@ struct ReadOpsResult {
 // This stores a set of log messages by their index. New operations can be appended to the end as
 // they are written to the log. Readers fetch entries that were explicitly appended, or they can
 // fetch older entries which are asynchronously fetched from the disk.
+//
+// When the memory limit is exceeded and log cache compression is enabled, the oldest entries,
+// that are still needed by lagging followers or CDC, are compressed before anything is evicted.
+// Such entries are decompressed when they are read, so followers could catch up without reading
+// the log from disk.
 class LogCache {
  public:
   LogCache(const scoped_refptr<MetricEntity>& metric_entity,
@@ -189,10 +195,21 @@ class LogCache {
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimitMB);
   FRIEND_TEST(LogCacheTest, TestGlobalMemoryLimitPercentage);
   FRIEND_TEST(LogCacheTest, TestReplaceMessages);
+  FRIEND_TEST(LogCacheTest, TestCompressInsteadOfEvict);
   friend class LogCacheTest;
 
+  // Compressed form of the cached message.
+  struct CompressedMsg {
+    yb::OpId op_id;
+    OperationType op_type;
+    // Size of the serialized message.
+    size_t uncompressed_size;
+    faststring data;
+  };
+
   // An entry in the cache.
   struct CacheEntry {
+    // Null when the entry is stored in compressed form.
     ReplicateMsgPtr msg;
     // The cached value of msg->SpaceUsedLong(). This method is expensive
     // to compute, so we compute it only once upon insertion.
@@ -200,6 +217,14 @@ class LogCache {
 
     // Did we start memory tracking for this entry.
     bool tracked = false;
+
+    std::shared_ptr<const CompressedMsg> compressed;
+
+    // Compression was already tried for this entry, but did not reduce its size.
+    bool incompressible = false;
+
+    yb::OpId op_id() const;
+    OperationType op_type() const;
   };
 
   typedef boost::container::small_vector<ReplicateMsgPtr, 8> ReplicateMsgVector;
@@ -215,6 +240,14 @@ class LogCache {
   // given message.
   void AccountForMessageRemovalUnlocked(const CacheEntry& entry);
 
+  // Frees bytes_to_free of memory used by entries with index <= stop_after_index. Compresses
+  // the oldest entries when log cache compression is enabled, and evicts them if it was not enough.
+  size_t CompressOrEvict(int64_t stop_after_index, int64_t bytes_to_free);
+
+  // Compresses the oldest not pinned entries with index <= stop_after_index, until bytes_to_free
+  // is saved. Compression is performed without holding the lock. Returns number of saved bytes.
+  size_t CompressSome(int64_t stop_after_index, int64_t bytes_to_free);
+
   // Return a string with stats
   std::string StatsStringUnlocked() const;
 
@@ -289,6 +322,10 @@ class LogCache {
     scoped_refptr<AtomicGauge<int64_t>> size;
 
     scoped_refptr<Counter> disk_reads;
+
+    scoped_refptr<Counter> compressed_ops;
+
+    scoped_refptr<Counter> compression_bytes_saved;
   };
   Metrics metrics_;
 
@@ -38,6 +38,11 @@
 #include <utility>
 
 #include <glog/logging.h>
+#include <lz4.h>
+
+#if defined(ZSTD)
+#include <zstd.h>
+#endif
 
 #include "yb/common/hybrid_time.h"
 
@@ -58,6 +63,7 @@
 #include "yb/util/debug-util.h"
 #include "yb/util/env_util.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/flags.h"
 #include "yb/util/logging.h"
 #include "yb/util/pb_util.h"
 #include "yb/util/result.h"
@@ -119,9 +125,135 @@ DEFINE_bool(
 TAG_FLAG(save_index_into_wal_segments, hidden);
 TAG_FLAG(save_index_into_wal_segments, advanced);
 
+DEFINE_string(log_compression_type, "none",
+              "Codec used to compress WAL entry batches: none, lz4 or zstd. Applied to newly "
+              "created log segments, segments written with any codec remain readable. Has no "
+              "effect until enable_log_compression is set.");
+TAG_FLAG(log_compression_type, advanced);
+
+// Using class kLocalPersisted since older versions cannot read compressed segments, and segments
+// are copied to other nodes of the universe by remote bootstrap.
+DEFINE_AUTO_bool(enable_log_compression, kLocalPersisted, false, true,
+                 "Whether new log segments could be compressed with log_compression_type.");
+
 namespace yb {
 namespace log {
 
+namespace {
+
+constexpr int kZstdCompressionLevel = 1;
+
+Result<LogEntryCompressionPB> ParseLogCompressionType(const std::string& value) {
+  if (value == "none") {
+    return LOG_ENTRY_NO_COMPRESSION;
+  }
+  if (value == "lz4") {
+    return LOG_ENTRY_LZ4;
+  }
+  if (value == "zstd") {
+#if defined(ZSTD)
+    return LOG_ENTRY_ZSTD;
+#else
+    return STATUS(NotSupported, "ZSTD compression is not supported by this build");
+#endif
+  }
+  return STATUS_FORMAT(InvalidArgument, "Unknown log compression type: $0", value);
+}
+
+bool ValidateLogCompressionType(const char* flag_name, const std::string& value) {
+  auto result = ParseLogCompressionType(value);
+  if (!result.ok()) {
+    LOG(ERROR) << flag_name << ": " << result.status();
+    return false;
+  }
+  return true;
+}
+
+DEFINE_validator(log_compression_type, &ValidateLogCompressionType);
+
+LogEntryCompressionPB ConfiguredLogCompressionCodec() {
+  if (!FLAGS_enable_log_compression) {
+    return LOG_ENTRY_NO_COMPRESSION;
+  }
+  auto result = ParseLogCompressionType(FLAGS_log_compression_type);
+  return result.ok() ? *result : LOG_ENTRY_NO_COMPRESSION;
+}
+
+} // namespace
+
+bool CompressEntryBatch(LogEntryCompressionPB codec, const Slice& data, faststring* out) {
+  switch (codec) {
+    case LOG_ENTRY_NO_COMPRESSION:
+      return false;
+    case LOG_ENTRY_LZ4: {
+      const auto input_size = narrow_cast<int>(data.size());
+      const auto bound = LZ4_compressBound(input_size);
+      out->resize(bound);
+      auto size = LZ4_compress_default(
+          data.cdata(), reinterpret_cast<char*>(out->data()), input_size, bound);
+      if (size <= 0) {
+        YB_LOG_EVERY_N_SECS(WARNING, 10) << "LZ4 compression of log entry batch failed";
+        return false;
+      }
+      out->resize(size);
+      return out->size() < data.size();
+    }
+    case LOG_ENTRY_ZSTD: {
+#if defined(ZSTD)
+      out->resize(ZSTD_compressBound(data.size()));
+      auto size = ZSTD_compress(
+          out->data(), out->size(), data.data(), data.size(), kZstdCompressionLevel);
+      if (ZSTD_isError(size)) {
+        YB_LOG_EVERY_N_SECS(WARNING, 10)
+            << "ZSTD compression of log entry batch failed: " << ZSTD_getErrorName(size);
+        return false;
+      }
+      out->resize(size);
+      return out->size() < data.size();
+#else
+      return false;
+#endif
+    }
+  }
+  FATAL_INVALID_PB_ENUM_VALUE(LogEntryCompressionPB, codec);
+}
+
+Status DecompressEntryBatch(
+    LogEntryCompressionPB codec, const Slice& data, size_t uncompressed_length, faststring* out) {
+  out->resize(uncompressed_length);
+  switch (codec) {
+    case LOG_ENTRY_NO_COMPRESSION:
+      break;
+    case LOG_ENTRY_LZ4: {
+      auto size = LZ4_decompress_safe(
+          data.cdata(), reinterpret_cast<char*>(out->data()), narrow_cast<int>(data.size()),
+          narrow_cast<int>(uncompressed_length));
+      if (size < 0 || implicit_cast<size_t>(size) != uncompressed_length) {
+        return STATUS_FORMAT(
+            Corruption, "LZ4 decompression failed: $0, expected length: $1", size,
+            uncompressed_length);
+      }
+      return Status::OK();
+    }
+    case LOG_ENTRY_ZSTD: {
+#if defined(ZSTD)
+      auto size = ZSTD_decompress(out->data(), out->size(), data.data(), data.size());
+      if (ZSTD_isError(size)) {
+        return STATUS_FORMAT(Corruption, "ZSTD decompression failed: $0", ZSTD_getErrorName(size));
+      }
+      if (size != uncompressed_length) {
+        return STATUS_FORMAT(
+            Corruption, "ZSTD decompressed length $0, expected $1", size, uncompressed_length);
+      }
+      return Status::OK();
+#else
+      return STATUS(NotSupported, "ZSTD compression is not supported by this build");
+#endif
+    }
+  }
+  return STATUS_FORMAT(Corruption, "Unexpected log entry codec: $0", codec);
+}
+
 using env_util::ReadFully;
 using std::vector;
 using std::shared_ptr;
@@ -144,6 +276,7 @@ const size_t kLogSegmentHeaderMagicAndHeaderLength = 12;
 const size_t kLogSegmentFooterMagicAndFooterLength  = 12;
 
 const size_t kEntryHeaderSize = 12;
+const size_t kExtendedEntryHeaderSize = 20;
 
 const int kLogMajorVersion = 1;
 const int kLogMinorVersion = 0;
@@ -162,9 +295,14 @@ LogOptions::LogOptions()
       bytes_durable_wal_write_mb(FLAGS_bytes_durable_wal_write_mb),
       preallocate_segments(FLAGS_log_preallocate_segments),
       async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+      compression_codec(ConfiguredLogCompressionCodec()),
       env(Env::Default()) {
 }
 
+size_t EntryHeaderSize(const LogSegmentHeaderPB& header) {
+  return header.has_compression_codec() ? kExtendedEntryHeaderSize : kEntryHeaderSize;
+}
+
 Result<scoped_refptr<ReadableLogSegment>> ReadableLogSegment::Open(
     Env* env, const std::string& path) {
   VLOG(1) << "Parsing wal segment: " << path;
@@ -321,7 +459,7 @@ Status ReadableLogSegment::CopyTo(
     index_entry.offset_in_segment = offset;
     LogEntryBatchPB current_batch;
 
-    if (offset + implicit_cast<ssize_t>(kEntryHeaderSize) < read_up_to) {
+    if (offset + implicit_cast<ssize_t>(entry_header_size()) < read_up_to) {
       RETURN_NOT_OK(ReadEntryHeaderAndBatch(&offset, &read_buf, &current_batch));
     } else {
       return STATUS(Corruption, Format("Truncated log entry at offset $0", offset));
@@ -618,7 +756,7 @@ ReadEntriesResult ReadableLogSegment::ReadEntries(
 
     // Read and validate the entry header first.
     Status s;
-    if (offset + implicit_cast<ssize_t>(kEntryHeaderSize) < read_up_to) {
+    if (offset + implicit_cast<ssize_t>(entry_header_size()) < read_up_to) {
       s = ReadEntryHeaderAndBatch(&offset, &tmp_buf, &current_batch);
     } else {
       s = STATUS(Corruption, Substitute("Truncated log entry at offset $0", offset));
@@ -775,11 +913,13 @@ Result<bool> ReadableLogSegment::ScanForValidEntryHeaders(int64_t offset) {
   const int kChunkSize = 1024 * 1024;
   std::unique_ptr<uint8_t[]> buf(new uint8_t[kChunkSize]);
 
+  const auto header_size = entry_header_size();
+
   // We overlap the reads by the size of the header, so that if a header
   // spans chunks, we don't miss it.
   for (;
-       offset < implicit_cast<int64_t>(file_size() - kEntryHeaderSize);
-       offset += kChunkSize - kEntryHeaderSize) {
+       offset < implicit_cast<int64_t>(file_size() - header_size);
+       offset += kChunkSize - header_size) {
     auto rem = std::min<int64_t>(file_size() - offset, kChunkSize);
     Slice chunk;
     // If encryption is enabled, need to use checkpoint file to read pre-allocated file since
@@ -801,9 +941,9 @@ Result<bool> ReadableLogSegment::ScanForValidEntryHeaders(int64_t offset) {
 
     // Check if this chunk has a valid entry header.
     for (size_t off_in_chunk = 0;
-         off_in_chunk < chunk.size() - kEntryHeaderSize;
+         off_in_chunk < chunk.size() - header_size;
          off_in_chunk++) {
-      const Slice potential_header = Slice(chunk.data() + off_in_chunk, kEntryHeaderSize);
+      const Slice potential_header = Slice(chunk.data() + off_in_chunk, header_size);
 
       EntryHeader header;
       if (DecodeEntryHeader(potential_header, &header).ok()) {
@@ -863,9 +1003,9 @@ Status ReadableLogSegment::ReadEntryHeaderAndBatch(int64_t* offset, faststring*
 
 
 Status ReadableLogSegment::ReadEntryHeader(int64_t *offset, EntryHeader* header) {
-  uint8_t scratch[kEntryHeaderSize];
+  uint8_t scratch[kExtendedEntryHeaderSize];
   Slice slice;
-  RETURN_NOT_OK_PREPEND(ReadFully(readable_file().get(), *offset, kEntryHeaderSize,
+  RETURN_NOT_OK_PREPEND(ReadFully(readable_file().get(), *offset, entry_header_size(),
                                   &slice, scratch),
                         "Could not read log entry header");
 
@@ -875,18 +1015,31 @@ Status ReadableLogSegment::ReadEntryHeader(int64_t *offset, EntryHeader* header)
 }
 
 Status ReadableLogSegment::DecodeEntryHeader(const Slice& data, EntryHeader* header) {
-  DCHECK_EQ(kEntryHeaderSize, data.size());
+  DCHECK_EQ(entry_header_size(), data.size());
+  const auto crc_offset = data.size() - 4;
   header->msg_length = DecodeFixed32(data.data());
   header->msg_crc = DecodeFixed32(data.data() + 4);
-  header->header_crc = DecodeFixed32(data.data() + 8);
+  header->header_crc = DecodeFixed32(data.data() + crc_offset);
 
   // Verify the header.
-  uint32_t computed_crc = crc::Crc32c(data.data(), 8);
+  uint32_t computed_crc = crc::Crc32c(data.data(), crc_offset);
   if (computed_crc != header->header_crc) {
     return STATUS_FORMAT(
         Corruption, "Invalid checksum in log entry head header: found=$0, computed=$1",
         header->header_crc, computed_crc);
   }
+
+  if (data.size() == kExtendedEntryHeaderSize) {
+    header->uncompressed_length = DecodeFixed32(data.data() + 8);
+    auto codec = DecodeFixed32(data.data() + 12);
+    if (!LogEntryCompressionPB_IsValid(codec)) {
+      return STATUS_FORMAT(Corruption, "Invalid log entry codec: $0", codec);
+    }
+    header->codec = static_cast<LogEntryCompressionPB>(codec);
+  } else {
+    header->uncompressed_length = header->msg_length;
+    header->codec = LOG_ENTRY_NO_COMPRESSION;
+  }
   return Status::OK();
 }
 
@@ -937,10 +1090,23 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
   }
 
 
+  Slice batch_data = entry_batch_slice;
+  faststring uncompressed_buf;
+  if (header.codec != LOG_ENTRY_NO_COMPRESSION) {
+    s = DecompressEntryBatch(
+        header.codec, entry_batch_slice, header.uncompressed_length, &uncompressed_buf);
+    if (!s.ok()) {
+      return STATUS_FORMAT(
+          Corruption, "Failed to decompress entry at offset: $0, length: $1. Cause: $2", *offset,
+          header.msg_length, s);
+    }
+    batch_data = Slice(uncompressed_buf);
+  }
+
   LogEntryBatchPB read_entry_batch;
   s = pb_util::ParseFromArray(&read_entry_batch,
-                              entry_batch_slice.data(),
-                              header.msg_length);
+                              batch_data.data(),
+                              batch_data.size());
 
   if (!s.ok()) {
     return STATUS_FORMAT(
@@ -1083,28 +1249,43 @@ Status WritableLogSegment::WriteIndexWithFooterAndClose(
 Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
   DCHECK(is_header_written_);
   DCHECK(!is_footer_written_);
-  uint8_t header_buf[kEntryHeaderSize];
+  uint8_t header_buf[kExtendedEntryHeaderSize];
+  const auto header_size = entry_header_size();
+  Slice payload = data;
+
+  if (header_size == kExtendedEntryHeaderSize) {
+    // Uncompressed length and codec of the message go after its CRC.
+    auto codec = header_.compression_codec();
+    if (CompressEntryBatch(codec, data, &compression_buffer_)) {
+      payload = Slice(compression_buffer_);
+    } else {
+      codec = LOG_ENTRY_NO_COMPRESSION;
+    }
+    InlineEncodeFixed32(&header_buf[8], narrow_cast<uint32_t>(data.size()));
+    InlineEncodeFixed32(&header_buf[12], codec);
+  }
 
   // First encode the length of the message.
-  auto len = data.size();
+  auto len = payload.size();
   InlineEncodeFixed32(&header_buf[0], narrow_cast<uint32_t>(len));
 
   // Then the CRC of the message.
-  uint32_t msg_crc = crc::Crc32c(data.data(), data.size());
+  uint32_t msg_crc = crc::Crc32c(payload.data(), payload.size());
   InlineEncodeFixed32(&header_buf[4], msg_crc);
 
   // Then the CRC of the header
-  uint32_t header_crc = crc::Crc32c(&header_buf, 8);
-  InlineEncodeFixed32(&header_buf[8], header_crc);
+  const auto crc_offset = header_size - 4;
+  uint32_t header_crc = crc::Crc32c(&header_buf, crc_offset);
+  InlineEncodeFixed32(&header_buf[crc_offset], header_crc);
 
   std::array<Slice, 2> slices = {
-      Slice(header_buf, sizeof(header_buf)),
-      Slice(data),
+      Slice(header_buf, header_size),
+      payload,
   };
 
   // Write the header to the file, followed by the batch data itself.
   RETURN_NOT_OK(writable_file_->AppendSlices(slices.data(), slices.size()));
-  written_offset_ += sizeof(header_buf) + data.size();
+  written_offset_ += header_size + payload.size();
 
   return Status::OK();
 }
@@ -73,6 +73,13 @@ extern const char kTmpSuffix[];
 // and checksum of the other two fields (see EntryHeader struct below).
 extern const size_t kEntryHeaderSize;
 
+// In segments with compression codec specified, each log entry is prefixed by its length (4 bytes),
+// CRC (4 bytes), uncompressed length (4 bytes), codec (4 bytes) and checksum of the other fields.
+extern const size_t kExtendedEntryHeaderSize;
+
+// Returns size of entry header used by segment with specified header.
+size_t EntryHeaderSize(const LogSegmentHeaderPB& header);
+
 extern const int kLogMajorVersion;
 extern const int kLogMinorVersion;
 
@@ -101,6 +108,9 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // Codec used to compress entry batches of new segments.
+  LogEntryCompressionPB compression_codec;
+
   uint32_t retention_secs = 0;
 
   // Env for log file operations.
@@ -282,18 +292,27 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
     return readable_to_offset_.load(std::memory_order_acquire);
   }
 
+  size_t entry_header_size() const {
+    return EntryHeaderSize(header_);
+  }
+
  private:
   friend class RefCountedThreadSafe<ReadableLogSegment>;
   friend class LogReader;
   FRIEND_TEST(LogTest, TestWriteAndReadToAndFromInProgressSegment);
 
   struct EntryHeader {
-    // The length of the batch data.
+    // The length of the batch data, as stored in the segment.
     uint32_t msg_length;
 
-    // The CRC32C of the batch data.
+    // The CRC32C of the batch data, as stored in the segment.
     uint32_t msg_crc;
 
+    // The length of the batch data after decompression.
+    uint32_t uncompressed_length = 0;
+
+    LogEntryCompressionPB codec = LOG_ENTRY_NO_COMPRESSION;
+
     // The CRC32C of this EntryHeader.
     uint32_t header_crc;
   };
@@ -336,7 +355,7 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
   // Also increments the passed offset* by the length of the entry.
   Status ReadEntryHeader(int64_t *offset, EntryHeader* header);
 
-  // Decode a log entry header from the given slice, which must be kEntryHeaderSize
+  // Decode a log entry header from the given slice, which must be entry_header_size()
   // bytes long. Returns true if successful, false if corrupt.
   //
   // NOTE: this is performance-critical since it is used by ScanForValidEntryHeaders
@@ -454,6 +473,10 @@ class WritableLogSegment {
     return written_offset_;
   }
 
+  size_t entry_header_size() const {
+    return EntryHeaderSize(header_);
+  }
+
  private:
 
   const std::shared_ptr<WritableFile>& writable_file() const {
@@ -487,6 +510,9 @@ class WritableLogSegment {
 
   faststring index_block_header_buffer_;
 
+  // Buffer for compressed entry batch.
+  faststring compression_buffer_;
+
   DISALLOW_COPY_AND_ASSIGN(WritableLogSegment);
 };
 
@@ -498,6 +524,14 @@ using consensus::ReplicateMsgs;
 // in some hot paths.
 LogEntryBatchPB CreateBatchFromAllocatedOperations(const ReplicateMsgs& msgs);
 
+// Compresses data into out using specified codec. Returns false when data should be stored
+// uncompressed, i.e. compression failed or does not reduce the size.
+bool CompressEntryBatch(LogEntryCompressionPB codec, const Slice& data, faststring* out);
+
+// Decompresses data, that was compressed by CompressEntryBatch, into out.
+Status DecompressEntryBatch(
+    LogEntryCompressionPB codec, const Slice& data, size_t uncompressed_length, faststring* out);
+
 // Checks if 'fname' is a correctly formatted name of log segment file.
 bool IsLogFileName(const std::string& fname);
 
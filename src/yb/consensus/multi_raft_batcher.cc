@@ -18,13 +18,19 @@
 
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/consensus.proxy.h"
+#include "yb/consensus/replicate_msgs_holder.h"
 
+#include "yb/rpc/messenger.h"
 #include "yb/rpc/periodic.h"
+#include "yb/rpc/scheduler.h"
 
 #include "yb/util/flag_tags.h"
+#include "yb/util/metrics.h"
+#include "yb/util/size_literals.h"
 
 using namespace std::literals;
 using namespace std::placeholders;
+using namespace yb::size_literals;
 
 DEFINE_bool(enable_multi_raft_heartbeat_batcher, false,
             "If true, enables multi-Raft batching of raft heartbeats.");
@@ -37,8 +43,36 @@ DEFINE_uint64(multi_raft_batch_size, 0,
               "Maximum batch size for a multi-Raft consensus payload. Ignored if set to zero.");
 TAG_FLAG(multi_raft_batch_size, advanced);
 
+DEFINE_bool(enable_multi_raft_update_batching, false,
+            "If true, small UpdateConsensus requests that carry entries are coalesced into "
+            "multi-Raft batches with requests of other tablets replicated to the same tserver. "
+            "Does not require enable_multi_raft_heartbeat_batcher.");
+
+DEFINE_uint64(multi_raft_update_batch_max_delay_us, 200,
+              "Maximum time that UpdateConsensus request could wait in a multi-Raft update batch, "
+              "while another update batch to the same tserver is in flight.");
+TAG_FLAG(multi_raft_update_batch_max_delay_us, advanced);
+
+DEFINE_uint64(multi_raft_update_batch_max_request_bytes, 16_KB,
+              "Only UpdateConsensus requests with size not greater than this value are coalesced "
+              "into multi-Raft update batches.");
+TAG_FLAG(multi_raft_update_batch_max_request_bytes, advanced);
+
+DEFINE_uint64(multi_raft_update_batch_max_bytes, 1_MB,
+              "Multi-Raft update batch is sent as soon as its size reaches this value.");
+TAG_FLAG(multi_raft_update_batch_max_bytes, advanced);
+
 DECLARE_int32(consensus_rpc_timeout_ms);
 
+METRIC_DEFINE_counter(server, multi_raft_batched_update_requests,
+                      "Multi-Raft Batched Update Requests", yb::MetricUnit::kRequests,
+                      "Number of UpdateConsensus requests that were sent as part of multi-Raft "
+                      "update batches.");
+METRIC_DEFINE_counter(server, multi_raft_update_rpcs_saved,
+                      "Multi-Raft Update RPCs Saved", yb::MetricUnit::kRequests,
+                      "Number of UpdateConsensus RPCs that were not sent, because their requests "
+                      "were coalesced into multi-Raft update batches.");
+
 namespace yb {
 namespace consensus {
 
@@ -50,10 +84,24 @@ namespace {
 struct ResponseCallbackData {
   ConsensusResponsePB* resp;
   HeartbeatResponseCallback callback;
+  // Set for update requests, data of which should be swapped back before invoking the callback.
+  ConsensusRequestPB* req = nullptr;
+  // Keeps ops of the update request alive until the batch is serialized and the response is
+  // received.
+  ReplicateMsgsHolder msgs_holder;
 };
 
 }
 
+struct MultiRaftBatcherMetrics {
+  explicit MultiRaftBatcherMetrics(const MetricEntityPtr& entity)
+      : batched_update_requests(METRIC_multi_raft_batched_update_requests.Instantiate(entity)),
+        update_rpcs_saved(METRIC_multi_raft_update_rpcs_saved.Instantiate(entity)) {}
+
+  scoped_refptr<Counter> batched_update_requests;
+  scoped_refptr<Counter> update_rpcs_saved;
+};
+
 struct MultiRaftHeartbeatBatcher::MultiRaftConsensusData {
   MultiRaftConsensusRequestPB batch_req;
   MultiRaftConsensusResponsePB batch_res;
@@ -65,11 +113,14 @@ MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(
     const HostPort& hostport,
     rpc::ProxyCache* proxy_cache,
     rpc::Messenger* messenger,
-    std::atomic<int>* running_calls)
+    std::atomic<int>* running_calls,
+    MultiRaftBatcherMetrics* metrics)
     : messenger_(messenger),
       consensus_proxy_(std::make_unique<ConsensusServiceProxy>(proxy_cache, hostport)),
       current_batch_(std::make_shared<MultiRaftConsensusData>()),
-      running_calls_(running_calls) {}
+      current_update_batch_(std::make_shared<MultiRaftConsensusData>()),
+      running_calls_(running_calls),
+      metrics_(metrics) {}
 
 void MultiRaftHeartbeatBatcher::Start() {
   std::weak_ptr<MultiRaftHeartbeatBatcher> weak_self = shared_from_this();
@@ -88,6 +139,8 @@ MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() {
   std::lock_guard<std::mutex> lock(mutex_);
   LOG_IF(DFATAL, current_batch_ && !current_batch_->response_callback_data.empty())
       << "Not empty batch in ~MultiRaftHeartbeatBatcher";
+  LOG_IF(DFATAL, current_update_batch_ && !current_update_batch_->response_callback_data.empty())
+      << "Not empty update batch in ~MultiRaftHeartbeatBatcher";
 }
 
 void MultiRaftHeartbeatBatcher::AddRequestToBatch(ConsensusRequestPB* request,
@@ -110,6 +163,109 @@ void MultiRaftHeartbeatBatcher::AddRequestToBatch(ConsensusRequestPB* request,
   SendBatchRequest(data);
 }
 
+bool MultiRaftHeartbeatBatcher::ShouldBatchUpdate(const ConsensusRequestPB& request) {
+  return FLAGS_enable_multi_raft_update_batching &&
+         request.ByteSizeLong() <= FLAGS_multi_raft_update_batch_max_request_bytes;
+}
+
+void MultiRaftHeartbeatBatcher::AddUpdateToBatch(ConsensusRequestPB* request,
+                                                 ConsensusResponsePB* response,
+                                                 ReplicateMsgsHolder msgs_holder,
+                                                 HeartbeatResponseCallback callback) {
+  std::shared_ptr<MultiRaftConsensusData> data;
+  bool added = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_update_batch_) {
+      added = true;
+      current_update_batch_bytes_ += request->ByteSizeLong();
+      current_update_batch_->response_callback_data.push_back({
+        .resp = response,
+        .callback = std::move(callback),
+        .req = request,
+        .msgs_holder = std::move(msgs_holder),
+      });
+      current_update_batch_->batch_req.add_consensus_request()->Swap(request);
+      // When there is no update batch in flight, the request is sent immediately. Otherwise
+      // requests are accumulated until the batch in flight completes.
+      if (update_batches_in_flight_ == 0 ||
+          current_update_batch_bytes_ >= FLAGS_multi_raft_update_batch_max_bytes) {
+        data = PrepareNextUpdateBatch();
+      } else {
+        ScheduleUpdateBatchFlush();
+      }
+    }
+  }
+  if (!added) {
+    callback(STATUS(Aborted, "MultiRaft shutdown"));
+    return;
+  }
+  SendBatchRequest(data, /* update_batch= */ true);
+}
+
+void MultiRaftHeartbeatBatcher::ScheduleUpdateBatchFlush() {
+  if (update_flush_task_id_ != rpc::kInvalidTaskId) {
+    return;
+  }
+  std::weak_ptr<MultiRaftHeartbeatBatcher> weak_self = shared_from_this();
+  update_flush_task_id_ = messenger_->scheduler().Schedule(
+      [weak_self](rpc::ScheduledTaskId task_id, const Status& status) {
+        if (!status.ok()) {
+          return;
+        }
+        if (auto self = weak_self.lock()) {
+          self->FlushUpdateBatch(task_id);
+        }
+      },
+      std::chrono::microseconds(FLAGS_multi_raft_update_batch_max_delay_us));
+}
+
+void MultiRaftHeartbeatBatcher::FlushUpdateBatch(rpc::ScheduledTaskId task_id) {
+  std::shared_ptr<MultiRaftConsensusData> data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (task_id != update_flush_task_id_) {
+      return;
+    }
+    update_flush_task_id_ = rpc::kInvalidTaskId;
+    data = PrepareNextUpdateBatch();
+  }
+  SendBatchRequest(data, /* update_batch= */ true);
+}
+
+void MultiRaftHeartbeatBatcher::UpdateBatchDone() {
+  std::shared_ptr<MultiRaftConsensusData> data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --update_batches_in_flight_;
+    data = PrepareNextUpdateBatch();
+  }
+  SendBatchRequest(data, /* update_batch= */ true);
+}
+
+std::shared_ptr<MultiRaftHeartbeatBatcher::MultiRaftConsensusData>
+    MultiRaftHeartbeatBatcher::PrepareNextUpdateBatch() {
+  if (!current_update_batch_ || current_update_batch_->batch_req.consensus_request_size() == 0) {
+    return nullptr;
+  }
+  if (update_flush_task_id_ != rpc::kInvalidTaskId) {
+    messenger_->scheduler().Abort(update_flush_task_id_);
+    update_flush_task_id_ = rpc::kInvalidTaskId;
+  }
+  auto data = std::make_shared<MultiRaftConsensusData>();
+  current_update_batch_.swap(data);
+  current_update_batch_bytes_ = 0;
+  ++update_batches_in_flight_;
+  if (metrics_) {
+    auto size = data->batch_req.consensus_request_size();
+    metrics_->batched_update_requests->IncrementBy(size);
+    metrics_->update_rpcs_saved->IncrementBy(size - 1);
+  }
+  auto running_calls = ++*running_calls_;
+  LOG_IF(DFATAL, running_calls <= 0) << "Wrong number or running calls: " << running_calls;
+  return data;
+}
+
 void MultiRaftHeartbeatBatcher::PrepareAndSendBatchRequest() {
   std::shared_ptr<MultiRaftConsensusData> data;
   {
@@ -132,7 +288,8 @@ std::shared_ptr<MultiRaftHeartbeatBatcher::MultiRaftConsensusData>
   return data;
 }
 
-void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsensusData> data) {
+void MultiRaftHeartbeatBatcher::SendBatchRequest(
+    std::shared_ptr<MultiRaftConsensusData> data, bool update_batch) {
   if (!data) {
     return;
   }
@@ -140,15 +297,33 @@ void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsen
   data->controller.Reset();
   data->controller.set_timeout(MonoDelta::FromMilliseconds(
       FLAGS_consensus_rpc_timeout_ms * data->batch_req.consensus_request_size()));
-  auto callback = [data, running_calls = running_calls_]() {
+  std::weak_ptr<MultiRaftHeartbeatBatcher> weak_self;
+  if (update_batch) {
+    weak_self = shared_from_this();
+    // Processing of update response could read ops from log cache or disk, so it should not be
+    // done on the reactor thread.
+    data->controller.set_invoke_callback_mode(rpc::InvokeCallbackMode::kThreadPoolHigh);
+  }
+  auto callback = [data, running_calls = running_calls_, weak_self]() {
     --*running_calls;
     auto status = data->controller.status();
+    if (status.ok()) {
+      status = data->controller.thread_pool_failure();
+    }
     for (int i = 0; i < data->batch_req.consensus_request_size(); i++) {
-      auto callback_data = data->response_callback_data[i];
+      auto& callback_data = data->response_callback_data[i];
+      if (callback_data.req) {
+        callback_data.req->Swap(data->batch_req.mutable_consensus_request(i));
+      }
       if (status.ok()) {
         callback_data.resp->Swap(data->batch_res.mutable_consensus_response(i));
       }
       callback_data.callback(status);
+      callback_data.msgs_holder.Reset();
+    }
+    // Requests that were added by the callbacks above are sent in the next batch.
+    if (auto self = weak_self.lock()) {
+      self->UpdateBatchDone();
     }
   };
   consensus_proxy_->MultiRaftUpdateConsensusAsync(
@@ -157,25 +332,42 @@ void MultiRaftHeartbeatBatcher::SendBatchRequest(std::shared_ptr<MultiRaftConsen
 
 void MultiRaftHeartbeatBatcher::Shutdown() {
   decltype(current_batch_) batch;
+  decltype(current_update_batch_) update_batch;
   batch_sender_->Stop();
   {
     std::lock_guard<std::mutex> lock(mutex_);
     batch.swap(current_batch_);
+    update_batch.swap(current_update_batch_);
+    if (update_flush_task_id_ != rpc::kInvalidTaskId) {
+      messenger_->scheduler().Abort(update_flush_task_id_);
+      update_flush_task_id_ = rpc::kInvalidTaskId;
+    }
   }
   static const Status status = STATUS(Aborted, "MultiRaft shutdown");
   for (const auto& callback : batch->response_callback_data) {
     callback.callback(status);
   }
+  for (int i = 0; i < update_batch->batch_req.consensus_request_size(); i++) {
+    auto& callback = update_batch->response_callback_data[i];
+    callback.req->Swap(update_batch->batch_req.mutable_consensus_request(i));
+    callback.callback(status);
+    callback.msgs_holder.Reset();
+  }
 }
 
 MultiRaftManager::MultiRaftManager(rpc::Messenger* messenger,
                                    rpc::ProxyCache* proxy_cache,
-                                   CloudInfoPB local_peer_cloud_info_pb)
+                                   CloudInfoPB local_peer_cloud_info_pb,
+                                   const MetricEntityPtr& metric_entity)
     : messenger_(messenger), proxy_cache_(proxy_cache),
-      local_peer_cloud_info_pb_(std::move(local_peer_cloud_info_pb)) {}
+      local_peer_cloud_info_pb_(std::move(local_peer_cloud_info_pb)) {
+  if (metric_entity) {
+    metrics_ = std::make_unique<MultiRaftBatcherMetrics>(metric_entity);
+  }
+}
 
 MultiRaftHeartbeatBatcherPtr MultiRaftManager::AddOrGetBatcher(const RaftPeerPB& remote_peer_pb) {
-  if (!FLAGS_enable_multi_raft_heartbeat_batcher) {
+  if (!FLAGS_enable_multi_raft_heartbeat_batcher && !FLAGS_enable_multi_raft_update_batching) {
     return nullptr;
   }
 
@@ -194,7 +386,7 @@ MultiRaftHeartbeatBatcherPtr MultiRaftManager::AddOrGetBatcher(const RaftPeerPB&
     return batcher;
   }
   batcher = std::make_shared<MultiRaftHeartbeatBatcher>(
-      hostport, proxy_cache_, messenger_, &running_calls_);
+      hostport, proxy_cache_, messenger_, &running_calls_, metrics_.get());
   batchers_[hostport] = batcher;
   batcher->Start();
   return batcher;
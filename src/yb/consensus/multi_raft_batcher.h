@@ -21,6 +21,7 @@
 
 #include "yb/rpc/rpc_controller.h"
 
+#include "yb/util/metrics_fwd.h"
 #include "yb/util/net/net_util.h"
 
 namespace yb {
@@ -34,6 +35,8 @@ namespace consensus {
 
 using HeartbeatResponseCallback = std::function<void(const Status&)>;
 
+struct MultiRaftBatcherMetrics;
+
 // - MultiRaftHeartbeatBatcher is responsible for the batching of heartbeats
 //   among peers that are communicating with remote peers at the same tserver
 // - It is also responsible for periodically sending out these batched requests
@@ -43,12 +46,18 @@ using HeartbeatResponseCallback = std::function<void(const Status&)>;
 //   FLAGS_multi_raft_batch_size
 // - To improve efficency multiple batches may be processed concurrently
 //   but only a single batch is being built at any given time
+// - Small UpdateConsensus requests that carry entries are coalesced into a separate batch
+//   (see AddUpdateToBatch). Such batch is sent immediately when there is no update batch in flight,
+//   otherwise it is accumulated until the batch in flight completes, or until
+//   FLAGS_multi_raft_update_batch_max_delay_us passes. So the batching window adapts to the load
+//   and round trip time, and requests are not delayed when load is low.
 class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
  public:
   MultiRaftHeartbeatBatcher(const HostPort& hostport,
                             rpc::ProxyCache* proxy_cache,
                             rpc::Messenger* messenger,
-                            std::atomic<int>* running_calls);
+                            std::atomic<int>* running_calls,
+                            MultiRaftBatcherMetrics* metrics = nullptr);
 
   ~MultiRaftHeartbeatBatcher();
 
@@ -63,6 +72,20 @@ class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftH
                          ConsensusResponsePB* response,
                          HeartbeatResponseCallback callback);
 
+  // Adds UpdateConsensus request that carries entries to the update batch.
+  // Request data is swapped into the batch, and swapped back before the callback is invoked,
+  // so the caller could release request ops in the callback.
+  // Since the batch is serialized later, msgs_holder keeps ops referenced by the request alive
+  // until the callback is invoked.
+  // Response handling is the same as in AddRequestToBatch.
+  void AddUpdateToBatch(ConsensusRequestPB* request,
+                        ConsensusResponsePB* response,
+                        ReplicateMsgsHolder msgs_holder,
+                        HeartbeatResponseCallback callback);
+
+  // Returns true if request is small enough to be coalesced by AddUpdateToBatch.
+  static bool ShouldBatchUpdate(const ConsensusRequestPB& request);
+
   void Shutdown();
 
  private:
@@ -75,8 +98,19 @@ class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftH
   // This method will return a nullptr if the current batch is empty.
   std::shared_ptr<MultiRaftConsensusData> PrepareNextBatchRequest() REQUIRES(mutex_);
 
+  // This method will return a nullptr if the current update batch is empty.
+  std::shared_ptr<MultiRaftConsensusData> PrepareNextUpdateBatch() REQUIRES(mutex_);
+
+  // Schedules sending of the current update batch after max batching delay.
+  void ScheduleUpdateBatchFlush() REQUIRES(mutex_);
+
+  // Sends the current update batch, if task_id matches the scheduled flush task.
+  void FlushUpdateBatch(rpc::ScheduledTaskId task_id);
+
+  void UpdateBatchDone();
+
   // If data is null then we will not send a batch request.
-  void SendBatchRequest(std::shared_ptr<MultiRaftConsensusData> data);
+  void SendBatchRequest(std::shared_ptr<MultiRaftConsensusData> data, bool update_batch = false);
 
   void MultiRaftUpdateHeartbeatResponseCallback(std::shared_ptr<MultiRaftConsensusData> data);
 
@@ -90,7 +124,17 @@ class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftH
 
   std::shared_ptr<MultiRaftConsensusData> current_batch_ GUARDED_BY(mutex_);
 
+  std::shared_ptr<MultiRaftConsensusData> current_update_batch_ GUARDED_BY(mutex_);
+
+  size_t current_update_batch_bytes_ GUARDED_BY(mutex_) = 0;
+
+  int update_batches_in_flight_ GUARDED_BY(mutex_) = 0;
+
+  rpc::ScheduledTaskId update_flush_task_id_ GUARDED_BY(mutex_) = rpc::kInvalidTaskId;
+
   std::atomic<int>* running_calls_;
+
+  MultiRaftBatcherMetrics* metrics_;
 };
 
 // MultiRaftManager is responsible for managing all MultiRaftHeartbeatBatchers
@@ -101,7 +145,8 @@ class MultiRaftManager: public std::enable_shared_from_this<MultiRaftManager> {
  public:
   MultiRaftManager(rpc::Messenger* messenger,
                    rpc::ProxyCache* proxy_cache,
-                   CloudInfoPB local_peer_cloud_info_pb);
+                   CloudInfoPB local_peer_cloud_info_pb,
+                   const MetricEntityPtr& metric_entity = nullptr);
 
   ~MultiRaftManager();
 
@@ -129,6 +174,8 @@ class MultiRaftManager: public std::enable_shared_from_this<MultiRaftManager> {
 
   bool shutdown_ = false;
   std::atomic<int> running_calls_{0};
+
+  std::unique_ptr<MultiRaftBatcherMetrics> metrics_;
 };
 
 }   // namespace consensus
@@ -55,8 +55,10 @@
 
 #include "yb/server/logical_clock.h"
 
+#include "yb/util/format.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/status_log.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
@@ -64,6 +66,8 @@
 
 DECLARE_int32(raft_heartbeat_interval_ms);
 DECLARE_bool(enable_leader_failure_detection);
+DECLARE_int32(consensus_max_in_flight_requests_per_peer);
+DECLARE_uint64(consensus_max_batch_size_bytes);
 
 METRIC_DECLARE_entity(table);
 METRIC_DECLARE_entity(tablet);
@@ -406,6 +410,48 @@ class RaftConsensusQuorumTest : public YBTest {
     }
   }
 
+  // Replicates batches of operations over links with different emulated latencies and reports
+  // replication throughput. Batch size is limited, so each operation batch requires several
+  // UpdateConsensus round trips.
+  void BenchmarkReplication(int max_in_flight_requests) {
+    constexpr int kNumOps = 1000;
+    const int kFollower0Idx = 0;
+    const int kFollower1Idx = 1;
+    const int kLeaderIdx = 2;
+
+    FLAGS_consensus_max_in_flight_requests_per_peer = max_in_flight_requests;
+    FLAGS_consensus_max_batch_size_bytes = 1_KB;
+    ASSERT_OK(BuildAndStartConfig(3));
+
+    OpIdPB last_op_id;
+    for (auto one_way_latency : {0ms, 2ms, 10ms}) {
+      for (auto follower_idx : {kFollower0Idx, kFollower1Idx}) {
+        GetLeaderProxyToPeer(follower_idx, kLeaderIdx)->SetOneWayLatency(one_way_latency);
+      }
+      vector<scoped_refptr<ConsensusRound>> rounds;
+      auto start = MonoTime::Now();
+      for (int i = 0; i != kNumOps; ++i) {
+        scoped_refptr<ConsensusRound> round;
+        ASSERT_OK(AppendDummyMessage(kLeaderIdx, &round));
+        rounds.push_back(round);
+      }
+      for (const auto& round : rounds) {
+        ASSERT_OK(WaitForReplicate(round.get()));
+      }
+      auto elapsed = MonoTime::Now().GetDeltaSince(start);
+      rounds.back()->id().ToPB(&last_op_id);
+      LOG(INFO) << Format(
+          "Max in flight: $0, one way latency: $1, ops/sec: $2", max_in_flight_requests,
+          MonoDelta(one_way_latency), kNumOps / std::max(elapsed.ToSeconds(), 1e-6));
+    }
+
+    WaitForReplicateIfNotAlreadyPresent(last_op_id, kFollower0Idx);
+    WaitForReplicateIfNotAlreadyPresent(last_op_id, kFollower1Idx);
+    WaitForCommitIfNotAlreadyPresent(last_op_id, kFollower0Idx, kLeaderIdx);
+    WaitForCommitIfNotAlreadyPresent(last_op_id, kFollower1Idx, kLeaderIdx);
+    VerifyLogs(kLeaderIdx, kFollower0Idx, kFollower1Idx);
+  }
+
   log::LogEntries GatherLogEntries(int idx, const scoped_refptr<Log>& log) {
     EXPECT_OK(log->WaitUntilAllFlushed());
     EXPECT_OK(log->Close());
@@ -726,6 +772,16 @@ TEST_F(RaftConsensusQuorumTest, TestReplicasHandleCommunicationErrors) {
   VerifyLogs(2, 0, 1);
 }
 
+TEST_F(RaftConsensusQuorumTest, BenchmarkReplication) {
+  BenchmarkReplication(1);
+}
+
+// Same as above, but with several UpdateConsensus requests in flight to each follower.
+// Followers should end up with the same log as the leader.
+TEST_F(RaftConsensusQuorumTest, BenchmarkPipelinedReplication) {
+  BenchmarkReplication(4);
+}
+
 // In this test we test the ability of the leader to send heartbeats
 // to replicas by simply pushing nothing after the configuration round
 // and still expecting for the replicas Update() hooks to be called.
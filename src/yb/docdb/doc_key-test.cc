@@ -408,8 +408,7 @@ std::string EncodeSimpleSubDocKeyWithDifferentNonHashPart(const std::string& has
   return EncodeSubDocKey(hash_key, "another_range_key", "another_sub_key", 55555L);
 }
 
-TEST_F(DocKeyTest, TestKeyMatching) {
-  DocDbAwareV2FilterPolicy policy(rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr);
+void TestKeyMatching(const rocksdb::FilterPolicy& policy) {
   std::string keys[] = { "foo", "bar", "test" };
   std::string absent_key = "fake";
 
@@ -436,6 +435,13 @@ TEST_F(DocKeyTest, TestKeyMatching) {
   ASSERT_FALSE(may_match(EncodeSimpleSubDocKey(absent_key))) << "Key: " << absent_key;
 }
 
+TEST_F(DocKeyTest, TestKeyMatching) {
+  TestKeyMatching(
+      DocDbAwareV2FilterPolicy(rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr));
+  TestKeyMatching(
+      DocDbAwareV4FilterPolicy(rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits, nullptr));
+}
+
 TEST_F(DocKeyTest, TestWriteId) {
   SubDocKey subdoc_key(DocKey({KeyEntryValue("a"), KeyEntryValue::Int32(135)}),
                        DocHybridTime(1000000, 4091, 135));
@@ -474,6 +480,20 @@ class IntentCollector {
   std::vector<CollectedIntent>* out_;
 };
 
+TEST_F(DocKeyTest, TestDocKeySliceTransform) {
+  DocKeySliceTransform transform;
+  for (const auto& sub_doc_key : GetVariedSubDocKeys()) {
+    SCOPED_TRACE(GetTestDescriptionForSubDocKey(sub_doc_key));
+    const auto encoded_doc_key = sub_doc_key.doc_key().Encode();
+    const auto encoded_sub_doc_key = sub_doc_key.Encode();
+    ASSERT_TRUE(transform.InDomain(encoded_sub_doc_key.AsSlice()));
+    ASSERT_EQ(encoded_doc_key.AsSlice(), transform.Transform(encoded_sub_doc_key.AsSlice()));
+    ASSERT_TRUE(transform.InRange(encoded_doc_key.AsSlice()));
+    // Key without the final group end marker could not be decoded.
+    ASSERT_FALSE(transform.InDomain(encoded_doc_key.AsSlice().Prefix(encoded_doc_key.size() - 1)));
+  }
+}
+
 TEST_F(DocKeyTest, TestDecodePrefixLengths) {
   for (const auto& sub_doc_key : GetVariedSubDocKeys()) {
     const auto encoded_input = sub_doc_key.Encode();
@@ -16,6 +16,7 @@
 #include <memory>
 #include <sstream>
 
+#include "yb/common/ql_expr.h"
 #include "yb/common/schema.h"
 
 #include "yb/docdb/doc_kv_util.h"
@@ -1196,6 +1197,25 @@ DocDbAwareV3FilterPolicy::GetKeyTransformer() const {
   return &DocKeyComponentsExtractor<DocKeyPart::kUpToHashOrFirstRange>::GetInstance();
 }
 
+const rocksdb::FilterPolicy::KeyTransformer*
+DocDbAwareV4FilterPolicy::GetKeyTransformer() const {
+  return &DocKeyComponentsExtractor<DocKeyPart::kUpToHashOrFirstRange>::GetInstance();
+}
+
+Slice DocKeySliceTransform::Transform(const Slice& key) const {
+  auto size = DocKey::EncodedSize(key, DocKeyPart::kWholeDocKey);
+  return size.ok() ? key.Prefix(*size) : key;
+}
+
+bool DocKeySliceTransform::InDomain(const Slice& key) const {
+  return DocKey::EncodedSize(key, DocKeyPart::kWholeDocKey).ok();
+}
+
+bool DocKeySliceTransform::InRange(const Slice& dst) const {
+  auto size = DocKey::EncodedSize(dst, DocKeyPart::kWholeDocKey);
+  return size.ok() && *size == dst.size();
+}
+
 DocKeyEncoderAfterTableIdStep DocKeyEncoder::CotableId(const Uuid& cotable_id) {
   if (!cotable_id.IsNil()) {
     std::string bytes;
@@ -1439,6 +1459,54 @@ bool DocKeyBelongsTo(Slice doc_key, const Schema& schema) {
   }
 }
 
+namespace {
+
+// Set primary key column values (hashed or range columns) in a QL row value map.
+Status SetQLPrimaryKeyColumnValues(const Schema& schema,
+                                   const size_t begin_index,
+                                   const size_t column_count,
+                                   const char* column_type,
+                                   DocKeyDecoder* decoder,
+                                   QLTableRow* table_row) {
+  if (begin_index + column_count > schema.num_columns()) {
+    return STATUS_SUBSTITUTE(
+        Corruption,
+        "$0 primary key columns between positions $1 and $2 go beyond table columns $3",
+        column_type, begin_index, begin_index + column_count - 1, schema.num_columns());
+  }
+  KeyEntryValue key_entry_value;
+  for (size_t i = 0, j = begin_index; i < column_count; i++, j++) {
+    const auto ql_type = schema.column(j).type();
+    QLTableColumn& column = table_row->AllocColumn(schema.column_id(j));
+    RETURN_NOT_OK(decoder->DecodeKeyEntryValue(&key_entry_value));
+    key_entry_value.ToQLValuePB(ql_type, &column.value);
+  }
+  return decoder->ConsumeGroupEnd();
+}
+
+} // namespace
+
+Status DecodeKeyColumns(const Schema& schema, const Slice& doc_key, QLTableRow* table_row) {
+  DocKeyDecoder decoder(doc_key);
+  RETURN_NOT_OK(decoder.DecodeCotableId());
+  RETURN_NOT_OK(decoder.DecodeColocationId());
+  bool has_hash_components = VERIFY_RESULT(decoder.DecodeHashCode());
+
+  // Populate the key column values from the doc key. The key column values in doc key were
+  // written in the same order as in the table schema (see DocKeyFromQLKey). If the range columns
+  // are present, read them also.
+  if (has_hash_components) {
+    RETURN_NOT_OK(SetQLPrimaryKeyColumnValues(
+        schema, 0, schema.num_hash_key_columns(), "hash", &decoder, table_row));
+  }
+  if (!decoder.GroupEnded()) {
+    RETURN_NOT_OK(SetQLPrimaryKeyColumnValues(
+        schema, schema.num_hash_key_columns(), schema.num_range_key_columns(), "range", &decoder,
+        table_row));
+  }
+  return Status::OK();
+}
+
 Result<boost::optional<DocKeyHash>> DecodeDocKeyHash(const Slice& encoded_key) {
   DocKey key;
   RETURN_NOT_OK(key.DecodeFrom(encoded_key, DocKeyPart::kUpToHashCode));
@@ -28,6 +28,7 @@
 
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/filter_policy.h"
+#include "yb/rocksdb/slice_transform.h"
 
 #include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/slice.h"
@@ -441,6 +442,10 @@ Result<bool> HashedOrFirstRangeComponentsEqual(const Slice& lhs, const Slice& rh
 
 bool DocKeyBelongsTo(Slice doc_key, const Schema& schema);
 
+// Decodes hash and range components of doc_key into values of corresponding key columns of
+// table_row.
+Status DecodeKeyColumns(const Schema& schema, const Slice& doc_key, QLTableRow* table_row);
+
 // Consumes single primitive value from start of slice.
 // Returns true when value was consumed, false when group end is found. The group end byte is
 // consumed in the latter case.
@@ -838,6 +843,10 @@ class DocDbAwareFilterPolicyBase : public rocksdb::FilterPolicy {
 
   FilterType GetFilterType() const override;
 
+ protected:
+  explicit DocDbAwareFilterPolicyBase(const rocksdb::FilterPolicy* builtin_policy)
+      : builtin_policy_(builtin_policy) {}
+
  private:
   std::unique_ptr<const rocksdb::FilterPolicy> builtin_policy_;
 };
@@ -882,6 +891,36 @@ class DocDbAwareV3FilterPolicy : public DocDbAwareFilterPolicyBase {
   const KeyTransformer* GetKeyTransformer() const override;
 };
 
+// Uses the same key transformation as DocDbAwareV3FilterPolicy, but register-blocked fixed-size
+// filter format (see rocksdb::NewBlockedFixedSizeFilterPolicy), which checks a key using single
+// cache line and supports prefetching cache lines for batches of keys.
+class DocDbAwareV4FilterPolicy : public DocDbAwareFilterPolicyBase {
+ public:
+  DocDbAwareV4FilterPolicy(size_t filter_block_size_bits, rocksdb::Logger* logger)
+      : DocDbAwareFilterPolicyBase(rocksdb::NewBlockedFixedSizeFilterPolicy(
+            filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate,
+            logger)) {}
+
+  const char* Name() const override { return "DocKeyV4Filter"; }
+
+  const KeyTransformer* GetKeyTransformer() const override;
+};
+
+// Extracts encoded DocKey from the key, i.e. identifies the document the key belongs to.
+// Keys that could not be decoded as DocKey are out of domain.
+// Any key that starts with an encoded DocKey has this DocKey, so keys of the same document form
+// a contiguous range. This property is required by rocksdb::NewPrefixSkipListRepFactory.
+class DocKeySliceTransform : public rocksdb::SliceTransform {
+ public:
+  const char* Name() const override { return "DocKeySliceTransform"; }
+
+  Slice Transform(const Slice& key) const override;
+
+  bool InDomain(const Slice& key) const override;
+
+  bool InRange(const Slice& dst) const override;
+};
+
 }  // namespace docdb
 }  // namespace yb
 
@@ -0,0 +1,592 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <gtest/gtest.h>
+
+#include "yb/bfpg/tserver_opcodes.h"
+
+#include "yb/common/ql_expr.h"
+#include "yb/common/ql_value.h"
+#include "yb/common/schema.h"
+
+#include "yb/docdb/doc_expr.h"
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/doc_pg_expr.h"
+#include "yb/docdb/doc_pg_vectorized_expr.h"
+#include "yb/docdb/packed_column_batch.h"
+#include "yb/docdb/packed_row.h"
+#include "yb/docdb/schema_packing.h"
+#include "yb/docdb/value_type.h"
+
+#include "yb/gutil/casts.h"
+
+#include "yb/util/fast_varint.h"
+#include "yb/util/format.h"
+#include "yb/util/random_util.h"
+#include "yb/util/stopwatch.h"
+#include "yb/util/test_macros.h"
+#include "yb/util/test_util.h"
+#include "yb/util/tsan_util.h"
+
+DECLARE_bool(ysql_vectorized_expr_use_simd);
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Postgres type OIDs.
+constexpr int kInt2Oid = 21;
+constexpr int kInt4Oid = 23;
+constexpr int kInt8Oid = 20;
+constexpr int kFloat4Oid = 700;
+constexpr int kFloat8Oid = 701;
+constexpr int kTextOid = 25;
+constexpr int kBoolOid = 16;
+
+// Postgres function OIDs of used comparison operators.
+constexpr int kInt4Gt = 147;
+constexpr int kInt4Le = 149;
+constexpr int kInt2Eq = 63;
+constexpr int kInt8Lt = 469;
+constexpr int kInt84Ne = 475;
+constexpr int kFloat8Ge = 298;
+constexpr int kFloat4Lt = 289;
+
+struct ColumnInfo {
+  const char* name;
+  DataType type;
+  int typid;
+};
+
+// Non key columns of the test table. Attribute number of column is its index plus 2, since
+// attribute 1 is the key.
+const ColumnInfo kColumns[] = {
+  {"v_int2", DataType::INT16, kInt2Oid},
+  {"v_int4", DataType::INT32, kInt4Oid},
+  {"v_int8", DataType::INT64, kInt8Oid},
+  {"v_float4", DataType::FLOAT, kFloat4Oid},
+  {"v_float8", DataType::DOUBLE, kFloat8Oid},
+  {"v_text", DataType::STRING, kTextOid},
+};
+
+constexpr int kKeyAttno = 1;
+
+int Attno(size_t column_idx) {
+  return narrow_cast<int>(column_idx) + kKeyAttno + 1;
+}
+
+std::string Var(size_t column_idx) {
+  return Format(
+      "{VAR :varno 1 :varattno $0 :vartype $1 :vartypmod -1 :varcollid 0 :varlevelsup 0 "
+      ":varnoold 1 :varoattno $0 :location 7}",
+      Attno(column_idx), kColumns[column_idx].typid);
+}
+
+std::string Const(int typid, int len, uint64_t datum) {
+  std::string bytes;
+  for (size_t i = 0; i != sizeof(datum); ++i) {
+    bytes += Format("$0 ", static_cast<int>(static_cast<int8_t>(datum >> (i * 8))));
+  }
+  return Format(
+      "{CONST :consttype $0 :consttypmod -1 :constcollid 0 :constlen $1 :constbyval true "
+      ":constisnull false :location 11 :constvalue $1 [ $2]}",
+      typid, len, bytes);
+}
+
+std::string Int4Const(int32_t value) {
+  return Const(kInt4Oid, 4, static_cast<uint64_t>(static_cast<int64_t>(value)));
+}
+
+std::string Int2Const(int16_t value) {
+  return Const(kInt2Oid, 2, static_cast<uint64_t>(static_cast<int64_t>(value)));
+}
+
+std::string Int8Const(int64_t value) {
+  return Const(kInt8Oid, 8, static_cast<uint64_t>(value));
+}
+
+std::string Float4Const(float value) {
+  return Const(kFloat4Oid, 4, bit_cast<uint32_t>(value));
+}
+
+std::string Float8Const(double value) {
+  return Const(kFloat8Oid, 8, bit_cast<uint64_t>(value));
+}
+
+std::string NullConst(int typid, int len) {
+  return Format(
+      "{CONST :consttype $0 :consttypmod -1 :constcollid 0 :constlen $1 :constbyval true "
+      ":constisnull true :location 11 :constvalue <>}",
+      typid, len);
+}
+
+std::string OpExpr(int funcid, const std::string& lhs, const std::string& rhs) {
+  return Format(
+      "{OPEXPR :opno 0 :opfuncid $0 :opresulttype $1 :opretset false :opcollid 0 :inputcollid 0 "
+      ":args ($2 $3) :location 9}",
+      funcid, kBoolOid, lhs, rhs);
+}
+
+std::string BoolExpr(const char* op, const std::vector<std::string>& args) {
+  std::string joined;
+  for (const auto& arg : args) {
+    joined += " " + arg;
+  }
+  return Format("{BOOLEXPR :boolop $0 :args ($1) :location 13}", op, joined);
+}
+
+std::string NullTest(size_t column_idx, bool is_null) {
+  return Format(
+      "{NULLTEST :arg $0 :nulltesttype $1 :argisrow false :location 15}",
+      Var(column_idx), is_null ? 0 : 1);
+}
+
+PgsqlExpressionPB TSCall(bfpg::TSOpcode opcode) {
+  PgsqlExpressionPB result;
+  result.mutable_tscall()->set_opcode(static_cast<int32_t>(opcode));
+  return result;
+}
+
+PgsqlExpressionPB WhereExpr(const std::string& expr) {
+  auto result = TSCall(bfpg::TSOpcode::kPgEvalExprCall);
+  result.mutable_tscall()->add_operands()->mutable_value()->set_string_value(expr);
+  return result;
+}
+
+class DocPgVectorizedExprTest : public YBTest {
+ protected:
+  void SetUp() override {
+    YBTest::SetUp();
+
+    SchemaBuilder builder;
+    ASSERT_OK(builder.AddHashKeyColumn("h", DataType::INT32));
+    for (size_t i = 0; i != arraysize(kColumns); ++i) {
+      ASSERT_OK(builder.AddColumn(
+          kColumns[i].name, kColumns[i].type, /* is_nullable= */ true, /* is_hash_key= */ false,
+          /* is_static= */ false, /* is_counter= */ false, /* order= */ Attno(i)));
+    }
+    schema_ = builder.Build();
+    schema_packing_.emplace(schema_);
+    batch_.Init(schema_, schema_);
+  }
+
+  // Fills the batch with num_rows random rows, values of integer columns are from a small range
+  // so equality conditions are matched by some rows.
+  void FillBatch(size_t num_rows) {
+    batch_.Clear();
+    for (size_t row = 0; row != num_rows; ++row) {
+      std::vector<QLValuePB> values;
+      for (size_t i = 0; i != arraysize(kColumns); ++i) {
+        values.push_back(RandomValue(kColumns[i].type));
+      }
+      ASSERT_NO_FATALS(AddRow(row, values));
+    }
+  }
+
+  // Fills the batch with rows that have specified value in both real columns and NULL in others.
+  void FillRealBatch(const std::vector<double>& reals) {
+    batch_.Clear();
+    for (size_t row = 0; row != reals.size(); ++row) {
+      std::vector<QLValuePB> values(arraysize(kColumns));
+      values[3].set_float_value(static_cast<float>(reals[row]));
+      values[4].set_double_value(reals[row]);
+      ASSERT_NO_FATALS(AddRow(row, values));
+    }
+  }
+
+  void AddRow(size_t row, const std::vector<QLValuePB>& values) {
+    RowPacker packer(
+        /* schema_version= */ 1, *schema_packing_,
+        /* packed_size_limit= */ std::numeric_limits<int64_t>::max(),
+        /* value_control_fields= */ Slice());
+    for (size_t i = 0; i != arraysize(kColumns); ++i) {
+      ASSERT_OK(packer.AddValue(ColumnIdOf(i), values[i]));
+    }
+    auto packed = ASSERT_RESULT(packer.Complete());
+    ASSERT_EQ(static_cast<ValueEntryType>(packed.consume_byte()), ValueEntryType::kPackedRow);
+    ASSERT_EQ(ASSERT_RESULT(util::FastDecodeUnsignedVarInt(&packed)), 1U);
+    auto doc_key = DocKey(0, {KeyEntryValue::Int32(narrow_cast<int32_t>(row))}, {}).Encode();
+    ASSERT_TRUE(ASSERT_RESULT(batch_.AddRow(doc_key.AsSlice(), *schema_packing_, packed)));
+  }
+
+  QLValuePB RandomValue(DataType type) {
+    if (RandomUniformInt(0, 9) == 0) {
+      return QLValuePB();
+    }
+    QLValuePB result;
+    switch (type) {
+      case DataType::INT16:
+        result.set_int16_value(RandomUniformInt<int16_t>(-100, 100));
+        break;
+      case DataType::INT32:
+        result.set_int32_value(RandomUniformInt<int32_t>(-100, 100));
+        break;
+      case DataType::INT64:
+        result.set_int64_value(RandomUniformInt<int64_t>(-100, 100) * 1000000000000LL);
+        break;
+      case DataType::FLOAT:
+        result.set_float_value(RandomUniformInt(-100, 100) / 4.0f);
+        break;
+      case DataType::DOUBLE:
+        result.set_double_value(
+            RandomUniformInt(0, 50) == 0 ? std::numeric_limits<double>::quiet_NaN()
+                                         : RandomUniformInt(-100, 100) / 8.0);
+        break;
+      case DataType::STRING:
+        result.set_string_value(RandomHumanReadableString(8));
+        break;
+      default:
+        LOG(FATAL) << "Unexpected type: " << type;
+    }
+    return result;
+  }
+
+  PgsqlReadRequestPB NewRequest() {
+    PgsqlReadRequestPB request;
+    for (size_t i = 0; i != arraysize(kColumns); ++i) {
+      auto* col_ref = request.add_col_refs();
+      col_ref->set_column_id(schema_.column_id(schema_.num_key_columns() + i));
+      col_ref->set_attno(Attno(i));
+      col_ref->set_typid(kColumns[i].typid);
+    }
+    return request;
+  }
+
+  ColumnId ColumnIdOf(size_t column_idx) {
+    return schema_.column_id(schema_.num_key_columns() + column_idx);
+  }
+
+  void AddAggregate(PgsqlReadRequestPB* request, bfpg::TSOpcode opcode, size_t column_idx) {
+    request->set_is_aggregate(true);
+    auto expr = TSCall(opcode);
+    expr.mutable_tscall()->add_operands()->set_column_id(ColumnIdOf(column_idx));
+    *request->add_targets() = expr;
+  }
+
+  void AddCountStar(PgsqlReadRequestPB* request) {
+    request->set_is_aggregate(true);
+    auto expr = TSCall(bfpg::TSOpcode::kCount);
+    expr.mutable_tscall()->add_operands()->mutable_value()->set_int64_value(0);
+    *request->add_targets() = expr;
+  }
+
+  // Evaluates request over the batch row by row, as PgsqlReadOperation does without vectorized
+  // executor.
+  Status EvalPerRow(
+      const PgsqlReadRequestPB& request, std::vector<bool>* selection,
+      std::vector<QLExprResult>* aggr_result) {
+    DocPgExprExecutor expr_exec(&schema_);
+    for (const auto& column_ref : request.col_refs()) {
+      RETURN_NOT_OK(expr_exec.AddColumnRef(column_ref));
+    }
+    for (const auto& expr : request.where_clauses()) {
+      RETURN_NOT_OK(expr_exec.AddWhereExpression(expr));
+    }
+    DocExprExecutor aggr_exec;
+    aggr_result->resize(request.targets_size());
+    selection->clear();
+    QLTableRow row;
+    for (size_t i = 0; i != batch_.num_rows(); ++i) {
+      row.Clear();
+      RETURN_NOT_OK(batch_.ToQLTableRow(i, &row));
+      bool match = true;
+      RETURN_NOT_OK(expr_exec.Exec(row, nullptr, &match));
+      selection->push_back(match);
+      if (match && request.is_aggregate()) {
+        size_t idx = 0;
+        for (const auto& target : request.targets()) {
+          RETURN_NOT_OK(aggr_exec.EvalExpr(target, row, (*aggr_result)[idx++].Writer()));
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  Status EvalVectorized(
+      const PgsqlReadRequestPB& request, std::vector<bool>* selection,
+      std::vector<QLExprResult>* aggr_result) {
+    DocPgVectorizedExecutor executor;
+    SCHECK(executor.Prepare(request, schema_), IllegalState, "Request is not supported");
+    SCHECK(VERIFY_RESULT(executor.Filter(batch_)), IllegalState, "Batch is not supported");
+    selection->clear();
+    size_t num_selected = 0;
+    for (size_t i = 0; i != batch_.num_rows(); ++i) {
+      selection->push_back(executor.IsSelected(i));
+      num_selected += executor.IsSelected(i);
+    }
+    SCHECK_EQ(num_selected, executor.num_selected(), IllegalState, "Wrong number of selected");
+    if (request.is_aggregate()) {
+      RETURN_NOT_OK(executor.Aggregate(aggr_result));
+    }
+    return Status::OK();
+  }
+
+  void CheckRequest(const PgsqlReadRequestPB& request) {
+    std::vector<bool> expected_selection;
+    std::vector<QLExprResult> expected_aggr;
+    ASSERT_OK(EvalPerRow(request, &expected_selection, &expected_aggr));
+
+    for (bool use_simd : {true, false}) {
+      FLAGS_ysql_vectorized_expr_use_simd = use_simd;
+      std::vector<bool> selection;
+      std::vector<QLExprResult> aggr;
+      ASSERT_OK(EvalVectorized(request, &selection, &aggr));
+      ASSERT_EQ(selection, expected_selection) << "SIMD: " << use_simd;
+      ASSERT_EQ(aggr.size(), expected_aggr.size());
+      for (size_t i = 0; i != aggr.size(); ++i) {
+        ASSERT_EQ(aggr[i].Value().ShortDebugString(), expected_aggr[i].Value().ShortDebugString())
+            << "Target: " << i << ", SIMD: " << use_simd;
+      }
+    }
+  }
+
+  Schema schema_;
+  boost::optional<SchemaPacking> schema_packing_;
+  PackedColumnBatch batch_;
+};
+
+} // namespace
+
+TEST_F(DocPgVectorizedExprTest, Filter) {
+  FillBatch(1000);
+
+  const std::vector<std::string> conditions = {
+    OpExpr(kInt4Gt, Var(1), Int4Const(10)),
+    OpExpr(kInt4Le, Int4Const(-20), Var(1)),
+    OpExpr(kInt2Eq, Var(0), Int2Const(7)),
+    OpExpr(kInt8Lt, Var(2), Var(2)),
+    OpExpr(kInt8Lt, Var(2), Int8Const(5000000000000LL)),
+    OpExpr(kInt84Ne, Var(2), Int4Const(0)),
+    OpExpr(kFloat8Ge, Var(4), Float8Const(1.5)),
+    OpExpr(kFloat8Ge, Var(4), Float8Const(std::numeric_limits<double>::quiet_NaN())),
+    OpExpr(kFloat4Lt, Var(3), Float4Const(-3.25)),
+    OpExpr(kInt4Gt, Var(1), NullConst(kInt4Oid, 4)),
+    NullTest(5, /* is_null= */ true),
+    NullTest(1, /* is_null= */ false),
+    BoolExpr("and", {
+        OpExpr(kInt4Gt, Var(1), Int4Const(0)), OpExpr(kFloat8Ge, Var(4), Float8Const(0))}),
+    BoolExpr("or", {
+        OpExpr(kInt4Gt, Var(1), Int4Const(50)), OpExpr(kInt2Eq, Var(0), Int2Const(3)),
+        NullTest(2, /* is_null= */ true)}),
+    BoolExpr("not", {BoolExpr("or", {
+        OpExpr(kInt4Gt, Var(1), Int4Const(50)), OpExpr(kFloat4Lt, Var(3), Float4Const(0))})}),
+  };
+
+  for (const auto& condition : conditions) {
+    SCOPED_TRACE(condition);
+    auto request = NewRequest();
+    *request.add_where_clauses() = WhereExpr(condition);
+    CheckRequest(request);
+  }
+}
+
+TEST_F(DocPgVectorizedExprTest, Aggregate) {
+  auto request = NewRequest();
+  *request.add_where_clauses() = WhereExpr(OpExpr(kInt4Gt, Var(1), Int4Const(-50)));
+  *request.add_where_clauses() = WhereExpr(NullTest(5, /* is_null= */ false));
+  AddCountStar(&request);
+  AddAggregate(&request, bfpg::TSOpcode::kCount, 2);
+  AddAggregate(&request, bfpg::TSOpcode::kSumInt16, 0);
+  AddAggregate(&request, bfpg::TSOpcode::kSumInt32, 1);
+  AddAggregate(&request, bfpg::TSOpcode::kSumInt64, 2);
+  AddAggregate(&request, bfpg::TSOpcode::kSumFloat, 3);
+  AddAggregate(&request, bfpg::TSOpcode::kSumDouble, 4);
+  for (size_t i = 0; i != 5; ++i) {
+    AddAggregate(&request, bfpg::TSOpcode::kMin, i);
+    AddAggregate(&request, bfpg::TSOpcode::kMax, i);
+  }
+
+  // Several batches are aggregated into the same result, as it happens during scan.
+  std::vector<bool> selection;
+  std::vector<QLExprResult> expected;
+  std::vector<QLExprResult> actual;
+  DocPgVectorizedExecutor executor;
+  ASSERT_TRUE(executor.Prepare(request, schema_));
+  for (int i = 0; i != 5; ++i) {
+    FillBatch(RandomUniformInt(0, 1000));
+    std::vector<QLExprResult> batch_expected;
+    ASSERT_OK(EvalPerRow(request, &selection, &batch_expected));
+    // Replay per row aggregation on top of the previous batches.
+    DocPgExprExecutor expr_exec(&schema_);
+    for (const auto& column_ref : request.col_refs()) {
+      ASSERT_OK(expr_exec.AddColumnRef(column_ref));
+    }
+    for (const auto& expr : request.where_clauses()) {
+      ASSERT_OK(expr_exec.AddWhereExpression(expr));
+    }
+    DocExprExecutor aggr_exec;
+    expected.resize(request.targets_size());
+    QLTableRow row;
+    for (size_t row_idx = 0; row_idx != batch_.num_rows(); ++row_idx) {
+      if (!selection[row_idx]) {
+        continue;
+      }
+      row.Clear();
+      ASSERT_OK(batch_.ToQLTableRow(row_idx, &row));
+      size_t idx = 0;
+      for (const auto& target : request.targets()) {
+        ASSERT_OK(aggr_exec.EvalExpr(target, row, expected[idx++].Writer()));
+      }
+    }
+
+    ASSERT_TRUE(ASSERT_RESULT(executor.Filter(batch_)));
+    ASSERT_OK(executor.Aggregate(&actual));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t idx = 0; idx != actual.size(); ++idx) {
+      ASSERT_EQ(actual[idx].Value().ShortDebugString(), expected[idx].Value().ShortDebugString())
+          << "Target: " << idx << ", batch: " << i;
+    }
+
+    CheckRequest(request);
+  }
+}
+
+// MIN and MAX of real columns should order NaN after all other values, the same way in a batch
+// and across batches.
+TEST_F(DocPgVectorizedExprTest, NanAcrossBatches) {
+  constexpr auto kNaN = std::numeric_limits<double>::quiet_NaN();
+
+  auto request = NewRequest();
+  for (size_t i = 3; i != 5; ++i) {
+    AddAggregate(&request, bfpg::TSOpcode::kMin, i);
+    AddAggregate(&request, bfpg::TSOpcode::kMax, i);
+  }
+
+  const std::vector<std::vector<std::vector<double>>> scenarios = {
+    {{1.5, kNaN, -2.0}, {kNaN, 5.0, -7.0}},
+    {{kNaN, kNaN}, {3.0, -1.0}},
+    {{3.0, -1.0}, {kNaN}},
+    {{kNaN}, {kNaN, 2.5}, {-4.0}},
+  };
+
+  for (const auto& batches : scenarios) {
+    std::vector<QLExprResult> expected(request.targets_size());
+    std::vector<QLExprResult> actual;
+    DocPgVectorizedExecutor executor;
+    ASSERT_TRUE(executor.Prepare(request, schema_));
+    DocExprExecutor aggr_exec;
+    QLTableRow row;
+    for (const auto& reals : batches) {
+      ASSERT_NO_FATALS(FillRealBatch(reals));
+      for (size_t row_idx = 0; row_idx != batch_.num_rows(); ++row_idx) {
+        row.Clear();
+        ASSERT_OK(batch_.ToQLTableRow(row_idx, &row));
+        size_t idx = 0;
+        for (const auto& target : request.targets()) {
+          ASSERT_OK(aggr_exec.EvalExpr(target, row, expected[idx++].Writer()));
+        }
+      }
+      ASSERT_TRUE(ASSERT_RESULT(executor.Filter(batch_)));
+      ASSERT_OK(executor.Aggregate(&actual));
+    }
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t idx = 0; idx != actual.size(); ++idx) {
+      ASSERT_EQ(actual[idx].Value().ShortDebugString(), expected[idx].Value().ShortDebugString())
+          << "Target: " << idx << ", batches: " << AsString(batches);
+    }
+    // Any NaN is the maximum.
+    ASSERT_TRUE(std::isnan(actual[1].Value().float_value()));
+    ASSERT_TRUE(std::isnan(actual[3].Value().double_value()));
+  }
+}
+
+TEST_F(DocPgVectorizedExprTest, Unsupported) {
+  DocPgVectorizedExecutor executor;
+
+  // Key column.
+  auto request = NewRequest();
+  auto* key_ref = request.add_col_refs();
+  key_ref->set_column_id(schema_.column_id(0));
+  key_ref->set_attno(kKeyAttno);
+  key_ref->set_typid(kInt4Oid);
+  {
+    auto key_var = Format(
+        "{VAR :varno 1 :varattno $0 :vartype $1 :vartypmod -1 :varcollid 0 :varlevelsup 0 "
+        ":varnoold 1 :varoattno $0 :location 7}", kKeyAttno, kInt4Oid);
+    *request.add_where_clauses() = WhereExpr(OpExpr(kInt4Gt, key_var, Int4Const(1)));
+    ASSERT_FALSE(executor.Prepare(request, schema_));
+  }
+
+  // Unknown function.
+  request = NewRequest();
+  *request.add_where_clauses() = WhereExpr(OpExpr(/* int4pl */ 177, Var(1), Int4Const(1)));
+  ASSERT_FALSE(DocPgVectorizedExecutor().Prepare(request, schema_));
+
+  // Comparison of text column.
+  request = NewRequest();
+  *request.add_where_clauses() = WhereExpr(OpExpr(kInt4Gt, Var(5), Int4Const(1)));
+  ASSERT_FALSE(DocPgVectorizedExecutor().Prepare(request, schema_));
+
+  // Malformed expression.
+  request = NewRequest();
+  *request.add_where_clauses() = WhereExpr("{OPEXPR :opfuncid 147 :args (");
+  ASSERT_FALSE(DocPgVectorizedExecutor().Prepare(request, schema_));
+
+  // Aggregate of text column.
+  request = NewRequest();
+  AddAggregate(&request, bfpg::TSOpcode::kMax, 5);
+  ASSERT_FALSE(DocPgVectorizedExecutor().Prepare(request, schema_));
+}
+
+// Compares time of per row evaluation with vectorized one, for a typical analytic query:
+// SELECT count(*), sum(v_int8), min(v_int4), max(v_int4) WHERE v_int4 > 0 AND v_int2 <= 50.
+TEST_F(DocPgVectorizedExprTest, Benchmark) {
+  constexpr size_t kBatchSize = 1024;
+  const int kIterations = RegularBuildVsSanitizers(200, 5);
+
+  FillBatch(kBatchSize);
+  auto request = NewRequest();
+  *request.add_where_clauses() = WhereExpr(OpExpr(kInt4Gt, Var(1), Int4Const(0)));
+  *request.add_where_clauses() = WhereExpr(OpExpr(/* int2le */ 148, Var(0), Int2Const(50)));
+  AddCountStar(&request);
+  AddAggregate(&request, bfpg::TSOpcode::kSumInt64, 2);
+  AddAggregate(&request, bfpg::TSOpcode::kMin, 1);
+  AddAggregate(&request, bfpg::TSOpcode::kMax, 1);
+  CheckRequest(request);
+
+  std::vector<bool> selection;
+  std::vector<QLExprResult> aggr;
+  LOG_TIMING(INFO, Format("Per row evaluation of $0 rows", kIterations * kBatchSize)) {
+    for (int i = 0; i != kIterations; ++i) {
+      ASSERT_OK(EvalPerRow(request, &selection, &aggr));
+    }
+  }
+
+  for (bool use_simd : {false, true}) {
+    FLAGS_ysql_vectorized_expr_use_simd = use_simd;
+    if (use_simd && !DocPgVectorizedExecutor::SimdEnabled()) {
+      LOG(INFO) << "SIMD is not supported on this host";
+      continue;
+    }
+    DocPgVectorizedExecutor executor;
+    ASSERT_TRUE(executor.Prepare(request, schema_));
+    aggr.clear();
+    LOG_TIMING(INFO, Format(
+        "Vectorized evaluation of $0 rows, SIMD: $1", kIterations * kBatchSize, use_simd)) {
+      for (int i = 0; i != kIterations; ++i) {
+        ASSERT_TRUE(ASSERT_RESULT(executor.Filter(batch_)));
+        ASSERT_OK(executor.Aggregate(&aggr));
+      }
+    }
+  }
+}
+
+} // namespace docdb
+} // namespace yb
@@ -0,0 +1,1354 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/doc_pg_vectorized_expr.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include "yb/bfpg/tserver_opcodes.h"
+
+#include "yb/common/ql_value.h"
+#include "yb/common/schema.h"
+
+#include "yb/docdb/packed_column_batch.h"
+#include "yb/docdb/value_type.h"
+
+#include "yb/gutil/casts.h"
+#include "yb/gutil/cpu.h"
+#include "yb/gutil/endian.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
+#include "yb/util/result.h"
+#include "yb/util/slice.h"
+#include "yb/util/status_format.h"
+
+DEFINE_bool(ysql_vectorized_expr_use_simd, true,
+            "Whether vectorized evaluation of pushed down YSQL expressions should use SIMD "
+            "instructions when they are supported by the CPU.");
+TAG_FLAG(ysql_vectorized_expr_use_simd, advanced);
+
+#if defined(__x86_64__)
+#define YB_VECTORIZED_AVX2 1
+#define YB_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define YB_VECTORIZED_AVX2 0
+#endif
+
+namespace yb {
+namespace docdb {
+
+namespace {
+
+// Postgres type OIDs of supported constants, see pg_type.dat.
+constexpr uint32_t kInt8Oid = 20;
+constexpr uint32_t kInt2Oid = 21;
+constexpr uint32_t kInt4Oid = 23;
+constexpr uint32_t kFloat4Oid = 700;
+constexpr uint32_t kFloat8Oid = 701;
+
+// Order matches columns of kIntCompareFuncs and kRealCompareFuncs.
+YB_DEFINE_ENUM(CompareOp, (kEq)(kNe)(kLt)(kLe)(kGt)(kGe));
+
+// Postgres function OIDs of comparison operators for =, <>, <, <=, >, >=, see pg_proc.dat.
+// Integer comparisons are performed on int64 values, real ones on double values.
+constexpr uint32_t kIntCompareFuncs[][kCompareOpMapSize] = {
+  {63, 145, 64, 148, 146, 151},          // int2
+  {65, 144, 66, 149, 147, 150},          // int4
+  {467, 468, 469, 471, 470, 472},        // int8
+  {158, 164, 160, 166, 162, 168},        // int24
+  {159, 165, 161, 167, 163, 169},        // int42
+  {474, 475, 476, 478, 477, 479},        // int84
+  {852, 853, 854, 856, 855, 857},        // int48
+  {1850, 1851, 1852, 1854, 1853, 1855},  // int28
+  {1856, 1857, 1858, 1860, 1859, 1861},  // int82
+};
+
+constexpr uint32_t kRealCompareFuncs[][kCompareOpMapSize] = {
+  {287, 288, 289, 290, 291, 292},  // float4
+  {293, 294, 295, 296, 297, 298},  // float8
+  {299, 300, 301, 302, 303, 304},  // float48
+  {305, 306, 307, 308, 309, 310},  // float84
+};
+
+// Finds comparison operator implemented by Postgres function with specified OID.
+template <size_t N>
+bool FindCompareFunc(
+    const uint32_t (&funcs)[N][kCompareOpMapSize], uint32_t funcid, CompareOp* op) {
+  for (const auto& family : funcs) {
+    for (size_t i = 0; i != kCompareOpMapSize; ++i) {
+      if (family[i] == funcid) {
+        *op = static_cast<CompareOp>(i);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns operator that produces the same result when operands are swapped.
+CompareOp Commute(CompareOp op) {
+  switch (op) {
+    case CompareOp::kEq: FALLTHROUGH_INTENDED;
+    case CompareOp::kNe:
+      return op;
+    case CompareOp::kLt: return CompareOp::kGt;
+    case CompareOp::kLe: return CompareOp::kGe;
+    case CompareOp::kGt: return CompareOp::kLt;
+    case CompareOp::kGe: return CompareOp::kLe;
+  }
+  FATAL_INVALID_ENUM_VALUE(CompareOp, op);
+}
+
+// Compares doubles the same way Postgres does: NaN is equal to itself and greater than any other
+// value.
+inline int PgFloatCompare(double lhs, double rhs) {
+  if (PREDICT_FALSE(std::isnan(lhs))) {
+    return std::isnan(rhs) ? 0 : 1;
+  }
+  if (PREDICT_FALSE(std::isnan(rhs))) {
+    return -1;
+  }
+  return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+template <CompareOp kOp, class T>
+inline bool Matches(T lhs, T rhs) {
+  switch (kOp) {
+    case CompareOp::kEq: return lhs == rhs;
+    case CompareOp::kNe: return lhs != rhs;
+    case CompareOp::kLt: return lhs < rhs;
+    case CompareOp::kLe: return lhs <= rhs;
+    case CompareOp::kGt: return lhs > rhs;
+    case CompareOp::kGe: return lhs >= rhs;
+  }
+  return false;
+}
+
+inline bool MatchesRuntime(CompareOp op, int compare_result) {
+  switch (op) {
+    case CompareOp::kEq: return compare_result == 0;
+    case CompareOp::kNe: return compare_result != 0;
+    case CompareOp::kLt: return compare_result < 0;
+    case CompareOp::kLe: return compare_result <= 0;
+    case CompareOp::kGt: return compare_result > 0;
+    case CompareOp::kGe: return compare_result >= 0;
+  }
+  FATAL_INVALID_ENUM_VALUE(CompareOp, op);
+}
+
+bool UseSimd() {
+#if YB_VECTORIZED_AVX2
+  static const bool has_avx2 = base::CPU().has_avx2();
+  return has_avx2 && FLAGS_ysql_vectorized_expr_use_simd;
+#else
+  return false;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+// Kernels.
+// Comparison kernels store 1 to out[i] when lhs[i] matches rhs[i] (or rhs_value if rhs is null),
+// and 0 otherwise. Aggregate kernels take into account only values with non zero mask.
+
+template <CompareOp kOp, class T>
+void CompareScalar(
+    const T* lhs, const T* rhs, T rhs_value, size_t begin, size_t end, uint8_t* out) {
+  if (rhs) {
+    for (size_t i = begin; i != end; ++i) {
+      out[i] = Matches<kOp>(lhs[i], rhs[i]);
+    }
+  } else {
+    for (size_t i = begin; i != end; ++i) {
+      out[i] = Matches<kOp>(lhs[i], rhs_value);
+    }
+  }
+}
+
+template <CompareOp kOp>
+void ComparePgFloatScalar(
+    const double* lhs, const double* rhs, double rhs_value, size_t end, uint8_t* out) {
+  for (size_t i = 0; i != end; ++i) {
+    out[i] = MatchesRuntime(kOp, PgFloatCompare(lhs[i], rhs ? rhs[i] : rhs_value));
+  }
+}
+
+uint64_t SumInt64Scalar(const int64_t* values, const uint8_t* mask, size_t begin, size_t end) {
+  uint64_t result = 0;
+  for (size_t i = begin; i != end; ++i) {
+    // Integer sums wrap around on overflow the same way as per row evaluation does.
+    result += mask[i] ? static_cast<uint64_t>(values[i]) : 0;
+  }
+  return result;
+}
+
+template <bool kMax>
+int64_t MinMaxInt64Scalar(
+    const int64_t* values, const uint8_t* mask, size_t begin, size_t end, int64_t result) {
+  for (size_t i = begin; i != end; ++i) {
+    if (mask[i] && (kMax ? values[i] > result : values[i] < result)) {
+      result = values[i];
+    }
+  }
+  return result;
+}
+
+#if YB_VECTORIZED_AVX2
+
+// Bytes of 4 row mask for every combination of 4 lane comparison result bits.
+constexpr uint32_t kLaneBitsToBytes[16] = {
+  0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+  0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101,
+};
+
+YB_AVX2_TARGET inline void StoreLaneMask(__m256d lanes, uint8_t* out) {
+  memcpy(out, &kLaneBitsToBytes[_mm256_movemask_pd(lanes)], sizeof(uint32_t));
+}
+
+// Expands 4 bytes of mask into 4 64 bit lanes with all bits set for non zero mask bytes.
+YB_AVX2_TARGET inline __m256i LoadLaneMask(const uint8_t* mask) {
+  int32_t bytes;
+  memcpy(&bytes, mask, sizeof(bytes));
+  const __m256i ones = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes));
+  return _mm256_cmpgt_epi64(ones, _mm256_setzero_si256());
+}
+
+template <CompareOp kOp>
+YB_AVX2_TARGET inline __m256i CompareInt64x4(__m256i lhs, __m256i rhs) {
+  const __m256i all = _mm256_set1_epi64x(-1);
+  switch (kOp) {
+    case CompareOp::kEq: return _mm256_cmpeq_epi64(lhs, rhs);
+    case CompareOp::kNe: return _mm256_xor_si256(_mm256_cmpeq_epi64(lhs, rhs), all);
+    case CompareOp::kLt: return _mm256_cmpgt_epi64(rhs, lhs);
+    case CompareOp::kLe: return _mm256_xor_si256(_mm256_cmpgt_epi64(lhs, rhs), all);
+    case CompareOp::kGt: return _mm256_cmpgt_epi64(lhs, rhs);
+    case CompareOp::kGe: return _mm256_xor_si256(_mm256_cmpgt_epi64(rhs, lhs), all);
+  }
+  return all;
+}
+
+template <CompareOp kOp>
+constexpr int AvxPredicate() {
+  switch (kOp) {
+    case CompareOp::kEq: return _CMP_EQ_OQ;
+    case CompareOp::kNe: return _CMP_NEQ_OQ;
+    case CompareOp::kLt: return _CMP_LT_OQ;
+    case CompareOp::kLe: return _CMP_LE_OQ;
+    case CompareOp::kGt: return _CMP_GT_OQ;
+    case CompareOp::kGe: return _CMP_GE_OQ;
+  }
+  return _CMP_FALSE_OQ;
+}
+
+template <CompareOp kOp>
+YB_AVX2_TARGET void CompareInt64Avx2(
+    const int64_t* lhs, const int64_t* rhs, int64_t rhs_value, size_t end, uint8_t* out) {
+  size_t i = 0;
+  if (rhs) {
+    for (; i + 4 <= end; i += 4) {
+      auto lanes = CompareInt64x4<kOp>(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+      StoreLaneMask(_mm256_castsi256_pd(lanes), out + i);
+    }
+  } else {
+    const __m256i value = _mm256_set1_epi64x(rhs_value);
+    for (; i + 4 <= end; i += 4) {
+      auto lanes = CompareInt64x4<kOp>(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)), value);
+      StoreLaneMask(_mm256_castsi256_pd(lanes), out + i);
+    }
+  }
+  CompareScalar<kOp>(lhs, rhs, rhs_value, i, end, out);
+}
+
+template <CompareOp kOp>
+YB_AVX2_TARGET void CompareDoubleAvx2(
+    const double* lhs, const double* rhs, double rhs_value, size_t end, uint8_t* out) {
+  size_t i = 0;
+  if (rhs) {
+    for (; i + 4 <= end; i += 4) {
+      StoreLaneMask(
+          _mm256_cmp_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i), AvxPredicate<kOp>()),
+          out + i);
+    }
+  } else {
+    const __m256d value = _mm256_set1_pd(rhs_value);
+    for (; i + 4 <= end; i += 4) {
+      StoreLaneMask(_mm256_cmp_pd(_mm256_loadu_pd(lhs + i), value, AvxPredicate<kOp>()), out + i);
+    }
+  }
+  CompareScalar<kOp>(lhs, rhs, rhs_value, i, end, out);
+}
+
+YB_AVX2_TARGET uint64_t SumInt64Avx2(const int64_t* values, const uint8_t* mask, size_t end) {
+  __m256i sum = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= end; i += 4) {
+    auto lanes = _mm256_and_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), LoadLaneMask(mask + i));
+    sum = _mm256_add_epi64(sum, lanes);
+  }
+  uint64_t parts[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), sum);
+  return parts[0] + parts[1] + parts[2] + parts[3] + SumInt64Scalar(values, mask, i, end);
+}
+
+template <bool kMax>
+YB_AVX2_TARGET int64_t MinMaxInt64Avx2(
+    const int64_t* values, const uint8_t* mask, size_t end, int64_t initial) {
+  const __m256i identity = _mm256_set1_epi64x(initial);
+  __m256i result = identity;
+  size_t i = 0;
+  for (; i + 4 <= end; i += 4) {
+    auto lanes = _mm256_blendv_epi8(
+        identity, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)),
+        LoadLaneMask(mask + i));
+    auto better = kMax ? _mm256_cmpgt_epi64(lanes, result) : _mm256_cmpgt_epi64(result, lanes);
+    result = _mm256_blendv_epi8(result, lanes, better);
+  }
+  int64_t parts[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), result);
+  int64_t best = initial;
+  for (auto part : parts) {
+    if (kMax ? part > best : part < best) {
+      best = part;
+    }
+  }
+  return MinMaxInt64Scalar<kMax>(values, mask, i, end, best);
+}
+
+#endif // YB_VECTORIZED_AVX2
+
+template <CompareOp kOp>
+void DoCompareInt64(
+    const int64_t* lhs, const int64_t* rhs, int64_t rhs_value, size_t end, uint8_t* out) {
+#if YB_VECTORIZED_AVX2
+  if (UseSimd()) {
+    CompareInt64Avx2<kOp>(lhs, rhs, rhs_value, end, out);
+    return;
+  }
+#endif
+  CompareScalar<kOp>(lhs, rhs, rhs_value, 0, end, out);
+}
+
+template <CompareOp kOp>
+void DoCompareDouble(
+    const double* lhs, const double* rhs, double rhs_value, bool has_nan, size_t end,
+    uint8_t* out) {
+  if (has_nan) {
+    // Hardware comparisons treat NaN as unordered, while Postgres orders it after all other values.
+    ComparePgFloatScalar<kOp>(lhs, rhs, rhs_value, end, out);
+    return;
+  }
+#if YB_VECTORIZED_AVX2
+  if (UseSimd()) {
+    CompareDoubleAvx2<kOp>(lhs, rhs, rhs_value, end, out);
+    return;
+  }
+#endif
+  CompareScalar<kOp>(lhs, rhs, rhs_value, 0, end, out);
+}
+
+void CompareInt64(
+    CompareOp op, const int64_t* lhs, const int64_t* rhs, int64_t rhs_value, size_t end,
+    uint8_t* out) {
+  switch (op) {
+    case CompareOp::kEq: return DoCompareInt64<CompareOp::kEq>(lhs, rhs, rhs_value, end, out);
+    case CompareOp::kNe: return DoCompareInt64<CompareOp::kNe>(lhs, rhs, rhs_value, end, out);
+    case CompareOp::kLt: return DoCompareInt64<CompareOp::kLt>(lhs, rhs, rhs_value, end, out);
+    case CompareOp::kLe: return DoCompareInt64<CompareOp::kLe>(lhs, rhs, rhs_value, end, out);
+    case CompareOp::kGt: return DoCompareInt64<CompareOp::kGt>(lhs, rhs, rhs_value, end, out);
+    case CompareOp::kGe: return DoCompareInt64<CompareOp::kGe>(lhs, rhs, rhs_value, end, out);
+  }
+  FATAL_INVALID_ENUM_VALUE(CompareOp, op);
+}
+
+void CompareDouble(
+    CompareOp op, const double* lhs, const double* rhs, double rhs_value, bool has_nan,
+    size_t end, uint8_t* out) {
+  switch (op) {
+    case CompareOp::kEq:
+      return DoCompareDouble<CompareOp::kEq>(lhs, rhs, rhs_value, has_nan, end, out);
+    case CompareOp::kNe:
+      return DoCompareDouble<CompareOp::kNe>(lhs, rhs, rhs_value, has_nan, end, out);
+    case CompareOp::kLt:
+      return DoCompareDouble<CompareOp::kLt>(lhs, rhs, rhs_value, has_nan, end, out);
+    case CompareOp::kLe:
+      return DoCompareDouble<CompareOp::kLe>(lhs, rhs, rhs_value, has_nan, end, out);
+    case CompareOp::kGt:
+      return DoCompareDouble<CompareOp::kGt>(lhs, rhs, rhs_value, has_nan, end, out);
+    case CompareOp::kGe:
+      return DoCompareDouble<CompareOp::kGe>(lhs, rhs, rhs_value, has_nan, end, out);
+  }
+  FATAL_INVALID_ENUM_VALUE(CompareOp, op);
+}
+
+int64_t SumInt64(const int64_t* values, const uint8_t* mask, size_t end) {
+#if YB_VECTORIZED_AVX2
+  if (UseSimd()) {
+    return static_cast<int64_t>(SumInt64Avx2(values, mask, end));
+  }
+#endif
+  return static_cast<int64_t>(SumInt64Scalar(values, mask, 0, end));
+}
+
+template <bool kMax>
+int64_t MinMaxInt64(const int64_t* values, const uint8_t* mask, size_t end) {
+  constexpr int64_t kInitial =
+      kMax ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+#if YB_VECTORIZED_AVX2
+  if (UseSimd()) {
+    return MinMaxInt64Avx2<kMax>(values, mask, end, kInitial);
+  }
+#endif
+  return MinMaxInt64Scalar<kMax>(values, mask, 0, end, kInitial);
+}
+
+size_t CountNonZero(const uint8_t* mask, size_t end) {
+  size_t result = 0;
+  for (size_t i = 0; i != end; ++i) {
+    result += mask[i] != 0;
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Reader of Postgres expression trees serialized by nodeToString.
+
+class PgNodeReader {
+ public:
+  explicit PgNodeReader(const std::string& input)
+      : pos_(input.data()), end_(input.data() + input.size()) {}
+
+  // Returns next token, or empty slice at the end of input.
+  Slice Next() {
+    while (pos_ != end_ && isspace(*pos_)) {
+      ++pos_;
+    }
+    const char* start = pos_;
+    if (pos_ == end_) {
+      return Slice(start, start);
+    }
+    if (IsDelimiter(*pos_)) {
+      ++pos_;
+      return Slice(start, pos_);
+    }
+    while (pos_ != end_ && !isspace(*pos_) && !IsDelimiter(*pos_)) {
+      if (*pos_ == '\\' && pos_ + 1 != end_) {
+        ++pos_;
+      }
+      ++pos_;
+    }
+    return Slice(start, pos_);
+  }
+
+  Slice Peek() {
+    auto pos = pos_;
+    auto result = Next();
+    pos_ = pos;
+    return result;
+  }
+
+  bool NextIs(const char* token) {
+    return Next() == Slice(token);
+  }
+
+  template <class T>
+  bool NextInt(T* out) {
+    auto token = Next();
+    if (token.empty() || token.size() > 20) {
+      return false;
+    }
+    char buffer[24];
+    memcpy(buffer, token.cdata(), token.size());
+    buffer[token.size()] = 0;
+    char* parse_end = nullptr;
+    errno = 0;
+    auto value = strtoll(buffer, &parse_end, 10);
+    if (errno != 0 || parse_end != buffer + token.size()) {
+      return false;
+    }
+    *out = static_cast<T>(value);
+    return true;
+  }
+
+  bool NextBool(bool* out) {
+    auto token = Next();
+    if (token == Slice("true")) {
+      *out = true;
+    } else if (token == Slice("false")) {
+      *out = false;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // Skips value of a scalar field. Fails on node and list values, as they are not expected in
+  // fields that are ignored.
+  bool SkipScalar() {
+    auto token = Next();
+    return !token.empty() && !IsDelimiter(token[0]);
+  }
+
+ private:
+  static bool IsDelimiter(char ch) {
+    return ch == '(' || ch == ')' || ch == '{' || ch == '}';
+  }
+
+  const char* pos_;
+  const char* end_;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+YB_DEFINE_ENUM(ColumnKind, (kInt)(kReal)(kOther));
+
+ColumnKind KindOfType(DataType type) {
+  switch (type) {
+    case DataType::INT8: FALLTHROUGH_INTENDED;
+    case DataType::INT16: FALLTHROUGH_INTENDED;
+    case DataType::INT32: FALLTHROUGH_INTENDED;
+    case DataType::INT64:
+      return ColumnKind::kInt;
+    case DataType::FLOAT: FALLTHROUGH_INTENDED;
+    case DataType::DOUBLE:
+      return ColumnKind::kReal;
+    default:
+      return ColumnKind::kOther;
+  }
+}
+
+// Column of the batch decoded to plain arrays.
+struct ColumnVector {
+  ColumnId id;
+  DataType type;
+  ColumnKind kind;
+  // Whether values are used, otherwise only null flags are decoded.
+  bool need_values = false;
+
+  std::vector<int64_t> ints;
+  std::vector<double> reals;
+  std::vector<uint8_t> nulls;
+  bool has_nan = false;
+
+  // Decodes values of this column from the batch. Returns false if some value has unexpected type.
+  bool Decode(const PackedColumnBatch& batch) {
+    const auto column_idx = batch.ColumnIndex(id);
+    if (column_idx < 0) {
+      return false;
+    }
+    const auto num_rows = batch.num_rows();
+    nulls.resize(num_rows);
+    if (!need_values) {
+      for (size_t row = 0; row != num_rows; ++row) {
+        nulls[row] = batch.IsNull(column_idx, row);
+      }
+      return true;
+    }
+    has_nan = false;
+    if (kind == ColumnKind::kInt) {
+      ints.resize(num_rows);
+    } else {
+      reals.resize(num_rows);
+    }
+    for (size_t row = 0; row != num_rows; ++row) {
+      if (batch.IsNull(column_idx, row)) {
+        nulls[row] = 1;
+        if (kind == ColumnKind::kInt) {
+          ints[row] = 0;
+        } else {
+          reals[row] = 0;
+        }
+        continue;
+      }
+      nulls[row] = 0;
+      auto value = batch.value(column_idx, row);
+      const auto* data = value.data() + 1;
+      switch (static_cast<ValueEntryType>(value[0])) {
+        case ValueEntryType::kInt32:
+          if (kind != ColumnKind::kInt || value.size() != 1 + sizeof(int32_t)) {
+            return false;
+          }
+          ints[row] = static_cast<int32_t>(BigEndian::Load32(data));
+          break;
+        case ValueEntryType::kInt64:
+          if (kind != ColumnKind::kInt || value.size() != 1 + sizeof(int64_t)) {
+            return false;
+          }
+          ints[row] = static_cast<int64_t>(BigEndian::Load64(data));
+          break;
+        case ValueEntryType::kFloat:
+          if (kind != ColumnKind::kReal || value.size() != 1 + sizeof(float)) {
+            return false;
+          }
+          reals[row] = bit_cast<float>(BigEndian::Load32(data));
+          has_nan |= std::isnan(reals[row]);
+          break;
+        case ValueEntryType::kDouble:
+          if (kind != ColumnKind::kReal || value.size() != 1 + sizeof(double)) {
+            return false;
+          }
+          reals[row] = bit_cast<double>(BigEndian::Load64(data));
+          has_nan |= std::isnan(reals[row]);
+          break;
+        default:
+          return false;
+      }
+    }
+    return true;
+  }
+};
+
+// Either reference to a column or a constant.
+struct Operand {
+  ssize_t column = -1;
+  bool is_null = false;
+  int64_t int_value = 0;
+  double real_value = 0;
+};
+
+YB_DEFINE_ENUM(ExprKind, (kCompare)(kAnd)(kOr)(kNot)(kIsNull)(kIsNotNull));
+
+struct Expr {
+  ExprKind kind = ExprKind::kCompare;
+  CompareOp op = CompareOp::kEq;
+  // Whether comparison is performed on real values.
+  bool real = false;
+  Operand lhs;
+  Operand rhs;
+  std::vector<Expr> args;
+};
+
+struct AggregateTarget {
+  bfpg::TSOpcode opcode;
+  // Index of column in columns_, or -1 for COUNT of a constant.
+  ssize_t column = -1;
+  // COUNT(NULL) is always zero.
+  bool null_constant = false;
+};
+
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+class DocPgVectorizedExecutor::Impl {
+ public:
+  bool Prepare(const PgsqlReadRequestPB& request, const Schema& projection) {
+    projection_ = &projection;
+    for (const auto& column_ref : request.col_refs()) {
+      attno_to_column_id_.emplace(column_ref.attno(), ColumnId(column_ref.column_id()));
+    }
+    for (const auto& where : request.where_clauses()) {
+      if (!where.has_tscall() ||
+          static_cast<bfpg::TSOpcode>(where.tscall().opcode()) != bfpg::TSOpcode::kPgEvalExprCall ||
+          where.tscall().operands_size() != 1) {
+        return false;
+      }
+      PgNodeReader reader(where.tscall().operands(0).value().string_value());
+      Expr expr;
+      if (!ParseExpr(&reader, &expr) || !reader.Next().empty()) {
+        VLOG(3) << "Not vectorized where clause: " << where.ShortDebugString();
+        return false;
+      }
+      where_.push_back(std::move(expr));
+    }
+    if (request.is_aggregate()) {
+      for (const auto& target : request.targets()) {
+        if (!ParseAggregate(target)) {
+          VLOG(3) << "Not vectorized target: " << target.ShortDebugString();
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  Result<bool> Filter(
+      const PackedColumnBatch& batch, std::vector<uint8_t>* selection, size_t* num_selected) {
+    for (auto& column : columns_) {
+      if (!column.Decode(batch)) {
+        return false;
+      }
+    }
+    num_rows_ = batch.num_rows();
+    selection->assign(num_rows_, 1);
+    for (const auto& expr : where_) {
+      Eval(expr, &values_, &nulls_);
+      // Row is selected only when all where clauses are evaluated to true, and the value is
+      // set only for non null results.
+      for (size_t i = 0; i != num_rows_; ++i) {
+        (*selection)[i] &= values_[i];
+      }
+    }
+    *num_selected = CountNonZero(selection->data(), num_rows_);
+    return true;
+  }
+
+  Status Aggregate(
+      const std::vector<uint8_t>& selection, size_t num_selected,
+      std::vector<QLExprResult>* aggr_result) {
+    if (aggr_result->empty()) {
+      aggr_result->resize(aggregates_.size());
+    }
+    SCHECK_EQ(aggr_result->size(), aggregates_.size(), IllegalState, "Wrong number of aggregates");
+    for (size_t i = 0; i != aggregates_.size(); ++i) {
+      RETURN_NOT_OK(Aggregate(
+          aggregates_[i], selection, num_selected, &(*aggr_result)[i].ForceNewValue()));
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Returns index of the column in columns_, or -1 if column could not be used.
+  ssize_t AddColumn(ColumnId column_id, bool need_values) {
+    auto idx = projection_->find_column_by_id(column_id);
+    if (idx == Schema::kColumnNotFound ||
+        static_cast<size_t>(idx) < projection_->num_key_columns()) {
+      // Key columns are not stored in the batch.
+      return -1;
+    }
+    const auto type = projection_->column(idx).type()->main();
+    const auto kind = KindOfType(type);
+    if (need_values && kind == ColumnKind::kOther) {
+      return -1;
+    }
+    for (size_t i = 0; i != columns_.size(); ++i) {
+      if (columns_[i].id == column_id) {
+        columns_[i].need_values |= need_values;
+        return i;
+      }
+    }
+    columns_.push_back(ColumnVector {
+      .id = column_id,
+      .type = type,
+      .kind = kind,
+      .need_values = need_values,
+    });
+    return columns_.size() - 1;
+  }
+
+  bool ParseExpr(PgNodeReader* reader, Expr* expr) {
+    if (!reader->NextIs("{")) {
+      return false;
+    }
+    auto type = reader->Next();
+    if (type == Slice("OPEXPR")) {
+      return ParseOpExpr(reader, expr);
+    }
+    if (type == Slice("BOOLEXPR")) {
+      return ParseBoolExpr(reader, expr);
+    }
+    if (type == Slice("NULLTEST")) {
+      return ParseNullTest(reader, expr);
+    }
+    return false;
+  }
+
+  bool ParseOpExpr(PgNodeReader* reader, Expr* expr) {
+    expr->kind = ExprKind::kCompare;
+    bool has_func = false;
+    size_t num_args = 0;
+    for (;;) {
+      auto field = reader->Next();
+      if (field == Slice("}")) {
+        break;
+      }
+      if (field == Slice(":opfuncid")) {
+        uint32_t funcid;
+        if (!reader->NextInt(&funcid)) {
+          return false;
+        }
+        if (FindCompareFunc(kIntCompareFuncs, funcid, &expr->op)) {
+          expr->real = false;
+        } else if (FindCompareFunc(kRealCompareFuncs, funcid, &expr->op)) {
+          expr->real = true;
+        } else {
+          return false;
+        }
+        has_func = true;
+      } else if (field == Slice(":args")) {
+        // Function is written before its arguments.
+        if (!has_func || !reader->NextIs("(")) {
+          return false;
+        }
+        while (reader->Peek() != Slice(")")) {
+          if (num_args == 2 ||
+              !ParseOperand(reader, expr->real, num_args == 0 ? &expr->lhs : &expr->rhs)) {
+            return false;
+          }
+          ++num_args;
+        }
+        reader->Next();
+      } else if (!reader->SkipScalar()) {
+        return false;
+      }
+    }
+    return has_func && num_args == 2;
+  }
+
+  bool ParseBoolExpr(PgNodeReader* reader, Expr* expr) {
+    bool has_op = false;
+    for (;;) {
+      auto field = reader->Next();
+      if (field == Slice("}")) {
+        break;
+      }
+      if (field == Slice(":boolop")) {
+        auto op = reader->Next();
+        if (op == Slice("and")) {
+          expr->kind = ExprKind::kAnd;
+        } else if (op == Slice("or")) {
+          expr->kind = ExprKind::kOr;
+        } else if (op == Slice("not")) {
+          expr->kind = ExprKind::kNot;
+        } else {
+          return false;
+        }
+        has_op = true;
+      } else if (field == Slice(":args")) {
+        if (!reader->NextIs("(")) {
+          return false;
+        }
+        while (reader->Peek() != Slice(")")) {
+          expr->args.emplace_back();
+          if (!ParseExpr(reader, &expr->args.back())) {
+            return false;
+          }
+        }
+        reader->Next();
+      } else if (!reader->SkipScalar()) {
+        return false;
+      }
+    }
+    return has_op && !expr->args.empty() &&
+           (expr->kind != ExprKind::kNot || expr->args.size() == 1);
+  }
+
+  bool ParseNullTest(PgNodeReader* reader, Expr* expr) {
+    bool has_type = false;
+    for (;;) {
+      auto field = reader->Next();
+      if (field == Slice("}")) {
+        break;
+      }
+      if (field == Slice(":arg")) {
+        if (!ParseVar(reader, /* need_values= */ false, &expr->lhs)) {
+          return false;
+        }
+      } else if (field == Slice(":nulltesttype")) {
+        int type;
+        if (!reader->NextInt(&type) || (type != 0 && type != 1)) {
+          return false;
+        }
+        // IS_NULL is 0, IS_NOT_NULL is 1.
+        expr->kind = type == 0 ? ExprKind::kIsNull : ExprKind::kIsNotNull;
+        has_type = true;
+      } else if (field == Slice(":argisrow")) {
+        bool argisrow;
+        if (!reader->NextBool(&argisrow) || argisrow) {
+          return false;
+        }
+      } else if (!reader->SkipScalar()) {
+        return false;
+      }
+    }
+    return has_type && expr->lhs.column >= 0;
+  }
+
+  bool ParseOperand(PgNodeReader* reader, bool real, Operand* operand) {
+    auto type = reader->Peek();
+    if (type != Slice("{")) {
+      return false;
+    }
+    return ParseVar(reader, /* need_values= */ true, operand, real) ||
+           ParseConst(reader, real, operand);
+  }
+
+  // Parses VAR node. Does not consume input if next node is not VAR.
+  bool ParseVar(
+      PgNodeReader* reader, bool need_values, Operand* operand, bool real = false) {
+    {
+      auto lookahead = *reader;
+      if (!lookahead.NextIs("{") || !lookahead.NextIs("VAR")) {
+        return false;
+      }
+      *reader = lookahead;
+    }
+    int32_t attno = 0;
+    bool has_attno = false;
+    for (;;) {
+      auto field = reader->Next();
+      if (field == Slice("}")) {
+        break;
+      }
+      if (field == Slice(":varattno")) {
+        if (!reader->NextInt(&attno)) {
+          return false;
+        }
+        has_attno = true;
+      } else if (field == Slice(":varlevelsup")) {
+        int levelsup;
+        if (!reader->NextInt(&levelsup) || levelsup != 0) {
+          return false;
+        }
+      } else if (!reader->SkipScalar()) {
+        return false;
+      }
+    }
+    if (!has_attno) {
+      return false;
+    }
+    auto it = attno_to_column_id_.find(attno);
+    if (it == attno_to_column_id_.end()) {
+      return false;
+    }
+    operand->column = AddColumn(it->second, need_values);
+    if (operand->column < 0) {
+      return false;
+    }
+    const auto& column = columns_[operand->column];
+    return !need_values || column.kind == (real ? ColumnKind::kReal : ColumnKind::kInt);
+  }
+
+  bool ParseConst(PgNodeReader* reader, bool real, Operand* operand) {
+    if (!reader->NextIs("{") || !reader->NextIs("CONST")) {
+      return false;
+    }
+    uint32_t type = 0;
+    bool byval = false;
+    bool has_value = false;
+    uint64_t datum = 0;
+    for (;;) {
+      auto field = reader->Next();
+      if (field == Slice("}")) {
+        break;
+      }
+      if (field == Slice(":consttype")) {
+        if (!reader->NextInt(&type)) {
+          return false;
+        }
+      } else if (field == Slice(":constbyval")) {
+        if (!reader->NextBool(&byval)) {
+          return false;
+        }
+      } else if (field == Slice(":constisnull")) {
+        if (!reader->NextBool(&operand->is_null)) {
+          return false;
+        }
+      } else if (field == Slice(":constvalue")) {
+        if (reader->Peek() == Slice("<>")) {
+          reader->Next();
+          continue;
+        }
+        // Pass by value datum is written as its length followed by all bytes of Datum in memory
+        // order, i.e. "4 [ 10 0 0 0 0 0 0 0 ]".
+        size_t length;
+        if (!reader->NextInt(&length) || !reader->NextIs("[")) {
+          return false;
+        }
+        size_t num_bytes = 0;
+        uint8_t bytes[sizeof(datum)];
+        while (reader->Peek() != Slice("]")) {
+          int byte;
+          if (num_bytes == sizeof(bytes) || !reader->NextInt(&byte)) {
+            return false;
+          }
+          bytes[num_bytes++] = static_cast<uint8_t>(byte);
+        }
+        reader->Next();
+        if (num_bytes != sizeof(bytes)) {
+          return false;
+        }
+        memcpy(&datum, bytes, sizeof(datum));
+        has_value = true;
+      } else if (!reader->SkipScalar()) {
+        return false;
+      }
+    }
+    if (operand->is_null) {
+      return true;
+    }
+    if (!byval || !has_value) {
+      return false;
+    }
+    // Decode the same way as DatumGetXXX functions do.
+    switch (type) {
+      case kInt2Oid:
+        operand->int_value = static_cast<int16_t>(datum);
+        break;
+      case kInt4Oid:
+        operand->int_value = static_cast<int32_t>(datum);
+        break;
+      case kInt8Oid:
+        operand->int_value = static_cast<int64_t>(datum);
+        break;
+      case kFloat4Oid:
+        operand->real_value = bit_cast<float>(static_cast<uint32_t>(datum));
+        break;
+      case kFloat8Oid:
+        operand->real_value = bit_cast<double>(datum);
+        break;
+      default:
+        return false;
+    }
+    return real == (type == kFloat4Oid || type == kFloat8Oid);
+  }
+
+  bool ParseAggregate(const PgsqlExpressionPB& target) {
+    if (!target.has_tscall() || target.tscall().operands_size() != 1) {
+      return false;
+    }
+    AggregateTarget aggregate;
+    aggregate.opcode = static_cast<bfpg::TSOpcode>(target.tscall().opcode());
+    const auto& operand = target.tscall().operands(0);
+    if (aggregate.opcode == bfpg::TSOpcode::kCount && operand.has_value()) {
+      aggregate.null_constant = IsNull(operand.value());
+      aggregates_.push_back(aggregate);
+      return true;
+    }
+    if (!operand.has_column_id()) {
+      return false;
+    }
+    switch (aggregate.opcode) {
+      case bfpg::TSOpcode::kCount:
+        aggregate.column = AddColumn(ColumnId(operand.column_id()), /* need_values= */ false);
+        break;
+      case bfpg::TSOpcode::kSumInt8: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt16: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt32: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt64: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumFloat: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumDouble: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kMin: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kMax:
+        aggregate.column = AddColumn(ColumnId(operand.column_id()), /* need_values= */ true);
+        break;
+      default:
+        return false;
+    }
+    if (aggregate.column < 0) {
+      return false;
+    }
+    const auto type = columns_[aggregate.column].type;
+    switch (aggregate.opcode) {
+      case bfpg::TSOpcode::kSumInt8: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt16: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt32: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt64:
+        if (KindOfType(type) != ColumnKind::kInt) {
+          return false;
+        }
+        break;
+      case bfpg::TSOpcode::kSumFloat:
+        if (type != DataType::FLOAT) {
+          return false;
+        }
+        break;
+      case bfpg::TSOpcode::kSumDouble:
+        if (type != DataType::DOUBLE) {
+          return false;
+        }
+        break;
+      default:
+        break;
+    }
+    aggregates_.push_back(aggregate);
+    return true;
+  }
+
+  // Evaluates expression over all rows of the current batch.
+  // On return values[i] is 1 when expression is true for row i, and nulls[i] is 1 when it is NULL.
+  void Eval(const Expr& expr, std::vector<uint8_t>* values, std::vector<uint8_t>* nulls) {
+    values->resize(num_rows_);
+    nulls->resize(num_rows_);
+    switch (expr.kind) {
+      case ExprKind::kCompare:
+        EvalCompare(expr, values, nulls);
+        return;
+      case ExprKind::kIsNull: FALLTHROUGH_INTENDED;
+      case ExprKind::kIsNotNull: {
+        const auto& column_nulls = columns_[expr.lhs.column].nulls;
+        const uint8_t expected = expr.kind == ExprKind::kIsNull;
+        for (size_t i = 0; i != num_rows_; ++i) {
+          (*values)[i] = column_nulls[i] == expected;
+        }
+        std::fill(nulls->begin(), nulls->end(), 0);
+        return;
+      }
+      case ExprKind::kNot: {
+        Eval(expr.args[0], values, nulls);
+        for (size_t i = 0; i != num_rows_; ++i) {
+          (*values)[i] = !(*values)[i] & !(*nulls)[i];
+        }
+        return;
+      }
+      case ExprKind::kAnd: FALLTHROUGH_INTENDED;
+      case ExprKind::kOr: {
+        // Three valued logic: AND is false when any argument is false, OR is true when any
+        // argument is true, otherwise the result is NULL if any argument is NULL.
+        const bool is_and = expr.kind == ExprKind::kAnd;
+        std::vector<uint8_t> decided(num_rows_, 0);
+        std::fill(nulls->begin(), nulls->end(), 0);
+        std::vector<uint8_t> arg_values;
+        std::vector<uint8_t> arg_nulls;
+        for (const auto& arg : expr.args) {
+          Eval(arg, &arg_values, &arg_nulls);
+          for (size_t i = 0; i != num_rows_; ++i) {
+            const uint8_t arg_decides = is_and ? !arg_values[i] & !arg_nulls[i] : arg_values[i];
+            decided[i] |= arg_decides;
+            (*nulls)[i] |= arg_nulls[i];
+          }
+        }
+        for (size_t i = 0; i != num_rows_; ++i) {
+          (*nulls)[i] &= !decided[i];
+          (*values)[i] = is_and ? !decided[i] & !(*nulls)[i] : decided[i];
+        }
+        return;
+      }
+    }
+    FATAL_INVALID_ENUM_VALUE(ExprKind, expr.kind);
+  }
+
+  void EvalCompare(const Expr& expr, std::vector<uint8_t>* values, std::vector<uint8_t>* nulls) {
+    if (expr.lhs.is_null || expr.rhs.is_null) {
+      // Comparison operators are strict.
+      std::fill(values->begin(), values->end(), 0);
+      std::fill(nulls->begin(), nulls->end(), 1);
+      return;
+    }
+    const Operand* lhs = &expr.lhs;
+    const Operand* rhs = &expr.rhs;
+    auto op = expr.op;
+    if (lhs->column < 0) {
+      std::swap(lhs, rhs);
+      op = Commute(op);
+    }
+    if (lhs->column < 0) {
+      bool result = expr.real
+          ? MatchesRuntime(op, PgFloatCompare(lhs->real_value, rhs->real_value))
+          : MatchesRuntime(op, lhs->int_value < rhs->int_value
+                                   ? -1 : (lhs->int_value > rhs->int_value ? 1 : 0));
+      std::fill(values->begin(), values->end(), result);
+      std::fill(nulls->begin(), nulls->end(), 0);
+      return;
+    }
+
+    const auto& lhs_column = columns_[lhs->column];
+    const ColumnVector* rhs_column = rhs->column >= 0 ? &columns_[rhs->column] : nullptr;
+    if (expr.real) {
+      const bool has_nan = lhs_column.has_nan ||
+          (rhs_column ? rhs_column->has_nan : std::isnan(rhs->real_value));
+      CompareDouble(
+          op, lhs_column.reals.data(), rhs_column ? rhs_column->reals.data() : nullptr,
+          rhs->real_value, has_nan, num_rows_, values->data());
+    } else {
+      CompareInt64(
+          op, lhs_column.ints.data(), rhs_column ? rhs_column->ints.data() : nullptr,
+          rhs->int_value, num_rows_, values->data());
+    }
+    for (size_t i = 0; i != num_rows_; ++i) {
+      const uint8_t is_null = lhs_column.nulls[i] | (rhs_column ? rhs_column->nulls[i] : 0);
+      (*nulls)[i] = is_null;
+      (*values)[i] &= !is_null;
+    }
+  }
+
+  Status Aggregate(
+      const AggregateTarget& aggregate, const std::vector<uint8_t>& selection,
+      size_t num_selected, QLValuePB* result) {
+    if (aggregate.column < 0) {
+      // COUNT of a constant.
+      if (!aggregate.null_constant) {
+        AddCount(num_selected, result);
+      }
+      return Status::OK();
+    }
+
+    const auto& column = columns_[aggregate.column];
+    // Rows that are selected and have non null value of the aggregated column.
+    mask_.resize(num_rows_);
+    for (size_t i = 0; i != num_rows_; ++i) {
+      mask_[i] = selection[i] & !column.nulls[i];
+    }
+    const auto count = CountNonZero(mask_.data(), num_rows_);
+    if (count == 0) {
+      return Status::OK();
+    }
+
+    switch (aggregate.opcode) {
+      case bfpg::TSOpcode::kCount:
+        AddCount(count, result);
+        return Status::OK();
+      case bfpg::TSOpcode::kSumInt8: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt16: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt32: FALLTHROUGH_INTENDED;
+      case bfpg::TSOpcode::kSumInt64: {
+        uint64_t sum = SumInt64(column.ints.data(), mask_.data(), num_rows_);
+        if (!IsNull(*result)) {
+          sum += static_cast<uint64_t>(result->int64_value());
+        }
+        result->set_int64_value(static_cast<int64_t>(sum));
+        return Status::OK();
+      }
+      case bfpg::TSOpcode::kSumFloat:
+        SumReal<float>(column, result, [](float value, QLValuePB* out) {
+          out->set_float_value(value);
+        }, [](const QLValuePB& value) {
+          return value.float_value();
+        });
+        return Status::OK();
+      case bfpg::TSOpcode::kSumDouble:
+        SumReal<double>(column, result, [](double value, QLValuePB* out) {
+          out->set_double_value(value);
+        }, [](const QLValuePB& value) {
+          return value.double_value();
+        });
+        return Status::OK();
+      case bfpg::TSOpcode::kMin:
+        return MinMax<false>(column, result);
+      case bfpg::TSOpcode::kMax:
+        return MinMax<true>(column, result);
+      default:
+        break;
+    }
+    return STATUS_FORMAT(
+        IllegalState, "Unexpected aggregate: $0", static_cast<int>(aggregate.opcode));
+  }
+
+  static void AddCount(size_t count, QLValuePB* result) {
+    if (count == 0) {
+      return;
+    }
+    result->set_int64_value(
+        (IsNull(*result) ? 0 : result->int64_value()) + static_cast<int64_t>(count));
+  }
+
+  // Floating point sum is accumulated in row order, so it matches the sum calculated per row.
+  template <class T, class Setter, class Getter>
+  void SumReal(
+      const ColumnVector& column, QLValuePB* result, const Setter& setter, const Getter& getter) {
+    bool has_value = !IsNull(*result);
+    T sum = has_value ? getter(*result) : 0;
+    for (size_t i = 0; i != num_rows_; ++i) {
+      if (mask_[i]) {
+        sum = has_value ? sum + static_cast<T>(column.reals[i]) : static_cast<T>(column.reals[i]);
+        has_value = true;
+      }
+    }
+    setter(sum, result);
+  }
+
+  template <bool kMax>
+  Status MinMax(const ColumnVector& column, QLValuePB* result) {
+    QLValuePB candidate;
+    if (column.kind == ColumnKind::kInt) {
+      auto value = MinMaxInt64<kMax>(column.ints.data(), mask_.data(), num_rows_);
+      switch (column.type) {
+        case DataType::INT8:
+          candidate.set_int8_value(narrow_cast<int8_t>(value));
+          break;
+        case DataType::INT16:
+          candidate.set_int16_value(narrow_cast<int16_t>(value));
+          break;
+        case DataType::INT32:
+          candidate.set_int32_value(narrow_cast<int32_t>(value));
+          break;
+        case DataType::INT64:
+          candidate.set_int64_value(value);
+          break;
+        default:
+          return STATUS_FORMAT(
+              IllegalState, "Unexpected column type: $0", DataType_Name(column.type));
+      }
+    } else {
+      // Postgres ordering of NaN values is not supported by SIMD kernels, and real columns are
+      // rarely aggregated, so use sequential search.
+      // Result of previous batches takes part in the same search, so NaN is ordered by
+      // PgFloatCompare both within a batch and across batches.
+      const bool is_float = column.type == DataType::FLOAT;
+      bool found = !IsNull(*result);
+      double best = 0;
+      if (found) {
+        best = is_float ? result->float_value() : result->double_value();
+      }
+      for (size_t i = 0; i != num_rows_; ++i) {
+        if (!mask_[i]) {
+          continue;
+        }
+        const auto cmp = PgFloatCompare(best, column.reals[i]);
+        if (!found || (kMax ? cmp < 0 : cmp > 0)) {
+          best = column.reals[i];
+          found = true;
+        }
+      }
+      if (is_float) {
+        result->set_float_value(static_cast<float>(best));
+      } else {
+        result->set_double_value(best);
+      }
+      return Status::OK();
+    }
+    if (IsNull(*result) || (kMax ? *result < candidate : *result > candidate)) {
+      *result = std::move(candidate);
+    }
+    return Status::OK();
+  }
+
+  const Schema* projection_ = nullptr;
+  std::unordered_map<int32_t, ColumnId> attno_to_column_id_;
+  std::vector<ColumnVector> columns_;
+  std::vector<Expr> where_;
+  std::vector<AggregateTarget> aggregates_;
+
+  size_t num_rows_ = 0;
+  std::vector<uint8_t> values_;
+  std::vector<uint8_t> nulls_;
+  std::vector<uint8_t> mask_;
+};
+
+DocPgVectorizedExecutor::DocPgVectorizedExecutor() : impl_(new Impl()) {}
+
+DocPgVectorizedExecutor::~DocPgVectorizedExecutor() = default;
+
+bool DocPgVectorizedExecutor::Prepare(
+    const PgsqlReadRequestPB& request, const Schema& projection) {
+  return impl_->Prepare(request, projection);
+}
+
+Result<bool> DocPgVectorizedExecutor::Filter(const PackedColumnBatch& batch) {
+  num_selected_ = 0;
+  return impl_->Filter(batch, &selection_, &num_selected_);
+}
+
+Status DocPgVectorizedExecutor::Aggregate(std::vector<QLExprResult>* aggr_result) {
+  return impl_->Aggregate(selection_, num_selected_, aggr_result);
+}
+
+bool DocPgVectorizedExecutor::SimdEnabled() {
+  return UseSimd();
+}
+
+} // namespace docdb
+} // namespace yb
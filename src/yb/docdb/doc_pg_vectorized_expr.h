@@ -0,0 +1,84 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "yb/common/pgsql_protocol.pb.h"
+#include "yb/common/ql_expr.h"
+
+#include "yb/docdb/docdb_fwd.h"
+
+#include "yb/util/status_fwd.h"
+
+namespace yb {
+namespace docdb {
+
+// DocPgVectorizedExecutor evaluates pushed down where clauses and aggregates of a YSQL scan over
+// batches of rows in columnar form, as an alternative to the per row DocPgExprExecutor and
+// PgsqlReadOperation::EvalAggregate.
+//
+// Only a subset of expressions is supported:
+//  - comparisons (=, <>, <, <=, >, >=) of smallint, integer, bigint, real and double precision
+//    columns with constants or other columns of such types;
+//  - AND, OR, NOT, IS NULL and IS NOT NULL;
+//  - COUNT, SUM, MIN and MAX of such columns, and COUNT(*).
+// Prepare tells whether the whole request is supported. If it is not, or if some batch could not
+// be decoded, the caller is expected to process rows individually.
+//
+// Comparisons and integer aggregates use AVX2 kernels when the CPU supports them, and portable
+// scalar loops otherwise. Results are the same as those of the per row evaluation, including NULL
+// and NaN handling, and floating point sums are accumulated in row order.
+class DocPgVectorizedExecutor {
+ public:
+  DocPgVectorizedExecutor();
+  ~DocPgVectorizedExecutor();
+
+  // Analyzes where clauses and, for aggregate requests, targets of the request.
+  // projection is the schema used to fill the batches, it should outlive the executor.
+  // Returns true if all of them could be evaluated by this executor.
+  bool Prepare(const PgsqlReadRequestPB& request, const Schema& projection);
+
+  // Evaluates where clauses over all rows of the batch.
+  // Returns false if batch contains values that could not be handled, in this case rows of this
+  // batch should be processed individually.
+  Result<bool> Filter(const PackedColumnBatch& batch);
+
+  // Number of rows selected by the last Filter call.
+  size_t num_selected() const {
+    return num_selected_;
+  }
+
+  bool IsSelected(size_t row_idx) const {
+    return selection_[row_idx] != 0;
+  }
+
+  // Accumulates aggregate targets over rows selected by the last Filter call into aggr_result,
+  // with the same semantics as PgsqlReadOperation::EvalAggregate.
+  Status Aggregate(std::vector<QLExprResult>* aggr_result);
+
+  // Whether SIMD kernels are used on this host.
+  static bool SimdEnabled();
+
+ private:
+  class Impl;
+
+  std::unique_ptr<Impl> impl_;
+  std::vector<uint8_t> selection_;
+  size_t num_selected_ = 0;
+};
+
+} // namespace docdb
+} // namespace yb
@@ -27,6 +27,7 @@
 #include "yb/docdb/docdb-internal.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/packed_column_batch.h"
 #include "yb/docdb/schema_packing.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/docdb/value.h"
@@ -233,6 +234,43 @@ class DocDBTableReader::GetHelper {
 
     RETURN_NOT_OK(Prepare());
 
+    return RunPrepared();
+  }
+
+  // Same as Run, but tries to add row directly to batch when it is represented by a single packed
+  // row. Returns kAddedToBatch in this case, otherwise reads row to result_ as Run does.
+  Result<DocReaderResult> RunPacked(PackedColumnBatch* batch) {
+    IntentAwareIteratorPrefixScope prefix_scope(root_doc_key_, reader_.iter_);
+
+    RETURN_NOT_OK(Prepare());
+
+    if (schema_packing_ && !state_.front().expiration) {
+      if (reader_.deadline_info_.CheckAndSetDeadlinePassed()) {
+        return STATUS(Expired, "Deadline for query passed");
+      }
+      auto key_data = VERIFY_RESULT(reader_.iter_->FetchKey());
+      // Iterator points to the packed row itself, check whether there are any column level records
+      // after it.
+      reader_.iter_->SeekPastSubKey(key_data.key);
+      if (!reader_.iter_->valid() &&
+          VERIFY_RESULT(batch->AddRow(root_doc_key_, *schema_packing_, packed_row_.AsSlice()))) {
+        reader_.iter_->SeekOutOfSubDoc(root_doc_key_);
+        return DocReaderResult::kAddedToBatch;
+      }
+      VLOG_WITH_PREFIX_AND_FUNC(4) << "Row could not be added to batch";
+      reader_.iter_->Seek(root_doc_key_);
+    }
+
+    return VERIFY_RESULT(RunPrepared()) ? DocReaderResult::kFound : DocReaderResult::kNotFound;
+  }
+
+  // Whether document was found or not.
+  bool Found() const {
+    return last_found_ >= 0 || has_root_value_;
+  }
+
+ private:
+  Result<bool> RunPrepared() {
     // projection could be null in tests only.
     if (reader_.projection_) {
       if (reader_.projection_->empty()) {
@@ -270,12 +308,6 @@ class DocDBTableReader::GetHelper {
     return false;
   }
 
-  // Whether document was found or not.
-  bool Found() const {
-    return last_found_ >= 0 || has_root_value_;
-  }
-
- private:
   // Scans DocDB for entries related to root_doc_key_.
   // Iterator should already point to the first such entry.
   // Changes nearly all internal state fields.
@@ -617,5 +649,11 @@ Result<bool> DocDBTableReader::Get(const Slice& root_doc_key, SubDocument* resul
   return helper.Run();
 }
 
+Result<DocReaderResult> DocDBTableReader::GetPacked(
+    const Slice& root_doc_key, SubDocument* result, PackedColumnBatch* batch) {
+  GetHelper helper(this, root_doc_key, result);
+  return helper.RunPacked(batch);
+}
+
 }  // namespace docdb
 }  // namespace yb
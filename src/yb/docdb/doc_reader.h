@@ -64,6 +64,8 @@ Result<boost::optional<SubDocument>> TEST_GetSubDocument(
     const ReadHybridTime& read_time = ReadHybridTime::Max(),
     const std::vector<KeyEntryValue>* projection = nullptr);
 
+YB_DEFINE_ENUM(DocReaderResult, (kNotFound)(kFound)(kAddedToBatch));
+
 // This class reads SubDocument instances for a given table. The caller should initialize with
 // UpdateTableTombstoneTime and SetTableTtl, if applicable, before calling Get(). Instances
 // of DocDBTableReader assume, for the lifetime of the instance, that the provided
@@ -93,6 +95,13 @@ class DocDBTableReader {
   // Returns true if value was found, false otherwise.
   Result<bool> Get(const Slice& root_doc_key, SubDocument* result);
 
+  // Same as Get, but when row is represented by a single packed row without column level updates
+  // on top of it, appends it to batch instead of building SubDocument and returns kAddedToBatch.
+  // Otherwise reads row to result, like Get does.
+  // Column write time and TTL are not tracked for rows added to batch.
+  Result<DocReaderResult> GetPacked(
+      const Slice& root_doc_key, SubDocument* result, PackedColumnBatch* batch);
+
  private:
   // Initializes the reader to read a row at sub_doc_key by seeking to and reading obsolescence info
   // at that row.
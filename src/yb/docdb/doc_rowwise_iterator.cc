@@ -39,6 +39,7 @@
 #include "yb/docdb/docdb_types.h"
 #include "yb/docdb/expiration.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/packed_column_batch.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/subdocument.h"
 #include "yb/docdb/value.h"
@@ -54,6 +55,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/result.h"
+#include "yb/util/scope_exit.h"
 #include "yb/util/status.h"
 #include "yb/util/status_format.h"
 #include "yb/util/status_log.h"
@@ -1213,15 +1215,26 @@ DocRowwiseIterator::DocRowwiseIterator(
 DocRowwiseIterator::~DocRowwiseIterator() {
 }
 
-Status DocRowwiseIterator::Init(TableType table_type, const Slice& sub_doc_key) {
-  db_iter_ = CreateIntentAwareIterator(
+void DocRowwiseIterator::InitIterator(
+    TableType table_type, const std::vector<Slice>& user_keys_for_filter) {
+  // Without keys for filter no SST files are excluded, as with DONT_USE_BLOOM_FILTER.
+  db_iter_ = CreateIntentAwareIteratorForKeys(
       doc_db_,
-      BloomFilterMode::DONT_USE_BLOOM_FILTER,
-      boost::none /* user_key_for_filter */,
+      user_keys_for_filter,
       rocksdb::kDefaultQueryId,
       txn_op_context_,
       deadline_,
       read_time_);
+  row_ready_ = false;
+  has_bound_key_ = false;
+  table_type_ = table_type;
+  if (table_type == TableType::PGSQL_TABLE_TYPE) {
+    ignore_ttl_ = true;
+  }
+}
+
+Status DocRowwiseIterator::Init(TableType table_type, const Slice& sub_doc_key) {
+  InitIterator(table_type);
   if (!sub_doc_key.empty()) {
     row_key_ = sub_doc_key;
   } else {
@@ -1231,16 +1244,28 @@ Status DocRowwiseIterator::Init(TableType table_type, const Slice& sub_doc_key)
   row_hash_key_ = row_key_;
   VLOG(3) << __PRETTY_FUNCTION__ << " Seeking to " << row_key_;
   db_iter_->Seek(row_key_);
-  row_ready_ = false;
-  has_bound_key_ = false;
-  table_type_ = table_type;
-  if (table_type == TableType::PGSQL_TABLE_TYPE) {
-    ignore_ttl_ = true;
-  }
 
   return Status::OK();
 }
 
+Status DocRowwiseIterator::InitForTupleLookups(
+    TableType table_type, const std::vector<Slice>& tuple_ids) {
+  // Bloom filter of a single key does not fit an iterator that serves many tuples, so SST files are
+  // filtered by keys of all tuples instead.
+  std::vector<KeyBytes> tuple_keys;
+  tuple_keys.reserve(tuple_ids.size());
+  for (const auto& tuple_id : tuple_ids) {
+    tuple_keys.emplace_back(TupleKey(tuple_id));
+  }
+  std::vector<Slice> user_keys_for_filter;
+  user_keys_for_filter.reserve(tuple_keys.size());
+  for (const auto& tuple_key : tuple_keys) {
+    user_keys_for_filter.push_back(tuple_key.AsSlice());
+  }
+  InitIterator(table_type, user_keys_for_filter);
+  return Status::OK();
+}
+
 Result<bool> DocRowwiseIterator::InitScanChoices(
     const DocQLScanSpec& doc_spec, const KeyBytes& lower_doc_key, const KeyBytes& upper_doc_key) {
 
@@ -1465,23 +1490,26 @@ Result<bool> DocRowwiseIterator::HasNext() const {
       // We found a match for the target key or a static column, so we move on to getting the
       // SubDocument.
     }
-    if (doc_reader_ == nullptr) {
-      doc_reader_ = std::make_unique<DocDBTableReader>(
-          db_iter_.get(), deadline_, &projection_subkeys_, table_type_,
-          doc_read_context_.schema_packing_storage);
-      RETURN_NOT_OK(doc_reader_->UpdateTableTombstoneTime(doc_key));
-      if (!ignore_ttl_) {
-        doc_reader_->SetTableTtl(doc_read_context_.schema);
-      }
-    }
+    RETURN_NOT_OK(InitDocReader(doc_key));
 
     row_ = SubDocument();
-    auto doc_found_res = doc_reader_->Get(doc_key, &row_);
-    if (!doc_found_res.ok()) {
-      has_next_status_ = doc_found_res.status();
-      return has_next_status_;
+    if (packed_batch_) {
+      auto get_result = doc_reader_->GetPacked(doc_key, &row_, packed_batch_);
+      if (!get_result.ok()) {
+        has_next_status_ = get_result.status();
+        return has_next_status_;
+      }
+      doc_found = *get_result != DocReaderResult::kNotFound;
+      row_in_batch_ = *get_result == DocReaderResult::kAddedToBatch;
     } else {
-      doc_found = *doc_found_res;
+      auto doc_found_res = doc_reader_->Get(doc_key, &row_);
+      if (!doc_found_res.ok()) {
+        has_next_status_ = doc_found_res.status();
+        return has_next_status_;
+      } else {
+        doc_found = *doc_found_res;
+      }
+      row_in_batch_ = false;
     }
     if (scan_choices_ && !is_static_column) {
       has_next_status_ = scan_choices_->DoneWithCurrentTarget();
@@ -1495,37 +1523,24 @@ Result<bool> DocRowwiseIterator::HasNext() const {
   return true;
 }
 
-string DocRowwiseIterator::ToString() const {
-  return "DocRowwiseIterator";
+Status DocRowwiseIterator::InitDocReader(const Slice& doc_key) const {
+  if (doc_reader_ != nullptr) {
+    return Status::OK();
+  }
+  doc_reader_ = std::make_unique<DocDBTableReader>(
+      db_iter_.get(), deadline_, &projection_subkeys_, table_type_,
+      doc_read_context_.schema_packing_storage);
+  RETURN_NOT_OK(doc_reader_->UpdateTableTombstoneTime(doc_key));
+  if (!ignore_ttl_) {
+    doc_reader_->SetTableTtl(doc_read_context_.schema);
+  }
+  return Status::OK();
 }
 
-namespace {
-
-// Set primary key column values (hashed or range columns) in a QL row value map.
-Status SetQLPrimaryKeyColumnValues(const Schema& schema,
-                                           const size_t begin_index,
-                                           const size_t column_count,
-                                           const char* column_type,
-                                           DocKeyDecoder* decoder,
-                                           QLTableRow* table_row) {
-  if (begin_index + column_count > schema.num_columns()) {
-    return STATUS_SUBSTITUTE(
-        Corruption,
-        "$0 primary key columns between positions $1 and $2 go beyond table columns $3",
-        column_type, begin_index, begin_index + column_count - 1, schema.num_columns());
-  }
-  KeyEntryValue key_entry_value;
-  for (size_t i = 0, j = begin_index; i < column_count; i++, j++) {
-    const auto ql_type = schema.column(j).type();
-    QLTableColumn& column = table_row->AllocColumn(schema.column_id(j));
-    RETURN_NOT_OK(decoder->DecodeKeyEntryValue(&key_entry_value));
-    key_entry_value.ToQLValuePB(ql_type, &column.value);
-  }
-  return decoder->ConsumeGroupEnd();
+string DocRowwiseIterator::ToString() const {
+  return "DocRowwiseIterator";
 }
 
-} // namespace
-
 void DocRowwiseIterator::SkipRow() {
   row_ready_ = false;
 }
@@ -1556,24 +1571,7 @@ Status DocRowwiseIterator::DoNextRow(const Schema& projection, QLTableRow* table
     return STATUS(InternalError, "next row has not be prepared for reading");
   }
 
-  DocKeyDecoder decoder(row_key_);
-  RETURN_NOT_OK(decoder.DecodeCotableId());
-  RETURN_NOT_OK(decoder.DecodeColocationId());
-  bool has_hash_components = VERIFY_RESULT(decoder.DecodeHashCode());
-
-  // Populate the key column values from the doc key. The key column values in doc key were
-  // written in the same order as in the table schema (see DocKeyFromQLKey). If the range columns
-  // are present, read them also.
-  if (has_hash_components) {
-    RETURN_NOT_OK(SetQLPrimaryKeyColumnValues(
-        doc_read_context_.schema, 0, doc_read_context_.schema.num_hash_key_columns(),
-        "hash", &decoder, table_row));
-  }
-  if (!decoder.GroupEnded()) {
-    RETURN_NOT_OK(SetQLPrimaryKeyColumnValues(
-        doc_read_context_.schema, doc_read_context_.schema.num_hash_key_columns(),
-        doc_read_context_.schema.num_range_key_columns(), "range", &decoder, table_row));
-  }
+  RETURN_NOT_OK(DecodeKeyColumns(doc_read_context_.schema, row_key_, table_row));
 
   for (size_t i = projection.num_key_columns(); i < projection.num_columns(); i++) {
     const auto& column_id = projection.column_id(i);
@@ -1593,6 +1591,35 @@ Status DocRowwiseIterator::DoNextRow(const Schema& projection, QLTableRow* table
   return Status::OK();
 }
 
+Result<size_t> DocRowwiseIterator::NextPackedRows(size_t max_rows, PackedColumnBatch* batch) {
+  if (table_type_ != TableType::PGSQL_TABLE_TYPE || doc_read_context_.schema.has_statics()) {
+    return 0;
+  }
+  if (row_ready_ && !row_in_batch_) {
+    // Row was already prepared in regular form, it should be read with NextRow.
+    return 0;
+  }
+  if (!batch->initialized()) {
+    batch->Init(doc_read_context_.schema, projection_);
+  }
+
+  packed_batch_ = batch;
+  auto se = ScopeExit([this] {
+    packed_batch_ = nullptr;
+  });
+  size_t result = 0;
+  while (result < max_rows && VERIFY_RESULT(HasNext())) {
+    if (!row_in_batch_) {
+      // Row could not be added to batch, keep it prepared for NextRow.
+      break;
+    }
+    row_in_batch_ = false;
+    row_ready_ = false;
+    ++result;
+  }
+  return result;
+}
+
 bool DocRowwiseIterator::LivenessColumnExists() const {
   const SubDocument* subdoc = row_.GetChild(KeyEntryValue::kLivenessColumn);
   return subdoc != nullptr && subdoc->value_type() != ValueEntryType::kInvalid;
@@ -1627,38 +1654,72 @@ Result<Slice> DocRowwiseIterator::GetTupleId() const {
   return tuple_id;
 }
 
-Result<bool> DocRowwiseIterator::SeekTuple(const Slice& tuple_id) {
+Slice DocRowwiseIterator::TupleKey(const Slice& tuple_id) {
   // If cotable id / colocation id is present in the table schema, then
   // we need to prepend it in the tuple key to seek.
-  if (doc_read_context_.schema.has_cotable_id() || doc_read_context_.schema.has_colocation_id()) {
-    uint32_t size = doc_read_context_.schema.has_colocation_id() ? sizeof(ColocationId) : kUuidSize;
-    if (!tuple_key_) {
-      tuple_key_.emplace();
-      tuple_key_->Reserve(1 + size + tuple_id.size());
-
-      if (doc_read_context_.schema.has_cotable_id()) {
-        std::string bytes;
-        doc_read_context_.schema.cotable_id().EncodeToComparable(&bytes);
-        tuple_key_->AppendKeyEntryType(KeyEntryType::kTableId);
-        tuple_key_->AppendRawBytes(bytes);
-      } else {
-        tuple_key_->AppendKeyEntryType(KeyEntryType::kColocationId);
-        tuple_key_->AppendUInt32(doc_read_context_.schema.colocation_id());
-      }
+  if (!doc_read_context_.schema.has_cotable_id() && !doc_read_context_.schema.has_colocation_id()) {
+    return tuple_id;
+  }
+  uint32_t size = doc_read_context_.schema.has_colocation_id() ? sizeof(ColocationId) : kUuidSize;
+  if (!tuple_key_) {
+    tuple_key_.emplace();
+    tuple_key_->Reserve(1 + size + tuple_id.size());
+
+    if (doc_read_context_.schema.has_cotable_id()) {
+      std::string bytes;
+      doc_read_context_.schema.cotable_id().EncodeToComparable(&bytes);
+      tuple_key_->AppendKeyEntryType(KeyEntryType::kTableId);
+      tuple_key_->AppendRawBytes(bytes);
     } else {
-      tuple_key_->Truncate(1 + size);
+      tuple_key_->AppendKeyEntryType(KeyEntryType::kColocationId);
+      tuple_key_->AppendUInt32(doc_read_context_.schema.colocation_id());
     }
-    tuple_key_->AppendRawBytes(tuple_id);
-    db_iter_->Seek(*tuple_key_);
   } else {
-    db_iter_->Seek(tuple_id);
+    tuple_key_->Truncate(1 + size);
   }
+  tuple_key_->AppendRawBytes(tuple_id);
+  return *tuple_key_;
+}
+
+Result<bool> DocRowwiseIterator::SeekTuple(const Slice& tuple_id) {
+  db_iter_->Seek(TupleKey(tuple_id));
 
   iter_key_.Clear();
+  fetched_tuple_key_.Clear();
   row_ready_ = false;
+  done_ = false;
 
   return VERIFY_RESULT(HasNext()) && VERIFY_RESULT(GetTupleId()) == tuple_id;
 }
 
+Result<bool> DocRowwiseIterator::FetchTuple(const Slice& tuple_id, QLTableRow* table_row) {
+  const auto tuple_key = TupleKey(tuple_id);
+  // DocDBTableReader only moves the iterator forward, so we have to seek explicitly when it could
+  // be positioned past the tuple.
+  if (fetched_tuple_key_.empty() || fetched_tuple_key_.AsSlice().compare(tuple_key) >= 0) {
+    VLOG(4) << __func__ << " Seeking to " << DocKey::DebugSliceToString(tuple_key);
+    db_iter_->Seek(tuple_key);
+  }
+  fetched_tuple_key_.Reset(tuple_key);
+
+  iter_key_.Clear();
+  row_ready_ = false;
+  row_in_batch_ = false;
+  done_ = false;
+
+  RETURN_NOT_OK(InitDocReader(tuple_key));
+  row_ = SubDocument();
+  if (!VERIFY_RESULT(doc_reader_->Get(tuple_key, &row_))) {
+    return false;
+  }
+
+  const auto dockey_sizes = VERIFY_RESULT(DocKey::EncodedHashPartAndDocKeySizes(tuple_key));
+  row_hash_key_ = tuple_key.Prefix(dockey_sizes.hash_part_size);
+  row_key_ = tuple_key;
+  row_ready_ = true;
+  RETURN_NOT_OK(DoNextRow(projection_, table_row));
+  return true;
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -72,6 +72,11 @@ class DocRowwiseIterator : public YQLRowwiseIteratorIf {
   // Init QL read scan.
   Status Init(const QLScanSpec& spec);
   Status Init(const PgsqlScanSpec& spec);
+  // Init iterator for reading individual rows by FetchTuple. The iterator is not positioned, so
+  // HasNext should not be called before SeekTuple.
+  // When tuple_ids is not empty, SST files whose bloom filter rejects all of them are skipped, so
+  // only tuples from tuple_ids could be fetched.
+  Status InitForTupleLookups(TableType table_type, const std::vector<Slice>& tuple_ids = {});
 
   // This must always be called before NextRow. The implementation actually finds the
   // first row to scan, and NextRow expects the RocksDB iterator to already be properly
@@ -109,9 +114,22 @@ class DocRowwiseIterator : public YQLRowwiseIteratorIf {
   // the cotable id.
   Result<bool> SeekTuple(const Slice& tuple_id) override;
 
+  // Reads the given tuple into table_row using the iterator projection. Returns false when there is
+  // no such tuple. The tuple id format is the same as for SeekTuple.
+  // When tuples are fetched in ascending order of their ids, the underlying iterator only moves
+  // forward: keys that are close to the current position are reached with Next instead of Seek,
+  // and already loaded data blocks are reused. Fetching a tuple that precedes the previously
+  // fetched one costs a regular seek. Should not be interleaved with HasNext based iteration.
+  Result<bool> FetchTuple(const Slice& tuple_id, QLTableRow* table_row) override;
+
   // Retrieves the next key to read after the iterator finishes for the given page.
   Status GetNextReadSubDocKey(SubDocKey* sub_doc_key) const override;
 
+  // Reads up to max_rows rows that are represented by a single packed row into batch, in columnar
+  // form. Stops at the first row that requires generic processing, this row is left prepared for
+  // NextRow. Supported for YSQL tables only, returns 0 for other tables.
+  Result<size_t> NextPackedRows(size_t max_rows, PackedColumnBatch* batch) override;
+
   void set_debug_dump(bool value) {
     debug_dump_ = value;
   }
@@ -120,6 +138,17 @@ class DocRowwiseIterator : public YQLRowwiseIteratorIf {
   template <class T>
   Status DoInit(const T& spec);
 
+  // Creates an unbounded db_iter_ without positioning it. SST files whose bloom filter rejects all
+  // of user_keys_for_filter are skipped.
+  void InitIterator(TableType table_type, const std::vector<Slice>& user_keys_for_filter = {});
+
+  // Creates doc_reader_ if it was not created yet.
+  Status InitDocReader(const Slice& doc_key) const;
+
+  // Returns the key that should be used to seek the given tuple, prepending cotable id /
+  // colocation id when necessary.
+  Slice TupleKey(const Slice& tuple_id);
+
   Result<bool> InitScanChoices(
       const DocQLScanSpec& doc_spec, const KeyBytes& lower_doc_key, const KeyBytes& upper_doc_key);
 
@@ -224,8 +253,18 @@ class DocRowwiseIterator : public YQLRowwiseIteratorIf {
   // Key for seeking a YSQL tuple. Used only when the table has a cotable id.
   boost::optional<KeyBytes> tuple_key_;
 
+  // Key of the tuple read by the last FetchTuple call, empty when the iterator was positioned by
+  // other means after it.
+  KeyBytes fetched_tuple_key_;
+
   mutable std::unique_ptr<DocDBTableReader> doc_reader_ = nullptr;
 
+  // Batch that rows should be added to by HasNext, set only while NextPackedRows is running.
+  mutable PackedColumnBatch* packed_batch_ = nullptr;
+
+  // Whether the current row was added to packed_batch_ instead of row_.
+  mutable bool row_in_batch_ = false;
+
   TableType table_type_;
   mutable bool ignore_ttl_ = false;
 
@@ -39,6 +39,7 @@ class IntentAwareIterator;
 class KeyBytes;
 class KeyEntryValue;
 class ManualHistoryRetentionPolicy;
+class PackedColumnBatch;
 class PgsqlWriteOperation;
 class PrimitiveValue;
 class QLWriteOperation;
@@ -100,6 +100,13 @@ DEFINE_uint64(rocksdb_compaction_size_threshold_bytes, 2ULL * 1024 * 1024 * 1024
              "Threshold beyond which compaction is considered large.");
 DEFINE_uint64(rocksdb_max_file_size_for_compaction, 0,
              "Maximal allowed file size to participate in RocksDB compaction. 0 - unlimited.");
+DEFINE_int32(rocksdb_max_subcompactions, 1,
+             "Maximal number of subcompactions a large RocksDB compaction is split into. "
+             "Subcompactions process disjoint key ranges in parallel on the compaction thread "
+             "pool. 1 - disables subcompactions.");
+DEFINE_uint64(rocksdb_min_subcompaction_input_size, 2_GB,
+              "Compaction is split into subcompactions only when each of them would process at "
+              "least this amount of input data.");
 DEFINE_int32(rocksdb_max_write_buffer_number, 2,
              "Maximum number of write buffers that are built up in memory.");
 
@@ -123,6 +130,11 @@ DEFINE_int32(memstore_size_mb, 128,
 
 DEFINE_bool(use_docdb_aware_bloom_filter, true,
             "Whether to use the DocDbAwareFilterPolicy for both bloom storage and seeks.");
+// Using class kExternal as this change affects the format of bloom filters in the SST files which
+// are sent to xClusters during bootstrap.
+DEFINE_AUTO_bool(use_docdb_blocked_bloom_filter, kExternal, false, true,
+                 "Whether to write DocDB aware bloom filters in register-blocked format "
+                 "(DocKeyV4Filter). Files written with previous filter formats remain readable.");
 // Empirically 2 is a minimal value that provides best performance on sequential scan.
 DEFINE_int32(max_nexts_to_avoid_seek, 2,
              "The number of next calls to try before doing resorting to do a rocksdb seek.");
@@ -136,6 +148,15 @@ DEFINE_AUTO_string(regular_tablets_data_block_key_value_encoding,
     "Key-value encoding to use for regular data blocks in RocksDB. Possible options: "
     "shared_prefix, three_shared_parts");
 
+DEFINE_string(regular_tablets_memtable_rep, "skiplist",
+    "Memtable representation to use for regular RocksDB of tablets. Possible options: "
+    "skiplist, doc_key_skiplist. doc_key_skiplist groups memtable entries by DocKey, so "
+    "inserts and point reads only compare keys of the same document.");
+
+DEFINE_uint64(regular_tablets_memtable_rep_bucket_count, 16384,
+    "Number of hash buckets used to find documents in doc_key_skiplist memtables. Allocated "
+    "for each memtable.");
+
 DEFINE_uint64(initial_seqno, 1ULL << 50, "Initial seqno for new RocksDB instances.");
 
 DEFINE_int32(num_reserved_small_compaction_threads, -1, "Number of reserved small compaction "
@@ -153,6 +174,14 @@ DEFINE_string(compression_type, "Snappy",
               "On-disk compression type to use in RocksDB."
               "By default, Snappy is used if supported.");
 
+DEFINE_uint64(rocksdb_compression_dict_bytes, 16_KB,
+              "Maximal size of ZSTD dictionary trained on data blocks of each SST file written by "
+              "compaction. Only used when compression_type is ZSTD. 0 disables dictionaries.");
+
+DEFINE_uint64(rocksdb_compression_dict_max_train_bytes, 0,
+              "Maximal size of data blocks sampled to train ZSTD dictionary of each SST file. "
+              "0 means 100 times rocksdb_compression_dict_bytes.");
+
 DEFINE_int32(block_restart_interval, kDefaultDataBlockRestartInterval,
              "Controls the number of keys to look at for computing the diff encoding.");
 
@@ -174,7 +203,8 @@ Result<rocksdb::CompressionType> GetConfiguredCompressionType(const std::string&
     rocksdb::kNoCompression,
     rocksdb::kSnappyCompression,
     rocksdb::kZlibCompression,
-    rocksdb::kLZ4Compression
+    rocksdb::kLZ4Compression,
+    rocksdb::kZSTD
   };
   for (const auto& compression_type : kValidRocksDBCompressionTypes) {
     if (boost::iequals(flag_value, rocksdb::CompressionTypeToString(compression_type))) {
@@ -203,6 +233,20 @@ namespace docdb {
     return STATUS_FORMAT(InvalidArgument, "Key-value encoding format $0 is not valid.", flag_value);
   }
 
+Result<std::shared_ptr<rocksdb::MemTableRepFactory>> GetConfiguredMemTableRepFactory(
+    const std::string& flag_value) {
+  if (flag_value == "skiplist") {
+    return std::make_shared<rocksdb::SkipListFactory>(
+        0 /* lookahead */, rocksdb::ConcurrentWrites::kFalse);
+  }
+  if (flag_value == "doc_key_skiplist") {
+    return std::shared_ptr<rocksdb::MemTableRepFactory>(rocksdb::NewPrefixSkipListRepFactory(
+        std::make_shared<DocKeySliceTransform>(),
+        std::max<uint64_t>(FLAGS_regular_tablets_memtable_rep_bucket_count, 1)));
+  }
+  return STATUS_FORMAT(InvalidArgument, "Memtable representation $0 is not valid.", flag_value);
+}
+
 } // namespace docdb
 
 } // namespace yb
@@ -229,10 +273,20 @@ bool KeyValueEncodingFormatValidator(const char* flag_name, const std::string& f
   return ok;
 }
 
+bool MemTableRepValidator(const char* flag_name, const std::string& flag_value) {
+  auto res = yb::docdb::GetConfiguredMemTableRepFactory(flag_value);
+  bool ok = res.ok();
+  if (!ok) {
+    LOG(ERROR) << flag_name << ": " << res.status();
+  }
+  return ok;
+}
+
 } // namespace
 
 DEFINE_validator(compression_type, &CompressionTypeValidator);
 DEFINE_validator(regular_tablets_data_block_key_value_encoding, &KeyValueEncodingFormatValidator);
+DEFINE_validator(regular_tablets_memtable_rep, &MemTableRepValidator);
 
 using std::shared_ptr;
 using std::string;
@@ -379,6 +433,24 @@ unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
       doc_db, read_opts, deadline, read_time, txn_op_context);
 }
 
+unique_ptr<IntentAwareIterator> CreateIntentAwareIteratorForKeys(
+    const DocDB& doc_db,
+    const std::vector<Slice>& user_keys_for_filter,
+    const rocksdb::QueryId query_id,
+    const TransactionOperationContext& txn_op_context,
+    CoarseTimePoint deadline,
+    const ReadHybridTime& read_time) {
+  rocksdb::ReadOptions read_opts = PrepareReadOptions(doc_db.regular,
+      BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, query_id,
+      /* file_filter = */ nullptr, /* iterate_upper_bound = */ nullptr);
+  if (FLAGS_use_docdb_aware_bloom_filter && !user_keys_for_filter.empty()) {
+    read_opts.table_aware_file_filter = doc_db.regular->GetOptions().table_factory->
+        NewTableAwareMultiKeyReadFileFilter(read_opts, user_keys_for_filter);
+  }
+  return std::make_unique<IntentAwareIterator>(
+      doc_db, read_opts, deadline, read_time, txn_op_context);
+}
+
 namespace {
 
 std::mutex rocksdb_flags_mutex;
@@ -633,6 +705,10 @@ void InitRocksDBOptions(
   // Since the flag validator for FLAGS_compression_type will fail if the result of this call is not
   // OK, this CHECK_RESULT should never fail and is safe.
   options->compression = CHECK_RESULT(GetConfiguredCompressionType(FLAGS_compression_type));
+  options->compression_opts.max_dict_bytes =
+      narrow_cast<uint32_t>(FLAGS_rocksdb_compression_dict_bytes);
+  options->compression_opts.zstd_max_train_bytes =
+      narrow_cast<uint32_t>(FLAGS_rocksdb_compression_dict_max_train_bytes);
 
   options->listeners.insert(
       options->listeners.end(), tablet_options.listeners.begin(),
@@ -641,6 +717,7 @@ void InitRocksDBOptions(
   // Set block cache options.
   if (tablet_options.block_cache) {
     table_options.block_cache = tablet_options.block_cache;
+    table_options.persistent_cache = tablet_options.persistent_block_cache;
     // Cache the bloom filters in the block cache.
     table_options.cache_index_and_filter_blocks = true;
   } else {
@@ -653,10 +730,19 @@ void InitRocksDBOptions(
   // Set our custom bloom filter that is docdb aware.
   if (FLAGS_use_docdb_aware_bloom_filter) {
     const auto filter_block_size_bits = table_options.filter_block_size * 8;
-    table_options.filter_policy = std::make_shared<const DocDbAwareV3FilterPolicy>(
+    auto v3_policy = std::make_shared<const DocDbAwareV3FilterPolicy>(
         filter_block_size_bits, options->info_log.get());
     table_options.supported_filter_policies =
         std::make_shared<rocksdb::BlockBasedTableOptions::FilterPoliciesMap>();
+    if (FLAGS_use_docdb_blocked_bloom_filter) {
+      table_options.filter_policy = std::make_shared<const DocDbAwareV4FilterPolicy>(
+          filter_block_size_bits, options->info_log.get());
+      AddSupportedFilterPolicy(v3_policy, &table_options);
+    } else {
+      table_options.filter_policy = v3_policy;
+      AddSupportedFilterPolicy(std::make_shared<const DocDbAwareV4FilterPolicy>(
+              filter_block_size_bits, options->info_log.get()), &table_options);
+    }
     AddSupportedFilterPolicy(std::make_shared<const DocDbAwareHashedComponentsFilterPolicy>(
             filter_block_size_bits, options->info_log.get()), &table_options);
     AddSupportedFilterPolicy(std::make_shared<const DocDbAwareV2FilterPolicy>(
@@ -698,6 +784,11 @@ void InitRocksDBOptions(
     options->compaction_options_universal.min_merge_width =
         FLAGS_rocksdb_universal_compaction_min_merge_width;
     options->compaction_size_threshold_bytes = FLAGS_rocksdb_compaction_size_threshold_bytes;
+    options->max_subcompactions = std::max(FLAGS_rocksdb_max_subcompactions, 1);
+    options->min_subcompaction_input_size = FLAGS_rocksdb_min_subcompaction_input_size;
+    // Compaction feed keeps state across records of the same document, so subcompaction
+    // boundaries should not split documents.
+    options->subcompaction_boundary_transform = std::make_shared<DocKeySliceTransform>();
     options->rate_limiter = tablet_options.rate_limiter ? tablet_options.rate_limiter
                                                         : CreateRocksDBRateLimiter();
   } else {
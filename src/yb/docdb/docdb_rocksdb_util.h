@@ -101,6 +101,17 @@ std::unique_ptr<IntentAwareIterator> CreateIntentAwareIterator(
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter = nullptr,
     const Slice* iterate_upper_bound = nullptr);
 
+// Creates iterator for looking up a batch of keys with possibly different hashed components.
+// SST files whose bloom filter rejects all of user_keys_for_filter are excluded, so lookups of a
+// few keys check the bloom filter as CreateIntentAwareIterator with USE_BLOOM_FILTER does.
+std::unique_ptr<IntentAwareIterator> CreateIntentAwareIteratorForKeys(
+    const DocDB& doc_db,
+    const std::vector<Slice>& user_keys_for_filter,
+    const rocksdb::QueryId query_id,
+    const TransactionOperationContext& transaction_context,
+    CoarseTimePoint deadline,
+    const ReadHybridTime& read_time);
+
 // Request RocksDB compaction and wait until it completes.
 Status ForceRocksDBCompact(rocksdb::DB* db, SkipFlush skip_flush = SkipFlush::kFalse);
 
@@ -113,6 +124,10 @@ Result<rocksdb::CompressionType> TEST_GetConfiguredCompressionType(const std::st
 Result<rocksdb::KeyValueEncodingFormat> GetConfiguredKeyValueEncodingFormat(
     const std::string& flag_value);
 
+// Returns memtable representation factory for the value of regular_tablets_memtable_rep flag.
+Result<std::shared_ptr<rocksdb::MemTableRepFactory>> GetConfiguredMemTableRepFactory(
+    const std::string& flag_value);
+
 // Defines how rate limiter is shared across a node
 YB_DEFINE_ENUM(RateLimiterSharingMode, (NONE)(TSERVER));
 
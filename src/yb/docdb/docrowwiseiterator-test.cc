@@ -2108,6 +2108,58 @@ TXN REV 30303030-3030-3030-3030-303030303031 HT{ physical: 500 w: 3 } -> \
   }
 }
 
+TEST_F(DocRowwiseIteratorTest, FetchTuple) {
+  const KeyBytes encoded_doc_key3(DocKey(KeyEntryValues("row3", 33333)).Encode());
+  const KeyBytes missing_doc_key(DocKey(KeyEntryValues("row15", 15555)).Encode());
+
+  ASSERT_OK(SetPrimitive(
+      DocPath(kEncodedDocKey1, KeyEntryValue::MakeColumnId(30_ColId)),
+      QLValue::Primitive("row1_c"), HybridTime::FromMicros(1000)));
+  ASSERT_OK(SetPrimitive(
+      DocPath(kEncodedDocKey2, KeyEntryValue::MakeColumnId(30_ColId)),
+      QLValue::Primitive("row2_c"), HybridTime::FromMicros(1000)));
+  ASSERT_OK(SetPrimitive(
+      DocPath(encoded_doc_key3, KeyEntryValue::MakeColumnId(30_ColId)),
+      QLValue::Primitive("row3_c"), HybridTime::FromMicros(1000)));
+  ASSERT_OK(DeleteSubDoc(DocPath(kEncodedDocKey2), HybridTime::FromMicros(2000)));
+  // Flush, so tuple lookups go through SST file filtered by the bloom filter.
+  ASSERT_OK(FlushRocksDbAndWait());
+
+  const Schema &projection = kProjectionForIteratorTests;
+  DocReadContext doc_read_context(kSchemaForIteratorTests, 1);
+
+  DocRowwiseIterator iter(
+      projection, doc_read_context, kNonTransactionalOperationContext, doc_db(),
+      CoarseTimePoint::max() /* deadline */, ReadHybridTime::FromMicros(3000));
+  ASSERT_OK(iter.InitForTupleLookups(
+      YQL_TABLE_TYPE,
+      {kEncodedDocKey1.AsSlice(), missing_doc_key.AsSlice(), kEncodedDocKey2.AsSlice(),
+       encoded_doc_key3.AsSlice()}));
+
+  const std::vector<std::pair<const KeyBytes*, std::string>> lookups = {
+      {&kEncodedDocKey1, "row1_c"},
+      {&missing_doc_key, ""},
+      {&kEncodedDocKey2, ""},
+      {&encoded_doc_key3, "row3_c"},
+      // Lookups in the reverse order should reposition the iterator.
+      {&encoded_doc_key3, "row3_c"},
+      {&kEncodedDocKey1, "row1_c"},
+  };
+  for (const auto& [key, expected_value] : lookups) {
+    SCOPED_TRACE(DocKey::DebugSliceToString(key->AsSlice()));
+    QLTableRow row;
+    auto found = ASSERT_RESULT(iter.FetchTuple(key->AsSlice(), &row));
+    ASSERT_EQ(!expected_value.empty(), found);
+    if (!found) {
+      continue;
+    }
+    ASSERT_EQ(key->AsSlice(), ASSERT_RESULT(iter.GetTupleId()));
+    QLValue value;
+    ASSERT_OK(row.GetValue(projection.column_id(0), &value));
+    ASSERT_EQ(expected_value, value.string_value());
+  }
+}
+
 TEST_F(DocRowwiseIteratorTest, ScanWithinTheSameTxn) {
   SetTransactionIsolationLevel(IsolationLevel::SNAPSHOT_ISOLATION);
 
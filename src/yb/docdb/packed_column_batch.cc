@@ -0,0 +1,145 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/docdb/packed_column_batch.h"
+
+#include "yb/common/ql_expr.h"
+#include "yb/common/schema.h"
+
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/primitive_value.h"
+#include "yb/docdb/schema_packing.h"
+#include "yb/docdb/value.h"
+
+#include "yb/gutil/casts.h"
+
+#include "yb/util/result.h"
+#include "yb/util/uuid.h"
+
+namespace yb {
+namespace docdb {
+
+PackedColumnBatch::PackedColumnBatch() = default;
+PackedColumnBatch::~PackedColumnBatch() = default;
+
+void PackedColumnBatch::Init(const Schema& schema, const Schema& projection) {
+  schema_ = &schema;
+  projection_ = &projection;
+  columns_.clear();
+  columns_.reserve(projection.num_columns() - projection.num_key_columns());
+  for (auto i = projection.num_key_columns(); i != projection.num_columns(); ++i) {
+    columns_.push_back(Column {
+      .id = projection.column_id(i),
+      .values = {},
+    });
+  }
+  last_packing_ = nullptr;
+  Clear();
+}
+
+void PackedColumnBatch::Clear() {
+  for (auto& column : columns_) {
+    column.values.clear();
+  }
+  doc_keys_.clear();
+  data_.clear();
+  num_rows_ = 0;
+}
+
+ssize_t PackedColumnBatch::ColumnIndex(ColumnId column_id) const {
+  for (size_t i = 0; i != columns_.size(); ++i) {
+    if (columns_[i].id == column_id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+PackedColumnBatch::ValueRange PackedColumnBatch::Append(const Slice& slice) {
+  auto begin = narrow_cast<uint32_t>(data_.size());
+  data_.append(slice.cdata(), slice.size());
+  return ValueRange(begin, narrow_cast<uint32_t>(data_.size()));
+}
+
+void PackedColumnBatch::PreparePacking(const SchemaPacking& packing) {
+  if (last_packing_ == &packing) {
+    return;
+  }
+  column_packing_idx_.clear();
+  column_packing_idx_.reserve(columns_.size());
+  for (const auto& column : columns_) {
+    column_packing_idx_.push_back(packing.GetIndex(column.id));
+  }
+  last_packing_ = &packing;
+}
+
+Result<bool> PackedColumnBatch::AddRow(
+    const Slice& doc_key, const SchemaPacking& packing, const Slice& packed_row) {
+  PreparePacking(packing);
+
+  auto data_size = data_.size();
+  for (size_t i = 0; i != columns_.size(); ++i) {
+    auto& values = columns_[i].values;
+    auto packing_idx = column_packing_idx_[i];
+    if (packing_idx < 0) {
+      // Column is not present in the packing, so it is NULL for this row.
+      values.emplace_back(0, 0);
+      continue;
+    }
+    auto value = packing.GetValue(static_cast<size_t>(packing_idx), packed_row);
+    if (!value.empty()) {
+      auto control_fields = VERIFY_RESULT(ValueControlFields::Decode(&value));
+      if (control_fields.has_ttl()) {
+        // Column level TTL requires expiration tracking, that is not supported in columnar form.
+        for (size_t j = 0; j <= i; ++j) {
+          columns_[j].values.resize(num_rows_);
+        }
+        data_.resize(data_size);
+        return false;
+      }
+    }
+    values.push_back(value.empty() ? ValueRange(0, 0) : Append(value));
+  }
+  doc_keys_.push_back(Append(doc_key));
+  ++num_rows_;
+  return true;
+}
+
+Slice PackedColumnBatch::tuple_id(size_t row_idx) const {
+  Slice result = doc_key(row_idx);
+  if (result.starts_with(KeyEntryTypeAsChar::kTableId)) {
+    result.remove_prefix(1 + kUuidSize);
+  } else if (result.starts_with(KeyEntryTypeAsChar::kColocationId)) {
+    result.remove_prefix(1 + sizeof(ColocationId));
+  }
+  return result;
+}
+
+Status PackedColumnBatch::ToQLTableRow(size_t row_idx, QLTableRow* table_row) const {
+  RETURN_NOT_OK(DecodeKeyColumns(*schema_, doc_key(row_idx), table_row));
+
+  PrimitiveValue primitive_value;
+  for (size_t i = 0; i != columns_.size(); ++i) {
+    auto& column = table_row->AllocColumn(columns_[i].id);
+    if (IsNull(i, row_idx)) {
+      continue;
+    }
+    RETURN_NOT_OK(primitive_value.DecodeFromValue(value(i, row_idx)));
+    primitive_value.ToQLValuePB(
+        projection_->column(projection_->num_key_columns() + i).type(), &column.value);
+  }
+  return Status::OK();
+}
+
+} // namespace docdb
+} // namespace yb
@@ -0,0 +1,130 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "yb/common/common_fwd.h"
+#include "yb/common/column_id.h"
+
+#include "yb/docdb/docdb_fwd.h"
+
+#include "yb/util/slice.h"
+#include "yb/util/status_fwd.h"
+
+namespace yb {
+namespace docdb {
+
+// Batch of rows decoded from packed rows in columnar form.
+//
+// Only projected non key columns are extracted. Each column is stored as an array of encoded values
+// (value type followed by encoded data) referencing the batch own buffer, so no per row or per
+// column allocations are made after the batch has warmed up. Empty value means NULL.
+//
+// The batch is filled by DocRowwiseIterator::NextPackedRows and consumed by scans that could
+// process column vectors instead of individual rows.
+class PackedColumnBatch {
+ public:
+  PackedColumnBatch();
+  ~PackedColumnBatch();
+
+  // Prepares batch to accept rows of table with specified schema, using provided projection.
+  // Both schema and projection should outlive the batch.
+  void Init(const Schema& schema, const Schema& projection);
+
+  bool initialized() const {
+    return projection_ != nullptr;
+  }
+
+  // Removes all rows from batch, keeping allocated memory.
+  void Clear();
+
+  // Appends row identified by doc_key and stored as packed_row, using specified packing.
+  // packed_row should not contain value type and schema version.
+  // Returns false when row could not be represented in columnar form, for instance when some
+  // column has TTL or is not packed. In this case batch is not modified.
+  Result<bool> AddRow(const Slice& doc_key, const SchemaPacking& packing, const Slice& packed_row);
+
+  size_t num_rows() const {
+    return num_rows_;
+  }
+
+  // Number of projected non key columns.
+  size_t num_columns() const {
+    return columns_.size();
+  }
+
+  ColumnId column_id(size_t column_idx) const {
+    return columns_[column_idx].id;
+  }
+
+  // Returns index of column with specified id in batch, or -1 if it is not present.
+  ssize_t ColumnIndex(ColumnId column_id) const;
+
+  Slice doc_key(size_t row_idx) const {
+    return GetSlice(doc_keys_[row_idx]);
+  }
+
+  // Returns tuple id (ybctid) of the specified row, i.e. its doc key without cotable id /
+  // colocation id, the same way as DocRowwiseIterator::GetTupleId does.
+  Slice tuple_id(size_t row_idx) const;
+
+  Slice value(size_t column_idx, size_t row_idx) const {
+    return GetSlice(columns_[column_idx].values[row_idx]);
+  }
+
+  bool IsNull(size_t column_idx, size_t row_idx) const {
+    const auto& value = columns_[column_idx].values[row_idx];
+    return value.first == value.second;
+  }
+
+  // Fills table_row with key and projected columns of the specified row.
+  Status ToQLTableRow(size_t row_idx, QLTableRow* table_row) const;
+
+ private:
+  // Begin and end of value in data_.
+  using ValueRange = std::pair<uint32_t, uint32_t>;
+
+  struct Column {
+    ColumnId id;
+    std::vector<ValueRange> values;
+  };
+
+  Slice GetSlice(const ValueRange& range) const {
+    return Slice(data_.data() + range.first, data_.data() + range.second);
+  }
+
+  ValueRange Append(const Slice& slice);
+
+  // Updates column_packing_idx_ to match packing.
+  void PreparePacking(const SchemaPacking& packing);
+
+  const Schema* schema_ = nullptr;
+  const Schema* projection_ = nullptr;
+
+  std::vector<Column> columns_;
+  std::vector<ValueRange> doc_keys_;
+  std::string data_;
+  size_t num_rows_ = 0;
+
+  // Packing used by the last added row, and indexes of projected columns in this packing.
+  // Rows in a single scan usually share the same packing, so it is cached to avoid column id
+  // lookups for each row.
+  const SchemaPacking* last_packing_ = nullptr;
+  std::vector<int64_t> column_packing_idx_;
+};
+
+} // namespace docdb
+} // namespace yb
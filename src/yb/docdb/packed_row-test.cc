@@ -13,14 +13,19 @@
 
 #include <gtest/gtest.h>
 
+#include "yb/common/ql_expr.h"
 #include "yb/common/ql_value.h"
 #include "yb/common/schema.h"
 
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/packed_column_batch.h"
 #include "yb/docdb/packed_row.h"
 #include "yb/docdb/primitive_value.h"
 #include "yb/docdb/schema_packing.h"
 #include "yb/docdb/value_type.h"
 
+#include "yb/gutil/casts.h"
+
 #include "yb/util/fast_varint.h"
 #include "yb/util/random_util.h"
 #include "yb/util/test_macros.h"
@@ -117,5 +122,73 @@ TEST(PackedRowTest, Random) {
   }
 }
 
+TEST(PackedRowTest, ColumnarBatch) {
+  constexpr size_t kNumRows = 100;
+  constexpr int kVersion = 1;
+
+  SchemaBuilder builder;
+  ASSERT_OK(builder.AddHashKeyColumn("h1", DataType::INT32));
+  ASSERT_OK(builder.AddKeyColumn("r1", DataType::INT32));
+  ASSERT_OK(builder.AddColumn("v1", DataType::INT64));
+  ASSERT_OK(builder.AddNullableColumn("v2", DataType::STRING));
+  ASSERT_OK(builder.AddNullableColumn("v3", DataType::INT32));
+  auto schema = builder.Build();
+  SchemaPacking schema_packing(schema);
+
+  PackedColumnBatch batch;
+  batch.Init(schema, schema);
+  ASSERT_EQ(batch.num_columns(), schema.num_columns() - schema.num_key_columns());
+
+  std::vector<std::vector<QLValuePB>> rows;
+  for (size_t i = 0; i != kNumRows; ++i) {
+    std::vector<QLValuePB> values;
+    for (auto idx = schema.num_key_columns(); idx != schema.num_columns(); ++idx) {
+      if (schema.column(idx).is_nullable() && RandomUniformBool()) {
+        values.emplace_back();
+      } else {
+        values.push_back(RandomQLValue(schema.column(idx).type_info()->type));
+      }
+    }
+    RowPacker packer(
+        kVersion, schema_packing, /* packed_size_limit= */ std::numeric_limits<int64_t>::max(),
+        /* value_control_fields= */ Slice());
+    for (size_t j = 0; j != values.size(); ++j) {
+      ASSERT_OK(packer.AddValue(schema.column_id(schema.num_key_columns() + j), values[j]));
+    }
+    auto packed = ASSERT_RESULT(packer.Complete());
+    ASSERT_EQ(static_cast<ValueEntryType>(packed.consume_byte()), ValueEntryType::kPackedRow);
+    ASSERT_EQ(ASSERT_RESULT(util::FastDecodeUnsignedVarInt(&packed)), kVersion);
+
+    auto key = narrow_cast<int32_t>(i);
+    auto encoded_doc_key = DocKey(
+        0, {KeyEntryValue::Int32(key)}, {KeyEntryValue::Int32(-key)}).Encode();
+    ASSERT_TRUE(ASSERT_RESULT(batch.AddRow(encoded_doc_key.AsSlice(), schema_packing, packed)));
+    rows.push_back(std::move(values));
+  }
+
+  ASSERT_EQ(batch.num_rows(), kNumRows);
+  for (size_t i = 0; i != kNumRows; ++i) {
+    QLTableRow table_row;
+    ASSERT_OK(batch.ToQLTableRow(i, &table_row));
+    auto key = narrow_cast<int32_t>(i);
+    ASSERT_EQ(table_row.GetValue(schema.column_id(0))->int32_value(), key);
+    ASSERT_EQ(table_row.GetValue(schema.column_id(1))->int32_value(), -key);
+    const auto& values = rows[i];
+    for (size_t j = 0; j != values.size(); ++j) {
+      ASSERT_EQ(batch.IsNull(j, i), IsNull(values[j]));
+      auto value = table_row.GetValue(schema.column_id(schema.num_key_columns() + j));
+      ASSERT_TRUE(value);
+      if (IsNull(values[j])) {
+        ASSERT_TRUE(IsNull(*value));
+      } else {
+        ASSERT_EQ(*value, values[j]);
+      }
+    }
+  }
+
+  batch.Clear();
+  ASSERT_EQ(batch.num_rows(), 0U);
+}
+
 } // namespace docdb
 } // namespace yb
@@ -13,7 +13,9 @@
 
 #include "yb/docdb/pgsql_operation.h"
 
+#include <algorithm>
 #include <limits>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -26,6 +28,7 @@
 
 #include "yb/docdb/doc_path.h"
 #include "yb/docdb/doc_pg_expr.h"
+#include "yb/docdb/doc_pg_vectorized_expr.h"
 #include "yb/docdb/doc_pgsql_scanspec.h"
 #include "yb/docdb/doc_read_context.h"
 #include "yb/docdb/doc_rowwise_iterator.h"
@@ -35,6 +38,7 @@
 #include "yb/docdb/docdb_pgapi.h"
 #include "yb/docdb/docdb_rocksdb_util.h"
 #include "yb/docdb/intent_aware_iterator.h"
+#include "yb/docdb/packed_column_batch.h"
 #include "yb/docdb/packed_row.h"
 #include "yb/docdb/primitive_value_util.h"
 #include "yb/docdb/ql_storage_interface.h"
@@ -81,6 +85,21 @@ DEFINE_uint64(
     ysql_packed_row_size_limit, 0,
     "Packed row size limit for YSQL in bytes. 0 to make this equal to SSTable block size.");
 
+DEFINE_uint64(ysql_packed_row_scan_batch_size, 1024,
+              "Max number of packed rows decoded at once in columnar form by YSQL scans. "
+              "0 to read each row individually.");
+TAG_FLAG(ysql_packed_row_scan_batch_size, advanced);
+
+DEFINE_bool(ysql_enable_vectorized_expr_eval, true,
+            "Whether pushed down where clauses and aggregates of YSQL scans should be evaluated "
+            "over batches of packed rows, when all expressions of the request are supported.");
+TAG_FLAG(ysql_enable_vectorized_expr_eval, advanced);
+
+DEFINE_bool(ysql_use_shared_iterator_for_ybctid_batch, true,
+            "Whether rows requested by a batch of ybctids should be read in ybctid order using a "
+            "single iterator, instead of creating and seeking a new iterator for every ybctid.");
+TAG_FLAG(ysql_use_shared_iterator_for_ybctid_batch, advanced);
+
 DEFINE_test_flag(bool, ysql_suppress_ybctid_corruption_details, false,
                  "Whether to show less details on ybctid corruption error status message.  Useful "
                  "during tests that require consistent output.");
@@ -1204,10 +1223,74 @@ Result<size_t> PgsqlReadOperation::ExecuteScalar(const YQLStorageIf& ql_storage,
   CoarseTimePoint stop_scan = deadline - FLAGS_ysql_scan_deadline_margin_ms * 1ms;
 
   // Fetching data.
-  int match_count = 0;
+  size_t match_count = 0;
   QLTableRow row;
-  while (fetched_rows < row_count_limit && VERIFY_RESULT(iter->HasNext()) &&
-         !scan_time_exceeded) {
+  // Match the row with the where condition before adding to the row block.
+  auto process_row = [&]() -> Status {
+    bool is_match = true;
+    RETURN_NOT_OK(doc_expr_exec.Exec(row, nullptr, &is_match));
+    if (is_match) {
+      match_count++;
+      if (request_.is_aggregate()) {
+        RETURN_NOT_OK(EvalAggregate(row));
+      } else {
+        RETURN_NOT_OK(PopulateResultSet(row, result_buffer));
+        ++fetched_rows;
+      }
+    } else {
+      VLOG(1) << "Row filtered out by the condition";
+    }
+    return Status::OK();
+  };
+
+  // Rows that are stored as packed rows are decoded by batches, bypassing per row document
+  // construction in the iterator.
+  const size_t packed_batch_size =
+      request_.has_index_request() ? 0 : FLAGS_ysql_packed_row_scan_batch_size;
+  PackedColumnBatch packed_batch;
+  // When all expressions of the request are supported, batches are filtered and aggregated in
+  // columnar form, and only selected rows of non aggregate requests are materialized.
+  DocPgVectorizedExecutor vectorized_exec;
+  const bool vectorized = packed_batch_size && FLAGS_ysql_enable_vectorized_expr_eval &&
+                          vectorized_exec.Prepare(request_, doc_projection);
+  while (fetched_rows < row_count_limit && !scan_time_exceeded) {
+    if (packed_batch_size) {
+      packed_batch.Clear();
+      auto num_rows = VERIFY_RESULT(iter->NextPackedRows(
+          std::min(packed_batch_size, row_count_limit - fetched_rows), &packed_batch));
+      if (num_rows) {
+        if (vectorized && VERIFY_RESULT(vectorized_exec.Filter(packed_batch))) {
+          match_count += vectorized_exec.num_selected();
+          if (request_.is_aggregate()) {
+            RETURN_NOT_OK(vectorized_exec.Aggregate(&aggr_result_));
+          } else {
+            for (size_t i = 0; i != num_rows; ++i) {
+              if (vectorized_exec.IsSelected(i)) {
+                row.Clear();
+                RETURN_NOT_OK(packed_batch.ToQLTableRow(i, &row));
+                packed_row_tuple_id_ = packed_batch.tuple_id(i);
+                RETURN_NOT_OK(PopulateResultSet(row, result_buffer));
+                ++fetched_rows;
+              }
+            }
+          }
+        } else {
+          for (size_t i = 0; i != num_rows; ++i) {
+            row.Clear();
+            RETURN_NOT_OK(packed_batch.ToQLTableRow(i, &row));
+            packed_row_tuple_id_ = packed_batch.tuple_id(i);
+            RETURN_NOT_OK(process_row());
+          }
+        }
+        packed_row_tuple_id_ = Slice();
+        scan_time_exceeded = CoarseMonoClock::now() >= stop_scan;
+        continue;
+      }
+    }
+
+    if (!VERIFY_RESULT(iter->HasNext())) {
+      break;
+    }
     bool is_match = true;
     row.Clear();
 
@@ -1248,19 +1331,7 @@ Result<size_t> PgsqlReadOperation::ExecuteScalar(const YQLStorageIf& ql_storage,
       RETURN_NOT_OK(iter->NextRow(doc_projection, &row));
     }
 
-    // Match the row with the where condition before adding to the row block.
-    RETURN_NOT_OK(doc_expr_exec.Exec(row, nullptr, &is_match));
-    if (is_match) {
-      match_count++;
-      if (request_.is_aggregate()) {
-        RETURN_NOT_OK(EvalAggregate(row));
-      } else {
-        RETURN_NOT_OK(PopulateResultSet(row, result_buffer));
-        ++fetched_rows;
-      }
-    } else {
-      VLOG(1) << "Row filtered out by the condition";
-    }
+    RETURN_NOT_OK(process_row());
 
     // Check if we are running out of time
     scan_time_exceeded = CoarseMonoClock::now() >= stop_scan;
@@ -1311,26 +1382,83 @@ Result<size_t> PgsqlReadOperation::ExecuteBatchYbctid(const YQLStorageIf& ql_sto
     VLOG(1) << "Added where expression to the executor";
   }
 
-  for (const PgsqlBatchArgumentPB& batch_argument : request_.batch_arguments()) {
+  const auto& batch_arguments = request_.batch_arguments();
+  std::vector<int> batch_argument_indexes(batch_arguments.size());
+  std::iota(batch_argument_indexes.begin(), batch_argument_indexes.end(), 0);
+  const bool use_shared_iterator = FLAGS_ysql_use_shared_iterator_for_ybctid_batch;
+  // With shared iterator rows are read in sorted order, but pggate expects them in the order of
+  // the request. So they are serialized to row_buffer first, and row_ranges keeps the location of
+  // the row of each matched batch argument in it.
+  faststring row_buffer;
+  std::vector<boost::optional<std::pair<size_t, size_t>>> row_ranges;
+  if (use_shared_iterator) {
+    std::vector<Slice> ybctids;
+    ybctids.reserve(batch_arguments.size());
+    for (const auto& batch_argument : batch_arguments) {
+      SCHECK(batch_argument.has_ybctid(),
+             InternalError,
+             "ybctid arguments can be batched only");
+      ybctids.emplace_back(batch_argument.ybctid().value().binary_value());
+    }
+    // Visit ybctids in sorted order, so the iterator moves forward only.
+    std::sort(
+        batch_argument_indexes.begin(), batch_argument_indexes.end(),
+        [&ybctids](int lhs, int rhs) {
+          return ybctids[lhs].compare(ybctids[rhs]) < 0;
+        });
+    RETURN_NOT_OK(ql_storage.CreateIterator(
+        projection, doc_read_context, txn_op_context_, deadline, read_time, ybctids,
+        &table_iter_));
+    row_ranges.resize(batch_arguments.size());
+  }
+
+  for (int index : batch_argument_indexes) {
+    const PgsqlBatchArgumentPB& batch_argument = batch_arguments[index];
     SCHECK(batch_argument.has_ybctid(),
            InternalError,
            "ybctid arguments can be batched only");
     // Get the row.
-    RETURN_NOT_OK(ql_storage.GetIterator(
-        request_.stmt_id(), projection, doc_read_context, txn_op_context_,
-        deadline, read_time, batch_argument.ybctid().value(), &table_iter_));
+    row.Clear();
+    if (use_shared_iterator) {
+      if (!VERIFY_RESULT(table_iter_->FetchTuple(
+              batch_argument.ybctid().value().binary_value(), &row))) {
+        continue;
+      }
+    } else {
+      RETURN_NOT_OK(ql_storage.GetIterator(
+          request_.stmt_id(), projection, doc_read_context, txn_op_context_,
+          deadline, read_time, batch_argument.ybctid().value(), &table_iter_));
 
-    if (VERIFY_RESULT(table_iter_->HasNext())) {
-      row.Clear();
+      if (!VERIFY_RESULT(table_iter_->HasNext())) {
+        continue;
+      }
       RETURN_NOT_OK(table_iter_->NextRow(projection, &row));
-      bool is_match = true;
-      RETURN_NOT_OK(expr_exec.Exec(row, nullptr, &is_match));
-      if (is_match) {
-        // Populate result set.
+    }
+
+    bool is_match = true;
+    RETURN_NOT_OK(expr_exec.Exec(row, nullptr, &is_match));
+    if (is_match) {
+      // Populate result set.
+      if (use_shared_iterator) {
+        const auto begin = row_buffer.size();
+        RETURN_NOT_OK(PopulateResultSet(row, &row_buffer));
+        row_ranges[index] = std::make_pair(begin, row_buffer.size());
+      } else {
         RETURN_NOT_OK(PopulateResultSet(row, result_buffer));
         response_.add_batch_orders(batch_argument.order());
-        row_count++;
       }
+      row_count++;
+    }
+  }
+
+  if (use_shared_iterator) {
+    for (int index = 0; index != batch_arguments.size(); ++index) {
+      if (!row_ranges[index]) {
+        continue;
+      }
+      const auto& [begin, end] = *row_ranges[index];
+      result_buffer->append(row_buffer.data() + begin, end - begin);
+      response_.add_batch_orders(batch_arguments[index].order());
     }
   }
 
@@ -1403,7 +1531,8 @@ Status PgsqlReadOperation::GetTupleId(QLValuePB *result) const {
   // TODO(neil) Check if we need to append a table_id and other info to TupleID. For example, we
   // might need info to make sure the TupleId by itself is a valid reference to a specific row of
   // a valid table.
-  const Slice tuple_id = VERIFY_RESULT(table_iter_->GetTupleId());
+  const Slice tuple_id = !packed_row_tuple_id_.empty()
+      ? packed_row_tuple_id_ : VERIFY_RESULT(table_iter_->GetTupleId());
   result->set_binary_value(tuple_id.data(), tuple_id.size());
   return Status::OK();
 }
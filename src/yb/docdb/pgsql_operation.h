@@ -220,6 +220,10 @@ class PgsqlReadOperation : public DocExprExecutor {
   PgsqlResponsePB response_;
   YQLRowwiseIteratorIf::UniPtr table_iter_;
   YQLRowwiseIteratorIf::UniPtr index_iter_;
+  // Tuple id of the row materialized from a packed column batch, the table iterator is already
+  // positioned after the whole batch, so it could not provide it. Empty when rows are read one by
+  // one.
+  Slice packed_row_tuple_id_;
 };
 
 }  // namespace docdb
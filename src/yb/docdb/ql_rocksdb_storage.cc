@@ -108,9 +108,11 @@ Status QLRocksDBStorage::CreateIterator(
     const TransactionOperationContext& txn_op_context,
     CoarseTimePoint deadline,
     const ReadHybridTime& read_time,
+    const std::vector<Slice>& ybctids,
     YQLRowwiseIteratorIf::UniPtr* iter) const {
   auto doc_iter = std::make_unique<DocRowwiseIterator>(
       projection, doc_read_context, txn_op_context, doc_db_, deadline, read_time);
+  RETURN_NOT_OK(doc_iter->InitForTupleLookups(TableType::PGSQL_TABLE_TYPE, ybctids));
   *iter = std::move(doc_iter);
   return Status::OK();
 }
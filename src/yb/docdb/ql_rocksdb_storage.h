@@ -57,6 +57,7 @@ class QLRocksDBStorage : public YQLStorageIf {
       const TransactionOperationContext& txn_op_context,
       CoarseTimePoint deadline,
       const ReadHybridTime& read_time,
+      const std::vector<Slice>& ybctids,
       YQLRowwiseIteratorIf::UniPtr* iter) const override;
 
   Status InitIterator(YQLRowwiseIteratorIf* doc_iter,
@@ -30,6 +30,14 @@ Result<bool> YQLRowwiseIteratorIf::SeekTuple(const Slice& tuple_id) {
   return STATUS(NotSupported, "This iterator cannot seek by tuple id");
 }
 
+Result<bool> YQLRowwiseIteratorIf::FetchTuple(const Slice& tuple_id, QLTableRow* table_row) {
+  return STATUS(NotSupported, "This iterator cannot fetch by tuple id");
+}
+
+Result<size_t> YQLRowwiseIteratorIf::NextPackedRows(size_t max_rows, PackedColumnBatch* batch) {
+  return 0;
+}
+
 Status YQLRowwiseIteratorIf::NextRow(const Schema& projection, QLTableRow* table_row) {
   return DoNextRow(projection, table_row);
 }
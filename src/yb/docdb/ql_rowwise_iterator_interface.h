@@ -70,6 +70,14 @@ class YQLRowwiseIteratorIf {
   // Seeks to the given tuple by its id. See DocRowwiseIterator for details.
   virtual Result<bool> SeekTuple(const Slice& tuple_id);
 
+  // Reads the given tuple by its id into table_row. See DocRowwiseIterator for details.
+  virtual Result<bool> FetchTuple(const Slice& tuple_id, QLTableRow* table_row);
+
+  // Reads up to max_rows next rows into batch in columnar form. Returns number of added rows,
+  // 0 when iterator does not support columnar reads or next row could not be added to batch.
+  // In the latter case the row should be read using NextRow.
+  virtual Result<size_t> NextPackedRows(size_t max_rows, PackedColumnBatch* batch);
+
   //------------------------------------------------------------------------------------------------
   // Common API methods.
   //------------------------------------------------------------------------------------------------
@@ -60,21 +60,16 @@ class YQLStorageIf {
   //------------------------------------------------------------------------------------------------
   // PGSQL Support.
 
-  // TODO(neil) Need to replace GetIterator(ybctid) with CreateIterator and InitIterator.
-  // I leave Create and Init code here, so I don't have to rewrite them in the near future.
-  //
-  // - Replacement is not done yet because reusing iterator is not yet allowed. When reusing it,
-  //   doc_key.get_next() asserts that an infinite loop is detected even though we're calling
-  //   get_next() for a different hash codes.
-  // - Create and init can be used to create iterator once and initialize with different ybctid for
-  //   different execution.
-  // - Doc_key needs to be changed to allow reusing iterator.
+  // Create iterator for reading rows by ybctid with YQLRowwiseIteratorIf::FetchTuple. A single
+  // iterator is used to read a whole batch of ybctids, which should be fetched in sorted order.
+  // Only ybctids from the batch could be fetched, since bloom filter is checked against them.
   virtual Status CreateIterator(
       const Schema& projection,
       std::reference_wrapper<const DocReadContext> doc_read_context,
       const TransactionOperationContext& txn_op_context,
       CoarseTimePoint deadline,
       const ReadHybridTime& read_time,
+      const std::vector<Slice>& ybctids,
       std::unique_ptr<YQLRowwiseIteratorIf>* iter) const = 0;
 
   virtual Status InitIterator(YQLRowwiseIteratorIf* doc_iter,
@@ -13,6 +13,8 @@
 
 #include "yb/docdb/rocksdb_writer.h"
 
+#include <algorithm>
+
 #include "yb/common/row_mark.h"
 
 #include "yb/docdb/conflict_resolution.h"
@@ -25,6 +27,8 @@
 
 #include "yb/gutil/walltime.h"
 
+#include "yb/rocksdb/sst_file_writer.h"
+
 #include "yb/util/bitmap.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/pb_util.h"
@@ -566,6 +570,39 @@ void ApplyIntentsContext::Complete(rocksdb::DirectWriteHandler* handler) {
   }
 }
 
+ApplyIntentsCollector::ApplyIntentsCollector(rocksdb::WriteBatch* apply_state_batch)
+    : apply_state_batch_(*apply_state_batch) {
+}
+
+void ApplyIntentsCollector::Put(const SliceParts& key, const SliceParts& value) {
+  if (key.num_parts > 0 && !key.parts[0].empty() &&
+      key.parts[0][0] == KeyEntryTypeAsChar::kTransactionApplyState) {
+    apply_state_batch_.Put(key, value);
+    return;
+  }
+  records_.emplace_back(std::string(key.SumSizes(), 0), std::string(value.SumSizes(), 0));
+  auto& record = records_.back();
+  key.CopyAllTo(&record.first[0]);
+  value.CopyAllTo(&record.second[0]);
+}
+
+void ApplyIntentsCollector::SingleDelete(const Slice& key) {
+  // ApplyIntentsContext does not delete regular records.
+  LOG(DFATAL) << "Unexpected single delete of " << key.ToDebugHexString();
+}
+
+Status ApplyIntentsCollector::WriteTo(rocksdb::SstFileWriter* writer) {
+  // Reverse index is ordered by intent key suffix, so records are not sorted by key.
+  // All keys are unique, since each of them contains write id.
+  std::sort(records_.begin(), records_.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+  for (const auto& record : records_) {
+    RETURN_NOT_OK(writer->Add(record.first, record.second));
+  }
+  return Status::OK();
+}
+
 RemoveIntentsContext::RemoveIntentsContext(const TransactionId& transaction_id)
     : IntentsWriterContext(transaction_id) {
 }
@@ -23,6 +23,7 @@
 #include "yb/docdb/docdb_fwd.h"
 #include "yb/docdb/intent.h"
 
+#include "yb/rocksdb/rocksdb_fwd.h"
 #include "yb/rocksdb/write_batch.h"
 
 namespace yb {
@@ -210,6 +211,35 @@ class ApplyIntentsContext : public IntentsWriterContext {
   BoundedRocksDbIterator intent_iter_;
 };
 
+// DirectWriteHandler that collects regular records produced by ApplyIntentsContext, so they could
+// be written to an external SST file instead of the memtable.
+// Apply state records are added to the provided write batch instead, because they should be
+// persisted together with the frontier of the apply operation. Otherwise the apply state could
+// become durable before the previous portions of the transaction, that were written to memtable.
+class ApplyIntentsCollector : public rocksdb::DirectWriteHandler {
+ public:
+  explicit ApplyIntentsCollector(rocksdb::WriteBatch* apply_state_batch);
+
+  void Put(const SliceParts& key, const SliceParts& value) override;
+
+  void SingleDelete(const Slice& key) override;
+
+  bool empty() const {
+    return records_.empty();
+  }
+
+  size_t num_records() const {
+    return records_.size();
+  }
+
+  // Adds collected records to the writer in key order.
+  Status WriteTo(rocksdb::SstFileWriter* writer);
+
+ private:
+  rocksdb::WriteBatch& apply_state_batch_;
+  std::vector<std::pair<std::string, std::string>> records_;
+};
+
 class RemoveIntentsContext : public IntentsWriterContext {
  public:
   explicit RemoveIntentsContext(const TransactionId& transaction_id);
@@ -121,6 +121,11 @@ bool SchemaPacking::SkippedColumn(ColumnId column_id) const {
   return it != column_to_idx_.end() && it->second == kSkippedColumnIdx;
 }
 
+int64_t SchemaPacking::GetIndex(ColumnId column_id) const {
+  auto it = column_to_idx_.find(column_id);
+  return it != column_to_idx_.end() ? it->second : kSkippedColumnIdx;
+}
+
 Slice SchemaPacking::GetValue(size_t idx, const Slice& packed) const {
   const auto& column_data = columns_[idx];
   size_t offset = column_data.num_varlen_columns_before
@@ -78,6 +78,8 @@ class SchemaPacking {
   }
 
   bool SkippedColumn(ColumnId column_id) const;
+  // Returns index of the specified column in packing, or -1 if column is not packed.
+  int64_t GetIndex(ColumnId column_id) const;
   Slice GetValue(size_t idx, const Slice& packed) const;
   std::optional<Slice> GetValue(ColumnId column_id, const Slice& packed) const;
   void ToPB(SchemaPackingPB* out) const;
@@ -186,6 +186,90 @@ TEST_F(SharedLockManagerTest, LockConflicts) {
   tp.Shutdown();
 }
 
+// Threads lock and unlock batches that share the weak intents on the same key, so the entry of
+// this key is mostly reserved and released by the fast paths, without exclusive shard lock.
+// Checks that shared entry stays consistent: all batches are locked, and after all of them are
+// released the shared key could be locked in conflicting mode without waiting.
+TEST_F(SharedLockManagerTest, HotSharedKey) {
+  constexpr int kThreads = 16;
+  constexpr int kBatchesPerThread = 20000;
+  constexpr int kKeysPerThread = 64;
+  const RefCntPrefix kSharedKey("shared"s);
+
+  std::vector<std::thread> threads;
+  std::atomic<int> failed_batches{0};
+  for (int thread_idx = 0; thread_idx != kThreads; ++thread_idx) {
+    threads.emplace_back([this, &failed_batches, &kSharedKey, thread_idx] {
+      for (int i = 0; i != kBatchesPerThread; ++i) {
+        RefCntPrefix key(Format("key_$0_$1", thread_idx, i % kKeysPerThread));
+        LockBatch lb(&lm_, {
+            {kSharedKey, IntentTypeSet({IntentType::kWeakRead, IntentType::kWeakWrite})},
+            {key, IntentTypeSet({IntentType::kStrongRead, IntentType::kStrongWrite})}},
+            CoarseMonoClock::now() + 10s);
+        if (!lb.status().ok()) {
+          failed_batches.fetch_add(1, std::memory_order_acq_rel);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(failed_batches.load(std::memory_order_acquire), 0);
+  LockBatch lb(&lm_, {
+      {kSharedKey, IntentTypeSet({IntentType::kStrongRead, IntentType::kStrongWrite})}},
+      CoarseMonoClock::now());
+  ASSERT_OK(lb.status());
+}
+
+// Measures lock/unlock throughput of write-like batches for various number of threads.
+// Each batch takes weak intents on the key shared by all threads, as it happens for the parent
+// document of a hot tablet, and strong intents on a key that is private to the thread.
+// Runs for several seconds and asserts nothing, so it is disabled by default.
+TEST_F(SharedLockManagerTest, DISABLED_BenchmarkLockThroughput) {
+  constexpr int kKeysPerThread = 1024;
+  const auto kDuration = 1s;
+  const RefCntPrefix kSharedKey("shared"s);
+
+  for (int num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    std::atomic<bool> stop_requested{false};
+    std::atomic<size_t> total_batches{0};
+    std::vector<std::thread> threads;
+    for (int thread_idx = 0; thread_idx != num_threads; ++thread_idx) {
+      threads.emplace_back([this, &stop_requested, &total_batches, &kSharedKey, thread_idx] {
+        std::vector<RefCntPrefix> keys;
+        for (int i = 0; i != kKeysPerThread; ++i) {
+          keys.emplace_back(Format("key_$0_$1", thread_idx, i));
+        }
+        size_t batches = 0;
+        while (!stop_requested.load(std::memory_order_acquire)) {
+          LockBatch lb(&lm_, {
+              {kSharedKey, IntentTypeSet({IntentType::kWeakRead, IntentType::kWeakWrite})},
+              {keys[batches % kKeysPerThread],
+               IntentTypeSet({IntentType::kStrongRead, IntentType::kStrongWrite})}},
+              CoarseTimePoint::max());
+          CHECK_OK(lb.status());
+          ++batches;
+        }
+        total_batches.fetch_add(batches, std::memory_order_acq_rel);
+      });
+    }
+
+    std::this_thread::sleep_for(kDuration);
+    stop_requested.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    auto batches = total_batches.load(std::memory_order_acquire);
+    LOG(INFO) << Format(
+        "Threads: $0, lock batches: $1, batches/sec: $2",
+        num_threads, batches, batches * 1000 / ToMilliseconds(kDuration));
+  }
+}
+
 TEST_F(SharedLockManagerTest, DumpKeys) {
   FLAGS_dump_lock_keys = true;
 
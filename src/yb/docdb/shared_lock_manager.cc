@@ -14,16 +14,21 @@
 #include "yb/docdb/shared_lock_manager.h"
 
 #include <array>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
+#include <boost/container/small_vector.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <glog/logging.h>
 
 #include "yb/docdb/lock_batch.h"
 
+#include "yb/gutil/port.h"
+
 #include "yb/util/enums.h"
 #include "yb/util/ref_cnt_buffer.h"
 #include "yb/util/scope_exit.h"
@@ -49,6 +54,14 @@ const size_t kIntentTypeBits = 16;
 // is "least significant", as in furthest to the right.
 const LockState kSingleIntentMask = (static_cast<LockState>(1) << kIntentTypeBits) - 1;
 
+// Lock table is partitioned into 2^kLockTableShardBits shards by key hash, so concurrent batches
+// that lock different keys don't contend on the same mutex. Batches that share a key, e.g. weak
+// intents on a hot parent document, find the existing entry under shared lock of its shard and
+// release it without shard lock, see Reserve and Cleanup.
+constexpr size_t kLockTableShardBits = 4;
+constexpr size_t kLockTableShards = 1ULL << kLockTableShardBits;
+static_assert(kLockTableShards <= 64, "Shard set of a batch should fit into uint64_t");
+
 bool IntentTypesConflict(IntentType lhs, IntentType rhs) {
   auto lhs_value = to_underlying(lhs);
   auto rhs_value = to_underlying(rhs);
@@ -135,9 +148,15 @@ struct LockedBatchEntry {
 
   std::condition_variable cond_var;
 
-  // Refcounting for garbage collection. Can only be used while the global mutex is locked.
-  // Global mutex resides in lock manager and covers this field for all LockBatchEntries.
-  size_t ref_count = 0;
+  // Refcounting for garbage collection. Entry is present in the shard map iff ref_count is not 0.
+  // It could be incremented while the mutex of the owning shard is locked in shared mode, and
+  // decremented to a non zero value without locking it. Decrement to zero, with removal of the
+  // entry from the map, happens only while the shard mutex is locked in exclusive mode.
+  std::atomic<size_t> ref_count{0};
+
+  // Index of the lock table shard that owns this entry. Does not change after creation, since
+  // entries are reused only within the same shard.
+  size_t shard = 0;
 
   // Number of holders for each type
   std::atomic<LockState> num_holding{0};
@@ -151,7 +170,8 @@ struct LockedBatchEntry {
   std::string ToString() const {
     std::lock_guard<std::mutex> lock(mutex);
     return Format("{ ref_count: $0 num_holding: $1 num_waiters: $2 }",
-                  ref_count, num_holding.load(std::memory_order_acquire),
+                  ref_count.load(std::memory_order_acquire),
+                  num_holding.load(std::memory_order_acquire),
                   num_waiters.load(std::memory_order_acquire));
   }
 };
@@ -162,28 +182,42 @@ class SharedLockManager::Impl {
   void Unlock(const LockBatchEntries& key_to_intent_type);
 
   ~Impl() {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    LOG_IF(DFATAL, !locks_.empty()) << "Locks not empty in dtor: " << yb::ToString(locks_);
+    for (auto& shard : shards_) {
+      std::lock_guard<std::shared_mutex> lock(shard.mutex);
+      LOG_IF(DFATAL, !shard.locks.empty())
+          << "Locks not empty in dtor: " << yb::ToString(shard.locks);
+    }
   }
 
  private:
   typedef std::unordered_map<RefCntPrefix, LockedBatchEntry*, RefCntPrefixHash> LockEntryMap;
 
-  // Make sure the entries exist in the locks_ map and return pointers so we can access
-  // them without holding the global lock. Returns a vector with pointers in the same order
-  // as the keys in the batch.
+  struct Shard {
+    // The shard mutex should be taken only for very short duration, with no blocking wait.
+    // Shared mode is enough to find existing entry and increment its ref_count.
+    std::shared_mutex mutex;
+
+    LockEntryMap locks GUARDED_BY(mutex);
+    // Cache of lock entries, to avoid allocation/deallocation of heavy LockedBatchEntry.
+    std::vector<std::unique_ptr<LockedBatchEntry>> lock_entries GUARDED_BY(mutex);
+    std::vector<LockedBatchEntry*> free_lock_entries GUARDED_BY(mutex);
+  } CACHELINE_ALIGNED;
+
+  static size_t ShardIndex(const RefCntPrefix& key) {
+    // High bits of FNV hash are better mixed than low bits, also low bits are used by the map.
+    return RefCntPrefixHash()(key) >> (sizeof(size_t) * 8 - kLockTableShardBits);
+  }
+
+  // Make sure the entries exist in the shard maps and fill pointers to them into the batch, so we
+  // can access them without holding shard locks. Each shard touched by the batch is locked once in
+  // shared mode, and once more in exclusive mode only when some of its keys are missing.
   void Reserve(LockBatchEntries* batch);
 
-  // Update refcounts and maybe collect garbage.
+  // Update refcounts and maybe collect garbage. Shard is locked only when some of its entries
+  // could become unused.
   void Cleanup(const LockBatchEntries& key_to_intent_type);
 
-  // The global mutex should be taken only for very short duration, with no blocking wait.
-  std::mutex global_mutex_;
-
-  LockEntryMap locks_ GUARDED_BY(global_mutex_);
-  // Cache of lock entries, to avoid allocation/deallocation of heavy LockedBatchEntry.
-  std::vector<std::unique_ptr<LockedBatchEntry>> lock_entries_ GUARDED_BY(global_mutex_);
-  std::vector<LockedBatchEntry*> free_lock_entries_ GUARDED_BY(global_mutex_);
+  std::array<Shard, kLockTableShards> shards_;
 };
 
 std::string SharedLockManager::ToString(const LockState& state) {
@@ -303,20 +337,62 @@ bool SharedLockManager::Impl::Lock(LockBatchEntries* key_to_intent_type, CoarseT
 }
 
 void SharedLockManager::Impl::Reserve(LockBatchEntries* key_to_intent_type) {
-  std::lock_guard<std::mutex> lock(global_mutex_);
-  for (auto& key_and_intent_type : *key_to_intent_type) {
-    auto& value = locks_[key_and_intent_type.key];
-    if (!value) {
-      if (!free_lock_entries_.empty()) {
-        value = free_lock_entries_.back();
-        free_lock_entries_.pop_back();
-      } else {
-        lock_entries_.emplace_back(std::make_unique<LockedBatchEntry>());
-        value = lock_entries_.back().get();
+  boost::container::small_vector<size_t, 16> shard_indexes;
+  shard_indexes.reserve(key_to_intent_type->size());
+  uint64_t shards_mask = 0;
+  for (const auto& key_and_intent_type : *key_to_intent_type) {
+    auto shard_idx = ShardIndex(key_and_intent_type.key);
+    shard_indexes.push_back(shard_idx);
+    shards_mask |= 1ULL << shard_idx;
+  }
+
+  for (size_t shard_idx = 0; shards_mask; ++shard_idx, shards_mask >>= 1) {
+    if (!(shards_mask & 1)) {
+      continue;
+    }
+    auto& shard = shards_[shard_idx];
+    bool has_missing = false;
+    {
+      // Existing entry could not be removed while shared lock is held, since its ref_count is
+      // decremented to zero only in exclusive mode.
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      for (size_t i = 0; i != shard_indexes.size(); ++i) {
+        if (shard_indexes[i] != shard_idx) {
+          continue;
+        }
+        auto& key_and_intent_type = (*key_to_intent_type)[i];
+        auto it = shard.locks.find(key_and_intent_type.key);
+        if (it == shard.locks.end()) {
+          has_missing = true;
+          continue;
+        }
+        it->second->ref_count.fetch_add(1, std::memory_order_acq_rel);
+        key_and_intent_type.locked = it->second;
       }
     }
-    value->ref_count++;
-    key_and_intent_type.locked = value;
+    if (!has_missing) {
+      continue;
+    }
+    std::lock_guard<std::shared_mutex> lock(shard.mutex);
+    for (size_t i = 0; i != shard_indexes.size(); ++i) {
+      auto& key_and_intent_type = (*key_to_intent_type)[i];
+      if (shard_indexes[i] != shard_idx || key_and_intent_type.locked) {
+        continue;
+      }
+      auto& value = shard.locks[key_and_intent_type.key];
+      if (!value) {
+        if (!shard.free_lock_entries.empty()) {
+          value = shard.free_lock_entries.back();
+          shard.free_lock_entries.pop_back();
+        } else {
+          shard.lock_entries.emplace_back(std::make_unique<LockedBatchEntry>());
+          value = shard.lock_entries.back().get();
+          value->shard = shard_idx;
+        }
+      }
+      value->ref_count.fetch_add(1, std::memory_order_acq_rel);
+      key_and_intent_type.locked = value;
+    }
   }
 }
 
@@ -331,11 +407,39 @@ void SharedLockManager::Impl::Unlock(const LockBatchEntries& key_to_intent_type)
 }
 
 void SharedLockManager::Impl::Cleanup(const LockBatchEntries& key_to_intent_type) {
-  std::lock_guard<std::mutex> lock(global_mutex_);
-  for (const auto& item : key_to_intent_type) {
-    if (--(item.locked->ref_count) == 0) {
-      locks_.erase(item.key);
-      free_lock_entries_.push_back(item.locked);
+  // Entries that could become unused by this batch.
+  boost::container::small_vector<bool, 16> last_ref(key_to_intent_type.size());
+  uint64_t shards_mask = 0;
+  for (size_t i = 0; i != key_to_intent_type.size(); ++i) {
+    auto& ref_count = key_to_intent_type[i].locked->ref_count;
+    auto old_value = ref_count.load(std::memory_order_acquire);
+    while (old_value > 1) {
+      if (ref_count.compare_exchange_weak(old_value, old_value - 1, std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+    if (old_value <= 1) {
+      last_ref[i] = true;
+      shards_mask |= 1ULL << key_to_intent_type[i].locked->shard;
+    }
+  }
+
+  for (size_t shard_idx = 0; shards_mask; ++shard_idx, shards_mask >>= 1) {
+    if (!(shards_mask & 1)) {
+      continue;
+    }
+    auto& shard = shards_[shard_idx];
+    std::lock_guard<std::shared_mutex> lock(shard.mutex);
+    for (size_t i = 0; i != key_to_intent_type.size(); ++i) {
+      const auto& item = key_to_intent_type[i];
+      if (!last_ref[i] || item.locked->shard != shard_idx) {
+        continue;
+      }
+      // Other batches could reserve the entry after we checked its ref_count.
+      if (item.locked->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        shard.locks.erase(item.key);
+        shard.free_lock_entries.push_back(item.locked);
+      }
     }
   }
 }
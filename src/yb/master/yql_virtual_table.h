@@ -78,6 +78,7 @@ class YQLVirtualTable : public docdb::YQLStorageIf {
       const TransactionOperationContext& txn_op_context,
       CoarseTimePoint deadline,
       const ReadHybridTime& read_time,
+      const std::vector<Slice>& ybctids,
       std::unique_ptr<docdb::YQLRowwiseIteratorIf>* iter) const override {
     LOG(FATAL) << "Postgresql virtual tables are not yet implemented";
     return Status::OK();
@@ -68,6 +68,12 @@ extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits);
 extern shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                      bool strict_capacity_limit);
 
+// Create a new CLOCK cache with frequency based admission. Hits only take shard lock in shared
+// mode, and entries that are accessed less frequently than eviction candidates are not admitted,
+// so large scans do not flush frequently used entries. Sharding is the same as in NewLRUCache.
+extern shared_ptr<Cache> NewClockCache(size_t capacity, int num_shard_bits,
+                                       bool strict_capacity_limit = false);
+
 using QueryId = int64_t;
 // Query ids to represent values for the default query id.
 constexpr QueryId kDefaultQueryId = 0;
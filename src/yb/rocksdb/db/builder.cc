@@ -144,10 +144,14 @@ Status BuildTable(const std::string& dbname,
     if (!s.ok()) {
       return s;
     }
+    // Flushed files are small and short lived, so compression dictionary is trained only during
+    // compaction.
+    CompressionOptions flush_compression_opts = compression_opts;
+    flush_compression_opts.max_dict_bytes = 0;
     std::unique_ptr<TableBuilder> builder(NewTableBuilder(
         ioptions, internal_comparator, int_tbl_prop_collector_factories,
         column_family_id, base_file_writer.get(), data_file_writer.get(), compression,
-        compression_opts));
+        flush_compression_opts));
 
     MergeHelper merge(env, internal_comparator->user_comparator(),
                       ioptions.merge_operator, nullptr, ioptions.info_log,
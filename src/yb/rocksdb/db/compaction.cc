@@ -591,7 +591,9 @@ bool Compaction::ShouldFormSubcompactions() const {
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
     return start_level_ == 0 && !IsOutputLevelEmpty();
   } else if (IsCompactionStyleUniversal()) {
-    return number_levels_ > 1 && output_level_ > 0;
+    // Inputs of single level universal compaction overlap, so subcompaction boundaries are taken
+    // from data blocks of input files, see CompactionJob::GenSingleLevelSubcompactionBoundaries.
+    return number_levels_ == 1 || output_level_ > 0;
   } else {
     return false;
   }
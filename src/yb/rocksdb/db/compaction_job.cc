@@ -32,9 +32,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -52,16 +55,19 @@
 #include "yb/rocksdb/db/memtable.h"
 #include "yb/rocksdb/db/memtable_list.h"
 #include "yb/rocksdb/db/merge_helper.h"
+#include "yb/rocksdb/db/table_cache.h"
 #include "yb/rocksdb/db/version_set.h"
 #include "yb/rocksdb/port/likely.h"
 #include "yb/rocksdb/port/port.h"
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/env.h"
+#include "yb/rocksdb/slice_transform.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/status.h"
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/table/internal_iterator.h"
 #include "yb/rocksdb/table/table_builder.h"
+#include "yb/rocksdb/table/table_reader.h"
 #include "yb/rocksdb/util/coding.h"
 #include "yb/rocksdb/util/file_reader_writer.h"
 #include "yb/rocksdb/util/log_buffer.h"
@@ -72,12 +78,16 @@
 #include "yb/rocksdb/util/stop_watch.h"
 #include "yb/rocksdb/util/sync_point.h"
 
+#include "yb/util/format.h"
 #include "yb/util/logging.h"
+#include "yb/util/priority_thread_pool.h"
 #include "yb/util/result.h"
 #include "yb/util/stats/perf_step_timer.h"
 #include "yb/util/stats/iostats_context_imp.h"
 #include "yb/util/string_util.h"
 
+DECLARE_bool(use_priority_thread_pool_for_compactions);
+
 namespace rocksdb {
 
 // Maintains state for each sub-compaction
@@ -110,6 +120,9 @@ struct CompactionJob::SubcompactionState : public CompactionFeed {
   CompactionFeed* feed = nullptr; // Owned externally.
   CompactionContextPtr context;
 
+  // Suspender of the thread pool task running this subcompaction.
+  yb::PriorityThreadPoolSuspender* suspender = nullptr;
+
   Output* current_output() {
     if (outputs.empty()) {
       // This subcompaction's outptut could be empty if compaction was aborted
@@ -329,6 +342,10 @@ struct RangeWithSize {
 // consecutive groups such that each group has a similar size.
 void CompactionJob::GenSubcompactionBoundaries() {
   auto* c = compact_->compaction;
+  if (c->number_levels() == 1) {
+    GenSingleLevelSubcompactionBoundaries();
+    return;
+  }
   auto* cfd = c->column_family_data();
   const Comparator* cfd_comparator = cfd->user_comparator();
   std::vector<Slice> bounds;
@@ -439,6 +456,212 @@ void CompactionJob::GenSubcompactionBoundaries() {
   }
 }
 
+// Files of single level universal compaction overlap, so their smallest and largest keys do not
+// split the key range well. Instead data blocks of all input files are used as a histogram of
+// key distribution, and the key range is cut into parts with similar amount of input data.
+void CompactionJob::GenSingleLevelSubcompactionBoundaries() {
+  // Number of anchors per subcompaction, more anchors give more even split.
+  constexpr uint64_t kAnchorsPerSubcompaction = 16;
+
+  auto* c = compact_->compaction;
+  auto* cfd = c->column_family_data();
+  const Comparator* user_comparator = cfd->user_comparator();
+  const uint64_t total_size = c->CalculateTotalInputSize();
+  const uint64_t subcompactions = std::min<uint64_t>(
+      db_options_.max_subcompactions,
+      total_size / std::max<uint64_t>(db_options_.min_subcompaction_input_size, 1));
+  if (subcompactions <= 1) {
+    sizes_.emplace_back(total_size);
+    return;
+  }
+
+  const uint64_t min_range_size = total_size / subcompactions / kAnchorsPerSubcompaction;
+  std::vector<KeyAnchor> anchors;
+  for (size_t level_idx = 0; level_idx < c->num_input_levels(); level_idx++) {
+    for (FileMetaData* file : *c->inputs(level_idx)) {
+      auto file_anchors = [&]() -> Result<std::vector<KeyAnchor>> {
+        auto reader = VERIFY_RESULT(cfd->table_cache()->GetTableReader(
+            env_options_, cfd->internal_comparator(), file->fd, kDefaultQueryId,
+            /* no_io= */ false, /* file_read_hist= */ nullptr, /* skip_filters= */ true));
+        return reader.table_reader->GetKeyAnchors(min_range_size);
+      }();
+      if (!file_anchors.ok()) {
+        RLOG(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+            "[%s] [JOB %d] Failed to get key anchors of file %" PRIu64 ", not splitting "
+            "compaction: %s", cfd->GetName().c_str(), job_id_, file->fd.GetNumber(),
+            file_anchors.status().ToString().c_str());
+        sizes_.emplace_back(total_size);
+        return;
+      }
+      std::move(file_anchors->begin(), file_anchors->end(), std::back_inserter(anchors));
+    }
+  }
+
+  std::sort(anchors.begin(), anchors.end(),
+      [user_comparator](const KeyAnchor& lhs, const KeyAnchor& rhs) {
+    return user_comparator->Compare(ExtractUserKey(lhs.key), ExtractUserKey(rhs.key)) < 0;
+  });
+  uint64_t anchors_size = 0;
+  for (const auto& anchor : anchors) {
+    anchors_size += anchor.range_size;
+  }
+
+  const auto* transform = db_options_.subcompaction_boundary_transform.get();
+  const double mean = anchors_size * 1.0 / subcompactions;
+  uint64_t sum = 0;
+  uint64_t last_boundary_sum = 0;
+  for (const auto& anchor : anchors) {
+    sum += anchor.range_size;
+    if (boundaries_.size() + 1 >= subcompactions || sum < mean * (boundaries_.size() + 1)) {
+      continue;
+    }
+    Slice boundary = ExtractUserKey(anchor.key);
+    if (transform) {
+      if (!transform->InDomain(boundary)) {
+        continue;
+      }
+      boundary = transform->Transform(boundary);
+    }
+    if (!boundaries_.empty() && user_comparator->Compare(boundary, boundaries_.back()) <= 0) {
+      continue;
+    }
+    boundary_keys_.push_back(boundary.ToBuffer());
+    boundaries_.emplace_back(boundary_keys_.back());
+    sizes_.emplace_back(sum - last_boundary_sum);
+    last_boundary_sum = sum;
+  }
+  sizes_.emplace_back(anchors_size - last_boundary_sum);
+}
+
+namespace {
+
+// Same as for compaction tasks, see DBImpl::CompactionTask.
+constexpr int kTopDiskSubcompactionPriority = 100;
+
+// Helper task that processes subcompactions of a compaction job running in another thread.
+class SubcompactionTask : public yb::PriorityThreadPoolTask {
+ public:
+  using RunNextFunctor = std::function<bool(yb::PriorityThreadPoolSuspender*)>;
+
+  SubcompactionTask(std::string description, RunNextFunctor run_next)
+      : description_(std::move(description)), run_next_(std::move(run_next)) {}
+
+  void Run(const Status& status, yb::PriorityThreadPoolSuspender* suspender) override {
+    // Aborted task leaves its subcompactions to the compaction job thread.
+    if (!status.ok()) {
+      return;
+    }
+    while (run_next_(suspender)) {}
+  }
+
+  // Compaction job does not depend on this task being run, so it is never removed.
+  bool ShouldRemoveWithKey(void* key) override {
+    return false;
+  }
+
+  std::string ToString() const override {
+    return description_;
+  }
+
+  int CalculateGroupNoPriority(int active_tasks) const override {
+    return kTopDiskSubcompactionPriority - active_tasks;
+  }
+
+ private:
+  const std::string description_;
+  const RunNextFunctor run_next_;
+};
+
+} // namespace
+
+// Distributes subcompactions between the compaction job thread and helper tasks. Each participant
+// claims the next not started subcompaction, so when helper tasks are not scheduled because the
+// pool is busy, the compaction job thread processes all subcompactions itself.
+class CompactionJob::SubcompactionRunner {
+ public:
+  SubcompactionRunner(CompactionJob* job, FileNumbersHolder* holder)
+      : job_(job), holder_(holder), size_(job->compact_->sub_compact_states.size()) {}
+
+  // Processes the next not started subcompaction, returns false if there is no such one.
+  // Job is not accessed after all subcompactions were claimed, so it is safe to call this method
+  // after the job is destroyed.
+  bool RunNext(yb::PriorityThreadPoolSuspender* suspender) {
+    auto idx = next_.fetch_add(1, std::memory_order_acq_rel);
+    if (idx >= size_) {
+      return false;
+    }
+    auto* sub_compact = &job_->compact_->sub_compact_states[idx];
+    sub_compact->suspender = suspender;
+    job_->ProcessKeyValueCompaction(holder_, sub_compact);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (++finished_ == size_) {
+      cond_.notify_all();
+    }
+    return true;
+  }
+
+  // Waits until all subcompactions are processed.
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return finished_ == size_; });
+  }
+
+ private:
+  CompactionJob* const job_;
+  FileNumbersHolder* const holder_;
+  const size_t size_;
+  std::atomic<size_t> next_{0};
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  size_t finished_ = 0;
+};
+
+void CompactionJob::RunSubcompactions(FileNumbersHolder* holder) {
+  auto& sub_compact_states = compact_->sub_compact_states;
+  auto* compaction = compact_->compaction;
+  auto* pool = FLAGS_use_priority_thread_pool_for_compactions
+      ? db_options_.priority_thread_pool_for_compactions_and_flushes : nullptr;
+  if (pool == nullptr) {
+    // Launch a thread for each of subcompactions 1...num_threads-1
+    std::vector<std::thread> thread_pool;
+    thread_pool.reserve(sub_compact_states.size() - 1);
+    for (size_t i = 1; i < sub_compact_states.size(); i++) {
+      thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this, holder,
+                               &sub_compact_states[i]);
+    }
+
+    // Always schedule the first subcompaction (whether or not there are also
+    // others) in the current thread to be efficient with resources
+    sub_compact_states[0].suspender = compaction->suspender();
+    ProcessKeyValueCompaction(holder, &sub_compact_states[0]);
+
+    // Wait for all other threads (if there are any) to finish execution
+    for (auto& thread : thread_pool) {
+      thread.join();
+    }
+    return;
+  }
+
+  auto runner = std::make_shared<SubcompactionRunner>(this, holder);
+  for (size_t i = 1; i < sub_compact_states.size(); i++) {
+    std::unique_ptr<yb::PriorityThreadPoolTask> task = std::make_unique<SubcompactionTask>(
+        yb::Format("{ subcompaction db: $0 job_id: $1 }", dbname_, job_id_),
+        [runner](yb::PriorityThreadPoolSuspender* suspender) {
+      return runner->RunNext(suspender);
+    });
+    auto status = pool->Submit(compaction->priority(), &task, db_options_.disk_group_no);
+    if (!status.ok()) {
+      RLOG(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+          "[JOB %d] Failed to submit subcompaction task: %s", job_id_, status.ToString().c_str());
+      break;
+    }
+  }
+
+  while (runner->RunNext(compaction->suspender())) {}
+  runner->Wait();
+}
+
 Result<FileNumbersHolder> CompactionJob::Run() {
   TEST_SYNC_POINT("CompactionJob::Run():Start");
   log_buffer_->FlushBufferToLog();
@@ -448,24 +671,9 @@ Result<FileNumbersHolder> CompactionJob::Run() {
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
 
-  // Launch a thread for each of subcompactions 1...num_threads-1
-  std::vector<std::thread> thread_pool;
-  thread_pool.reserve(num_threads - 1);
   FileNumbersHolder file_numbers_holder(file_numbers_provider_->CreateHolder());
   file_numbers_holder.Reserve(num_threads);
-  for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
-    thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this, &file_numbers_holder,
-                             &compact_->sub_compact_states[i]);
-  }
-
-  // Always schedule the first subcompaction (whether or not there are also
-  // others) in the current thread to be efficient with resources
-  ProcessKeyValueCompaction(&file_numbers_holder, &compact_->sub_compact_states[0]);
-
-  // Wait for all other threads (if there are any) to finish execution
-  for (auto& thread : thread_pool) {
-    thread.join();
-  }
+  RunSubcompactions(&file_numbers_holder);
 
   if (output_directory_ && !db_options_.disableDataSync) {
     RETURN_NOT_OK(output_directory_->Fsync());
@@ -707,9 +915,14 @@ void CompactionJob::ProcessKeyValueCompaction(
   }
 
   // This is used to persist the history cutoff hybrid time chosen for the DocDB compaction
-  // filter.
+  // filter. Subcompactions could choose different cutoffs, so the largest one is persisted.
   if (sub_compact->context) {
-    largest_user_frontier_ = sub_compact->context->GetLargestUserFrontier();
+    auto frontier = sub_compact->context->GetLargestUserFrontier();
+    if (frontier) {
+      std::lock_guard<std::mutex> lock(largest_user_frontier_mutex_);
+      UpdateUserFrontier(
+          &largest_user_frontier_, std::move(frontier), UpdateUserValueType::kLargest);
+    }
   }
 
   sub_compact->num_input_records = c_iter_stats.num_input_records;
@@ -1012,7 +1225,7 @@ Status CompactionJob::OpenCompactionOutputFile(
         (*writable_file)->SetPreallocationBlockSize(preallocation_block_size);
       }
       writer->reset(new WritableFileWriter(
-          std::move(*writable_file), env_options_, sub_compact->compaction->suspender()));
+          std::move(*writable_file), env_options_, sub_compact->suspender));
     };
 
     const bool is_split_sst = cfd->ioptions()->table_factory->IsSplitSstForWriteSupported();
@@ -30,6 +30,7 @@
 #include <deque>
 #include <functional>
 #include <limits>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -102,9 +103,15 @@ class CompactionJob {
 
  private:
   struct SubcompactionState;
+  class SubcompactionRunner;
 
   void AggregateStatistics();
   void GenSubcompactionBoundaries();
+  // Splits single level universal compaction using data block boundaries of its input files.
+  void GenSingleLevelSubcompactionBoundaries();
+  // Runs subcompactions 1...n-1 on the priority thread pool, helping with them from the current
+  // thread. Falls back to dedicated threads when there is no pool.
+  void RunSubcompactions(FileNumbersHolder* holder);
 
   // update the thread status for starting a compaction.
   void ReportStartedCompaction(Compaction* compaction);
@@ -178,9 +185,12 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
+  // Holds boundaries that do not point into input files metadata.
+  std::deque<std::string> boundary_keys_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
 
+  std::mutex largest_user_frontier_mutex_;
   UserFrontierPtr largest_user_frontier_;
 };
 
@@ -0,0 +1,143 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "yb/rocksdb/db/db_test_util.h"
+#include "yb/rocksdb/port/stack_trace.h"
+
+namespace rocksdb {
+
+namespace {
+
+constexpr int kKeysPerBatch = 10;
+
+// Writes keys of the batch directly to memtable, the same way as DocDB writes Raft-applied batches.
+class TestDirectWriter : public DirectWriter {
+ public:
+  TestDirectWriter(int thread, int batch, bool single_delete)
+      : thread_(thread), batch_(batch), single_delete_(single_delete) {}
+
+  Status Apply(DirectWriteHandler* handler) override {
+    for (int i = 0; i != kKeysPerBatch; ++i) {
+      auto key = Key(thread_, batch_, i);
+      Slice key_slice(key);
+      if (single_delete_) {
+        handler->SingleDelete(key_slice);
+      } else {
+        handler->Put(SliceParts(&key_slice, 1), SliceParts(&key_slice, 1));
+      }
+    }
+    return Status::OK();
+  }
+
+  static std::string Key(int thread, int batch, int idx) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02d/%06d/%02d", thread, batch, idx);
+    return buf;
+  }
+
+ private:
+  const int thread_;
+  const int batch_;
+  const bool single_delete_;
+};
+
+} // namespace
+
+class DBConcurrentWriteTest : public DBTestBase {
+ public:
+  DBConcurrentWriteTest() : DBTestBase("/db_concurrent_write_test") {}
+
+ protected:
+  void Open(bool concurrent) {
+    Options options = CurrentOptions();
+    options.allow_concurrent_memtable_write = concurrent;
+    options.enable_write_thread_adaptive_yield = concurrent;
+    options.write_buffer_size = 256_MB;
+    DestroyAndReopen(options);
+  }
+
+  // Writes num_batches batches of direct entries from each of num_threads threads.
+  void WriteBatches(int num_threads, int num_batches, bool single_delete) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t != num_threads; ++t) {
+      threads.emplace_back([this, t, num_batches, single_delete] {
+        WriteOptions write_options;
+        write_options.disableWAL = true;
+        for (int b = 0; b != num_batches; ++b) {
+          TestDirectWriter writer(t, b, single_delete);
+          WriteBatch batch;
+          batch.SetDirectWriter(&writer);
+          ASSERT_OK(db_->Write(write_options, &batch));
+          if (!single_delete) {
+            ASSERT_EQ(static_cast<size_t>(kKeysPerBatch), batch.DirectEntries());
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+class DBConcurrentWriteTestWithParam : public DBConcurrentWriteTest,
+                                       public ::testing::WithParamInterface<bool> {
+};
+
+// Checks that direct writer entries are available after writes from several threads, and that
+// every direct entry gets its own sequence number, also when concurrent memtable writes are
+// allowed. Batches with direct writers are never inserted in parallel, since the number of
+// sequence numbers they use is unknown before they are applied.
+TEST_P(DBConcurrentWriteTestWithParam, DirectWriters) {
+  constexpr int kThreads = 8;
+  constexpr int kBatches = 500;
+
+  Open(GetParam());
+  auto start_sequence = db_->GetLatestSequenceNumber();
+  WriteBatches(kThreads, kBatches, /* single_delete= */ false);
+  ASSERT_EQ(start_sequence + kThreads * kBatches * kKeysPerBatch,
+            db_->GetLatestSequenceNumber());
+
+  for (int t = 0; t != kThreads; ++t) {
+    for (int b = 0; b != kBatches; ++b) {
+      for (int i = 0; i != kKeysPerBatch; ++i) {
+        auto key = TestDirectWriter::Key(t, b, i);
+        ASSERT_EQ(key, Get(key));
+      }
+    }
+  }
+
+  // Single deletion either erases entry from memtable, or is added as a separate entry when
+  // memtable does not support erase. Both ways key should not be found.
+  WriteBatches(kThreads, kBatches, /* single_delete= */ true);
+  for (int t = 0; t != kThreads; ++t) {
+    for (int b = 0; b != kBatches; ++b) {
+      auto key = TestDirectWriter::Key(t, b, 0);
+      ASSERT_EQ("NOT_FOUND", Get(key));
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(Concurrent, DBConcurrentWriteTestWithParam, ::testing::Bool());
+
+} // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
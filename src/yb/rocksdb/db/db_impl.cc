@@ -382,6 +382,12 @@ class DBImpl::CompactionTask : public ThreadPoolTask {
     compaction_ = nullptr;
   }
 
+  // Subcompaction tasks of this compaction are submitted with the same priority.
+  void PropagatePriority() {
+    db_impl_->mutex_.AssertHeld();
+    compaction_->SetPriority(priority_);
+  }
+
   int Priority() const override {
     return priority_;
   }
@@ -3426,6 +3432,7 @@ void DBImpl::BackgroundCallCompaction(ManualCompaction* m, std::unique_ptr<Compa
   if (compaction_task) {
     LOG_IF_WITH_PREFIX(DFATAL, compaction_tasks_.count(compaction_task) != 1)
         << "Running compaction for unknown task: " << compaction_task;
+    compaction_task->PropagatePriority();
   } else {
     LOG_IF_WITH_PREFIX(DFATAL, bg_compaction_scheduled_ == 0)
         << "Running compaction while no compactions were scheduled";
@@ -4338,6 +4345,8 @@ Status DBImpl::AddFile(ColumnFamilyHandle* column_family,
     return STATUS(InvalidArgument,
         "Non zero sequence numbers are not supported");
   }
+  meta.smallest.user_frontier = file_info->smallest_frontier;
+  meta.largest.user_frontier = file_info->largest_frontier;
 
   std::string db_base_fname;
   std::string db_data_fname;
@@ -4381,7 +4390,7 @@ Status DBImpl::AddFile(ColumnFamilyHandle* column_family,
             STATUS(NotSupported, "Cannot add a file while holding snapshots");
       }
 
-      if (status.ok()) {
+      if (status.ok() && !file_info->allow_overlapping_range) {
         // Verify that added file key range dont overlap with any keys in DB
         SuperVersion* sv = cfd->GetSuperVersion()->Ref();
         Arena arena;
@@ -5126,11 +5135,13 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     // 4. Merges are not okay
     // 5. YugaByte-specific user-specified sequence numbers are currently not compatible with
     //    parallel memtable writes.
+    // 6. Direct writers are not okay, since the number of entries they add, and so the sequence
+    //    numbers they use, is known only after they are applied.
     //
     // Rules 1..3 are enforced by checking the options
     // during startup (CheckConcurrentWritesSupported), so if
     // options.allow_concurrent_memtable_write is true then they can be
-    // assumed to be true.  Rule 4 is checked for each batch.  We could
+    // assumed to be true.  Rules 4 and 6 are checked for each batch.  We could
     // relax rules 2 and 3 if we could prevent write batches from referring
     // more than once to a particular key.
     bool parallel =
@@ -5142,7 +5153,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         total_count += WriteBatchInternal::Count(writer->batch);
         total_byte_size = WriteBatchInternal::AppendedByteSize(
             total_byte_size, WriteBatchInternal::ByteSize(writer->batch));
-        parallel = parallel && !writer->batch->HasMerge();
+        parallel = parallel && !writer->batch->HasMerge() && !writer->batch->HasDirectWriter();
       }
     }
 
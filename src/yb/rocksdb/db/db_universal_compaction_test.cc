@@ -28,6 +28,8 @@
 #include "yb/rocksdb/util/file_util.h"
 #include "yb/rocksdb/util/sync_point.h"
 
+#include "yb/util/priority_thread_pool.h"
+
 namespace rocksdb {
 
 static std::string CompressibleString(Random* rnd, int len) {
@@ -1465,6 +1467,90 @@ TEST_F(DBTestUniversalCompaction, IncludeFilesSmallerThanThreshold) {
   GenerateFilesAndCheckCompactionResult(options, file_sizes, value_size, 1);
 }
 
+class DBTestUniversalSubcompactions : public DBTestBase,
+                                      public ::testing::WithParamInterface<bool> {
+ public:
+  DBTestUniversalSubcompactions() : DBTestBase("/db_universal_subcompactions_test") {}
+};
+
+namespace {
+
+constexpr size_t kGroupPrefixSize = 5;
+
+std::string GroupKey(int group, int idx) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%04d/%04d", group, idx);
+  return buf;
+}
+
+} // namespace
+
+// Checks that single level universal compaction is split into subcompactions, and keys sharing
+// subcompaction boundary prefix are processed by the same subcompaction.
+TEST_P(DBTestUniversalSubcompactions, SingleLevel) {
+  constexpr int kNumFiles = 4;
+  constexpr int kNumGroups = 200;
+  constexpr int kKeysPerGroup = 20;
+  constexpr uint32_t kMaxSubcompactions = 4;
+
+  std::unique_ptr<yb::PriorityThreadPool> thread_pool;
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = 1;
+  options.write_buffer_size = 16_MB;
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = kMaxSubcompactions;
+  options.min_subcompaction_input_size = 1;
+  options.subcompaction_boundary_transform.reset(NewFixedPrefixTransform(kGroupPrefixSize));
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1_KB;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  if (GetParam()) {
+    thread_pool = std::make_unique<yb::PriorityThreadPool>(kMaxSubcompactions);
+    options.priority_thread_pool_for_compactions_and_flushes = thread_pool.get();
+  }
+  DestroyAndReopen(options);
+
+  // Each file overlaps all other files and overwrites their values.
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int file = 0; file != kNumFiles; ++file) {
+    for (int group = 0; group != kNumGroups; ++group) {
+      for (int idx = 0; idx != kKeysPerGroup; ++idx) {
+        auto key = GroupKey(group, idx);
+        auto value = RandomString(&rnd, 20);
+        ASSERT_OK(Put(key, value));
+        expected[key] = value;
+      }
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(NumSortedRuns(0), kNumFiles);
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  auto files = db_->GetLiveFilesMetaData();
+  ASSERT_GT(files.size(), 1);
+  ASSERT_LE(files.size(), kMaxSubcompactions);
+  std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.smallest.key < rhs.smallest.key;
+  });
+  for (size_t i = 1; i != files.size(); ++i) {
+    const auto& prev_largest = files[i - 1].largest.key;
+    const auto& smallest = files[i].smallest.key;
+    ASSERT_LT(prev_largest, smallest);
+    ASSERT_NE(prev_largest.substr(0, kGroupPrefixSize), smallest.substr(0, kGroupPrefixSize));
+  }
+
+  for (const auto& p : expected) {
+    ASSERT_EQ(p.second, Get(p.first)) << p.first;
+  }
+
+  Close();
+}
+
+INSTANTIATE_TEST_CASE_P(UsePriorityThreadPool, DBTestUniversalSubcompactions, ::testing::Bool());
+
 }  // namespace rocksdb
 
 #endif  // !defined(ROCKSDB_LITE)
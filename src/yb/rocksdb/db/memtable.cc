@@ -491,7 +491,7 @@ void MemTable::ApplyPreparedAdd(
     while (
         (cur_earliest_seqno == kMaxSequenceNumber ||
              prepared_add.min_seq_no < cur_earliest_seqno) &&
-        !first_seqno_.compare_exchange_weak(cur_earliest_seqno, prepared_add.min_seq_no)) {
+        !earliest_seqno_.compare_exchange_weak(cur_earliest_seqno, prepared_add.min_seq_no)) {
     }
   }
 
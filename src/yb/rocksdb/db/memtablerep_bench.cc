@@ -52,6 +52,7 @@ int main() {
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/slice_transform.h"
 #include "yb/rocksdb/util/arena.h"
+#include "yb/rocksdb/util/concurrent_arena.h"
 #include "yb/rocksdb/util/mutexlock.h"
 #include "yb/rocksdb/util/stop_watch.h"
 #include "yb/rocksdb/util/testutil.h"
@@ -70,7 +71,11 @@ DEFINE_string(benchmarks, "fillrandom",
               "do random\n"
               "\t                          reads\n"
               "\tseqreadwrite           -- 1 thread writes while N - 1 threads "
-              "do scans\n");
+              "do scans\n"
+              "\tfillrandomconcurrent   -- N threads write N random values "
+              "concurrently\n"
+              "\tseekrandom             -- seek to N random keys and read "
+              "--seek_nexts entries after each\n");
 
 DEFINE_string(memtablerep, "skiplist",
               "Which implementation of memtablerep to use. See "
@@ -79,11 +84,12 @@ DEFINE_string(memtablerep, "skiplist",
               "\tskiplist            -- backed by a skiplist\n"
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
-              "\thashlinklist        -- backed by a hash linked list\n");
+              "\thashlinklist        -- backed by a hash linked list\n"
+              "\tprefixskiplist      -- backed by per prefix skip lists\n");
 
 DEFINE_int64(bucket_count, 1000000,
-             "bucket_count parameter to pass into NewHashSkiplistRepFactory or "
-             "NewHashLinkListRepFactory");
+             "bucket_count parameter to pass into NewHashSkiplistRepFactory, "
+             "NewHashLinkListRepFactory or NewPrefixSkipListRepFactory");
 
 DEFINE_int32(
     hashskiplist_height, 4,
@@ -93,6 +99,10 @@ DEFINE_int32(
     hashskiplist_branching_factor, 4,
     "branching_factor parameter to pass into NewHashSkiplistRepFactory");
 
+DEFINE_int32(
+    prefixskiplist_height, 6,
+    "prefix_skiplist_height parameter to pass into NewPrefixSkipListRepFactory");
+
 DEFINE_int32(
     huge_page_tlb_size, 0,
     "huge_page_tlb_size parameter to pass into NewHashLinkListRepFactory");
@@ -127,6 +137,19 @@ DEFINE_int32(item_size, 100, "Number of bytes each item should be");
 DEFINE_int32(prefix_length, 8,
              "Prefix length to pass into NewFixedPrefixTransform");
 
+DEFINE_int32(key_shared_prefix_size, 0,
+             "Number of leading bytes that are the same for all keys. Could be "
+             "used to model DocDB keys that start with the same table id.");
+
+DEFINE_int32(keys_per_prefix, 1,
+             "Number of consecutive keys that share the same 8 byte prefix "
+             "after --key_shared_prefix_size bytes. Could be used to model "
+             "DocDB documents with several columns. When greater than 1, an "
+             "8 byte suffix is appended to every key.");
+
+DEFINE_int32(seek_nexts, 10,
+             "Number of entries to read after each seek in seekrandom");
+
 /* VectorRep settings */
 DEFINE_int64(vectorrep_count, 0,
              "Number of entries to reserve on VectorRep initialization");
@@ -146,6 +169,32 @@ struct CallbackVerifyArgs {
 };
 }  // namespace
 
+size_t UserKeySize() {
+  return FLAGS_key_shared_prefix_size + 8 + (FLAGS_keys_per_prefix > 1 ? 8 : 0);
+}
+
+size_t InternalKeySize() {
+  return UserKeySize() + 8;
+}
+
+char* EncodeUserKey(uint64_t key, char* out) {
+  memset(out, 'k', FLAGS_key_shared_prefix_size);
+  out += FLAGS_key_shared_prefix_size;
+  if (FLAGS_keys_per_prefix > 1) {
+    EncodeFixed64(out, key / FLAGS_keys_per_prefix);
+    EncodeFixed64(out + 8, key % FLAGS_keys_per_prefix);
+    return out + 16;
+  }
+  EncodeFixed64(out, key);
+  return out + 8;
+}
+
+std::string UserKey(uint64_t key) {
+  std::string result(UserKeySize(), 0);
+  EncodeUserKey(key, &result[0]);
+  return result;
+}
+
 // Helper for quickly generating random data.
 class RandomGenerator {
  private:
@@ -248,27 +297,34 @@ class FillBenchmarkThread : public BenchmarkThread {
       : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
                         num_ops, read_hits) {}
 
-  void FillOne() {
+  void FillOne(uint64_t key, uint64_t sequence, bool concurrently) {
     char* buf = nullptr;
-    auto internal_key_size = 16;
+    auto internal_key_size = static_cast<uint32_t>(InternalKeySize());
     auto encoded_len =
         FLAGS_item_size + VarintLength(internal_key_size) + internal_key_size;
     KeyHandle handle = table_->Allocate(encoded_len, &buf);
     assert(buf != nullptr);
     char* p = EncodeVarint32(buf, internal_key_size);
-    auto key = key_gen_->Next();
-    EncodeFixed64(p, key);
-    p += 8;
-    EncodeFixed64(p, ++(*sequence_));
+    p = EncodeUserKey(key, p);
+    EncodeFixed64(p, sequence);
     p += 8;
     Slice bytes = generator_.Generate(FLAGS_item_size);
     memcpy(p, bytes.data(), FLAGS_item_size);
     p += FLAGS_item_size;
     assert(p == buf + encoded_len);
-    table_->Insert(handle);
+    if (concurrently) {
+      table_->InsertConcurrently(handle);
+    } else {
+      table_->Insert(handle);
+    }
     *bytes_written_ += encoded_len;
   }
 
+  void FillOne() {
+    auto key = key_gen_->Next();
+    FillOne(key, ++(*sequence_), /* concurrently= */ false);
+  }
+
   void operator()() override {
     for (unsigned int i = 0; i < num_ops_; ++i) {
       FillOne();
@@ -300,6 +356,29 @@ class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
   std::atomic_int* threads_done_;
 };
 
+// Inserts keys generated by its own key generator concurrently with other threads of the same type.
+// Keys generated by the thread are transformed to key * FLAGS_num_threads + thread_idx, so they do
+// not intersect with keys of other threads.
+class ConcurrentInsertBenchmarkThread : public FillBenchmarkThread {
+ public:
+  ConcurrentInsertBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                                  uint64_t* bytes_written, uint64_t* sequence,
+                                  uint64_t num_ops, int thread_idx)
+      : FillBenchmarkThread(table, key_gen, bytes_written, nullptr, sequence,
+                            num_ops, nullptr),
+        thread_idx_(thread_idx) {}
+
+  void operator()() override {
+    for (unsigned int i = 0; i < num_ops_; ++i) {
+      auto key = key_gen_->Next() * FLAGS_num_threads + thread_idx_;
+      FillOne(key, ++(*sequence_), /* concurrently= */ true);
+    }
+  }
+
+ private:
+  int thread_idx_;
+};
+
 class ReadBenchmarkThread : public BenchmarkThread {
  public:
   ReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
@@ -323,9 +402,7 @@ class ReadBenchmarkThread : public BenchmarkThread {
   }
 
   void ReadOne() {
-    std::string user_key;
-    auto key = key_gen_->Next();
-    PutFixed64(&user_key, key);
+    auto user_key = UserKey(key_gen_->Next());
     LookupKey lookup_key(user_key, *sequence_);
     InternalKeyComparator internal_key_comp(BytewiseComparator());
     CallbackVerifyArgs verify_args;
@@ -335,7 +412,7 @@ class ReadBenchmarkThread : public BenchmarkThread {
     verify_args.comparator = &internal_key_comp;
     table_->Get(lookup_key, &verify_args, callback);
     if (verify_args.found) {
-      *bytes_read_ += VarintLength(16) + 16 + FLAGS_item_size;
+      *bytes_read_ += VarintLength(InternalKeySize()) + InternalKeySize() + FLAGS_item_size;
       ++*read_hits_;
     }
   }
@@ -359,7 +436,7 @@ class SeqReadBenchmarkThread : public BenchmarkThread {
     std::unique_ptr<MemTableRep::Iterator> iter(table_->GetIterator());
     for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
       // pretend to read the value
-      *bytes_read_ += VarintLength(16) + 16 + FLAGS_item_size;
+      *bytes_read_ += VarintLength(InternalKeySize()) + InternalKeySize() + FLAGS_item_size;
     }
     ++*read_hits_;
   }
@@ -371,6 +448,42 @@ class SeqReadBenchmarkThread : public BenchmarkThread {
   }
 };
 
+class SeekBenchmarkThread : public BenchmarkThread {
+ public:
+  SeekBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                      uint64_t* bytes_written, uint64_t* bytes_read,
+                      uint64_t* sequence, uint64_t num_ops, uint64_t* read_hits)
+      : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
+                        num_ops, read_hits) {}
+
+  void SeekOne(MemTableRep::Iterator* iter) {
+    auto user_key = UserKey(key_gen_->Next());
+    LookupKey lookup_key(user_key, *sequence_);
+    iter->Seek(lookup_key.internal_key(), lookup_key.memtable_key().cdata());
+    if (!iter->Valid()) {
+      return;
+    }
+    ++*read_hits_;
+    const auto entry_size = VarintLength(InternalKeySize()) + InternalKeySize() + FLAGS_item_size;
+    // pretend to read the values
+    *bytes_read_ += entry_size;
+    for (int i = 0; i < FLAGS_seek_nexts; ++i) {
+      iter->Next();
+      if (!iter->Valid()) {
+        break;
+      }
+      *bytes_read_ += entry_size;
+    }
+  }
+
+  void operator()() override {
+    std::unique_ptr<MemTableRep::Iterator> iter(table_->GetIterator());
+    for (unsigned int i = 0; i < num_ops_; ++i) {
+      SeekOne(iter.get());
+    }
+  }
+};
+
 class ConcurrentReadBenchmarkThread : public ReadBenchmarkThread {
  public:
   ConcurrentReadBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
@@ -489,6 +602,39 @@ class FillBenchmark : public Benchmark {
   }
 };
 
+class ConcurrentFillBenchmark : public Benchmark {
+ public:
+  ConcurrentFillBenchmark(MemTableRep* table, Random64* rand, uint64_t* sequence)
+      : Benchmark(table, nullptr, sequence, FLAGS_num_threads) {
+    num_write_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      key_gens_.emplace_back(new KeyGenerator(rand, UNIQUE_RANDOM, num_write_ops_per_thread_));
+    }
+  }
+
+  void RunThreads(std::vector<std::thread>* threads, uint64_t* bytes_written,
+                  uint64_t* bytes_read, bool write,
+                  uint64_t* read_hits) override {
+    std::vector<uint64_t> thread_bytes_written(FLAGS_num_threads);
+    std::vector<uint64_t> thread_sequences(FLAGS_num_threads, *sequence_);
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      threads->emplace_back(ConcurrentInsertBenchmarkThread(
+          table_, key_gens_[i].get(), &thread_bytes_written[i], &thread_sequences[i],
+          num_write_ops_per_thread_, i));
+    }
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      *bytes_written += thread_bytes_written[i];
+      *sequence_ = std::max(*sequence_, thread_sequences[i]);
+    }
+  }
+
+ private:
+  std::vector<std::unique_ptr<KeyGenerator>> key_gens_;
+};
+
 class ReadBenchmark : public Benchmark {
  public:
   explicit ReadBenchmark(MemTableRep* table, KeyGenerator* key_gen,
@@ -514,6 +660,37 @@ class ReadBenchmark : public Benchmark {
   }
 };
 
+class SeekBenchmark : public Benchmark {
+ public:
+  SeekBenchmark(MemTableRep* table, KeyGenerator* key_gen, uint64_t* sequence)
+      : Benchmark(table, key_gen, sequence, FLAGS_num_threads) {
+    num_read_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
+  }
+
+  void RunThreads(std::vector<std::thread>* threads, uint64_t* bytes_written,
+                  uint64_t* bytes_read, bool write,
+                  uint64_t* read_hits) override {
+    // Counters are not atomic, so every thread gets its own ones.
+    std::vector<uint64_t> thread_bytes_read(FLAGS_num_threads);
+    std::vector<uint64_t> thread_read_hits(FLAGS_num_threads);
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      threads->emplace_back(SeekBenchmarkThread(
+          table_, key_gen_, bytes_written, &thread_bytes_read[i], sequence_,
+          num_read_ops_per_thread_, &thread_read_hits[i]));
+    }
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      *bytes_read += thread_bytes_read[i];
+      *read_hits += thread_read_hits[i];
+    }
+    std::cout << "seek hit%: "
+              << (static_cast<double>(*read_hits) / FLAGS_num_operations) * 100
+              << std::endl;
+  }
+};
+
 class SeqReadBenchmark : public Benchmark {
  public:
   explicit SeqReadBenchmark(MemTableRep* table, uint64_t* sequence)
@@ -608,6 +785,11 @@ int main(int argc, char** argv) {
         FLAGS_if_log_bucket_dist_when_flash, FLAGS_threshold_use_skiplist));
     options.prefix_extractor.reset(
         rocksdb::NewFixedPrefixTransform(FLAGS_prefix_length));
+  } else if (FLAGS_memtablerep == "prefixskiplist") {
+    factory.reset(rocksdb::NewPrefixSkipListRepFactory(
+        nullptr, FLAGS_bucket_count, FLAGS_prefixskiplist_height));
+    options.prefix_extractor.reset(
+        rocksdb::NewFixedPrefixTransform(FLAGS_prefix_length));
   } else {
     fprintf(stdout, "Unknown memtablerep: %s\n", FLAGS_memtablerep.c_str());
     exit(1);
@@ -616,7 +798,8 @@ int main(int argc, char** argv) {
   rocksdb::InternalKeyComparator internal_key_comp(
       rocksdb::BytewiseComparator());
   rocksdb::MemTable::KeyComparator key_comp(internal_key_comp);
-  rocksdb::Arena arena;
+  // Concurrent arena is used to support fillrandomconcurrent, as it is done by MemTable.
+  rocksdb::ConcurrentArena arena;
   rocksdb::WriteBuffer wb(FLAGS_write_buffer_size);
   rocksdb::MemTableAllocator memtable_allocator(&arena, &wb);
   uint64_t sequence;
@@ -653,11 +836,26 @@ int main(int argc, char** argv) {
                                               FLAGS_num_operations));
       benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
                                                  key_gen.get(), &sequence));
+    } else if (name == rocksdb::Slice("fillrandomconcurrent")) {
+      if (!factory->IsInsertConcurrentlySupported()) {
+        std::cout << "WARNING: " << FLAGS_memtablerep
+                  << " does not support concurrent inserts, skipping "
+                  << name.ToString() << std::endl;
+        continue;
+      }
+      memtablerep.reset(createMemtableRep());
+      benchmark.reset(new rocksdb::ConcurrentFillBenchmark(
+          memtablerep.get(), &rng, &sequence));
     } else if (name == rocksdb::Slice("readrandom")) {
       key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::RANDOM,
                                               FLAGS_num_operations));
       benchmark.reset(new rocksdb::ReadBenchmark(memtablerep.get(),
                                                  key_gen.get(), &sequence));
+    } else if (name == rocksdb::Slice("seekrandom")) {
+      key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::RANDOM,
+                                              FLAGS_num_operations));
+      benchmark.reset(new rocksdb::SeekBenchmark(memtablerep.get(),
+                                                 key_gen.get(), &sequence));
     } else if (name == rocksdb::Slice("readseq")) {
       key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::SEQUENTIAL,
                                               FLAGS_num_operations));
@@ -0,0 +1,221 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/rocksdb/db/memtable.h"
+#include "yb/rocksdb/db/merge_context.h"
+#include "yb/rocksdb/db/writebuffer.h"
+#include "yb/rocksdb/memtablerep.h"
+#include "yb/rocksdb/slice_transform.h"
+#include "yb/rocksdb/table/scoped_arena_iterator.h"
+#include "yb/rocksdb/util/random.h"
+#include "yb/rocksdb/util/testharness.h"
+
+#include "yb/util/format.h"
+
+namespace rocksdb {
+
+namespace {
+
+constexpr size_t kPrefixSize = 4;
+
+class TestMemTable {
+ public:
+  explicit TestMemTable(std::shared_ptr<MemTableRepFactory> factory)
+      : cmp_(BytewiseComparator()), options_(MakeOptions(std::move(factory))), ioptions_(options_),
+        write_buffer_(options_.db_write_buffer_size),
+        mem_(new MemTable(cmp_, ioptions_, MutableCFOptions(options_, ioptions_), &write_buffer_,
+                          kMaxSequenceNumber)) {
+    mem_->Ref();
+  }
+
+  ~TestMemTable() {
+    delete mem_->Unref();
+  }
+
+  void Add(SequenceNumber seq, const std::string& key, const std::string& value,
+           bool allow_concurrent = false) {
+    Slice key_slice(key);
+    Slice value_slice(value);
+    mem_->Add(seq, kTypeValue, SliceParts(&key_slice, 1), SliceParts(&value_slice, 1),
+              allow_concurrent);
+  }
+
+  bool Get(const std::string& key, SequenceNumber seq, std::string* value) {
+    Status s;
+    MergeContext merge_context;
+    return mem_->Get(LookupKey(key, seq), value, &s, &merge_context) && s.ok();
+  }
+
+  InternalIterator* NewIterator(Arena* arena) {
+    return mem_->NewIterator(ReadOptions(), arena);
+  }
+
+ private:
+  static Options MakeOptions(std::shared_ptr<MemTableRepFactory> factory) {
+    Options options;
+    options.memtable_factory = std::move(factory);
+    options.allow_concurrent_memtable_write = true;
+    return options;
+  }
+
+  InternalKeyComparator cmp_;
+  Options options_;
+  ImmutableCFOptions ioptions_;
+  WriteBuffer write_buffer_;
+  MemTable* mem_;
+};
+
+std::shared_ptr<MemTableRepFactory> PrefixFactory() {
+  return std::shared_ptr<MemTableRepFactory>(NewPrefixSkipListRepFactory(
+      std::shared_ptr<const SliceTransform>(NewFixedPrefixTransform(kPrefixSize)),
+      /* bucket_count= */ 16));
+}
+
+// Generates keys that share a small number of prefixes. Keys shorter than prefix size are outside
+// of the prefix extractor domain.
+std::string RandomKey(Random* rnd) {
+  std::string result;
+  auto len = rnd->Uniform(static_cast<int>(kPrefixSize * 2 + 1));
+  for (size_t i = 0; i != len; ++i) {
+    result.push_back('a' + rnd->Uniform(i < kPrefixSize ? 3 : 26));
+  }
+  return result;
+}
+
+std::vector<std::string> CollectKeys(InternalIterator* iter, bool forward) {
+  std::vector<std::string> result;
+  if (forward) {
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      result.push_back(iter->key().ToBuffer());
+    }
+  } else {
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      result.push_back(iter->key().ToBuffer());
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+class PrefixSkipListRepTest : public RocksDBTest {};
+
+TEST_F(PrefixSkipListRepTest, MatchesSkipList) {
+  TestMemTable expected(std::make_shared<SkipListFactory>());
+  TestMemTable actual(PrefixFactory());
+
+  Random rnd(301);
+  std::vector<std::string> keys;
+  SequenceNumber seq = 0;
+  for (int i = 0; i != 5000; ++i) {
+    auto key = RandomKey(&rnd);
+    auto value = std::to_string(i);
+    ++seq;
+    expected.Add(seq, key, value);
+    actual.Add(seq, key, value);
+    keys.push_back(key);
+  }
+
+  Arena arena;
+  ScopedArenaIterator expected_iter(expected.NewIterator(&arena));
+  ScopedArenaIterator actual_iter(actual.NewIterator(&arena));
+
+  ASSERT_EQ(CollectKeys(expected_iter.get(), true), CollectKeys(actual_iter.get(), true));
+  ASSERT_EQ(CollectKeys(expected_iter.get(), false), CollectKeys(actual_iter.get(), false));
+
+  for (int i = 0; i != 2000; ++i) {
+    auto key = rnd.OneIn(2) ? keys[rnd.Uniform(static_cast<int>(keys.size()))] : RandomKey(&rnd);
+    auto read_seq = rnd.Uniform(static_cast<int>(seq)) + 1;
+
+    std::string expected_value, actual_value;
+    bool found = expected.Get(key, read_seq, &expected_value);
+    ASSERT_EQ(found, actual.Get(key, read_seq, &actual_value)) << key;
+    if (found) {
+      ASSERT_EQ(expected_value, actual_value);
+    }
+
+    InternalKey target(key, read_seq, kTypeValue);
+    expected_iter->Seek(target.Encode());
+    actual_iter->Seek(target.Encode());
+    bool forward = rnd.OneIn(2);
+    for (int step = 0; step != 5; ++step) {
+      ASSERT_EQ(expected_iter->Valid(), actual_iter->Valid());
+      if (!expected_iter->Valid()) {
+        break;
+      }
+      ASSERT_EQ(expected_iter->key(), actual_iter->key());
+      ASSERT_EQ(expected_iter->value(), actual_iter->value());
+      if (forward) {
+        expected_iter->Next();
+        actual_iter->Next();
+      } else {
+        expected_iter->Prev();
+        actual_iter->Prev();
+      }
+    }
+  }
+}
+
+TEST_F(PrefixSkipListRepTest, ConcurrentInsert) {
+  constexpr int kThreads = 4;
+  constexpr int kKeysPerThread = 5000;
+
+  TestMemTable mem(PrefixFactory());
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([&mem, t] {
+      for (int i = 0; i != kKeysPerThread; ++i) {
+        // Threads write interleaving keys of the same prefixes.
+        auto key = yb::Format("p$0//$1", i % 10, i * kThreads + t);
+        mem.Add(i * kThreads + t + 1, key, key, /* allow_concurrent= */ true);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::set<std::string> expected;
+  for (int i = 0; i != kThreads * kKeysPerThread; ++i) {
+    expected.insert(yb::Format("p$0//$1", (i / kThreads) % 10, i));
+  }
+
+  Arena arena;
+  ScopedArenaIterator iter(mem.NewIterator(&arena));
+  std::vector<std::string> actual;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(ExtractUserKey(iter->key()), iter->value());
+    actual.push_back(ExtractUserKey(iter->key()).ToBuffer());
+  }
+  ASSERT_EQ(std::vector<std::string>(expected.begin(), expected.end()), actual);
+
+  for (const auto& key : expected) {
+    std::string value;
+    ASSERT_TRUE(mem.Get(key, kMaxSequenceNumber, &value)) << key;
+    ASSERT_EQ(key, value);
+  }
+}
+
+} // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -69,6 +69,15 @@ class FilterBitsReader {
 
   // Check if the entry match the bits in filter
   virtual bool MayMatch(const Slice& entry) = 0;
+
+  // Checks num_entries entries at once, may_match[i] is set to MayMatch(entries[i]).
+  // Implementations could compute all hashes and prefetch filter data first, so memory accesses
+  // for different entries overlap.
+  virtual void MultiMayMatch(size_t num_entries, const Slice* entries, bool* may_match) {
+    for (size_t i = 0; i != num_entries; ++i) {
+      may_match[i] = MayMatch(entries[i]);
+    }
+  }
 };
 
 // We add a new format of filter block called full filter block
@@ -215,6 +224,14 @@ extern const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
 extern const FilterPolicy* NewFixedSizeFilterPolicy(size_t total_bits,
                                                     double error_rate,
                                                     Logger* logger);
+
+// Same as NewFixedSizeFilterPolicy, but uses register-blocked format: all probes of a key are
+// within one cache line and each probe tests one bit of a separate 64-bit word of this line, so
+// probes don't depend on each other. Filter blocks built by this policy are not compatible with
+// the ones built by NewFixedSizeFilterPolicy and have a different policy name.
+extern const FilterPolicy* NewBlockedFixedSizeFilterPolicy(size_t total_bits,
+                                                           double error_rate,
+                                                           Logger* logger);
 }  // namespace rocksdb
 
 #endif  // YB_ROCKSDB_FILTER_POLICY_H
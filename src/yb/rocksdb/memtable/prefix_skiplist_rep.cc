@@ -0,0 +1,406 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef ROCKSDB_LITE
+#include "yb/rocksdb/memtable/prefix_skiplist_rep.h"
+
+#include <atomic>
+
+#include "yb/rocksdb/db/dbformat.h"
+#include "yb/rocksdb/db/inlineskiplist.h"
+#include "yb/rocksdb/db/memtable.h"
+#include "yb/rocksdb/memtablerep.h"
+#include "yb/rocksdb/util/arena.h"
+#include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/murmurhash.h"
+
+#include "yb/util/slice.h"
+
+namespace rocksdb {
+namespace {
+
+// Memtable representation that groups entries by key prefix, i.e. by DocDB document.
+//
+// Every group owns a small skip list with its entries. Groups are found by a fixed size lock
+// free hash table and are ordered by an additional skip list, so total order iteration over the
+// whole memtable is preserved. Inserts and point lookups only walk the skip list of a single
+// group and compare keys that share the group prefix, instead of walking the skip list of the
+// whole memtable.
+//
+// Grouping relies on the prefix extractor being consistent with the key order: any key that
+// starts with a prefix P returned by the extractor should have prefix P. Keys that are not in the
+// extractor domain form groups of their own, keyed by the whole user key.
+class PrefixSkipListRep : public MemTableRep {
+ public:
+  PrefixSkipListRep(const MemTableRep::KeyComparator& compare, MemTableAllocator* allocator,
+                    const SliceTransform* transform, size_t bucket_count,
+                    int32_t prefix_skiplist_height);
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = entry_allocator_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  void Insert(KeyHandle handle) override {
+    auto* key = static_cast<char*>(handle);
+    FindOrCreateGroup(PrefixOfEntry(key), /* concurrently= */ false)->entries.Insert(key);
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    auto* key = static_cast<char*>(handle);
+    FindOrCreateGroup(PrefixOfEntry(key), /* concurrently= */ true)->entries.InsertConcurrently(
+        key);
+  }
+
+  bool Contains(const char* key) const override {
+    auto* group = FindGroup(PrefixOfEntry(key));
+    return group != nullptr && group->entries.Contains(key);
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override;
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override;
+
+ private:
+  typedef InlineSkipList<const MemTableRep::KeyComparator&> EntryList;
+
+  // Key of the group skip list. PrefixGroup is stored as a key of this list, so the comparator
+  // could access prefix of both stored groups and lookup keys.
+  struct GroupKey {
+    Slice prefix;
+  };
+
+  struct PrefixGroup : public GroupKey {
+    PrefixGroup(const Slice& prefix_, const MemTableRep::KeyComparator& compare,
+                Allocator* allocator, int32_t height)
+        : GroupKey{prefix_}, next_in_bucket(nullptr), entries(compare, allocator, height) {}
+
+    // Next group in the same hash bucket.
+    std::atomic<PrefixGroup*> next_in_bucket;
+    EntryList entries;
+  };
+
+  struct GroupComparator {
+    int operator()(const char* lhs, const char* rhs) const {
+      return reinterpret_cast<const GroupKey*>(lhs)->prefix.compare(
+          reinterpret_cast<const GroupKey*>(rhs)->prefix);
+    }
+  };
+
+  typedef InlineSkipList<GroupComparator> GroupList;
+
+  class Iterator;
+
+  static const char* GroupListKey(const GroupKey* key) {
+    return reinterpret_cast<const char*>(key);
+  }
+
+  static PrefixGroup* GroupFromListKey(const char* key) {
+    return static_cast<PrefixGroup*>(reinterpret_cast<GroupKey*>(const_cast<char*>(key)));
+  }
+
+  Slice PrefixOfUserKey(const Slice& user_key) const {
+    if (transform_ != nullptr && transform_->InDomain(user_key)) {
+      return transform_->Transform(user_key);
+    }
+    return user_key;
+  }
+
+  // Returns prefix of the entry encoded in memtable format.
+  Slice PrefixOfEntry(const char* entry) const {
+    return PrefixOfUserKey(ExtractUserKey(GetLengthPrefixedSlice(entry)));
+  }
+
+  std::atomic<PrefixGroup*>& Bucket(const Slice& prefix) const {
+    return buckets_[MurmurHash(prefix.data(), static_cast<int>(prefix.size()), 0) %
+                    bucket_count_];
+  }
+
+  // Looks for a group with the specified prefix in a bucket chain, starting from begin and
+  // stopping before end.
+  static PrefixGroup* FindInChain(
+      PrefixGroup* begin, PrefixGroup* end, const Slice& prefix) {
+    for (auto* group = begin; group != end;
+         group = group->next_in_bucket.load(std::memory_order_acquire)) {
+      if (group->prefix == prefix) {
+        return group;
+      }
+    }
+    return nullptr;
+  }
+
+  PrefixGroup* FindGroup(const Slice& prefix) const {
+    return FindInChain(Bucket(prefix).load(std::memory_order_acquire), nullptr, prefix);
+  }
+
+  PrefixGroup* FindOrCreateGroup(const Slice& prefix, bool concurrently);
+
+  const MemTableRep::KeyComparator& compare_;
+  const SliceTransform* const transform_;
+  const size_t bucket_count_;
+  const int32_t prefix_skiplist_height_;
+
+  std::atomic<PrefixGroup*>* buckets_;
+
+  // Orders groups by prefix.
+  GroupList groups_;
+
+  // Never contains entries, only used to allocate nodes of the group lists. Node layout does not
+  // depend on the list, so a node allocated here could be inserted to any group list of the same
+  // height.
+  EntryList entry_allocator_;
+};
+
+PrefixSkipListRep::PrefixSkipListRep(
+    const MemTableRep::KeyComparator& compare, MemTableAllocator* allocator,
+    const SliceTransform* transform, size_t bucket_count, int32_t prefix_skiplist_height)
+    : MemTableRep(allocator),
+      compare_(compare),
+      transform_(transform),
+      bucket_count_(bucket_count),
+      prefix_skiplist_height_(prefix_skiplist_height),
+      groups_(GroupComparator(), allocator),
+      entry_allocator_(compare, allocator, prefix_skiplist_height) {
+  auto mem = allocator->AllocateAligned(sizeof(std::atomic<PrefixGroup*>) * bucket_count);
+  buckets_ = new (mem) std::atomic<PrefixGroup*>[bucket_count];
+  for (size_t i = 0; i < bucket_count_; ++i) {
+    buckets_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+PrefixSkipListRep::PrefixGroup* PrefixSkipListRep::FindOrCreateGroup(
+    const Slice& prefix, bool concurrently) {
+  auto& bucket = Bucket(prefix);
+  auto* head = bucket.load(std::memory_order_acquire);
+  auto* group = FindInChain(head, nullptr, prefix);
+  if (group != nullptr) {
+    return group;
+  }
+
+  char* mem = groups_.AllocateKey(sizeof(PrefixGroup) + prefix.size());
+  char* prefix_copy = mem + sizeof(PrefixGroup);
+  memcpy(prefix_copy, prefix.data(), prefix.size());
+  auto* new_group = new (mem) PrefixGroup(
+      Slice(prefix_copy, prefix.size()), compare_, allocator_, prefix_skiplist_height_);
+
+  for (;;) {
+    new_group->next_in_bucket.store(head, std::memory_order_relaxed);
+    auto* expected = head;
+    if (bucket.compare_exchange_strong(
+            expected, new_group, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      break;
+    }
+    // Other groups were added to the bucket concurrently, one of them could have the same prefix.
+    // In this case new group is abandoned, its memory is released together with the allocator.
+    group = FindInChain(expected, head, prefix);
+    if (group != nullptr) {
+      return group;
+    }
+    head = expected;
+  }
+
+  // The group becomes visible through the hash table before it is added to the ordered list.
+  // Iterators handle this gap by checking the group list when hash lookup does not match.
+  if (concurrently) {
+    groups_.InsertConcurrently(GroupListKey(new_group));
+  } else {
+    groups_.Insert(GroupListKey(new_group));
+  }
+  return new_group;
+}
+
+void PrefixSkipListRep::Get(const LookupKey& k, void* callback_args,
+                            bool (*callback_func)(void* arg, const char* entry)) {
+  // All entries with the same user key belong to the same group.
+  auto* group = FindGroup(PrefixOfUserKey(k.user_key()));
+  if (group == nullptr) {
+    return;
+  }
+  EntryList::Iterator iter(&group->entries);
+  for (iter.Seek(k.memtable_key().cdata());
+       iter.Valid() && callback_func(callback_args, iter.key());
+       iter.Next()) {
+  }
+}
+
+// Iterates groups in prefix order, and entries of the current group.
+class PrefixSkipListRep::Iterator : public MemTableRep::Iterator {
+ public:
+  explicit Iterator(const PrefixSkipListRep* rep)
+      : rep_(*rep), groups_iter_(&rep->groups_), entries_iter_(&rep->entry_allocator_) {}
+
+  bool Valid() const override {
+    return group_ != nullptr && entries_iter_.Valid();
+  }
+
+  const char* key() const override {
+    assert(Valid());
+    return entries_iter_.key();
+  }
+
+  void Next() override {
+    assert(Valid());
+    entries_iter_.Next();
+    if (!entries_iter_.Valid()) {
+      MoveToNextGroup();
+    }
+  }
+
+  void Prev() override {
+    assert(Valid());
+    entries_iter_.Prev();
+    if (!entries_iter_.Valid()) {
+      PositionGroupsIter();
+      // Current group or the first group after it.
+      if (groups_iter_.Valid()) {
+        groups_iter_.Prev();
+      } else {
+        groups_iter_.SeekToLast();
+      }
+      SkipEmptyGroupsBackward();
+    }
+  }
+
+  void Seek(const Slice& internal_key, const char* memtable_key) override {
+    const char* encoded_key =
+        memtable_key != nullptr ? memtable_key : EncodeKey(&tmp_, internal_key);
+    GroupKey target{rep_.PrefixOfEntry(encoded_key)};
+
+    auto* group = rep_.FindGroup(target.prefix);
+    if (group != nullptr) {
+      group_ = group;
+      groups_iter_positioned_ = false;
+      entries_iter_.SetList(&group->entries);
+      entries_iter_.Seek(encoded_key);
+      if (!entries_iter_.Valid()) {
+        MoveToNextGroup();
+      }
+      return;
+    }
+
+    groups_iter_.Seek(GroupListKey(&target));
+    groups_iter_positioned_ = true;
+    while (groups_iter_.Valid()) {
+      group = GroupFromListKey(groups_iter_.key());
+      entries_iter_.SetList(&group->entries);
+      // Group could be added after the hash table lookup.
+      if (group->prefix == target.prefix) {
+        entries_iter_.Seek(encoded_key);
+      } else {
+        entries_iter_.SeekToFirst();
+      }
+      if (entries_iter_.Valid()) {
+        group_ = group;
+        return;
+      }
+      groups_iter_.Next();
+    }
+    group_ = nullptr;
+  }
+
+  void SeekToFirst() override {
+    groups_iter_.SeekToFirst();
+    SkipEmptyGroupsForward();
+  }
+
+  void SeekToLast() override {
+    groups_iter_.SeekToLast();
+    SkipEmptyGroupsBackward();
+  }
+
+ private:
+  // Positions groups_iter_ at the current group, or at the first group after it when the current
+  // group is not yet added to the group list.
+  void PositionGroupsIter() {
+    if (!groups_iter_positioned_) {
+      groups_iter_.Seek(GroupListKey(group_));
+      groups_iter_positioned_ = true;
+    }
+  }
+
+  // Moves to the first entry of the first non empty group after the current one.
+  void MoveToNextGroup() {
+    PositionGroupsIter();
+    if (groups_iter_.Valid() && GroupFromListKey(groups_iter_.key()) == group_) {
+      groups_iter_.Next();
+    }
+    SkipEmptyGroupsForward();
+  }
+
+  void SkipEmptyGroupsForward() {
+    groups_iter_positioned_ = true;
+    for (; groups_iter_.Valid(); groups_iter_.Next()) {
+      group_ = GroupFromListKey(groups_iter_.key());
+      entries_iter_.SetList(&group_->entries);
+      entries_iter_.SeekToFirst();
+      if (entries_iter_.Valid()) {
+        return;
+      }
+    }
+    group_ = nullptr;
+  }
+
+  void SkipEmptyGroupsBackward() {
+    groups_iter_positioned_ = true;
+    for (; groups_iter_.Valid(); groups_iter_.Prev()) {
+      group_ = GroupFromListKey(groups_iter_.key());
+      entries_iter_.SetList(&group_->entries);
+      entries_iter_.SeekToLast();
+      if (entries_iter_.Valid()) {
+        return;
+      }
+    }
+    group_ = nullptr;
+  }
+
+  const PrefixSkipListRep& rep_;
+  GroupList::Iterator groups_iter_;
+  EntryList::Iterator entries_iter_;
+  PrefixGroup* group_ = nullptr;
+  // Whether groups_iter_ points to group_, group_ could be found via hash table without
+  // positioning groups_iter_.
+  bool groups_iter_positioned_ = false;
+  std::string tmp_; // For passing to EncodeKey
+};
+
+MemTableRep::Iterator* PrefixSkipListRep::GetIterator(Arena* arena) {
+  void* mem = arena ? arena->AllocateAligned(sizeof(PrefixSkipListRep::Iterator))
+                    : operator new(sizeof(PrefixSkipListRep::Iterator));
+  return new (mem) PrefixSkipListRep::Iterator(this);
+}
+
+} // namespace
+
+MemTableRep* PrefixSkipListRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, MemTableAllocator* allocator,
+    const SliceTransform* transform, Logger* logger) {
+  return new PrefixSkipListRep(
+      compare, allocator, prefix_extractor_ ? prefix_extractor_.get() : transform, bucket_count_,
+      prefix_skiplist_height_);
+}
+
+MemTableRepFactory* NewPrefixSkipListRepFactory(
+    std::shared_ptr<const SliceTransform> prefix_extractor, size_t bucket_count,
+    int32_t prefix_skiplist_height) {
+  return new PrefixSkipListRepFactory(
+      std::move(prefix_extractor), bucket_count, prefix_skiplist_height);
+}
+
+} // namespace rocksdb
+#endif  // ROCKSDB_LITE
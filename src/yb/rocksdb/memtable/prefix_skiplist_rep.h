@@ -0,0 +1,52 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+
+#include "yb/rocksdb/slice_transform.h"
+#include "yb/rocksdb/memtablerep.h"
+
+namespace rocksdb {
+
+class PrefixSkipListRepFactory : public MemTableRepFactory {
+ public:
+  PrefixSkipListRepFactory(
+      std::shared_ptr<const SliceTransform> prefix_extractor,
+      size_t bucket_count,
+      int32_t prefix_skiplist_height)
+      : prefix_extractor_(std::move(prefix_extractor)),
+        bucket_count_(bucket_count),
+        prefix_skiplist_height_(prefix_skiplist_height) {}
+
+  MemTableRep* CreateMemTableRep(
+      const MemTableRep::KeyComparator& compare, MemTableAllocator* allocator,
+      const SliceTransform* transform, Logger* logger) override;
+
+  const char* Name() const override {
+    return "PrefixSkipListRepFactory";
+  }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+ private:
+  const std::shared_ptr<const SliceTransform> prefix_extractor_;
+  const size_t bucket_count_;
+  const int32_t prefix_skiplist_height_;
+};
+
+} // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
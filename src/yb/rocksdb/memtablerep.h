@@ -312,6 +312,22 @@ extern MemTableRepFactory* NewHashSkipListRepFactory(
     int32_t skiplist_branching_factor = 4
 );
 
+// This factory creates memtables that group entries by key prefix, e.g. by DocDB document.
+// Entries of every group are kept in a separate small skip list. Groups are found by a hash table
+// and ordered by an additional skip list, so unlike other hash based memtables total order
+// iteration is supported and prefix_extractor is not required to be set in options.
+// Inserts and point lookups only compare keys of a single group.
+// prefix_extractor should be consistent with the key order: any key that starts with a prefix
+// returned by the extractor should have the same prefix. Keys outside of the extractor domain form
+// groups of their own.
+// @prefix_extractor: used to split keys into groups. When null, transform passed to
+//                    CreateMemTableRep is used.
+// @bucket_count: number of fixed array buckets of the hash table
+// @prefix_skiplist_height: the max height of the skip lists of individual groups
+extern MemTableRepFactory* NewPrefixSkipListRepFactory(
+    std::shared_ptr<const SliceTransform> prefix_extractor = nullptr,
+    size_t bucket_count = 65536, int32_t prefix_skiplist_height = 6);
+
 // The factory is to create memtables based on a hash table:
 // it contains a fixed array of buckets, each pointing to either a linked list
 // or a skip list if number of entries inside the bucket exceeds
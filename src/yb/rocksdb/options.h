@@ -96,7 +96,8 @@ enum CompressionType : char {
   kBZip2Compression = 0x3,
   kLZ4Compression = 0x4,
   kLZ4HCCompression = 0x5,
-  // zstd format is not finalized yet so it's subject to changes.
+  kZSTD = 0x7,
+  // Blocks written before ZSTD support was finalized, decompressed the same way as kZSTD.
   kZSTDNotFinalCompression = 0x40,
 };
 
@@ -171,9 +172,17 @@ struct CompressionOptions {
   int window_bits;
   int level;
   int strategy;
-  CompressionOptions() : window_bits(-14), level(-1), strategy(0) {}
-  CompressionOptions(int wbits, int _lev, int _strategy)
-      : window_bits(wbits), level(_lev), strategy(_strategy) {}
+  // Maximal size of ZSTD dictionary trained for each SST file, 0 disables dictionary compression.
+  // Dictionary is trained on the first data blocks of the file, which are kept in memory
+  // uncompressed until zstd_max_train_bytes of samples are collected.
+  uint32_t max_dict_bytes;
+  // Maximal size of dictionary training samples, 0 means 100 times max_dict_bytes.
+  uint32_t zstd_max_train_bytes;
+  CompressionOptions()
+      : window_bits(-14), level(-1), strategy(0), max_dict_bytes(0), zstd_max_train_bytes(0) {}
+  CompressionOptions(int wbits, int _lev, int _strategy, uint32_t _max_dict_bytes = 0)
+      : window_bits(wbits), level(_lev), strategy(_strategy), max_dict_bytes(_max_dict_bytes),
+        zstd_max_train_bytes(0) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
@@ -1025,6 +1034,10 @@ struct DBOptions {
   // Default: 1 (i.e. no subcompactions)
   uint32_t max_subcompactions;
 
+  // Single level universal compaction is split into subcompactions only when each of them would
+  // get at least this amount of input data.
+  uint64_t min_subcompaction_input_size = 1ULL << 30;
+
   // Maximum number of concurrent background memtable flush jobs, submitted to
   // the HIGH priority thread pool.
   //
@@ -1341,6 +1354,11 @@ struct DBOptions {
 
   std::shared_ptr<CompactionContextFactory> compaction_context_factory;
 
+  // When set, subcompaction boundaries are moved to the start of the prefix produced by this
+  // transform, so keys sharing such prefix are always processed by the same subcompaction.
+  // Boundary keys outside of the transform domain are not used.
+  std::shared_ptr<const SliceTransform> subcompaction_boundary_transform;
+
   // Function that returns max file size for compaction.
   // Supported only for level0 of universal style compactions.
   std::shared_ptr<std::function<uint64_t()>> max_file_size_for_compaction;
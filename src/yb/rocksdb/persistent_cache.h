@@ -0,0 +1,73 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+// PersistentCache is a second tier of the block cache, that keeps raw SST blocks outside of memory,
+// for instance on a local SSD, when the cloud volume holding SST files is much slower.
+// Blocks are stored as they are in SST files, i.e. compressed when SST file is compressed.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "yb/rocksdb/status.h"
+
+#include "yb/util/result.h"
+#include "yb/util/slice.h"
+
+namespace yb {
+class MemTracker;
+}
+
+namespace rocksdb {
+
+class Env;
+
+class PersistentCache {
+ public:
+  virtual ~PersistentCache() = default;
+
+  // Stores block contents under the specified key. Cache could silently drop the block.
+  virtual Status Insert(const Slice& key, const Slice& data) = 0;
+
+  // Reads block contents stored under the specified key. Returns NotFound when there is no such
+  // block in cache.
+  virtual Status Lookup(const Slice& key, std::unique_ptr<char[]>* data, size_t* size) = 0;
+
+  // Returns number of bytes used by cached blocks.
+  virtual size_t GetUsage() const = 0;
+
+  virtual size_t GetCapacity() const = 0;
+};
+
+struct FilePersistentCacheOptions {
+  Env* env = nullptr;
+
+  // Directory for cache files. Blocks found in this directory are reused when cache is opened.
+  std::string path;
+
+  // Maximal total size of cache files.
+  size_t capacity = 0;
+
+  // Size of single cache file. Cache is evicted by deleting whole files, oldest first.
+  size_t file_size = 64 * 1024 * 1024;
+
+  // Tracks memory used by in-memory index of cached blocks.
+  std::shared_ptr<yb::MemTracker> mem_tracker;
+};
+
+// Opens persistent cache that appends blocks to files in options.path. In-memory index is
+// rebuilt from existing cache files, so cached blocks survive restart.
+yb::Result<std::shared_ptr<PersistentCache>> NewFilePersistentCache(
+    const FilePersistentCacheOptions& options);
+
+}  // namespace rocksdb
@@ -25,6 +25,7 @@ class CompactionFeed;
 class DB;
 class Env;
 class MemTable;
+class SstFileWriter;
 class Statistics;
 class UserFrontiers;
 class WriteBatch;
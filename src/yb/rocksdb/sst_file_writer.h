@@ -24,6 +24,7 @@
 #include <string>
 #include "yb/rocksdb/env.h"
 #include "yb/rocksdb/immutable_options.h"
+#include "yb/rocksdb/metadata.h"
 #include "yb/rocksdb/types.h"
 
 namespace rocksdb {
@@ -65,6 +66,15 @@ struct ExternalSstFileInfo {
   bool is_split_sst;               // is SST split into metadata and data file(s)
   uint64_t num_entries;            // number of entries in file
   int32_t version;                 // file version
+
+  // Allows key range of the file to overlap with keys already present in DB.
+  // Should be used only when user keys of the file are known to be absent from DB, or present with
+  // the same values. Since all keys of the file have zero sequence number.
+  bool allow_overlapping_range = false;
+
+  // User frontiers to attach to the added file, could be null.
+  UserFrontierPtr smallest_frontier;
+  UserFrontierPtr largest_frontier;
 };
 
 // SstFileWriter is used to create sst files that can be added to database later
@@ -216,6 +216,10 @@ enum Tickers : uint32_t {
   COMPACTION_FILES_FILTERED,
   COMPACTION_FILES_NOT_FILTERED,
 
+  // Persistent (second tier) block cache statistics.
+  PERSISTENT_CACHE_HIT,
+  PERSISTENT_CACHE_MISS,
+
   // End of ticker enum.
   TICKER_ENUM_MAX,
 };
@@ -319,6 +323,9 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
 
     {COMPACTION_FILES_FILTERED, "rocksdb_compaction_files_filtered"},
     {COMPACTION_FILES_NOT_FILTERED, "rocksdb_compaction_files_not_filtered"},
+
+    {PERSISTENT_CACHE_HIT, "rocksdb_persistent_cache_hit"},
+    {PERSISTENT_CACHE_MISS, "rocksdb_persistent_cache_miss"},
 };
 
 /**
@@ -35,6 +35,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/status.h"
@@ -46,6 +47,7 @@ namespace rocksdb {
 
 // -- Block-based Table
 class FlushBlockPolicyFactory;
+class PersistentCache;
 struct TableReaderOptions;
 struct TableBuilderOptions;
 class TableBuilder;
@@ -121,6 +123,11 @@ struct BlockBasedTableOptions {
   // If NULL, rocksdb will not use a compressed block cache.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If non-NULL, blocks read from SST files are stored in this cache as they are in the file,
+  // and looked up there before reading SST file. Used as a second tier of block cache on a fast
+  // local disk.
+  std::shared_ptr<PersistentCache> persistent_cache = nullptr;
+
   // Approximate size of user data packed per block, in bytes. Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -428,6 +435,13 @@ class TableFactory {
   // DocDbAwareFilterPolicy and HashedComponentsExtractor.
   virtual std::shared_ptr<TableAwareReadFileFilter> NewTableAwareReadFileFilter(
       const ReadOptions &read_options, const Slice &user_key) const { return nullptr; }
+
+  // Returns SST file filter for pruning out files which doesn't contain any of user_keys. Has the
+  // same restrictions as NewTableAwareReadFileFilter.
+  virtual std::shared_ptr<TableAwareReadFileFilter> NewTableAwareMultiKeyReadFileFilter(
+      const ReadOptions &read_options, const std::vector<Slice> &user_keys) const {
+    return nullptr;
+  }
 };
 
 #ifndef ROCKSDB_LITE
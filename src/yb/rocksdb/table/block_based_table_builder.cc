@@ -107,10 +107,12 @@ bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
 }
 
 // format_version is the block format as defined in include/rocksdb/table.h
+// compression_dict is used by ZSTD when not null.
 Slice CompressBlock(const Slice& raw,
                     const CompressionOptions& compression_options,
                     CompressionType* type, uint32_t format_version,
-                    std::string* compressed_output) {
+                    std::string* compressed_output,
+                    const CompressionDict* compression_dict) {
   if (*type == kNoCompression) {
     return raw;
   }
@@ -161,9 +163,10 @@ Slice CompressBlock(const Slice& raw,
         return *compressed_output;
       }
       break;     // fall back to no compression.
+    case kZSTD:
     case kZSTDNotFinalCompression:
       if (ZSTD_Compress(compression_options, raw.cdata(), raw.size(),
-                        compressed_output) &&
+                        compressed_output, compression_dict) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -301,6 +304,19 @@ struct BlockBasedTableBuilder::Rep {
   std::string compressed_output;
   std::unique_ptr<FlushBlockPolicy> flush_block_policy;
 
+  // When ZSTD dictionary compression is enabled, data blocks are kept uncompressed in memory until
+  // enough samples are collected to train the dictionary. Index entries are added only when
+  // buffered blocks are written, since block handles are not known before that.
+  struct BufferedDataBlock {
+    std::string contents;
+    std::string last_key;
+    std::string next_block_first_key;
+  };
+  bool buffer_data_blocks = false;
+  std::vector<BufferedDataBlock> buffered_data_blocks;
+  size_t buffered_data_size = 0;
+  std::unique_ptr<CompressionDict> compression_dict;
+
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
   yb::MemTrackerPtr mem_tracker;
@@ -386,6 +402,14 @@ BlockBasedTableBuilder::Rep::Rep(
         "BlockBasedTableBuilder", _ioptions.mem_tracker);
   }
 
+  // Hash index collects key prefixes per data block and block based filter is split at data
+  // block boundaries, so both require data blocks to be written in the order they are built.
+  buffer_data_blocks =
+      (compression_type == kZSTD || compression_type == kZSTDNotFinalCompression) &&
+      compression_opts.max_dict_bytes > 0 && ZSTD_Supported() &&
+      table_options.index_type != IndexType::kHashSearch &&
+      filter_type != FilterType::kBlockBasedFilter;
+
   metadata_writer = std::make_shared<FileWriterWithOffsetAndCachePrefix>();
   metadata_writer->writer = metadata_file;
   if (data_file != nullptr) {
@@ -500,10 +524,21 @@ void BlockBasedTableBuilder::FlushDataBlock(const Slice& next_block_first_key) {
   if (!ok()) return;
   size_t data_block_size = 0;
 
+  if (r->buffer_data_blocks) {
+    BufferDataBlock(next_block_first_key);
+    return;
+  }
+
   if (!r->data_block_builder.empty()) {
     data_block_size = WriteBlock(&r->data_block_builder, &r->data_pending_handle,
-        r->data_writer.get());
+        r->data_writer.get(), r->compression_dict.get());
   }
+  AddDataBlockToIndex(data_block_size, &r->last_key, next_block_first_key);
+}
+
+void BlockBasedTableBuilder::AddDataBlockToIndex(
+    size_t data_block_size, std::string* last_key, const Slice& next_block_first_key) {
+  Rep* const r = rep_;
   if (!ok()) return;
 
   if (!r->table_options.skip_table_builder_flush) {
@@ -526,7 +561,7 @@ void BlockBasedTableBuilder::FlushDataBlock(const Slice& next_block_first_key) {
   // "the r" as the key for the index block entry since it is >= all
   // entries in the first block and < all entries in subsequent
   // blocks.
-  r->data_index_builder->AddIndexEntry(&r->last_key,
+  r->data_index_builder->AddIndexEntry(last_key,
       next_block_first_key.empty() ? nullptr : &next_block_first_key,
       r->data_pending_handle);
   while (r->data_index_builder->ShouldFlush()) {
@@ -545,6 +580,58 @@ void BlockBasedTableBuilder::FlushDataBlock(const Slice& next_block_first_key) {
   }
 }
 
+void BlockBasedTableBuilder::BufferDataBlock(const Slice& next_block_first_key) {
+  Rep* const r = rep_;
+  if (!r->data_block_builder.empty()) {
+    r->buffered_data_blocks.push_back(Rep::BufferedDataBlock {
+      .contents = r->data_block_builder.Finish().ToBuffer(),
+      .last_key = r->last_key,
+      .next_block_first_key = next_block_first_key.ToBuffer(),
+    });
+    r->data_block_builder.Reset();
+    r->buffered_data_size += r->buffered_data_blocks.back().contents.size();
+  }
+
+  const size_t max_train_bytes = r->compression_opts.zstd_max_train_bytes > 0
+      ? r->compression_opts.zstd_max_train_bytes
+      : r->compression_opts.max_dict_bytes * 100ULL;
+  if (r->buffered_data_size >= max_train_bytes) {
+    EnterUnbuffered();
+  }
+}
+
+void BlockBasedTableBuilder::EnterUnbuffered() {
+  Rep* const r = rep_;
+  r->buffer_data_blocks = false;
+
+  std::string samples;
+  samples.reserve(r->buffered_data_size);
+  std::vector<size_t> sample_lengths;
+  sample_lengths.reserve(r->buffered_data_blocks.size());
+  for (const auto& block : r->buffered_data_blocks) {
+    samples.append(block.contents);
+    sample_lengths.push_back(block.contents.size());
+  }
+  auto dict = ZSTD_TrainDictionary(samples, sample_lengths, r->compression_opts.max_dict_bytes);
+  if (!dict.empty()) {
+    r->compression_dict = std::make_unique<CompressionDict>(std::move(dict), r->compression_opts);
+  } else {
+    RLOG(InfoLogLevel::INFO_LEVEL, r->ioptions.info_log,
+        "Failed to train compression dictionary on %" ROCKSDB_PRIszt " blocks, compressing "
+        "without dictionary", sample_lengths.size());
+  }
+  samples = std::string();
+
+  for (auto& block : r->buffered_data_blocks) {
+    if (!ok()) break;
+    auto data_block_size = WriteBlock(block.contents, &r->data_pending_handle,
+        r->data_writer.get(), r->compression_dict.get());
+    AddDataBlockToIndex(data_block_size, &block.last_key, block.next_block_first_key);
+  }
+  r->buffered_data_blocks = std::vector<Rep::BufferedDataBlock>();
+  r->buffered_data_size = 0;
+}
+
 void BlockBasedTableBuilder::FlushFilterBlock(const Slice* const next_block_first_filter_key) {
   Rep* const r = rep_;
   assert(!r->closed);
@@ -575,15 +662,17 @@ void BlockBasedTableBuilder::FlushFilterBlock(const Slice* const next_block_firs
 
 size_t BlockBasedTableBuilder::WriteBlock(BlockBuilder* block,
                                           BlockHandle* handle,
-                                          FileWriterWithOffsetAndCachePrefix* writer_info) {
-  size_t block_size = WriteBlock(block->Finish(), handle, writer_info);
+                                          FileWriterWithOffsetAndCachePrefix* writer_info,
+                                          const CompressionDict* compression_dict) {
+  size_t block_size = WriteBlock(block->Finish(), handle, writer_info, compression_dict);
   block->Reset();
   return block_size;
 }
 
 size_t BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
     BlockHandle* handle,
-    FileWriterWithOffsetAndCachePrefix* writer_info) {
+    FileWriterWithOffsetAndCachePrefix* writer_info,
+    const CompressionDict* compression_dict) {
   // File format contains a sequence of blocks where each block has:
   //    block_data: uint8[n]
   //    type: uint8
@@ -596,7 +685,8 @@ size_t BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   if (raw_block_contents.size() < kCompressionSizeLimit) {
     block_contents =
         CompressBlock(raw_block_contents, r->compression_opts, &type,
-                      r->table_options.format_version, &r->compressed_output);
+                      r->table_options.format_version, &r->compressed_output,
+                      compression_dict);
   } else {
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
     type = kNoCompression;
@@ -717,6 +807,10 @@ Status BlockBasedTableBuilder::Finish() {
   if (!r->data_block_builder.empty()) {
     FlushDataBlock(end_slice);  // no more data block
   }
+  if (r->buffer_data_blocks) {
+    // Table is smaller than dictionary training limit, so train on all of its blocks.
+    EnterUnbuffered();
+  }
   if (r->filter_block_builder != nullptr) {
     FlushFilterBlock(nullptr);  // no more filter block
   }
@@ -743,6 +837,13 @@ Status BlockBasedTableBuilder::Finish() {
     meta_index_builder.Add(item.first, block_handle);
   }
 
+  if (ok() && r->compression_dict) {
+    BlockHandle compression_dict_block_handle;
+    WriteRawBlock(r->compression_dict->data(), kNoCompression, &compression_dict_block_handle,
+        r->metadata_writer.get());
+    meta_index_builder.Add(kCompressionDictBlock, compression_dict_block_handle);
+  }
+
   if (ok()) {
     if (r->filter_block_builder != nullptr) {
       // Add mapping from "<filter_block_prefix>.Name" to location of either filter block or
@@ -865,8 +966,10 @@ uint64_t BlockBasedTableBuilder::NumEntries() const {
 }
 
 uint64_t BlockBasedTableBuilder::TotalFileSize() const {
-  return rep_->is_split_sst() ? rep_->metadata_writer->offset + rep_->data_writer->offset :
-      rep_->metadata_writer->offset;
+  // Buffered data blocks are accounted uncompressed, so output files are not split too late while
+  // compression dictionary is being collected.
+  return (rep_->is_split_sst() ? rep_->metadata_writer->offset + rep_->data_writer->offset :
+      rep_->metadata_writer->offset) + rep_->buffered_data_size;
 }
 
 uint64_t BlockBasedTableBuilder::BaseFileSize() const {
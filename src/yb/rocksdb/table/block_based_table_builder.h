@@ -40,6 +40,7 @@ namespace rocksdb {
 
 class BlockBuilder;
 class BlockHandle;
+class CompressionDict;
 class WritableFile;
 struct BlockBasedTableOptions;
 
@@ -113,11 +114,15 @@ class BlockBasedTableBuilder : public TableBuilder {
   bool ok() const { return status().ok(); }
   // Call block's Finish() method and then write the finalize block contents to
   // file. Returns number of bytes written to file.
+  // compression_dict should be passed only for data blocks, since readers of index, filter and
+  // meta blocks don't use the dictionary.
   size_t WriteBlock(BlockBuilder* block, BlockHandle* handle,
-                    FileWriterWithOffsetAndCachePrefix* writer_info);
+                    FileWriterWithOffsetAndCachePrefix* writer_info,
+                    const CompressionDict* compression_dict = nullptr);
   // Directly write block content to the file. Returns number of bytes written to file.
   size_t WriteBlock(const Slice& block_contents, BlockHandle* handle,
-      FileWriterWithOffsetAndCachePrefix* writer_info);
+      FileWriterWithOffsetAndCachePrefix* writer_info,
+      const CompressionDict* compression_dict = nullptr);
   size_t WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle,
       FileWriterWithOffsetAndCachePrefix* writer_info);
   Status InsertBlockInCache(const Slice& block_contents,
@@ -135,6 +140,16 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called.
   void FlushDataBlock(const Slice& next_block_first_key);
 
+  // Adds index entry for the data block that was just written to disk.
+  void AddDataBlockToIndex(
+      size_t data_block_size, std::string* last_key, const Slice& next_block_first_key);
+
+  // Keeps the current data block in memory as a sample for compression dictionary training.
+  void BufferDataBlock(const Slice& next_block_first_key);
+
+  // Trains compression dictionary on buffered data blocks, then writes them compressed with it.
+  void EnterUnbuffered();
+
   // Flush the current filter block into disk. next_block_first_filter_key should be nullptr if this
   // is the last block written to disk.
   // REQUIRES: Finish(), Abandon() have not been called.
@@ -32,14 +32,15 @@ constexpr char kFixedSizeFilterBlockPrefix[] = "fixedsizefilter.";
 // The only relevant option is options.verify_checksums for now.
 // On failure return non-OK.
 // On success fill *result and return OK - caller owns *result
+// uncompression_dict should be set only for data blocks of an SST file with ZSTD dictionary.
 inline Status ReadBlockFromFile(
     RandomAccessFileReader* file, const Footer& footer, const ReadOptions& options,
     const BlockHandle& handle, std::unique_ptr<Block>* result, Env* env,
     const std::shared_ptr<yb::MemTracker>& mem_tracker,
-    bool do_uncompress = true) {
+    bool do_uncompress = true, const UncompressionDict* uncompression_dict = nullptr) {
   BlockContents contents;
   Status s = ReadBlockContents(file, footer, options, handle, &contents, env,
-                               mem_tracker, do_uncompress);
+                               mem_tracker, do_uncompress, uncompression_dict);
   if (s.ok()) {
     result->reset(new Block(std::move(contents)));
   }
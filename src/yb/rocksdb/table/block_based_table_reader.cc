@@ -23,8 +23,10 @@
 
 #include "yb/rocksdb/table/block_based_table_reader.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "yb/gutil/macros.h"
 
@@ -35,6 +37,7 @@
 #include "yb/rocksdb/filter_policy.h"
 #include "yb/rocksdb/iterator.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/persistent_cache.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/table/block.h"
@@ -55,6 +58,7 @@
 #include "yb/rocksdb/table/two_level_iterator.h"
 #include "yb/rocksdb/table_properties.h"
 #include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/compression.h"
 #include "yb/rocksdb/util/file_reader_writer.h"
 #include "yb/rocksdb/util/perf_context_imp.h"
 #include "yb/rocksdb/util/statistics.h"
@@ -67,6 +71,7 @@
 #include "yb/util/scope_exit.h"
 #include "yb/util/stats/perf_step_timer.h"
 #include "yb/util/status_format.h"
+#include "yb/util/status_log.h"
 #include "yb/util/string_util.h"
 
 namespace rocksdb {
@@ -150,6 +155,10 @@ struct BlockBasedTable::FileReaderWithCachePrefix {
   // Similar prefix, but for compressed blocks cache:
   block_based_table::CacheKeyPrefixBuffer compressed_cache_key_prefix;
 
+  // Prefix for persistent cache. Since persistent cache survives restart, it is only generated
+  // from the file unique id, and persistent cache is not used when the file does not have one.
+  block_based_table::CacheKeyPrefixBuffer persistent_cache_key_prefix;
+
   explicit FileReaderWithCachePrefix(unique_ptr<RandomAccessFileReader>&& _reader) :
       reader(std::move(_reader)) {}
 };
@@ -241,6 +250,9 @@ struct BlockBasedTable::Rep {
   // block to extract prefix without knowing if a key is internal or not.
   unique_ptr<SliceTransform> internal_prefix_transform;
 
+  // ZSTD dictionary used to compress data blocks, loaded on open when SST file has one.
+  std::unique_ptr<UncompressionDict> uncompression_dict;
+
   DataIndexLoadMode data_index_load_mode = static_cast<DataIndexLoadMode>(0);
   yb::MemTrackerPtr mem_tracker;
 };
@@ -303,6 +315,7 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep,
     FileReaderWithCachePrefix* reader_with_cache_prefix) {
   reader_with_cache_prefix->cache_key_prefix.size = 0;
   reader_with_cache_prefix->compressed_cache_key_prefix.size = 0;
+  reader_with_cache_prefix->persistent_cache_key_prefix.size = 0;
   if (rep->table_options.block_cache != nullptr) {
     GenerateCachePrefix(rep->table_options.block_cache.get(),
         reader_with_cache_prefix->reader->file(),
@@ -313,6 +326,11 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep,
         reader_with_cache_prefix->reader->file(),
         &reader_with_cache_prefix->compressed_cache_key_prefix);
   }
+  if (rep->table_options.persistent_cache != nullptr) {
+    reader_with_cache_prefix->persistent_cache_key_prefix.size =
+        reader_with_cache_prefix->reader->file()->GetUniqueId(
+            reader_with_cache_prefix->persistent_cache_key_prefix.data);
+  }
 }
 
 KeyValueEncodingFormat BlockBasedTable::GetKeyValueEncodingFormat(
@@ -366,6 +384,33 @@ bool BloomFilterAwareFileFilter::Filter(TableReader* reader) const {
   }
 }
 
+BloomFilterAwareMultiKeyFileFilter::BloomFilterAwareMultiKeyFileFilter(
+    const ReadOptions& read_options, const std::vector<Slice>& user_keys)
+    : read_options_(read_options) {
+  user_keys_.reserve(user_keys.size());
+  for (const auto& user_key : user_keys) {
+    user_keys_.push_back(user_key.ToBuffer());
+  }
+  // Slices are created after all keys are stored, so they are not invalidated by reallocation.
+  user_key_slices_.reserve(user_keys_.size());
+  for (const auto& user_key : user_keys_) {
+    user_key_slices_.emplace_back(user_key);
+  }
+}
+
+bool BloomFilterAwareMultiKeyFileFilter::Filter(TableReader* reader) const {
+  if (user_key_slices_.empty()) {
+    return true;
+  }
+  auto table = down_cast<BlockBasedTable*>(reader);
+  const auto num_keys = user_key_slices_.size();
+  std::unique_ptr<bool[]> may_match(new bool[num_keys]);
+  table->MultiUserKeyMayMatch(read_options_, num_keys, user_key_slices_.data(), may_match.get());
+  const bool use_file = std::any_of(
+      may_match.get(), may_match.get() + num_keys, [](bool value) { return value; });
+  return use_file;
+}
+
 namespace {
 // Return True if table_properties has `user_prop_name` has a `true` value
 // or it doesn't contain this property (for backward compatible).
@@ -434,6 +479,8 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
 
   RETURN_NOT_OK(new_table->ReadPropertiesBlock(meta_iter.get()));
 
+  RETURN_NOT_OK(new_table->ReadCompressionDictBlock(meta_iter.get()));
+
   RETURN_NOT_OK(new_table->SetupFilter(meta_iter.get()));
 
   if (data_index_load_mode == DataIndexLoadMode::PRELOAD_ON_OPEN) {
@@ -576,6 +623,21 @@ Status BlockBasedTable::ReadPropertiesBlock(InternalIterator* meta_iter) {
   return Status::OK();
 }
 
+Status BlockBasedTable::ReadCompressionDictBlock(InternalIterator* meta_iter) {
+  BlockHandle handle;
+  if (!FindMetaBlock(meta_iter, kCompressionDictBlock, &handle).ok()) {
+    // SST file was written without compression dictionary.
+    return Status::OK();
+  }
+
+  BlockContents contents;
+  RETURN_NOT_OK(ReadBlockContents(
+      rep_->base_reader_with_cache_prefix->reader.get(), rep_->footer, ReadOptions::kDefault,
+      handle, &contents, rep_->ioptions.env, rep_->mem_tracker, /* do_uncompress= */ false));
+  rep_->uncompression_dict = std::make_unique<UncompressionDict>(contents.data.ToBuffer());
+  return Status::OK();
+}
+
 Status BlockBasedTable::SetupFilter(InternalIterator* meta_iter) {
   // Find filter handle and filter type.
   if (!rep_->filter_policy) {
@@ -698,6 +760,9 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (data_index_reader) {
     usage += data_index_reader->ApproximateMemoryUsage();
   }
+  if (rep_->uncompression_dict) {
+    usage += rep_->uncompression_dict->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
@@ -762,7 +827,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
     Cache* block_cache, Cache* block_cache_compressed, Statistics* statistics,
     const ReadOptions& read_options, BlockBasedTable::CachableEntry<Block>* block,
     uint32_t format_version, BlockType block_type,
-    const std::shared_ptr<yb::MemTracker>& mem_tracker) {
+    const std::shared_ptr<yb::MemTracker>& mem_tracker,
+    const UncompressionDict* uncompression_dict) {
   Status s;
   Block* compressed_block = nullptr;
   Cache::Handle* block_cache_compressed_handle = nullptr;
@@ -806,7 +872,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
   // Retrieve the uncompressed contents into a new buffer
   BlockContents contents;
   s = UncompressBlockContents(compressed_block->data(), compressed_block->size(), &contents,
-                              format_version, mem_tracker);
+                              format_version, mem_tracker, uncompression_dict);
 
   // Insert uncompressed block into block cache
   if (s.ok()) {
@@ -834,7 +900,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     Cache* block_cache, Cache* block_cache_compressed,
     const ReadOptions& read_options, Statistics* statistics,
     CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-    const std::shared_ptr<yb::MemTracker>& mem_tracker) {
+    const std::shared_ptr<yb::MemTracker>& mem_tracker,
+    const UncompressionDict* uncompression_dict) {
   assert(raw_block->compression_type() == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -843,7 +910,7 @@ Status BlockBasedTable::PutDataBlockToCache(
   BlockContents contents;
   if (raw_block->compression_type() != kNoCompression) {
     s = UncompressBlockContents(raw_block->data(), raw_block->size(), &contents,
-                                format_version, mem_tracker);
+                                format_version, mem_tracker, uncompression_dict);
   }
   if (!s.ok()) {
     delete raw_block;
@@ -934,9 +1001,11 @@ FilterBlockReader* BlockBasedTable::ReadFilterBlock(const BlockHandle& filter_ha
           rep->whole_key_filtering, std::move(block), filter_bits_reader);
     }
     case FilterType::kFixedSizeFilter:
+      // rep->filter_policy could differ from the table_options.filter_policy when the file was
+      // written using one of supported_filter_policies.
       return new FixedSizeFilterBlockReader(
           rep->prefix_filtering ? rep->ioptions.prefix_extractor : nullptr,
-          rep->table_options, rep->whole_key_filtering, std::move(block));
+          rep->filter_policy, rep->whole_key_filtering, std::move(block));
       break;
   }
   RLOG(InfoLogLevel::FATAL_LEVEL, rep->ioptions.info_log, "Corrupted filter_type: %d",
@@ -1032,10 +1101,19 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     filter_block_handle = &rep_->filter_handle;
   }
 
+  return GetFilterBlock(query_id, no_io, *filter_block_handle);
+}
+
+BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilterBlock(
+    const QueryId query_id,
+    bool no_io,
+    const BlockHandle& filter_block_handle) const {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+
   // Fetching from the cache
   char cache_key_buffer[block_based_table::kCacheKeyBufferSize];
   auto filter_block_cache_key = GetCacheKey(rep_->base_reader_with_cache_prefix->cache_key_prefix,
-      *filter_block_handle, cache_key_buffer);
+      filter_block_handle, cache_key_buffer);
 
   Statistics* statistics = rep_->ioptions.statistics;
   auto cache_handle = GetEntryFromCache(block_cache, filter_block_cache_key,
@@ -1051,7 +1129,7 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     // For fixed-size filter we don't prefetch all filter blocks and ignore no_io parameter always
     // loading necessary filter block through block cache.
     size_t filter_size = 0;
-    filter = ReadFilterBlock(*filter_block_handle, rep_, &filter_size);
+    filter = ReadFilterBlock(filter_block_handle, rep_, &filter_size);
     if (filter != nullptr) {
       assert(filter_size > 0);
       Status s = block_cache->Insert(filter_block_cache_key, query_id,
@@ -1183,6 +1261,9 @@ yb::Result<BlockBasedTable::CachableEntry<Block>> BlockBasedTable::RetrieveBlock
   RETURN_NOT_OK(handle.DecodeFrom(&input));
 
   FileReaderWithCachePrefix* reader = GetBlockReader(block_type);
+  // Only data blocks are compressed with the dictionary.
+  const UncompressionDict* uncompression_dict =
+      block_type == BlockType::kData ? rep_->uncompression_dict.get() : nullptr;
 
   // If either block cache is enabled, we'll try to read from it.
   if (PREDICT_TRUE(use_cache) && (block_cache != nullptr || block_cache_compressed != nullptr)) {
@@ -1203,20 +1284,22 @@ yb::Result<BlockBasedTable::CachableEntry<Block>> BlockBasedTable::RetrieveBlock
 
     Status status = GetDataBlockFromCache(
         key, ckey, block_cache, block_cache_compressed, statistics, ro, &block,
-        rep_->table_options.format_version, block_type, rep_->mem_tracker);
+        rep_->table_options.format_version, block_type, rep_->mem_tracker,
+        uncompression_dict);
 
     if (block.value == nullptr && !no_io && ro.fill_cache) {
       std::unique_ptr<Block> raw_block;
       {
         StopWatch sw(rep_->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
-        RETURN_NOT_OK(block_based_table::ReadBlockFromFile(
-            reader->reader.get(), rep_->footer, ro, handle, &raw_block, rep_->ioptions.env,
-            rep_->mem_tracker, block_cache_compressed == nullptr));
+        RETURN_NOT_OK(ReadBlockWithPersistentCache(
+            reader, ro, handle, block_cache_compressed == nullptr, uncompression_dict,
+            &raw_block));
       }
 
       RETURN_NOT_OK(PutDataBlockToCache(key, ckey, block_cache, block_cache_compressed,
                                         ro, statistics, &block, raw_block.release(),
-                                        rep_->table_options.format_version, rep_->mem_tracker));
+                                        rep_->table_options.format_version, rep_->mem_tracker,
+                                        uncompression_dict));
       status = Status::OK();
     }
 
@@ -1236,7 +1319,7 @@ yb::Result<BlockBasedTable::CachableEntry<Block>> BlockBasedTable::RetrieveBlock
   std::unique_ptr<Block> block_value;
   RETURN_NOT_OK(block_based_table::ReadBlockFromFile(
       reader->reader.get(), rep_->footer, ro, handle, &block_value, rep_->ioptions.env,
-      rep_->mem_tracker));
+      rep_->mem_tracker, /* do_uncompress= */ true, uncompression_dict));
 
   block.value = block_value.release();
   RSTATUS_DCHECK(block.value, Incomplete, "No data block"); // Not expected to happen.
@@ -1244,6 +1327,54 @@ yb::Result<BlockBasedTable::CachableEntry<Block>> BlockBasedTable::RetrieveBlock
   return block;
 }
 
+Status BlockBasedTable::ReadBlockWithPersistentCache(
+    FileReaderWithCachePrefix* reader, const ReadOptions& ro, const BlockHandle& handle,
+    bool do_uncompress, const UncompressionDict* uncompression_dict,
+    std::unique_ptr<Block>* result) {
+  PersistentCache* persistent_cache = rep_->table_options.persistent_cache.get();
+  if (persistent_cache == nullptr || reader->persistent_cache_key_prefix.size == 0) {
+    return block_based_table::ReadBlockFromFile(
+        reader->reader.get(), rep_->footer, ro, handle, result, rep_->ioptions.env,
+        rep_->mem_tracker, do_uncompress, uncompression_dict);
+  }
+
+  Statistics* statistics = rep_->ioptions.statistics;
+  char cache_key[block_based_table::kCacheKeyBufferSize];
+  Slice key = GetCacheKey(reader->persistent_cache_key_prefix, handle, cache_key);
+  // Persistent cache stores raw block contents followed by compression type byte, since
+  // UncompressBlockContents expects compression type right after the block contents.
+  const size_t raw_size = handle.size() + 1;
+
+  BlockContents contents;
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  if (persistent_cache->Lookup(key, &data, &size).ok() && size == raw_size) {
+    RecordTick(statistics, PERSISTENT_CACHE_HIT);
+    auto compression_type = static_cast<CompressionType>(data[size - 1]);
+    contents = BlockContents(
+        std::move(data), handle.size(), /* cachable= */ true, compression_type,
+        rep_->mem_tracker);
+  } else {
+    RecordTick(statistics, PERSISTENT_CACHE_MISS);
+    RETURN_NOT_OK(ReadBlockContents(
+        reader->reader.get(), rep_->footer, ro, handle, &contents, rep_->ioptions.env,
+        rep_->mem_tracker, /* do_uncompress= */ false));
+    // Without decompression block contents are followed by the block trailer in memory.
+    WARN_NOT_OK(persistent_cache->Insert(key, Slice(contents.data.data(), raw_size)),
+                "Failed to insert block to persistent cache");
+  }
+
+  if (do_uncompress && contents.compression_type != kNoCompression) {
+    BlockContents uncompressed;
+    RETURN_NOT_OK(UncompressBlockContents(
+        contents.data.cdata(), contents.data.size(), &uncompressed, rep_->footer.version(),
+        rep_->mem_tracker, uncompression_dict));
+    contents = std::move(uncompressed);
+  }
+  result->reset(new Block(std::move(contents)));
+  return Status::OK();
+}
+
 yb::Result<std::unique_ptr<Block>> BlockBasedTable::RetrieveBlockFromFile(const ReadOptions& ro,
     const Slice& index_value, const BlockType block_type) {
   auto block = VERIFY_RESULT(RetrieveBlock(ro, index_value, block_type, /* use_cache = */ false));
@@ -1408,6 +1539,131 @@ bool BlockBasedTable::NonBlockBasedFilterKeyMayMatch(FilterBlockReader* filter,
   return true;
 }
 
+bool BlockBasedTable::MultiKeyFilterSupported() const {
+  // We are only using fixed-size bloom filters for DocDB, so no need to support others.
+  // Filter index is only loaded when filter is prefetched at open.
+  return rep_->filter_type == FilterType::kFixedSizeFilter && rep_->filter_policy != nullptr &&
+         rep_->filter_index_reader != nullptr && rep_->table_options.block_cache != nullptr;
+}
+
+void BlockBasedTable::MultiKeyMayMatch(
+    const ReadOptions& read_options, size_t num_keys, const Slice* internal_keys,
+    bool* may_match) {
+  std::fill_n(may_match, num_keys, true);
+  if (!MultiKeyFilterSupported()) {
+    return;
+  }
+
+  std::vector<Slice> filter_keys;
+  filter_keys.reserve(num_keys);
+  for (size_t i = 0; i != num_keys; ++i) {
+    filter_keys.push_back(GetFilterKeyFromInternalKey(internal_keys[i]));
+  }
+  FilterKeysMayMatch(read_options, filter_keys, may_match);
+}
+
+void BlockBasedTable::MultiUserKeyMayMatch(
+    const ReadOptions& read_options, size_t num_keys, const Slice* user_keys, bool* may_match) {
+  std::fill_n(may_match, num_keys, true);
+  if (!MultiKeyFilterSupported()) {
+    return;
+  }
+
+  std::vector<Slice> filter_keys;
+  filter_keys.reserve(num_keys);
+  for (size_t i = 0; i != num_keys; ++i) {
+    filter_keys.push_back(GetFilterKeyFromUserKey(user_keys[i]));
+  }
+  FilterKeysMayMatch(read_options, filter_keys, may_match);
+}
+
+void BlockBasedTable::FilterKeysMayMatch(
+    const ReadOptions& read_options, const std::vector<Slice>& filter_keys, bool* may_match) {
+  // Keys are grouped by filter block, so they should be ordered by filter key.
+  // Empty filter keys always match the filter, so they are not checked.
+  std::vector<size_t> order;
+  order.reserve(filter_keys.size());
+  for (size_t i = 0; i != filter_keys.size(); ++i) {
+    if (!filter_keys[i].empty()) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&filter_keys](size_t lhs, size_t rhs) {
+    return filter_keys[lhs].compare(filter_keys[rhs]) < 0;
+  });
+
+  BlockIter fiter;
+  if (rep_->filter_index_reader->NewIterator(&fiter, /* index_iterator_state = */ nullptr,
+                                             /* total_order_seek = */ true)) {
+    RLOG(InfoLogLevel::ERROR_LEVEL, rep_->ioptions.info_log,
+        "filter_index_reader->NewIterator() is supposed to reuse fiter");
+    FAIL_IF_NOT_PRODUCTION();
+    return;
+  }
+
+  const bool no_io = read_options.read_tier == kBlockCacheTier;
+  auto* statistics = rep_->ioptions.statistics;
+  const auto* prefix_extractor = rep_->ioptions.prefix_extractor;
+  std::vector<Slice> group_keys;
+  std::unique_ptr<bool[]> group_may_match(new bool[order.size()]);
+  size_t group_begin = 0;
+  while (group_begin != order.size()) {
+    // Filter index contains last filter key of each filter block, so all keys not greater than
+    // the found index key belong to the same filter block.
+    fiter.Seek(filter_keys[order[group_begin]]);
+    if (!fiter.Valid()) {
+      // The rest of keys are beyond the index, so they are absent in filter.
+      for (auto it = order.begin() + group_begin; it != order.end(); ++it) {
+        may_match[*it] = false;
+      }
+      RecordTick(statistics, BLOOM_FILTER_CHECKED, order.size() - group_begin);
+      RecordTick(statistics, BLOOM_FILTER_USEFUL, order.size() - group_begin);
+      break;
+    }
+    size_t group_end = group_begin + 1;
+    while (group_end != order.size() &&
+           filter_keys[order[group_end]].compare(fiter.key()) <= 0) {
+      ++group_end;
+    }
+
+    BlockHandle filter_block_handle;
+    Slice filter_block_handle_encoded = fiter.value();
+    auto status = filter_block_handle.DecodeFrom(&filter_block_handle_encoded);
+    if (!status.ok()) {
+      RLOG(InfoLogLevel::ERROR_LEVEL, rep_->ioptions.info_log,
+          "Failed to decode fixed-size filter block handle from filter index: %s",
+          status.ToString().c_str());
+      FAIL_IF_NOT_PRODUCTION();
+      return;
+    }
+    auto filter_entry = GetFilterBlock(read_options.query_id, no_io, filter_block_handle);
+    FilterBlockReader* filter = filter_entry.value;
+    if (filter != nullptr) {
+      const size_t group_size = group_end - group_begin;
+      group_keys.clear();
+      for (size_t i = group_begin; i != group_end; ++i) {
+        group_keys.push_back(filter_keys[order[i]]);
+      }
+      filter->MultiKeyMayMatch(group_size, group_keys.data(), group_may_match.get());
+      size_t useful = 0;
+      for (size_t i = 0; i != group_size; ++i) {
+        const auto& key = group_keys[i];
+        if (group_may_match[i] && prefix_extractor && prefix_extractor->InDomain(key)) {
+          group_may_match[i] = filter->PrefixMayMatch(prefix_extractor->Transform(key));
+        }
+        if (!group_may_match[i]) {
+          may_match[order[group_begin + i]] = false;
+          ++useful;
+        }
+      }
+      RecordTick(statistics, BLOOM_FILTER_CHECKED, group_size);
+      RecordTick(statistics, BLOOM_FILTER_USEFUL, useful);
+    }
+    filter_entry.Release(rep_->table_options.block_cache.get());
+    group_begin = group_end;
+  }
+}
+
 Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& internal_key,
                             GetContext* get_context, bool skip_filters) {
   Status s;
@@ -1560,7 +1816,8 @@ bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
   Slice ckey;
 
   s = GetDataBlockFromCache(cache_key, ckey, block_cache, nullptr, nullptr, options, &block,
-      rep_->table_options.format_version, BlockType::kData, rep_->mem_tracker);
+      rep_->table_options.format_version, BlockType::kData, rep_->mem_tracker,
+      rep_->uncompression_dict.get());
   assert(s.ok());
   bool in_cache = block.value != nullptr;
   if (in_cache) {
@@ -1959,6 +2216,34 @@ yb::Result<std::string> BlockBasedTable::GetMiddleKey() {
       rep_->comparator.get(), MiddlePointPolicy::kMiddleHigh);
 }
 
+yb::Result<std::vector<KeyAnchor>> BlockBasedTable::GetKeyAnchors(uint64_t min_range_size) {
+  // Index keys are not less than keys of the data blocks they point to, so data block boundaries
+  // are used as anchors.
+  std::unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions::kDefault));
+  RETURN_NOT_OK_PREPEND(index_iter->status(), "Index iterator creation failed");
+  std::vector<KeyAnchor> result;
+  uint64_t range_size = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    Slice index_value = index_iter->value();
+    BlockHandle handle;
+    RETURN_NOT_OK(handle.DecodeFrom(&index_value));
+    range_size += handle.size() + kBlockTrailerSize;
+    if (range_size >= min_range_size) {
+      result.push_back(KeyAnchor{index_iter->key().ToBuffer(), range_size});
+      range_size = 0;
+    }
+  }
+  RETURN_NOT_OK(index_iter->status());
+  if (range_size != 0) {
+    index_iter->SeekToLast();
+    RETURN_NOT_OK(index_iter->status());
+    if (index_iter->Valid()) {
+      result.push_back(KeyAnchor{index_iter->key().ToBuffer(), range_size});
+    }
+  }
+  return result;
+}
+
 yb::Result<IndexReaderCleanablePtr> BlockBasedTable::TEST_GetIndexReader() {
   auto index_reader = VERIFY_RESULT(GetIndexReader(ReadOptions::kDefault));
   auto cache = rep_->table_options.block_cache;
@@ -29,6 +29,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "yb/rocksdb/immutable_options.h"
 #include "yb/rocksdb/options.h"
@@ -52,6 +53,7 @@ class InternalKeyComparator;
 class Iterator;
 class TableCache;
 class TableReader;
+class UncompressionDict;
 class WritableFile;
 struct BlockBasedTableOptions;
 struct EnvOptions;
@@ -99,6 +101,22 @@ class BloomFilterAwareFileFilter : public TableAwareReadFileFilter {
   const std::string user_key_;
 };
 
+// BloomFilterAwareMultiKeyFileFilter ignores an SST file completely if bloom filter rejects all of
+// the keys specified in constructor. It has the same restrictions as BloomFilterAwareFileFilter and
+// is used by iterators that look up a batch of keys with different hashed components.
+class BloomFilterAwareMultiKeyFileFilter : public TableAwareReadFileFilter {
+ public:
+  BloomFilterAwareMultiKeyFileFilter(
+      const ReadOptions& read_options, const std::vector<Slice>& user_keys);
+
+  bool Filter(TableReader* reader) const override;
+
+ private:
+  const ReadOptions read_options_;
+  std::vector<std::string> user_keys_;
+  std::vector<Slice> user_key_slices_;
+};
+
 // A Table is a sorted map from strings to strings.  Tables are
 // immutable and persistent.  A Table may be safely accessed from
 // multiple threads without external synchronization.
@@ -154,6 +172,19 @@ class BlockBasedTable : public TableReader {
       const ReadOptions& readOptions, const Slice& key, GetContext* get_context,
       bool skip_filters = false) override;
 
+  // Checks bloom filter for num_keys internal keys at once, may_match[i] is set to false if
+  // internal_keys[i] is definitely absent in this table.
+  // For fixed-size filter, keys are grouped by filter block using the filter index, so each filter
+  // block is looked up once per batch, and filter cache lines of all keys of the group are
+  // prefetched before testing. Other filter types are not checked and always report a match.
+  void MultiKeyMayMatch(
+      const ReadOptions& read_options, size_t num_keys, const Slice* internal_keys,
+      bool* may_match);
+
+  // Same as MultiKeyMayMatch, but for user keys. Used by BloomFilterAwareMultiKeyFileFilter.
+  void MultiUserKeyMayMatch(
+      const ReadOptions& read_options, size_t num_keys, const Slice* user_keys, bool* may_match);
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return return error status in the event of
   // IO or iteration error.
@@ -204,6 +235,8 @@ class BlockBasedTable : public TableReader {
 
   yb::Result<std::string> GetMiddleKey() override;
 
+  yb::Result<std::vector<KeyAnchor>> GetKeyAnchors(uint64_t min_range_size) override;
+
   // Helper function that force reading block from a file and takes care about block cleanup.
   yb::Result<std::unique_ptr<Block>> RetrieveBlockFromFile(const ReadOptions& ro,
       const Slice& index_value, BlockType block_type);
@@ -239,6 +272,13 @@ class BlockBasedTable : public TableReader {
   // Returns key to be added to filter or verified against filter based on user_key.
   Slice GetFilterKeyFromUserKey(const Slice& user_key) const;
 
+  // Whether MultiKeyMayMatch could check keys against filter of this table.
+  bool MultiKeyFilterSupported() const;
+
+  // Implementation of MultiKeyMayMatch for already extracted filter keys.
+  void FilterKeysMayMatch(
+      const ReadOptions& read_options, const std::vector<Slice>& filter_keys, bool* may_match);
+
   // If `no_io == true`, we will not try to read filter/index from sst file (except fixed-size
   // filter blocks) were they not present in cache yet.
   // filter_key is only required when using fixed-size bloom filter in order to use the filter index
@@ -249,6 +289,11 @@ class BlockBasedTable : public TableReader {
                                              bool no_io = false,
                                              const Slice* filter_key = nullptr) const;
 
+  // Returns filter block with the specified handle, using block cache.
+  CachableEntry<FilterBlockReader> GetFilterBlock(const QueryId query_id,
+                                                  bool no_io,
+                                                  const BlockHandle& filter_block_handle) const;
+
   // Returns index reader.
   // If index reader is not stored in either block or internal cache:
   // - If read_options.read_tier == kBlockCacheTier: Status::Incomplete error will be returned.
@@ -264,7 +309,8 @@ class BlockBasedTable : public TableReader {
       Cache* block_cache, Cache* block_cache_compressed, Statistics* statistics,
       const ReadOptions& read_options, BlockBasedTable::CachableEntry<Block>* block,
       uint32_t format_version, BlockType block_type,
-      const std::shared_ptr<yb::MemTracker>& mem_tracker);
+      const std::shared_ptr<yb::MemTracker>& mem_tracker,
+      const UncompressionDict* uncompression_dict);
 
   // Put a raw block (maybe compressed) to the corresponding block caches.
   // This method will perform decompression against raw_block if needed and then
@@ -279,7 +325,8 @@ class BlockBasedTable : public TableReader {
       Cache* block_cache, Cache* block_cache_compressed,
       const ReadOptions& read_options, Statistics* statistics,
       CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-      const std::shared_ptr<yb::MemTracker>& mem_tracker);
+      const std::shared_ptr<yb::MemTracker>& mem_tracker,
+      const UncompressionDict* uncompression_dict);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -302,6 +349,9 @@ class BlockBasedTable : public TableReader {
 
   Status ReadPropertiesBlock(InternalIterator* meta_iter);
 
+  // Loads ZSTD compression dictionary, if SST file has one.
+  Status ReadCompressionDictBlock(InternalIterator* meta_iter);
+
   Status SetupFilter(InternalIterator* meta_iter);
 
   // Read the meta block from sst.
@@ -327,6 +377,13 @@ class BlockBasedTable : public TableReader {
   yb::Result<CachableEntry<Block>> RetrieveBlock(const ReadOptions& ro, const Slice& index_value,
       BlockType block_type, bool use_cache = true);
 
+  // Reads block from persistent cache if it is configured, otherwise or on miss reads block from
+  // file and stores it to persistent cache.
+  Status ReadBlockWithPersistentCache(
+      FileReaderWithCachePrefix* reader, const ReadOptions& ro, const BlockHandle& handle,
+      bool do_uncompress, const UncompressionDict* uncompression_dict,
+      std::unique_ptr<Block>* result);
+
   explicit BlockBasedTable(Rep* rep) : rep_(rep) {}
 
   // Helper functions for DumpTable()
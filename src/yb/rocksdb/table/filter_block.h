@@ -82,6 +82,14 @@ class FilterBlockReader {
                            uint64_t block_offset = kNotValid) = 0;
   virtual bool PrefixMayMatch(const Slice& prefix,
                               uint64_t block_offset = kNotValid) = 0;
+
+  // Checks num_keys keys at once, may_match[i] is set to KeyMayMatch(keys[i], block_offset).
+  virtual void MultiKeyMayMatch(size_t num_keys, const Slice* keys, bool* may_match,
+                                uint64_t block_offset = kNotValid) {
+    for (size_t i = 0; i != num_keys; ++i) {
+      may_match[i] = KeyMayMatch(keys[i], block_offset);
+    }
+  }
   virtual size_t ApproximateMemoryUsage() const = 0;
 
   // convert this object to a human readable form
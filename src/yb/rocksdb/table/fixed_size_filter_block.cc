@@ -17,6 +17,8 @@
 
 #include "yb/rocksdb/table/fixed_size_filter_block.h"
 
+#include <algorithm>
+
 #include "yb/rocksdb/filter_policy.h"
 #include "yb/rocksdb/util/perf_context_imp.h"
 
@@ -117,7 +119,17 @@ FixedSizeFilterBlockReader::FixedSizeFilterBlockReader(
     const BlockBasedTableOptions& table_opt,
     bool whole_key_filtering,
     BlockContents&& contents)
-    : policy_(table_opt.filter_policy.get()),
+    : FixedSizeFilterBlockReader(
+          prefix_extractor, table_opt.filter_policy.get(), whole_key_filtering,
+          std::move(contents)) {
+}
+
+FixedSizeFilterBlockReader::FixedSizeFilterBlockReader(
+    const SliceTransform* prefix_extractor,
+    const FilterPolicy* policy,
+    bool whole_key_filtering,
+    BlockContents&& contents)
+    : policy_(policy),
       prefix_extractor_(prefix_extractor),
       whole_key_filtering_(whole_key_filtering),
       contents_(std::move(contents)) {
@@ -133,6 +145,18 @@ bool FixedSizeFilterBlockReader::PrefixMayMatch(const Slice& prefix, uint64_t bl
   return prefix_extractor_ ? MayMatch(prefix) : true;
 }
 
+void FixedSizeFilterBlockReader::MultiKeyMayMatch(
+    size_t num_keys, const Slice* keys, bool* may_match, uint64_t block_offset) {
+  if (!whole_key_filtering_) {
+    std::fill_n(may_match, num_keys, true);
+    return;
+  }
+  reader_->MultiMayMatch(num_keys, keys, may_match);
+  const auto hits = std::count(may_match, may_match + num_keys, true);
+  PERF_COUNTER_ADD(bloom_sst_hit_count, hits);
+  PERF_COUNTER_ADD(bloom_sst_miss_count, num_keys - hits);
+}
+
 bool FixedSizeFilterBlockReader::MayMatch(const Slice& entry) {
   if (reader_->MayMatch(entry)) {
     PERF_COUNTER_ADD(bloom_sst_hit_count, 1);
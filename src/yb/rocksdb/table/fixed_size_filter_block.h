@@ -86,6 +86,12 @@ class FixedSizeFilterBlockReader : public FilterBlockReader {
                              const BlockBasedTableOptions& table_opt,
                              bool whole_key_filtering,
                              BlockContents&& contents);
+  // Uses specified policy instead of table_opt.filter_policy, should be used to read filter
+  // written by one of the BlockBasedTableOptions::supported_filter_policies.
+  FixedSizeFilterBlockReader(const SliceTransform* prefix_extractor,
+                             const FilterPolicy* policy,
+                             bool whole_key_filtering,
+                             BlockContents&& contents);
   FixedSizeFilterBlockReader(const FixedSizeFilterBlockReader&) = delete;
   void operator=(const FixedSizeFilterBlockReader&) = delete;
 
@@ -93,6 +99,8 @@ class FixedSizeFilterBlockReader : public FilterBlockReader {
                            uint64_t block_offset = 0) override;
   virtual bool PrefixMayMatch(const Slice& prefix,
                               uint64_t block_offset = 0) override;
+  void MultiKeyMayMatch(size_t num_keys, const Slice* keys, bool* may_match,
+                        uint64_t block_offset = 0) override;
   virtual size_t ApproximateMemoryUsage() const override;
 
   // convert this object to a human readable form
@@ -25,6 +25,8 @@
 #define YB_ROCKSDB_TABLE_TABLE_READER_H
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "yb/rocksdb/status.h"
 
@@ -42,6 +44,13 @@ class InternalIterator;
 class RandomAccessFileReader;
 class WritableFile;
 
+struct KeyAnchor {
+  // Internal key that is not less than any key in the range covered by this anchor.
+  std::string key;
+  // Approximate size of data in range between the previous anchor and this one.
+  uint64_t range_size;
+};
+
 // A Table is a sorted map from strings to strings.  Tables are
 // immutable and persistent.  A Table may be safely accessed from
 // multiple threads without external synchronization.
@@ -124,6 +133,12 @@ class TableReader {
   virtual yb::Result<std::string> GetMiddleKey() {
     return STATUS(NotSupported, "GetMiddleKey() not supported");
   }
+
+  // Returns keys splitting SST file into consecutive ranges of at least min_range_size bytes each,
+  // except the last one. Used to split large compactions into subcompactions of similar size.
+  virtual yb::Result<std::vector<KeyAnchor>> GetKeyAnchors(uint64_t min_range_size) {
+    return STATUS(NotSupported, "GetKeyAnchors() not supported");
+  }
 };
 
 }  // namespace rocksdb
@@ -26,6 +26,11 @@ int main() {
 }
 #else
 
+#include <inttypes.h>
+
+#include <algorithm>
+#include <vector>
+
 #include <gflags/gflags.h>
 
 #include "yb/rocksdb/db.h"
@@ -33,7 +38,9 @@ int main() {
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/db/db_impl.h"
 #include "yb/rocksdb/db/dbformat.h"
+#include "yb/rocksdb/filter_policy.h"
 #include "yb/rocksdb/table/block_based_table_factory.h"
+#include "yb/rocksdb/table/block_based_table_reader.h"
 #include "yb/rocksdb/table/internal_iterator.h"
 #include "yb/rocksdb/table/plain_table_factory.h"
 #include "yb/rocksdb/table/table_builder.h"
@@ -83,12 +90,17 @@ uint64_t Now(Env* env, bool measured_by_nanosecond) {
 //
 // If for_terator=true, instead of just query one key each time, it queries
 // a range sharing the same prefix.
+//
+// If multi_key_batch_size > 0, only bloom filter is checked for batches of
+// multi_key_batch_size keys using BlockBasedTable::MultiKeyMayMatch, and
+// histogram is collected per batch.
 namespace {
 void TableReaderBenchmark(const Options& opts, const EnvOptions& env_options,
                           const ReadOptions& read_options, int num_keys1,
                           int num_keys2, int num_iter, int prefix_len,
                           bool if_query_empty_keys, bool for_iterator,
-                          bool through_db, bool measured_by_nanosecond) {
+                          bool through_db, bool measured_by_nanosecond,
+                          int multi_key_batch_size) {
   rocksdb::InternalKeyComparator ikc(opts.comparator);
 
   std::string file_name = test::TmpDir()
@@ -162,6 +174,11 @@ void TableReaderBenchmark(const Options& opts, const EnvOptions& env_options,
   Random rnd(301);
   std::string result;
   HistogramImpl hist;
+  std::vector<std::string> batch_keys;
+  std::vector<Slice> batch_slices;
+  std::unique_ptr<bool[]> batch_may_match(new bool[std::max(multi_key_batch_size, 1)]);
+  uint64_t batch_matches = 0;
+  uint64_t batch_checks = 0;
 
   for (int it = 0; it < num_iter; it++) {
     for (int i = 0; i < num_keys1; i++) {
@@ -173,7 +190,22 @@ void TableReaderBenchmark(const Options& opts, const EnvOptions& env_options,
           r2 = num_keys2 * 2 - r2;
         }
 
-        if (!for_iterator) {
+        if (multi_key_batch_size > 0) {
+          batch_keys.push_back(MakeKey(r1, r2, false /* through_db */));
+          if (batch_keys.size() < static_cast<size_t>(multi_key_batch_size)) {
+            continue;
+          }
+          batch_slices.assign(batch_keys.begin(), batch_keys.end());
+          auto* table = static_cast<BlockBasedTable*>(table_reader.get());
+          uint64_t start_time = Now(env, measured_by_nanosecond);
+          table->MultiKeyMayMatch(
+              read_options, batch_slices.size(), batch_slices.data(), batch_may_match.get());
+          hist.Add(Now(env, measured_by_nanosecond) - start_time);
+          batch_matches += std::count(
+              batch_may_match.get(), batch_may_match.get() + batch_slices.size(), true);
+          batch_checks += batch_slices.size();
+          batch_keys.clear();
+        } else if (!for_iterator) {
           // Query one existing key;
           std::string key = MakeKey(r1, r2, through_db);
           uint64_t start_time = Now(env, measured_by_nanosecond);
@@ -253,6 +285,17 @@ void TableReaderBenchmark(const Options& opts, const EnvOptions& env_options,
       for_iterator ? "iterator" : (if_query_empty_keys ? "empty" : "non_empty"),
       measured_by_nanosecond ? "nanosecond" : "microsecond",
       hist.ToString().c_str());
+  if (multi_key_batch_size > 0) {
+    fprintf(stderr, "Filter matched %" PRIu64 " of %" PRIu64 " keys (%.3f%%)\n",
+            batch_matches, batch_checks, batch_checks ? 100.0 * batch_matches / batch_checks : 0);
+  }
+  if (opts.statistics) {
+    for (auto ticker : {BLOOM_FILTER_CHECKED, BLOOM_FILTER_USEFUL, BLOCK_CACHE_FILTER_HIT,
+                        BLOCK_CACHE_FILTER_MISS, BLOCK_CACHE_DATA_HIT, BLOCK_CACHE_DATA_MISS}) {
+      fprintf(stderr, "%s: %" PRIu64 "\n", TickersNameMap[ticker].second.c_str(),
+              opts.statistics->getTickerCount(ticker));
+    }
+  }
   if (!through_db) {
     env->DeleteFile(file_name);
   } else {
@@ -280,6 +323,15 @@ DEFINE_string(table_factory, "block_based",
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
+DEFINE_string(filter_policy, "none",
+              "Filter policy to use with block_based table factory: `none` (default), "
+              "`fixed_size` or `blocked_fixed_size`.");
+DEFINE_int64(filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterBits,
+             "Size of fixed-size filter block in bits.");
+DEFINE_int32(multi_key_batch_size, 0,
+             "If positive, only check bloom filter for batches of keys of this size using "
+             "MultiKeyMayMatch. Requires block_based table and through_db=false.");
+DEFINE_bool(statistics, false, "Print statistics after benchmark.");
 
 int main(int argc, char** argv) {
   SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
@@ -310,11 +362,33 @@ int main(int argc, char** argv) {
     options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(
         FLAGS_prefix_len));
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new rocksdb::BlockBasedTableFactory());
+    rocksdb::BlockBasedTableOptions table_options;
+    if (FLAGS_filter_policy == "fixed_size") {
+      table_options.filter_policy.reset(rocksdb::NewFixedSizeFilterPolicy(
+          FLAGS_filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate,
+          nullptr));
+    } else if (FLAGS_filter_policy == "blocked_fixed_size") {
+      table_options.filter_policy.reset(rocksdb::NewBlockedFixedSizeFilterPolicy(
+          FLAGS_filter_block_size_bits, rocksdb::FilterPolicy::kDefaultFixedSizeFilterErrorRate,
+          nullptr));
+    } else if (FLAGS_filter_policy != "none") {
+      fprintf(stderr, "Invalid filter policy %s\n", FLAGS_filter_policy.c_str());
+      return 1;
+    }
+    tf.reset(new rocksdb::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
 
+  if (FLAGS_multi_key_batch_size > 0 &&
+      (FLAGS_table_factory != "block_based" || FLAGS_through_db)) {
+    fprintf(stderr, "multi_key_batch_size requires block_based table and through_db=false\n");
+    return 1;
+  }
+  if (FLAGS_statistics) {
+    options.statistics = rocksdb::CreateDBStatisticsForTests();
+  }
+
   if (tf) {
     // if user provides invalid options, just fall back to microsecond.
     bool measured_by_nanosecond = FLAGS_time_unit == "nanosecond";
@@ -323,7 +397,8 @@ int main(int argc, char** argv) {
     rocksdb::TableReaderBenchmark(options, env_options, ro, FLAGS_num_keys1,
                                   FLAGS_num_keys2, FLAGS_iter, FLAGS_prefix_len,
                                   FLAGS_query_empty, FLAGS_iterator,
-                                  FLAGS_through_db, measured_by_nanosecond);
+                                  FLAGS_through_db, measured_by_nanosecond,
+                                  FLAGS_multi_key_batch_size);
   } else {
     return 1;
   }
@@ -66,6 +66,7 @@
 #include "yb/rocksdb/util/testutil.h"
 
 #include "yb/util/enums.h"
+#include "yb/util/format.h"
 #include "yb/util/string_util.h"
 #include "yb/util/test_macros.h"
 
@@ -308,7 +309,7 @@ class TableConstructor: public Constructor {
                             internal_comparator,
                             int_tbl_prop_collector_factories,
                             options.compression,
-                            CompressionOptions(),
+                            options.compression_opts,
                             /* skip_filters */ false),
         TablePropertiesCollectorFactory::Context::kUnknownColumnFamily,
         file_writer_.get());
@@ -1375,6 +1376,82 @@ TEST_F(BlockBasedTableTest, NoopTransformSeek) {
   }
 }
 
+TEST_F(BlockBasedTableTest, MultiKeyMayMatch) {
+  constexpr int kNumKeys = 10000;
+  // Use small filter blocks, so keys are spread across many of them.
+  constexpr size_t kFilterBits = 8192;
+
+  for (bool blocked : {false, true}) {
+    BlockBasedTableOptions table_options;
+    table_options.filter_policy.reset(
+        blocked ? NewBlockedFixedSizeFilterPolicy(
+                      kFilterBits, FilterPolicy::kDefaultFixedSizeFilterErrorRate, nullptr)
+                : NewFixedSizeFilterPolicy(
+                      kFilterBits, FilterPolicy::kDefaultFixedSizeFilterErrorRate, nullptr));
+    table_options.block_cache = NewLRUCache(8 << 20);
+    Options options;
+    options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+    TableConstructor c(BytewiseComparator());
+    for (int i = 0; i < kNumKeys; ++i) {
+      c.Add(InternalKey("key" + std::to_string(i * 2), 1, kTypeValue).Encode().ToString(), "v");
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    const ImmutableCFOptions ioptions(options);
+    auto internal_comparator = std::make_shared<InternalKeyComparator>(options.comparator);
+    c.Finish(options, ioptions, table_options, internal_comparator, &keys, &kvmap);
+    auto* reader = static_cast<BlockBasedTable*>(c.GetTableReader());
+
+    // Check present and absent keys in reverse order, to make sure batch is grouped by filter
+    // block regardless of the order of keys.
+    std::vector<std::string> check_keys;
+    for (int i = 2 * kNumKeys; i-- > 0;) {
+      check_keys.push_back(
+          InternalKey("key" + std::to_string(i), 1, kTypeValue).Encode().ToString());
+    }
+    std::vector<Slice> check_slices(check_keys.begin(), check_keys.end());
+    std::unique_ptr<bool[]> may_match(new bool[check_slices.size()]);
+    reader->MultiKeyMayMatch(
+        ReadOptions(), check_slices.size(), check_slices.data(), may_match.get());
+
+    size_t false_positives = 0;
+    for (size_t i = 0; i != check_slices.size(); ++i) {
+      const auto user_key = ExtractUserKey(check_slices[i]).ToBuffer();
+      if (kvmap.count(check_keys[i])) {
+        ASSERT_TRUE(may_match[i]) << user_key;
+      } else if (may_match[i]) {
+        ++false_positives;
+      }
+    }
+    LOG(INFO) << "Blocked: " << blocked << ", false positives: " << false_positives;
+    ASSERT_LE(false_positives, kNumKeys * 3 / 100);
+
+    // File filter keeps the table if any of user keys may match, and skips it when all of them
+    // are rejected.
+    constexpr size_t kNumAbsentKeys = 10;
+    std::vector<std::string> absent_user_keys;
+    for (int i = 0; i != kNumKeys; ++i) {
+      const auto user_key = "key" + std::to_string(i * 2 + 1);
+      bool may_match_key = false;
+      Slice user_key_slice(user_key);
+      reader->MultiUserKeyMayMatch(ReadOptions(), 1, &user_key_slice, &may_match_key);
+      if (!may_match_key) {
+        absent_user_keys.push_back(user_key);
+        if (absent_user_keys.size() == kNumAbsentKeys) {
+          break;
+        }
+      }
+    }
+    ASSERT_EQ(absent_user_keys.size(), kNumAbsentKeys);
+    std::vector<Slice> filter_keys(absent_user_keys.begin(), absent_user_keys.end());
+    ASSERT_FALSE(BloomFilterAwareMultiKeyFileFilter(ReadOptions(), filter_keys).Filter(reader));
+    const std::string present_user_key = "key0";
+    filter_keys.emplace_back(present_user_key);
+    ASSERT_TRUE(BloomFilterAwareMultiKeyFileFilter(ReadOptions(), filter_keys).Filter(reader));
+  }
+}
+
 void AddInternalKey(TableConstructor* c, const std::string& prefix,
                     int suffix_len = 800) {
   static Random rnd(1023);
@@ -2186,6 +2263,66 @@ TEST_F(GeneralTableTest, ApproximateOffsetOfCompressed) {
   }
 }
 
+namespace {
+
+// Builds table of small rows that share most of their content, as in log-like tables, and checks
+// that table contents are read back. Returns size of data blocks.
+uint64_t BuildAndCheckZSTDTable(uint32_t max_dict_bytes) {
+  Random rnd(301);
+  TableConstructor c(BytewiseComparator());
+  for (int i = 0; i != 20000; ++i) {
+    char key[20];
+    snprintf(key, sizeof(key), "k%08d", i);
+    c.Add(key, yb::Format(
+        "{\"ts\": $0, \"level\": \"INFO\", \"host\": \"node-$1.example.com\", "
+        "\"msg\": \"request $2 completed\"}",
+        1500000000 + i, rnd.Uniform(10), RandomString(&rnd, 8)));
+  }
+
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  Options options;
+  options.compression = kZSTD;
+  options.compression_opts.max_dict_bytes = max_dict_bytes;
+  options.compression_opts.zstd_max_train_bytes = 256 * 1024;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions(options);
+  auto ikc = std::make_shared<test::PlainInternalKeyComparator>(options.comparator);
+  c.Finish(options, ioptions, table_options, ikc, &keys, &kvmap);
+
+  std::unique_ptr<InternalIterator> iter(c.NewIterator());
+  iter->SeekToFirst();
+  for (const auto& expected : kvmap) {
+    if (!iter->Valid()) {
+      ADD_FAILURE() << "Missing key: " << expected.first << ", status: " << iter->status();
+      break;
+    }
+    EXPECT_EQ(expected.first, iter->key().ToBuffer());
+    EXPECT_EQ(expected.second, iter->value().ToBuffer());
+    iter->Next();
+  }
+  EXPECT_FALSE(iter->Valid());
+
+  return c.GetTableProperties().data_size;
+}
+
+} // namespace
+
+TEST_F(GeneralTableTest, ZSTDDictionaryCompression) {
+  if (!ZSTD_Supported()) {
+    LOG(INFO) << "skipping zstd compression tests";
+    return;
+  }
+
+  auto size_without_dict = BuildAndCheckZSTDTable(/* max_dict_bytes= */ 0);
+  auto size_with_dict = BuildAndCheckZSTDTable(/* max_dict_bytes= */ 16 * 1024);
+  LOG(INFO) << "Data size without dictionary: " << size_without_dict
+            << ", with dictionary: " << size_with_dict;
+  ASSERT_LT(size_with_dict, size_without_dict);
+}
+
 TEST_F(HarnessTest, Randomized) {
 #if defined(THREAD_SANITIZER)
   static constexpr int kMaxNumEntries = 200;
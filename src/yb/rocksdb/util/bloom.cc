@@ -23,8 +23,11 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 #include "yb/rocksdb/filter_policy.h"
 
+#include "yb/rocksdb/port/port.h"
 #include "yb/rocksdb/util/hash.h"
 #include "yb/rocksdb/util/coding.h"
 #include "yb/util/slice.h"
@@ -40,6 +43,10 @@ typedef FilterPolicy::FilterType FilterType;
 namespace {
 static const double LOG2 = log(2);
 
+// Number of entries processed at once by MultiMayMatch implementations: hashes are computed and
+// filter lines are prefetched for the whole group before checking.
+constexpr size_t kMultiMayMatchGroupSize = 16;
+
 inline void AddHash(uint32_t h, char* data, size_t num_lines, size_t total_bits,
     size_t num_probes) {
   DCHECK_GT(num_lines, 0);
@@ -204,6 +211,28 @@ class FullFilterBitsReader : public FilterBitsReader {
                         num_probes_, num_lines_);
   }
 
+  void MultiMayMatch(size_t num_entries, const Slice* entries, bool* may_match) override {
+    if (data_len_ <= FullFilterBitsBuilder::kMetaDataSize ||
+        num_probes_ == 0 || num_lines_ == 0) {
+      std::fill_n(may_match, num_entries, data_len_ > FullFilterBitsBuilder::kMetaDataSize);
+      return;
+    }
+    const Slice filter(data_, data_len_);
+    const uint32_t cache_line_size =
+        (data_len_ - FullFilterBitsBuilder::kMetaDataSize) / num_lines_;
+    uint32_t hashes[kMultiMayMatchGroupSize];
+    for (size_t start = 0; start < num_entries; start += kMultiMayMatchGroupSize) {
+      const size_t group_size = std::min(kMultiMayMatchGroupSize, num_entries - start);
+      for (size_t i = 0; i != group_size; ++i) {
+        hashes[i] = BloomHash(entries[start + i]);
+        PREFETCH(data_ + (hashes[i] % num_lines_) * cache_line_size, 0 /* rw */, 3 /* locality */);
+      }
+      for (size_t i = 0; i != group_size; ++i) {
+        may_match[start + i] = HashMayMatch(hashes[i], filter, num_probes_, num_lines_);
+      }
+    }
+  }
+
  private:
   Logger* logger_;
   // Filter meta data
@@ -487,6 +516,195 @@ class FixedSizeFilterBitsReader : public FullFilterBitsReader {
       : FullFilterBitsReader(contents, logger) {}
 };
 
+// Register-blocked variant of the fixed size filter.
+//
+// Filter consists of num_lines cache lines, key is mapped to one line by its hash. Each line is
+// treated as kBlockedFilterWordsPerLine 64-bit words, probe i of the key sets one bit in word i
+// and bit position is obtained by multiplying key hash by a probe specific odd salt. So probes
+// don't depend on each other and checking a key requires reading a single cache line, as opposed
+// to the double hashing used by FullFilterBitsBuilder, where position of each next probe depends
+// on the previous one.
+//
+// Metadata is encoded the same way as for FullFilter, but the filter data is not compatible with
+// it, so a separate policy name is used for this format.
+//
+// Since bits of one key are concentrated in a single line, false positive rate for the same
+// number of keys is a bit higher than for a classic Bloom filter. To keep the requested error
+// rate, the number of keys per filter block is computed using the false positive rate of blocked
+// filter (see BlockedFilterFalsePositiveRate), and the number of probes is chosen to maximize it.
+constexpr size_t kBlockedFilterWordBits = 64;
+constexpr size_t kBlockedFilterWordsPerLine = CACHE_LINE_SIZE * 8 / kBlockedFilterWordBits;
+constexpr size_t kBlockedFilterMaxProbes = 8;
+
+static_assert(kBlockedFilterWordsPerLine >= kBlockedFilterMaxProbes,
+              "Cache line is too small for blocked filter");
+
+constexpr uint32_t kBlockedFilterSalts[kBlockedFilterMaxProbes] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+inline size_t BlockedFilterBitIndex(uint32_t hash, size_t probe) {
+  // Use top 6 bits of the salted hash as bit index within the 64-bit word.
+  return (hash * kBlockedFilterSalts[probe]) >> (32 - 6);
+}
+
+inline void BlockedFilterAddHash(uint32_t hash, char* line, size_t num_probes) {
+  for (size_t i = 0; i != num_probes; ++i) {
+    const size_t bitpos = i * kBlockedFilterWordBits + BlockedFilterBitIndex(hash, i);
+    line[bitpos / 8] |= (1 << (bitpos % 8));
+  }
+}
+
+inline bool BlockedFilterHashMayMatch(uint32_t hash, const char* line, size_t num_probes) {
+  bool result = true;
+  // Intentionally don't exit early, so the compiler is free to evaluate all probes in parallel.
+  for (size_t i = 0; i != num_probes; ++i) {
+    const size_t bitpos = i * kBlockedFilterWordBits + BlockedFilterBitIndex(hash, i);
+    result &= ((line[bitpos / 8] >> (bitpos % 8)) & 1) != 0;
+  }
+  return result;
+}
+
+// Expected false positive rate of blocked filter with the specified number of probes and the
+// average number of keys per line. Number of keys in a particular line follows Poisson
+// distribution, and each word of line containing n keys has 1 - (1 - 1/64)^n bits set on average.
+double BlockedFilterFalsePositiveRate(size_t num_probes, double keys_per_line) {
+  const double word_keep_prob = 1.0 - 1.0 / kBlockedFilterWordBits;
+  const size_t max_keys = static_cast<size_t>(keys_per_line + 10 * sqrt(keys_per_line) + 20);
+  double result = 0;
+  // Poisson probability of line with n keys, updated incrementally.
+  double prob = exp(-keys_per_line);
+  for (size_t n = 0; n <= max_keys; ++n) {
+    result += prob * pow(1.0 - pow(word_keep_prob, n), num_probes);
+    prob *= keys_per_line / (n + 1);
+  }
+  return result;
+}
+
+// Returns max average number of keys per line, such that blocked filter with the specified number
+// of probes has false positive rate not greater than error_rate.
+double BlockedFilterMaxKeysPerLine(size_t num_probes, double error_rate) {
+  double low = 0;
+  double high = CACHE_LINE_SIZE * 8;
+  for (int i = 0; i != 50; ++i) {
+    const double middle = (low + high) / 2;
+    if (BlockedFilterFalsePositiveRate(num_probes, middle) <= error_rate) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+class BlockedFixedSizeFilterBitsBuilder : public FilterBitsBuilder {
+ public:
+  BlockedFixedSizeFilterBitsBuilder(const BlockedFixedSizeFilterBitsBuilder&) = delete;
+  void operator=(const BlockedFixedSizeFilterBitsBuilder&) = delete;
+
+  BlockedFixedSizeFilterBitsBuilder(size_t num_lines, size_t num_probes, size_t max_keys)
+      : num_lines_(num_lines), num_probes_(num_probes), max_keys_(max_keys) {
+    DCHECK_GT(num_lines_, 0);
+    DCHECK_GT(num_probes_, 0);
+    DCHECK_LE(num_probes_, kBlockedFilterMaxProbes);
+    data_.reset(new char[FilterSize()]);
+    memset(data_.get(), 0, FilterSize());
+  }
+
+  void AddKey(const Slice& key) override {
+    ++keys_added_;
+    const uint32_t hash = BloomHash(key);
+    BlockedFilterAddHash(hash, data_.get() + (hash % num_lines_) * CACHE_LINE_SIZE, num_probes_);
+  }
+
+  bool IsFull() const override { return keys_added_ >= max_keys_; }
+
+  Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    const size_t data_size = num_lines_ * CACHE_LINE_SIZE;
+    data_[data_size] = static_cast<char>(num_probes_);
+    EncodeFixed32(data_.get() + data_size + 1, static_cast<uint32_t>(num_lines_));
+    buf->reset(data_.release());
+    return Slice(buf->get(), FilterSize());
+  }
+
+  static constexpr size_t kMetaDataSize = FullFilterBitsBuilder::kMetaDataSize;
+
+ private:
+  size_t FilterSize() const { return num_lines_ * CACHE_LINE_SIZE + kMetaDataSize; }
+
+  std::unique_ptr<char[]> data_;
+  const size_t num_lines_;
+  const size_t num_probes_;
+  const size_t max_keys_;
+  size_t keys_added_ = 0;
+};
+
+class BlockedFixedSizeFilterBitsReader : public FilterBitsReader {
+ public:
+  BlockedFixedSizeFilterBitsReader(const BlockedFixedSizeFilterBitsReader&) = delete;
+  void operator=(const BlockedFixedSizeFilterBitsReader&) = delete;
+
+  BlockedFixedSizeFilterBitsReader(const Slice& contents, Logger* logger)
+      : data_(contents.cdata()),
+        data_len_(contents.size()) {
+    if (data_len_ <= kMetaDataSize) {
+      return;
+    }
+    num_probes_ = static_cast<uint8_t>(data_[data_len_ - kMetaDataSize]);
+    num_lines_ = DecodeFixed32(data_ + data_len_ - 4);
+    // Sanitize broken parameters.
+    if (num_lines_ == 0 || data_len_ != num_lines_ * CACHE_LINE_SIZE + kMetaDataSize ||
+        num_probes_ == 0 || num_probes_ > kBlockedFilterMaxProbes) {
+      RLOG(InfoLogLevel::ERROR_LEVEL, logger, "Bloom filter data is broken, won't be used.");
+      FAIL_IF_NOT_PRODUCTION();
+      num_lines_ = 0;
+      num_probes_ = 0;
+    }
+  }
+
+  bool MayMatch(const Slice& entry) override {
+    if (data_len_ <= kMetaDataSize) {
+      return false;
+    }
+    // Broken filter is regarded as match.
+    if (num_lines_ == 0) {
+      return true;
+    }
+    const uint32_t hash = BloomHash(entry);
+    return BlockedFilterHashMayMatch(hash, Line(hash), num_probes_);
+  }
+
+  void MultiMayMatch(size_t num_entries, const Slice* entries, bool* may_match) override {
+    if (num_lines_ == 0) {
+      std::fill_n(may_match, num_entries, data_len_ > kMetaDataSize);
+      return;
+    }
+    uint32_t hashes[kMultiMayMatchGroupSize];
+    for (size_t start = 0; start < num_entries; start += kMultiMayMatchGroupSize) {
+      const size_t group_size = std::min(kMultiMayMatchGroupSize, num_entries - start);
+      for (size_t i = 0; i != group_size; ++i) {
+        hashes[i] = BloomHash(entries[start + i]);
+        PREFETCH(Line(hashes[i]), 0 /* rw */, 3 /* locality */);
+      }
+      for (size_t i = 0; i != group_size; ++i) {
+        may_match[start + i] = BlockedFilterHashMayMatch(hashes[i], Line(hashes[i]), num_probes_);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kMetaDataSize = BlockedFixedSizeFilterBitsBuilder::kMetaDataSize;
+
+  const char* Line(uint32_t hash) const {
+    return data_ + (hash % num_lines_) * CACHE_LINE_SIZE;
+  }
+
+  const char* data_;
+  size_t data_len_;
+  size_t num_probes_ = 0;
+  size_t num_lines_ = 0;
+};
+
 class FixedSizeFilterPolicy : public FilterPolicy {
  public:
   explicit FixedSizeFilterPolicy(size_t total_bits, double error_rate, Logger* logger)
@@ -530,6 +748,54 @@ class FixedSizeFilterPolicy : public FilterPolicy {
   Logger* logger_;
 };
 
+class BlockedFixedSizeFilterPolicy : public FilterPolicy {
+ public:
+  BlockedFixedSizeFilterPolicy(size_t total_bits, double error_rate, Logger* logger)
+      : num_lines_(std::max<size_t>(total_bits / (CACHE_LINE_SIZE * 8), 1)),
+        logger_(logger) {
+    DCHECK_GT(error_rate, 0);
+    double best_keys_per_line = 0;
+    for (size_t num_probes = 1; num_probes <= kBlockedFilterMaxProbes; ++num_probes) {
+      const double keys_per_line = BlockedFilterMaxKeysPerLine(num_probes, error_rate);
+      if (keys_per_line > best_keys_per_line) {
+        best_keys_per_line = keys_per_line;
+        num_probes_ = num_probes;
+      }
+    }
+    max_keys_ = std::max<size_t>(static_cast<size_t>(best_keys_per_line * num_lines_), 1);
+  }
+
+  FilterType GetFilterType() const override { return FilterType::kFixedSizeFilter; }
+
+  const char* Name() const override {
+    return "rocksdb.BlockedFixedSizeBloomFilter";
+  }
+
+  // Not used in FixedSizeFilter. GetFilterBitsBuilder/Reader interface should be used.
+  void CreateFilter(const Slice* keys, int n, std::string* dst) const override {
+    assert(!"BlockedFixedSizeFilterPolicy::CreateFilter is not supported");
+  }
+
+  bool KeyMayMatch(const Slice& key, const Slice& filter) const override {
+    assert(!"BlockedFixedSizeFilterPolicy::KeyMayMatch is not supported");
+    return true;
+  }
+
+  FilterBitsBuilder* GetFilterBitsBuilder() const override {
+    return new BlockedFixedSizeFilterBitsBuilder(num_lines_, num_probes_, max_keys_);
+  }
+
+  FilterBitsReader* GetFilterBitsReader(const Slice& contents) const override {
+    return new BlockedFixedSizeFilterBitsReader(contents, logger_);
+  }
+
+ private:
+  size_t num_lines_;
+  size_t num_probes_ = 1;
+  size_t max_keys_;
+  Logger* logger_;
+};
+
 }  // namespace
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
@@ -544,4 +810,10 @@ const FilterPolicy* NewFixedSizeFilterPolicy(size_t total_bits,
   return new FixedSizeFilterPolicy(total_bits, error_rate, logger);
 }
 
+const FilterPolicy* NewBlockedFixedSizeFilterPolicy(size_t total_bits,
+                                                    double error_rate,
+                                                    Logger* logger) {
+  return new BlockedFixedSizeFilterPolicy(total_bits, error_rate, logger);
+}
+
 }  // namespace rocksdb
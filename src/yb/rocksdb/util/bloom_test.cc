@@ -29,6 +29,8 @@ int main() {
 }
 #else
 
+#include <algorithm>
+#include <string>
 #include <vector>
 #include <gflags/gflags.h>
 
@@ -236,7 +238,25 @@ class FixedSizeFilterBloomTestContext : public BloomTestContext {
           nullptr)};
 };
 
-YB_DEFINE_ENUM(BuilderReaderBloomTestType, (kFullFilter)(kFixedSizeFilter));
+class BlockedFixedSizeFilterBloomTestContext : public BloomTestContext {
+ public:
+  const FilterPolicy& filter_policy() const override { return *filter_policy_.get(); }
+
+  size_t max_keys() const override { return std::numeric_limits<size_t>::max(); }
+
+  void CheckFilterSize(size_t filter_size, size_t num_keys) const override {
+    ASSERT_LE(filter_size, FilterPolicy::kDefaultFixedSizeFilterBits / 8 + 5) << num_keys;
+  }
+
+ private:
+  std::unique_ptr<const FilterPolicy> filter_policy_{
+      NewBlockedFixedSizeFilterPolicy(
+          FilterPolicy::kDefaultFixedSizeFilterBits, FilterPolicy::kDefaultFixedSizeFilterErrorRate,
+          nullptr)};
+};
+
+YB_DEFINE_ENUM(BuilderReaderBloomTestType,
+               (kFullFilter)(kFixedSizeFilter)(kBlockedFixedSizeFilter));
 
 namespace {
 
@@ -246,6 +266,8 @@ std::unique_ptr<const BloomTestContext> CreateContext(BuilderReaderBloomTestType
       return std::make_unique<FullFilterBloomTestContext>();
     case BuilderReaderBloomTestType::kFixedSizeFilter:
       return std::make_unique<FixedSizeFilterBloomTestContext>();
+    case BuilderReaderBloomTestType::kBlockedFixedSizeFilter:
+      return std::make_unique<BlockedFixedSizeFilterBloomTestContext>();
   }
   FATAL_INVALID_ENUM_VALUE(BuilderReaderBloomTestType, type);
 }
@@ -372,9 +394,41 @@ TEST_P(BuilderReaderBloomTest, FullVaryingLengths) {
   ASSERT_LE(mediocre_filters, good_filters/5);
 }
 
+TEST_P(BuilderReaderBloomTest, MultiMayMatch) {
+  constexpr size_t kNumKeys = 1000;
+  constexpr size_t kNumChecks = 2 * kNumKeys;
+  char buffer[sizeof(size_t)];
+
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < kNumChecks; ++i) {
+    keys.push_back(Key(i, buffer).ToString());
+  }
+  std::vector<Slice> slices(keys.begin(), keys.end());
+  std::unique_ptr<bool[]> may_match(new bool[kNumChecks]);
+
+  // Empty filter does not match anything.
+  Build();
+  bits_reader_->MultiMayMatch(kNumChecks, slices.data(), may_match.get());
+  ASSERT_EQ(std::count(may_match.get(), may_match.get() + kNumChecks, true), 0);
+
+  Reset();
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    Add(slices[i]);
+  }
+  Build();
+  bits_reader_->MultiMayMatch(kNumChecks, slices.data(), may_match.get());
+  for (size_t i = 0; i < kNumChecks; ++i) {
+    ASSERT_EQ(may_match[i], Matches(slices[i])) << "Key " << i;
+    if (i < kNumKeys) {
+      ASSERT_TRUE(may_match[i]) << "Key " << i;
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(, BuilderReaderBloomTest, ::testing::Values(
     BuilderReaderBloomTestType::kFullFilter,
-    BuilderReaderBloomTestType::kFixedSizeFilter));
+    BuilderReaderBloomTestType::kFixedSizeFilter,
+    BuilderReaderBloomTestType::kBlockedFixedSizeFilter));
 
 }  // namespace rocksdb
 
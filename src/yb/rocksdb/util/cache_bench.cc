@@ -34,6 +34,9 @@ int main() {
 #include <stdio.h>
 #include <gflags/gflags.h>
 
+#include <algorithm>
+#include <atomic>
+
 #include "yb/rocksdb/db.h"
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/env.h"
@@ -49,6 +52,8 @@ DEFINE_int32(threads, 16, "Number of concurrent threads to run.");
 DEFINE_int64(cache_size, 8 * KB * KB,
              "Number of bytes to use as a cache of uncompressed data.");
 DEFINE_int32(num_shard_bits, 4, "shard_bits.");
+DEFINE_string(cache_type, "lru", "Cache implementation to benchmark: lru or clock.");
+DEFINE_int32(value_size, 1, "Charge of every cache entry.");
 
 DEFINE_int64(max_key, 1 * KB * KB * KB, "Max number of key to place in cache");
 DEFINE_uint64(ops_per_thread, 1200000, "Number of operations per thread.");
@@ -61,6 +66,15 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
+DEFINE_string(workload, "random",
+              "Workload to run. random - mix of inserts, lookups and erases of random keys. "
+              "mixed_scan - point reads of hot keys mixed with long sequential scans of cold keys, "
+              "every read inserts entry to cache on miss like block based table reader does.");
+DEFINE_int64(hot_keys, 1024, "Number of frequently read keys for mixed_scan workload.");
+DEFINE_int32(scan_percent, 50,
+             "Ratio of scan reads to total mixed_scan workload (expressed as a percentage)");
+DEFINE_int64(scan_length, 100000, "Number of keys read by a single scan in mixed_scan workload.");
+
 namespace rocksdb {
 
 class CacheBench;
@@ -136,16 +150,32 @@ struct ThreadState {
   uint32_t tid;
   Random rnd;
   SharedState* shared;
+  // Position of the current scan for mixed_scan workload.
+  uint64_t scan_key = 0;
+  int64_t scan_left = 0;
+  QueryId last_query_id;
 
   ThreadState(uint32_t index, SharedState* _shared)
-      : tid(index), rnd(1000 + index), shared(_shared) {}
+      : tid(index), rnd(1000 + index), shared(_shared),
+        last_query_id(static_cast<QueryId>(index + 1) << 40) {}
 };
+
+std::shared_ptr<Cache> CreateCache() {
+  if (FLAGS_cache_type == "clock") {
+    return NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+  }
+  if (FLAGS_cache_type != "lru") {
+    fprintf(stderr, "Unknown cache type: %s\n", FLAGS_cache_type.c_str());
+    exit(1);
+  }
+  return NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+}
 }  // namespace
 
 class CacheBench {
  public:
   CacheBench() :
-      cache_(NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits)),
+      cache_(CreateCache()),
       num_threads_(FLAGS_threads) {}
 
   ~CacheBench() {}
@@ -157,7 +187,7 @@ class CacheBench {
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       // do insert
-      cache_->Insert(key, new char[10], 1, &deleter);
+      cache_->Insert(key, kDefaultQueryId, new char[10], FLAGS_value_size, &deleter);
     }
   }
 
@@ -194,6 +224,12 @@ class CacheBench {
       uint32_t qps = static_cast<uint32_t>(
           static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
       fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
+      const uint64_t hits = hits_.load();
+      const uint64_t lookups = hits + misses_.load();
+      if (lookups != 0) {
+        fprintf(stdout, "Lookups = %" PRIu64 "; hit rate = %.2f%%\n",
+                lookups, 100.0 * hits / lookups);
+      }
     }
     return true;
   }
@@ -201,6 +237,8 @@ class CacheBench {
  private:
   std::shared_ptr<Cache> cache_;
   uint32_t num_threads_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
 
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
@@ -227,7 +265,49 @@ class CacheBench {
     }
   }
 
+  // Reads key from cache and inserts it on miss. Returns true on hit.
+  bool ReadThrough(uint64_t key_value, QueryId query_id) {
+    // Cast uint64* to be char*, data would be copied to cache
+    Slice key(reinterpret_cast<char*>(&key_value), 8);
+    auto handle = cache_->Lookup(key, query_id);
+    if (handle) {
+      cache_->Release(handle);
+      return true;
+    }
+    cache_->Insert(key, query_id, new char[10], FLAGS_value_size, &deleter);
+    return false;
+  }
+
+  // Point reads of hot keys are mixed with scans that read every cold key once per scan,
+  // so a cache could only keep hot keys if scans do not flush them.
+  void OperateCacheMixedScan(ThreadState* thread) {
+    const uint64_t cold_keys = std::max<int64_t>(FLAGS_max_key - FLAGS_hot_keys, 1);
+    uint64_t hits = 0;
+    for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
+      bool hit;
+      if (static_cast<int32_t>(thread->rnd.Uniform(100)) < FLAGS_scan_percent) {
+        if (thread->scan_left == 0) {
+          thread->scan_key = thread->rnd.Next() % cold_keys;
+          thread->scan_left = FLAGS_scan_length;
+          ++thread->last_query_id;
+        }
+        --thread->scan_left;
+        auto key = FLAGS_hot_keys + (thread->scan_key++ % cold_keys);
+        hit = ReadThrough(key, thread->last_query_id);
+      } else {
+        hit = ReadThrough(thread->rnd.Next() % FLAGS_hot_keys, ++thread->last_query_id);
+      }
+      hits += hit;
+    }
+    hits_ += hits;
+    misses_ += FLAGS_ops_per_thread - hits;
+  }
+
   void OperateCache(ThreadState* thread) {
+    if (FLAGS_workload == "mixed_scan") {
+      OperateCacheMixedScan(thread);
+      return;
+    }
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
       uint64_t rand_key = thread->rnd.Next() % FLAGS_max_key;
       // Cast uint64* to be char*, data would be copied to cache
@@ -235,13 +315,16 @@ class CacheBench {
       int32_t prob_op = thread->rnd.Uniform(100);
       if (prob_op >= 0 && prob_op < FLAGS_insert_percent) {
         // do insert
-        cache_->Insert(key, new char[10], 1, &deleter);
+        cache_->Insert(key, kDefaultQueryId, new char[10], FLAGS_value_size, &deleter);
       } else if (prob_op -= FLAGS_insert_percent &&
                  prob_op < FLAGS_lookup_percent) {
         // do lookup
-        auto handle = cache_->Lookup(key);
+        auto handle = cache_->Lookup(key, kDefaultQueryId);
         if (handle) {
+          ++hits_;
           cache_->Release(handle);
+        } else {
+          ++misses_;
         }
       } else if (prob_op -= FLAGS_lookup_percent &&
                  prob_op < FLAGS_erase_percent) {
@@ -256,11 +339,19 @@ class CacheBench {
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
+    printf("Cache type          : %s\n", FLAGS_cache_type.c_str());
+    printf("Value size          : %d\n", FLAGS_value_size);
+    printf("Workload            : %s\n", FLAGS_workload.c_str());
     printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
     printf("Populate cache      : %d\n", FLAGS_populate_cache);
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %d%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %d%%\n", FLAGS_erase_percent);
+    if (FLAGS_workload == "mixed_scan") {
+      printf("Hot keys            : %" PRId64 "\n", FLAGS_hot_keys);
+      printf("Scan percentage     : %d%%\n", FLAGS_scan_percent);
+      printf("Scan length         : %" PRId64 "\n", FLAGS_scan_length);
+    }
     printf("----------------------------\n");
   }
 };
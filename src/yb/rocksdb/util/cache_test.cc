@@ -23,12 +23,14 @@
 
 #include <forward_list>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/random.h"
 
 #include "yb/util/string_util.h"
 #include "yb/util/test_macros.h"
@@ -743,6 +745,178 @@ TEST_F(CacheTest, OverFlowTest) {
   cache->Release(h);
 }
 
+TEST_F(CacheTest, ClockCacheHitAndMiss) {
+  auto cache = NewClockCache(kCacheSize, kNumShardBits);
+  ASSERT_EQ(-1, Lookup(cache, 100));
+
+  ASSERT_OK(Insert(cache, 100, 101));
+  ASSERT_EQ(101, Lookup(cache, 100));
+  ASSERT_EQ(-1, Lookup(cache, 200));
+
+  ASSERT_OK(Insert(cache, 200, 201));
+  ASSERT_EQ(101, Lookup(cache, 100));
+  ASSERT_EQ(201, Lookup(cache, 200));
+
+  ASSERT_OK(Insert(cache, 100, 102));
+  ASSERT_EQ(102, Lookup(cache, 100));
+  ASSERT_EQ(1U, deleted_keys_.size());
+  ASSERT_EQ(100, deleted_keys_[0]);
+  ASSERT_EQ(101, deleted_values_[0]);
+
+  Erase(cache, 100);
+  ASSERT_EQ(-1, Lookup(cache, 100));
+  ASSERT_EQ(201, Lookup(cache, 200));
+  ASSERT_EQ(2U, deleted_keys_.size());
+
+  ASSERT_EQ(-1, Lookup(cache, 200, kNoCacheQueryId));
+  ASSERT_OK(Insert(cache, 300, 301, 1, kNoCacheQueryId));
+  ASSERT_EQ(-1, Lookup(cache, 300));
+}
+
+TEST_F(CacheTest, ClockCachePinnedEntries) {
+  auto cache = NewClockCache(kCacheSize, kNumShardBits);
+  ASSERT_OK(Insert(cache, 100, 101, 10));
+  Cache::Handle* h1 = cache->Lookup(EncodeKey(100), kTestQueryId);
+  Cache::Handle* h2 = cache->Lookup(EncodeKey(100), kTestQueryId);
+  ASSERT_EQ(10, cache->GetUsage());
+  ASSERT_EQ(10, cache->GetPinnedUsage());
+
+  // Erased entry is not counted anymore, but it is alive until the last handle is released.
+  Erase(cache, 100);
+  ASSERT_EQ(0, cache->GetUsage());
+  ASSERT_EQ(0, cache->GetPinnedUsage());
+  ASSERT_EQ(101, DecodeValue(cache->Value(h1)));
+  cache->Release(h1);
+  ASSERT_EQ(0U, deleted_keys_.size());
+  cache->Release(h2);
+  ASSERT_EQ(1U, deleted_keys_.size());
+
+  ASSERT_OK(Insert(cache, 200, 201, 10));
+  h1 = cache->Lookup(EncodeKey(200), kTestQueryId);
+  ASSERT_EQ(10, cache->GetPinnedUsage());
+  cache->Release(h1);
+  ASSERT_EQ(0, cache->GetPinnedUsage());
+  ASSERT_EQ(10, cache->GetUsage());
+}
+
+// Frequently accessed entries should survive a scan over a much larger set of keys.
+TEST_F(CacheTest, ClockCacheScanResistance) {
+  constexpr size_t kEntries = 100;
+  constexpr size_t kCharge = 64 * 1024;
+  constexpr int kHotKeys = 50;
+  constexpr int kScanKeys = 1000;
+
+  auto cache = NewClockCache(kEntries * kCharge, 0);
+  for (int i = 0; i != kHotKeys; ++i) {
+    ASSERT_OK(Insert(cache, i, i, kCharge));
+    for (int j = 0; j != 10; ++j) {
+      ASSERT_EQ(i, Lookup(cache, i));
+    }
+  }
+
+  for (int i = kHotKeys; i != kHotKeys + kScanKeys; ++i) {
+    if (Lookup(cache, i) == -1) {
+      ASSERT_OK(Insert(cache, i, i, kCharge));
+    }
+    ASSERT_LE(cache->GetUsage(), kEntries * kCharge);
+  }
+  ASSERT_EQ(kEntries * kCharge, cache->GetUsage());
+
+  for (int i = 0; i != kHotKeys; ++i) {
+    ASSERT_EQ(i, Lookup(cache, i));
+  }
+}
+
+TEST_F(CacheTest, ClockCacheRejectedEntryHandle) {
+  constexpr int kCapacity = 10;
+  auto cache = NewClockCache(kCapacity, 0);
+  for (int i = 0; i != kCapacity; ++i) {
+    ASSERT_OK(Insert(cache, i, i));
+    for (int j = 0; j != 3; ++j) {
+      ASSERT_EQ(i, Lookup(cache, i));
+    }
+  }
+
+  // New entry is accessed less frequently than cached ones, so it is not admitted, but is still
+  // available through the handle.
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(cache->Insert(
+      EncodeKey(100), kTestQueryId, EncodeValue(101), 1, &CacheTest::Deleter, &handle));
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(101, DecodeValue(cache->Value(handle)));
+  ASSERT_EQ(-1, Lookup(cache, 100));
+  ASSERT_EQ(kCapacity, cache->GetUsage());
+  ASSERT_EQ(0, cache->GetPinnedUsage());
+  ASSERT_EQ(0U, deleted_keys_.size());
+  cache->Release(handle);
+  ASSERT_EQ(std::vector<int>{100}, deleted_keys_);
+
+  ASSERT_OK(Insert(cache, 200, 201));
+  ASSERT_EQ((std::vector<int>{100, 200}), deleted_keys_);
+  for (int i = 0; i != kCapacity; ++i) {
+    ASSERT_EQ(i, Lookup(cache, i));
+  }
+}
+
+TEST_F(CacheTest, ClockCacheStrictCapacityLimit) {
+  auto cache = NewClockCache(2, 0, true);
+  ASSERT_TRUE(cache->HasStrictCapacityLimit());
+  std::vector<Cache::Handle*> handles(2);
+  for (int i = 0; i != 2; ++i) {
+    ASSERT_OK(cache->Insert(
+        EncodeKey(i), kTestQueryId, EncodeValue(i), 1, &CacheTest::Deleter, &handles[i]));
+  }
+
+  Cache::Handle* handle = nullptr;
+  auto s = cache->Insert(
+      EncodeKey(100), kTestQueryId, EncodeValue(100), 1, &CacheTest::Deleter, &handle);
+  ASSERT_TRUE(s.IsIncomplete());
+  ASSERT_EQ(nullptr, handle);
+  ASSERT_TRUE(Insert(cache, 100, 100).IsIncomplete());
+  ASSERT_EQ(std::vector<int>{100}, deleted_keys_);
+  ASSERT_EQ(2, cache->GetUsage());
+
+  for (auto* h : handles) {
+    cache->Release(h);
+  }
+  ASSERT_OK(Insert(cache, 100, 100));
+  ASSERT_EQ(100, Lookup(cache, 100));
+}
+
+TEST_F(CacheTest, ClockCacheConcurrentAccess) {
+  constexpr int kThreads = 4;
+  constexpr int kKeys = 200;
+  constexpr int kOpsPerThread = 20000;
+
+  auto cache = NewClockCache(kKeys / 2, 2);
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([&cache, t] {
+      Random rnd(t + 1);
+      for (int i = 0; i != kOpsPerThread; ++i) {
+        auto key = EncodeKey(rnd.Uniform(kKeys));
+        auto* handle = cache->Lookup(key, kTestQueryId);
+        if (handle == nullptr) {
+          ASSERT_OK(cache->Insert(key, kTestQueryId, new int(DecodeKey(key)), 1,
+                                  [](const Slice&, void* value) {
+            delete static_cast<int*>(value);
+          }, &handle));
+        }
+        ASSERT_EQ(DecodeKey(key), *static_cast<int*>(cache->Value(handle)));
+        cache->Release(handle);
+        if (rnd.OneIn(100)) {
+          cache->Erase(key);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, cache->GetPinnedUsage());
+  ASSERT_LE(cache->GetUsage(), kKeys / 2);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -0,0 +1,766 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "yb/rocksdb/cache.h"
+#include "yb/rocksdb/port/port.h"
+#include "yb/rocksdb/statistics.h"
+#include "yb/rocksdb/util/autovector.h"
+#include "yb/rocksdb/util/hash.h"
+#include "yb/rocksdb/util/mutexlock.h"
+#include "yb/rocksdb/util/statistics.h"
+
+#include "yb/util/cache_metrics.h"
+#include "yb/util/metrics.h"
+#include "yb/util/random_util.h"
+
+namespace rocksdb {
+
+namespace {
+
+// CLOCK cache with frequency based admission.
+//
+// Entries of a shard form a circular list traversed by the clock hand. Lookup only takes the
+// shard lock in shared mode and marks the entry as referenced using an atomic flag, so hits from
+// different threads do not serialize on the shard mutex. The clock hand gives referenced entries
+// a second chance and evicts entries that were not accessed since the previous pass.
+//
+// Admission is controlled by a count-min sketch of recent access frequencies (TinyLFU). A new
+// entry is not admitted when it is less frequently accessed than the victim selected by the
+// clock hand, so blocks read once by a large scan or compaction do not evict hot blocks. Such
+// entries are still returned to the caller through the handle and freed when it is released.
+
+// Bit 0 of ClockHandle::state is set while entry is in cache, the remaining bits count external
+// references.
+constexpr uint32_t kInCacheBit = 1;
+constexpr uint32_t kOneRef = 2;
+
+// Candidate frequency that makes the entry always admitted.
+constexpr uint32_t kAlwaysAdmit = std::numeric_limits<uint32_t>::max();
+
+struct ClockHandle {
+  void* value;
+  void (*deleter)(const Slice&, void* value);
+  ClockHandle* next_hash;
+  // Neighbours in the circular list of entries that are in cache.
+  ClockHandle* next;
+  ClockHandle* prev;
+  size_t charge;
+  size_t key_length;
+  uint32_t hash;
+  std::atomic<uint32_t> state;
+  // Set on access, cleared when clock hand passes the entry.
+  std::atomic<bool> referenced;
+  char key_data[1];   // Beginning of key
+
+  Slice key() const {
+    return Slice(key_data, key_length);
+  }
+
+  uint32_t refs() const {
+    return state.load(std::memory_order_acquire) / kOneRef;
+  }
+
+  static ClockHandle* Create(
+      const Slice& key, uint32_t hash, void* value, size_t charge,
+      void (*deleter)(const Slice& key, void* value)) {
+    auto* mem = new char[sizeof(ClockHandle) - 1 + key.size()];
+    auto* result = new (mem) ClockHandle;
+    result->value = value;
+    result->deleter = deleter;
+    result->next_hash = result->next = result->prev = nullptr;
+    result->charge = charge;
+    result->key_length = key.size();
+    result->hash = hash;
+    result->state.store(0, std::memory_order_relaxed);
+    result->referenced.store(false, std::memory_order_relaxed);
+    memcpy(result->key_data, key.data(), key.size());
+    return result;
+  }
+
+  // Calls deleter and frees memory.
+  void Free() {
+    (*deleter)(key(), value);
+    Destroy();
+  }
+
+  // Frees memory without calling deleter.
+  void Destroy() {
+    this->~ClockHandle();
+    delete[] reinterpret_cast<char*>(this);
+  }
+};
+
+// Chained hash table of cache entries, see HandleTable in cache.cc.
+class ClockHandleTable {
+ public:
+  ClockHandleTable() { Resize(); }
+
+  ~ClockHandleTable() {
+    delete[] list_;
+  }
+
+  ClockHandle* Lookup(const Slice& key, uint32_t hash) const {
+    return *FindPointer(key, hash);
+  }
+
+  // REQUIRES: there is no entry with the same key in table.
+  void Insert(ClockHandle* h) {
+    ClockHandle** ptr = FindPointer(h->key(), h->hash);
+    assert(*ptr == nullptr);
+    h->next_hash = nullptr;
+    *ptr = h;
+    if (++elems_ > length_) {
+      Resize();
+    }
+  }
+
+  ClockHandle* Remove(const Slice& key, uint32_t hash) {
+    ClockHandle** ptr = FindPointer(key, hash);
+    ClockHandle* result = *ptr;
+    if (result != nullptr) {
+      *ptr = result->next_hash;
+      --elems_;
+    }
+    return result;
+  }
+
+  uint32_t size() const {
+    return elems_;
+  }
+
+ private:
+  ClockHandle** FindPointer(const Slice& key, uint32_t hash) const {
+    ClockHandle** ptr = &list_[hash & (length_ - 1)];
+    while (*ptr != nullptr && ((*ptr)->hash != hash || key != (*ptr)->key())) {
+      ptr = &(*ptr)->next_hash;
+    }
+    return ptr;
+  }
+
+  void Resize() {
+    uint32_t new_length = 16;
+    while (new_length < elems_ * 1.5) {
+      new_length *= 2;
+    }
+    auto** new_list = new ClockHandle*[new_length];
+    memset(new_list, 0, sizeof(new_list[0]) * new_length);
+    for (uint32_t i = 0; i < length_; i++) {
+      ClockHandle* h = list_[i];
+      while (h != nullptr) {
+        ClockHandle* next = h->next_hash;
+        ClockHandle** ptr = &new_list[h->hash & (new_length - 1)];
+        h->next_hash = *ptr;
+        *ptr = h;
+        h = next;
+      }
+    }
+    delete[] list_;
+    list_ = new_list;
+    length_ = new_length;
+  }
+
+  uint32_t length_ = 0;
+  uint32_t elems_ = 0;
+  ClockHandle** list_ = nullptr;
+};
+
+// Count-min sketch with saturating 8 bit counters that estimates recent access frequency of keys.
+// All counters are halved after the number of recorded accesses reaches half of the number of
+// counters, so old accesses are gradually forgotten and collisions do not accumulate.
+// Counters are updated with relaxed atomics without read-modify-write, so concurrent updates could
+// be lost. It is acceptable since the sketch is an estimate anyway.
+class FrequencySketch {
+ public:
+  // Not thread safe.
+  void Resize(size_t num_counters) {
+    size_t size = 1024;
+    while (size < num_counters) {
+      size *= 2;
+    }
+    counters_.reset(new std::atomic<uint8_t>[size]);
+    for (size_t i = 0; i != size; ++i) {
+      counters_[i].store(0, std::memory_order_relaxed);
+    }
+    mask_ = size - 1;
+    sample_size_ = size / 2;
+    samples_.store(0, std::memory_order_relaxed);
+  }
+
+  void Record(uint32_t hash) {
+    for (int i = 0; i != kDepth; ++i) {
+      auto& counter = counters_[Index(hash, i)];
+      auto value = counter.load(std::memory_order_relaxed);
+      if (value != std::numeric_limits<uint8_t>::max()) {
+        counter.store(value + 1, std::memory_order_relaxed);
+      }
+    }
+    if (samples_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_) {
+      for (size_t i = 0; i <= mask_; ++i) {
+        counters_[i].store(counters_[i].load(std::memory_order_relaxed) / 2,
+                           std::memory_order_relaxed);
+      }
+      samples_.fetch_sub(sample_size_ / 2, std::memory_order_relaxed);
+    }
+  }
+
+  uint32_t Estimate(uint32_t hash) const {
+    uint32_t result = std::numeric_limits<uint8_t>::max();
+    for (int i = 0; i != kDepth; ++i) {
+      result = std::min<uint32_t>(
+          result, counters_[Index(hash, i)].load(std::memory_order_relaxed));
+    }
+    return result;
+  }
+
+ private:
+  static constexpr int kDepth = 4;
+
+  // Double hashing over 64 bit mix of the key hash.
+  size_t Index(uint32_t hash, int i) const {
+    uint64_t h = hash * 0x9E3779B97F4A7C15ULL;
+    return (h + i * ((h >> 32) | 1)) & mask_;
+  }
+
+  std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+  size_t mask_ = 0;
+  size_t sample_size_ = 0;
+  std::atomic<size_t> samples_{0};
+};
+
+class ClockHandleDeleter {
+ public:
+  void Add(ClockHandle* handle) {
+    handles_.push_back(handle);
+  }
+
+  size_t TotalCharge() const {
+    size_t result = 0;
+    for (ClockHandle* handle : handles_) {
+      result += handle->charge;
+    }
+    return result;
+  }
+
+  ~ClockHandleDeleter() {
+    for (ClockHandle* handle : handles_) {
+      handle->Free();
+    }
+  }
+
+ private:
+  autovector<ClockHandle*> handles_;
+};
+
+// A single shard of sharded clock cache.
+class ClockCacheShard {
+ public:
+  ClockCacheShard() = default;
+  ~ClockCacheShard();
+
+  void SetCapacity(size_t capacity);
+
+  void SetStrictCapacityLimit(bool strict_capacity_limit) {
+    WriteLock l(&mutex_);
+    strict_capacity_limit_ = strict_capacity_limit;
+  }
+
+  void SetMetrics(shared_ptr<yb::CacheMetrics> metrics) {
+    WriteLock l(&mutex_);
+    metrics_ = std::move(metrics);
+  }
+
+  Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value), Cache::Handle** handle,
+                Statistics* statistics);
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash, Statistics* statistics);
+  void Release(Cache::Handle* handle);
+  void Erase(const Slice& key, uint32_t hash);
+  size_t Evict(size_t required);
+
+  size_t GetUsage() const {
+    return usage_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetPinnedUsage() const {
+    return pinned_usage_.load(std::memory_order_relaxed);
+  }
+
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t), bool thread_safe);
+
+ private:
+  // Adds entry to table and clock list. Entry is placed right before the clock hand, so it is
+  // visited last.
+  void AddToCache(ClockHandle* e);
+
+  // Removes entry from table and clock list. Adds it to deleted when it is not referenced
+  // externally.
+  void RemoveFromCache(ClockHandle* e, ClockHandleDeleter* deleted);
+
+  // Moves clock hand evicting entries until usage drops to target_usage. Returns false when
+  // entry with candidate_freq access frequency should not be admitted, because it is accessed
+  // less frequently than the next victim.
+  bool EvictUntil(size_t target_usage, uint32_t candidate_freq, ClockHandleDeleter* deleted);
+
+  void UsageChanged(ClockHandle* e, bool added);
+
+  mutable port::RWMutex mutex_;
+
+  // Protected by mutex_.
+  ClockHandleTable table_;
+  ClockHandle* hand_ = nullptr;
+  size_t capacity_ = 0;
+  bool strict_capacity_limit_ = false;
+  shared_ptr<yb::CacheMetrics> metrics_;
+
+  // Structure is protected by mutex_, counters are updated under shared lock.
+  FrequencySketch sketch_;
+
+  // Modified under exclusive lock only.
+  std::atomic<size_t> usage_{0};
+  // Charge of entries that are in cache and referenced externally.
+  std::atomic<size_t> pinned_usage_{0};
+};
+
+ClockCacheShard::~ClockCacheShard() {
+  if (hand_ == nullptr) {
+    return;
+  }
+  auto* e = hand_;
+  do {
+    auto* next = e->next;
+    // Entries still referenced externally are leaked, see LRUCache.
+    if (e->refs() == 0) {
+      e->Free();
+    }
+    e = next;
+  } while (e != hand_);
+}
+
+void ClockCacheShard::SetCapacity(size_t capacity) {
+  // Assume that entries are not smaller than 1KB, so the sketch has several counters per cached
+  // entry and remembers accesses to keys that were recently evicted.
+  constexpr size_t kSketchCounterPerBytes = 1024;
+
+  ClockHandleDeleter deleted;
+  WriteLock l(&mutex_);
+  capacity_ = capacity;
+  sketch_.Resize(capacity / kSketchCounterPerBytes);
+  EvictUntil(capacity, kAlwaysAdmit, &deleted);
+}
+
+void ClockCacheShard::UsageChanged(ClockHandle* e, bool added) {
+  if (added) {
+    usage_.fetch_add(e->charge, std::memory_order_relaxed);
+  } else {
+    usage_.fetch_sub(e->charge, std::memory_order_relaxed);
+  }
+  if (metrics_) {
+    if (added) {
+      metrics_->cache_usage->IncrementBy(e->charge);
+      metrics_->multi_touch_cache_usage->IncrementBy(e->charge);
+    } else {
+      metrics_->cache_usage->DecrementBy(e->charge);
+      metrics_->multi_touch_cache_usage->DecrementBy(e->charge);
+    }
+  }
+}
+
+void ClockCacheShard::AddToCache(ClockHandle* e) {
+  table_.Insert(e);
+  if (hand_ == nullptr) {
+    e->next = e->prev = e;
+    hand_ = e;
+  } else {
+    e->next = hand_;
+    e->prev = hand_->prev;
+    e->prev->next = e;
+    hand_->prev = e;
+  }
+  UsageChanged(e, true);
+}
+
+void ClockCacheShard::RemoveFromCache(ClockHandle* e, ClockHandleDeleter* deleted) {
+  table_.Remove(e->key(), e->hash);
+  if (e->next == e) {
+    hand_ = nullptr;
+  } else {
+    if (hand_ == e) {
+      hand_ = e->next;
+    }
+    e->prev->next = e->next;
+    e->next->prev = e->prev;
+  }
+  e->next = e->prev = nullptr;
+  UsageChanged(e, false);
+
+  auto prev_state = e->state.fetch_and(~kInCacheBit, std::memory_order_acq_rel);
+  if (prev_state == kInCacheBit) {
+    deleted->Add(e);
+  } else {
+    pinned_usage_.fetch_sub(e->charge, std::memory_order_relaxed);
+  }
+}
+
+bool ClockCacheShard::EvictUntil(
+    size_t target_usage, uint32_t candidate_freq, ClockHandleDeleter* deleted) {
+  // Every entry is visited at most twice: the first visit could only clear referenced flag.
+  size_t steps_left = 2 * table_.size();
+  while (usage_.load(std::memory_order_relaxed) > target_usage && hand_ != nullptr &&
+         steps_left-- > 0) {
+    auto* e = hand_;
+    // Lookup could not run concurrently, so pinned entry could not become unpinned.
+    if (e->state.load(std::memory_order_acquire) != kInCacheBit) {
+      hand_ = e->next;
+      continue;
+    }
+    if (e->referenced.load(std::memory_order_relaxed)) {
+      e->referenced.store(false, std::memory_order_relaxed);
+      hand_ = e->next;
+      continue;
+    }
+    if (candidate_freq != kAlwaysAdmit && candidate_freq < sketch_.Estimate(e->hash)) {
+      return false;
+    }
+    RemoveFromCache(e, deleted);
+    if (metrics_) {
+      metrics_->evictions->Increment();
+    }
+  }
+  return true;
+}
+
+Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash, Statistics* statistics) {
+  ClockHandle* e;
+  {
+    ReadLock l(&mutex_);
+    sketch_.Record(hash);
+    e = table_.Lookup(key, hash);
+    if (e != nullptr) {
+      if (e->state.fetch_add(kOneRef, std::memory_order_acq_rel) == kInCacheBit) {
+        pinned_usage_.fetch_add(e->charge, std::memory_order_relaxed);
+      }
+      // Avoid writing to the cache line shared with other readers when flag is already set.
+      if (!e->referenced.load(std::memory_order_relaxed)) {
+        e->referenced.store(true, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  if (statistics != nullptr) {
+    if (e != nullptr) {
+      RecordTick(statistics, BLOCK_CACHE_HIT);
+      RecordTick(statistics, BLOCK_CACHE_BYTES_READ, e->charge);
+    } else {
+      RecordTick(statistics, BLOCK_CACHE_MISS);
+    }
+  }
+  if (metrics_ != nullptr) {
+    metrics_->lookups->Increment();
+    if (e != nullptr) {
+      metrics_->cache_hits->Increment();
+    } else {
+      metrics_->cache_misses->Increment();
+    }
+  }
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+void ClockCacheShard::Release(Cache::Handle* handle) {
+  if (handle == nullptr) {
+    return;
+  }
+  auto* e = reinterpret_cast<ClockHandle*>(handle);
+  auto prev_state = e->state.fetch_sub(kOneRef, std::memory_order_acq_rel);
+  if (prev_state == kInCacheBit + kOneRef) {
+    pinned_usage_.fetch_sub(e->charge, std::memory_order_relaxed);
+  } else if (prev_state == kOneRef) {
+    // The last reference to entry that is not in cache.
+    e->Free();
+  }
+}
+
+Status ClockCacheShard::Insert(
+    const Slice& key, uint32_t hash, void* value, size_t charge,
+    void (*deleter)(const Slice& key, void* value), Cache::Handle** handle,
+    Statistics* statistics) {
+  auto* e = ClockHandle::Create(key, hash, value, charge, deleter);
+  Status s;
+  bool admitted = false;
+  ClockHandleDeleter deleted;
+  {
+    WriteLock l(&mutex_);
+    sketch_.Record(hash);
+    auto* old = table_.Lookup(key, hash);
+    uint32_t candidate_freq = kAlwaysAdmit;
+    if (old != nullptr) {
+      // Replacing existing entry does not require admission.
+      RemoveFromCache(old, &deleted);
+    } else {
+      candidate_freq = sketch_.Estimate(hash);
+    }
+    const size_t target_usage = capacity_ > charge ? capacity_ - charge : 0;
+    admitted = EvictUntil(target_usage, candidate_freq, &deleted);
+    if (strict_capacity_limit_ && GetUsage() + charge > capacity_) {
+      if (handle == nullptr) {
+        deleted.Add(e);
+      } else {
+        e->Destroy();
+        *handle = nullptr;
+      }
+      s = STATUS(Incomplete, "Insert failed due to clock cache being full.");
+    } else if (!admitted) {
+      // Entry is still available to the caller through the handle, and is freed on release.
+      if (handle == nullptr) {
+        deleted.Add(e);
+      } else {
+        e->state.store(kOneRef, std::memory_order_release);
+        *handle = reinterpret_cast<Cache::Handle*>(e);
+      }
+    } else {
+      if (handle == nullptr) {
+        e->state.store(kInCacheBit, std::memory_order_release);
+      } else {
+        e->state.store(kInCacheBit + kOneRef, std::memory_order_release);
+        pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
+        *handle = reinterpret_cast<Cache::Handle*>(e);
+      }
+      // Note that the cache might get larger than its capacity if not enough space was freed.
+      AddToCache(e);
+      if (metrics_) {
+        metrics_->inserts->Increment();
+      }
+    }
+  }
+
+  if (statistics != nullptr) {
+    if (s.ok() && admitted) {
+      RecordTick(statistics, BLOCK_CACHE_ADD);
+      RecordTick(statistics, BLOCK_CACHE_BYTES_WRITE, charge);
+    } else {
+      RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
+    }
+  }
+  return s;
+}
+
+void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  ClockHandleDeleter deleted;
+  WriteLock l(&mutex_);
+  auto* e = table_.Lookup(key, hash);
+  if (e != nullptr) {
+    RemoveFromCache(e, &deleted);
+  }
+}
+
+size_t ClockCacheShard::Evict(size_t required) {
+  ClockHandleDeleter deleted;
+  {
+    WriteLock l(&mutex_);
+    auto usage = GetUsage();
+    EvictUntil(usage > required ? usage - required : 0, kAlwaysAdmit, &deleted);
+  }
+  return deleted.TotalCharge();
+}
+
+void ClockCacheShard::ApplyToAllCacheEntries(
+    void (*callback)(void*, size_t), bool thread_safe) {
+  if (thread_safe) {
+    mutex_.ReadLock();
+  }
+  if (hand_ != nullptr) {
+    auto* e = hand_;
+    do {
+      callback(e->value, e->charge);
+      e = e->next;
+    } while (e != hand_);
+  }
+  if (thread_safe) {
+    mutex_.ReadUnlock();
+  }
+}
+
+class ShardedClockCache : public Cache {
+ public:
+  ShardedClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit)
+      : num_shard_bits_(num_shard_bits),
+        capacity_(capacity),
+        strict_capacity_limit_(strict_capacity_limit) {
+    int num_shards = 1 << num_shard_bits_;
+    shards_ = new ClockCacheShard[num_shards];
+    const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
+    for (int s = 0; s < num_shards; s++) {
+      shards_[s].SetStrictCapacityLimit(strict_capacity_limit);
+      shards_[s].SetCapacity(per_shard);
+    }
+  }
+
+  virtual ~ShardedClockCache() {
+    delete[] shards_;
+  }
+
+  void SetCapacity(size_t capacity) override {
+    int num_shards = 1 << num_shard_bits_;
+    const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
+    MutexLock l(&capacity_mutex_);
+    for (int s = 0; s < num_shards; s++) {
+      shards_[s].SetCapacity(per_shard);
+    }
+    capacity_ = capacity;
+  }
+
+  Status Insert(const Slice& key, const QueryId query_id, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value),
+                Handle** handle, Statistics* statistics) override {
+    // Queries with no cache query ids are not cached.
+    if (query_id == kNoCacheQueryId) {
+      return Status::OK();
+    }
+    const uint32_t hash = HashSlice(key);
+    return shards_[Shard(hash)].Insert(key, hash, value, charge, deleter, handle, statistics);
+  }
+
+  Handle* Lookup(const Slice& key, const QueryId query_id, Statistics* statistics) override {
+    if (query_id == kNoCacheQueryId) {
+      return nullptr;
+    }
+    const uint32_t hash = HashSlice(key);
+    return shards_[Shard(hash)].Lookup(key, hash, statistics);
+  }
+
+  void Release(Handle* handle) override {
+    if (handle == nullptr) {
+      return;
+    }
+    auto* h = reinterpret_cast<ClockHandle*>(handle);
+    shards_[Shard(h->hash)].Release(handle);
+  }
+
+  void Erase(const Slice& key) override {
+    const uint32_t hash = HashSlice(key);
+    shards_[Shard(hash)].Erase(key, hash);
+  }
+
+  void* Value(Handle* handle) override {
+    return reinterpret_cast<ClockHandle*>(handle)->value;
+  }
+
+  uint64_t NewId() override {
+    MutexLock l(&id_mutex_);
+    return ++(last_id_);
+  }
+
+  size_t GetCapacity() const override { return capacity_; }
+
+  bool HasStrictCapacityLimit() const override {
+    return strict_capacity_limit_;
+  }
+
+  size_t GetUsage() const override {
+    int num_shards = 1 << num_shard_bits_;
+    size_t usage = 0;
+    for (int s = 0; s < num_shards; s++) {
+      usage += shards_[s].GetUsage();
+    }
+    return usage;
+  }
+
+  size_t GetUsage(Handle* handle) const override {
+    return reinterpret_cast<ClockHandle*>(handle)->charge;
+  }
+
+  size_t GetPinnedUsage() const override {
+    int num_shards = 1 << num_shard_bits_;
+    size_t usage = 0;
+    for (int s = 0; s < num_shards; s++) {
+      usage += shards_[s].GetPinnedUsage();
+    }
+    return usage;
+  }
+
+  size_t Evict(size_t bytes_to_evict) override {
+    auto num_shards = 1ULL << num_shard_bits_;
+    size_t total_evicted = 0;
+    // Start at random shard.
+    auto index = Shard(yb::RandomUniformInt<uint32_t>());
+    for (size_t i = 0; bytes_to_evict > total_evicted && i != num_shards; ++i) {
+      total_evicted += shards_[index].Evict(bytes_to_evict - total_evicted);
+      index = (index + 1) & (num_shards - 1);
+    }
+    return total_evicted;
+  }
+
+  void DisownData() override {
+    shards_ = nullptr;
+  }
+
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t), bool thread_safe) override {
+    int num_shards = 1 << num_shard_bits_;
+    for (int s = 0; s < num_shards; s++) {
+      shards_[s].ApplyToAllCacheEntries(callback, thread_safe);
+    }
+  }
+
+  void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) override {
+    int num_shards = 1 << num_shard_bits_;
+    metrics_ = std::make_shared<yb::CacheMetrics>(entity);
+    for (int s = 0; s < num_shards; s++) {
+      shards_[s].SetMetrics(metrics_);
+    }
+  }
+
+  // Clock cache does not have single-touch part, so all usage is reported as multi-touch.
+  std::vector<std::pair<size_t, size_t>> TEST_GetIndividualUsages() override {
+    std::vector<std::pair<size_t, size_t>> cache_sizes;
+    cache_sizes.reserve(1 << num_shard_bits_);
+    for (int i = 0; i < 1 << num_shard_bits_; ++i) {
+      cache_sizes.emplace_back(0, shards_[i].GetUsage());
+    }
+    return cache_sizes;
+  }
+
+ private:
+  static inline uint32_t HashSlice(const Slice& s) {
+    return Hash(s.data(), s.size(), 0);
+  }
+
+  uint32_t Shard(uint32_t hash) {
+    // Note, hash >> 32 yields hash in gcc, not the zero we expect!
+    return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
+  }
+
+  ClockCacheShard* shards_;
+  port::Mutex id_mutex_;
+  port::Mutex capacity_mutex_;
+  uint64_t last_id_ = 0;
+  size_t num_shard_bits_;
+  size_t capacity_;
+  bool strict_capacity_limit_;
+  shared_ptr<yb::CacheMetrics> metrics_;
+};
+
+} // namespace
+
+shared_ptr<Cache> NewClockCache(size_t capacity, int num_shard_bits,
+                                bool strict_capacity_limit) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  return std::make_shared<ShardedClockCache>(capacity, num_shard_bits, strict_capacity_limit);
+}
+
+} // namespace rocksdb
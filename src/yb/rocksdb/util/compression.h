@@ -25,7 +25,9 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "yb/rocksdb/options.h"
 #include "yb/rocksdb/util/coding.h"
@@ -48,6 +50,7 @@
 #endif
 
 #if defined(ZSTD)
+#include <zdict.h>
 #include <zstd.h>
 #endif
 
@@ -102,6 +105,7 @@ inline bool CompressionTypeSupported(CompressionType compression_type) {
       return LZ4_Supported();
     case kLZ4HCCompression:
       return LZ4_Supported();
+    case kZSTD:
     case kZSTDNotFinalCompression:
       return ZSTD_Supported();
     default:
@@ -124,8 +128,10 @@ inline std::string CompressionTypeToString(CompressionType compression_type) {
       return "LZ4";
     case kLZ4HCCompression:
       return "LZ4HC";
-    case kZSTDNotFinalCompression:
+    case kZSTD:
       return "ZSTD";
+    case kZSTDNotFinalCompression:
+      return "ZSTDNotFinal";
     default:
       assert(false);
       return "";
@@ -620,8 +626,133 @@ inline bool LZ4HC_Compress(const CompressionOptions& opts,
   return false;
 }
 
+#ifdef ZSTD
+namespace compression {
+
+// ZSTD contexts are reused by the thread to avoid allocating them for each block.
+inline ZSTD_CCtx* ThreadLocalZSTDCompressionContext() {
+  struct Holder {
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    ~Holder() { ZSTD_freeCCtx(context); }
+  };
+  thread_local Holder holder;
+  return holder.context;
+}
+
+inline ZSTD_DCtx* ThreadLocalZSTDDecompressionContext() {
+  struct Holder {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    ~Holder() { ZSTD_freeDCtx(context); }
+  };
+  thread_local Holder holder;
+  return holder.context;
+}
+
+// Level -1 means default level for all compression libraries.
+inline int ZSTD_Level(const CompressionOptions& opts) {
+  return opts.level < 0 ? ZSTD_CLEVEL_DEFAULT : opts.level;
+}
+
+} // namespace compression
+#endif
+
+// ZSTD dictionary shared by data blocks of a single SST file, digested for compression.
+// Digesting a dictionary costs much more than compressing a single block, so it is done once.
+class CompressionDict {
+ public:
+  CompressionDict(std::string dict, const CompressionOptions& opts) : dict_(std::move(dict)) {
+#ifdef ZSTD
+    cdict_ = ZSTD_createCDict(dict_.data(), dict_.size(), compression::ZSTD_Level(opts));
+#endif
+  }
+
+  ~CompressionDict() {
+#ifdef ZSTD
+    ZSTD_freeCDict(cdict_);
+#endif
+  }
+
+  CompressionDict(const CompressionDict&) = delete;
+  void operator=(const CompressionDict&) = delete;
+
+  const std::string& data() const { return dict_; }
+
+#ifdef ZSTD
+  const ZSTD_CDict* cdict() const { return cdict_; }
+#endif
+
+ private:
+  std::string dict_;
+#ifdef ZSTD
+  ZSTD_CDict* cdict_ = nullptr;
+#endif
+};
+
+// ZSTD dictionary read from SST file, digested for decompression. Kept by table reader.
+class UncompressionDict {
+ public:
+  explicit UncompressionDict(std::string dict) : dict_(std::move(dict)) {
+#ifdef ZSTD
+    ddict_ = ZSTD_createDDict(dict_.data(), dict_.size());
+#endif
+  }
+
+  ~UncompressionDict() {
+#ifdef ZSTD
+    ZSTD_freeDDict(ddict_);
+#endif
+  }
+
+  UncompressionDict(const UncompressionDict&) = delete;
+  void operator=(const UncompressionDict&) = delete;
+
+  const std::string& data() const { return dict_; }
+
+  size_t ApproximateMemoryUsage() const {
+#ifdef ZSTD
+    return dict_.size() + ZSTD_sizeof_DDict(ddict_);
+#endif
+    return dict_.size();
+  }
+
+#ifdef ZSTD
+  const ZSTD_DDict* ddict() const { return ddict_; }
+#endif
+
+ private:
+  std::string dict_;
+#ifdef ZSTD
+  ZSTD_DDict* ddict_ = nullptr;
+#endif
+};
+
+// Trains ZSTD dictionary of at most max_dict_bytes on samples, concatenated into single buffer.
+// Returns empty string when ZSTD is not supported or training failed, for instance because there
+// are too few samples.
+inline std::string ZSTD_TrainDictionary(const std::string& samples,
+                                        const std::vector<size_t>& sample_lengths,
+                                        size_t max_dict_bytes) {
+#ifdef ZSTD
+  if (sample_lengths.empty() || max_dict_bytes == 0) {
+    return std::string();
+  }
+  std::string dict(max_dict_bytes, '\0');
+  size_t dict_size = ZDICT_trainFromBuffer(
+      &dict[0], max_dict_bytes, samples.data(), sample_lengths.data(),
+      static_cast<unsigned>(sample_lengths.size()));
+  if (ZDICT_isError(dict_size)) {
+    return std::string();
+  }
+  dict.resize(dict_size);
+  return dict;
+#endif
+  return std::string();
+}
+
+// dict is used when not null, it should be created with the same compression options.
 inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
-                          size_t length, ::std::string* output) {
+                          size_t length, ::std::string* output,
+                          const CompressionDict* dict = nullptr) {
 #ifdef ZSTD
   if (length > std::numeric_limits<uint32_t>::max()) {
     // Can't compress more than 4GB
@@ -633,9 +764,13 @@ inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
 
   size_t compressBound = ZSTD_compressBound(length);
   output->resize(static_cast<size_t>(output_header_len + compressBound));
-  size_t outlen = ZSTD_compress(&(*output)[output_header_len], compressBound,
-                                input, length, opts.level);
-  if (outlen == 0) {
+  auto* context = compression::ThreadLocalZSTDCompressionContext();
+  size_t outlen = dict != nullptr
+      ? ZSTD_compress_usingCDict(context, &(*output)[output_header_len], compressBound,
+                                 input, length, dict->cdict())
+      : ZSTD_compressCCtx(context, &(*output)[output_header_len], compressBound,
+                          input, length, compression::ZSTD_Level(opts));
+  if (outlen == 0 || ZSTD_isError(outlen)) {
     return false;
   }
   output->resize(output_header_len + outlen);
@@ -644,8 +779,11 @@ inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
   return false;
 }
 
+// Blocks compressed without dictionary could be decompressed with dictionary, so dict could be
+// specified for all blocks of SST file that has a dictionary.
 inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
-                             int* decompress_size) {
+                             int* decompress_size,
+                             const UncompressionDict* dict = nullptr) {
 #ifdef ZSTD
   uint32_t output_len = 0;
   if (!compression::GetDecompressedSizeInfo(&input_data, &input_length,
@@ -653,12 +791,17 @@ inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
     return nullptr;
   }
 
-  char* output = new char[output_len];
-  size_t actual_output_length =
-      ZSTD_decompress(output, output_len, input_data, input_length);
-  assert(actual_output_length == output_len);
+  std::unique_ptr<char[]> output(new char[output_len]);
+  auto* context = compression::ThreadLocalZSTDDecompressionContext();
+  size_t actual_output_length = dict != nullptr
+      ? ZSTD_decompress_usingDDict(context, output.get(), output_len, input_data, input_length,
+                                   dict->ddict())
+      : ZSTD_decompressDCtx(context, output.get(), output_len, input_data, input_length);
+  if (ZSTD_isError(actual_output_length) || actual_output_length != output_len) {
+    return nullptr;
+  }
   *decompress_size = static_cast<int>(actual_output_length);
-  return output;
+  return output.release();
 #endif
   return nullptr;
 }
@@ -0,0 +1,492 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/gutil/thread_annotations.h"
+
+#include "yb/rocksdb/env.h"
+#include "yb/rocksdb/persistent_cache.h"
+#include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/crc32c.h"
+
+#include "yb/util/format.h"
+#include "yb/util/logging.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/size_literals.h"
+#include "yb/util/status_log.h"
+
+using namespace yb::size_literals;
+
+namespace rocksdb {
+
+namespace {
+
+// Cache consists of files named <id>.blkcache. Every file starts with magic number followed by
+// records:
+//   fixed32: masked crc32c of the rest of the record
+//   fixed32: key size
+//   fixed32: data size
+//   char[key size]: key
+//   char[data size]: data
+// Blocks are only appended to the newest file. When total size of files exceeds capacity, the
+// oldest file is deleted with all blocks stored in it.
+constexpr char kFileSuffix[] = ".blkcache";
+constexpr uint64_t kFileMagic = 0x7962626c6b636801ULL;
+constexpr size_t kFileHeaderSize = sizeof(kFileMagic);
+constexpr size_t kRecordHeaderSize = 3 * sizeof(uint32_t);
+constexpr size_t kMaxKeySize = 1_KB;
+
+// Appended records are accumulated in memory and written to file in batches of this size.
+// Batch is written with the mutex released, while new records are accumulated in another buffer.
+constexpr size_t kWriteBufferSize = 256_KB;
+
+// Approximate memory used by index entry in addition to its key.
+constexpr size_t kIndexEntryOverhead = 64;
+
+// Block is rewritten to the newest file when it is read from the oldest 1/kPromoteFraction of
+// cache files, so frequently read blocks are not lost when old files are deleted.
+constexpr uint64_t kPromoteFraction = 4;
+
+constexpr uint32_t kInvalidSize = std::numeric_limits<uint32_t>::max();
+
+struct BlockLocation {
+  uint64_t file_id;
+  uint32_t offset;
+  // Size of block data, kInvalidSize if block was found to be corrupted.
+  uint32_t size;
+};
+
+struct CacheFile {
+  uint64_t id;
+  std::unique_ptr<RandomAccessFile> reader;
+  // Keys of index entries that were stored to this file.
+  std::vector<const std::string*> keys;
+  // Size of file, including data that is not written to disk yet.
+  size_t size = 0;
+};
+
+uint32_t RecordChecksum(const char* header, const Slice& key, const Slice& data) {
+  uint32_t crc = crc32c::Value(header + sizeof(uint32_t), kRecordHeaderSize - sizeof(uint32_t));
+  crc = crc32c::Extend(crc, key.cdata(), key.size());
+  return crc32c::Mask(crc32c::Extend(crc, data.cdata(), data.size()));
+}
+
+class FilePersistentCache : public PersistentCache {
+ public:
+  explicit FilePersistentCache(const FilePersistentCacheOptions& options) : options_(options) {}
+
+  ~FilePersistentCache() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    WaitFlushDone(&lock);
+    if (writer_) {
+      WARN_NOT_OK(FlushWriteBuffer(), "Failed to flush block cache file");
+      WARN_NOT_OK(writer_->Close(), "Failed to close block cache file");
+    }
+    if (options_.mem_tracker) {
+      options_.mem_tracker->Release(index_memory_);
+    }
+  }
+
+  Status Open();
+
+  Status Insert(const Slice& key, const Slice& data) override;
+
+  Status Lookup(const Slice& key, std::unique_ptr<char[]>* data, size_t* size) override;
+
+  size_t GetUsage() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usage_;
+  }
+
+  size_t GetCapacity() const override {
+    return options_.capacity;
+  }
+
+ private:
+  std::string FilePath(uint64_t id) const {
+    return yb::Format("$0/$1$2", options_.path, id, kFileSuffix);
+  }
+
+  Status LoadFile(uint64_t id) REQUIRES(mutex_);
+  Status StartNewFile(uint64_t id) REQUIRES(mutex_);
+  Status AppendRecord(const Slice& key, const Slice& data, std::unique_lock<std::mutex>* lock)
+      REQUIRES(mutex_);
+  // Synchronously writes write buffer to disk. There should be no flush in progress.
+  Status FlushWriteBuffer() REQUIRES(mutex_);
+  // Writes write buffer to disk when it is full. Mutex is released while writing, so concurrent
+  // lookups and inserts are not blocked by disk IO.
+  Status FlushFullWriteBuffer(std::unique_lock<std::mutex>* lock) REQUIRES(mutex_);
+  void WaitFlushDone(std::unique_lock<std::mutex>* lock) REQUIRES(mutex_);
+  void EvictFiles() REQUIRES(mutex_);
+  void AddToIndex(const Slice& key, CacheFile* file, uint32_t offset, uint32_t size)
+      REQUIRES(mutex_);
+
+  const FilePersistentCacheOptions options_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, BlockLocation> index_ GUARDED_BY(mutex_);
+  // Cache files ordered by id, the last one is the file that new blocks are appended to.
+  std::map<uint64_t, std::shared_ptr<CacheFile>> files_ GUARDED_BY(mutex_);
+  std::unique_ptr<WritableFile> writer_ GUARDED_BY(mutex_);
+  std::string write_buffer_ GUARDED_BY(mutex_);
+  // Records that are being written to disk by FlushFullWriteBuffer, followed by write_buffer_ in
+  // the newest file. It is modified only with mutex_ held and flushing_ not set, so it could be
+  // read without mutex_ by the flushing thread.
+  std::string flushing_buffer_;
+  bool flushing_ GUARDED_BY(mutex_) = false;
+  std::condition_variable flush_done_cond_;
+  // Size of the newest file that was already written to disk, not including flushing_buffer_.
+  size_t flushed_size_ GUARDED_BY(mutex_) = 0;
+  size_t usage_ GUARDED_BY(mutex_) = 0;
+  int64_t index_memory_ GUARDED_BY(mutex_) = 0;
+};
+
+Status FilePersistentCache::Open() {
+  auto* env = options_.env;
+  RETURN_NOT_OK(env->CreateDirIfMissing(options_.path));
+  std::vector<std::string> children;
+  RETURN_NOT_OK(env->GetChildren(options_.path, &children));
+
+  std::vector<uint64_t> ids;
+  const Slice suffix(kFileSuffix);
+  for (const auto& child : children) {
+    Slice name(child);
+    if (!name.ends_with(suffix) || name.size() == suffix.size()) {
+      continue;
+    }
+    name.remove_suffix(suffix.size());
+    if (!std::all_of(name.cdata(), name.cend(), [](char ch) { return ch >= '0' && ch <= '9'; })) {
+      continue;
+    }
+    ids.push_back(std::stoull(name.ToBuffer()));
+  }
+  std::sort(ids.begin(), ids.end());
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto id : ids) {
+    auto status = LoadFile(id);
+    if (!status.ok()) {
+      LOG(WARNING) << "Dropping block cache file " << FilePath(id) << ": " << status;
+      WARN_NOT_OK(env->DeleteFile(FilePath(id)), "Failed to delete block cache file");
+    }
+  }
+  LOG(INFO) << "Loaded " << index_.size() << " blocks from " << files_.size()
+            << " block cache files in " << options_.path;
+
+  return StartNewFile(ids.empty() ? 1 : ids.back() + 1);
+}
+
+Status FilePersistentCache::LoadFile(uint64_t id) {
+  std::unique_ptr<SequentialFile> input;
+  RETURN_NOT_OK(options_.env->NewSequentialFile(FilePath(id), &input, EnvOptions()));
+
+  uint8_t magic[kFileHeaderSize];
+  Slice slice;
+  RETURN_NOT_OK(input->Read(kFileHeaderSize, &slice, magic));
+  if (slice.size() != kFileHeaderSize || DecodeFixed64(slice.cdata()) != kFileMagic) {
+    return STATUS(Corruption, "Bad block cache file header");
+  }
+
+  auto file = std::make_shared<CacheFile>();
+  file->id = id;
+  RETURN_NOT_OK(options_.env->NewRandomAccessFile(FilePath(id), &file->reader, EnvOptions()));
+  size_t offset = kFileHeaderSize;
+  std::vector<uint8_t> buffer;
+  // Records are read until the first incomplete or corrupted one, that could be left by a crash.
+  for (;;) {
+    uint8_t header_buffer[kRecordHeaderSize];
+    auto status = input->Read(kRecordHeaderSize, &slice, header_buffer);
+    if (!status.ok() || slice.size() != kRecordHeaderSize) {
+      break;
+    }
+    char header[kRecordHeaderSize];
+    memcpy(header, slice.cdata(), kRecordHeaderSize);
+    const uint32_t key_size = DecodeFixed32(header + sizeof(uint32_t));
+    const uint32_t data_size = DecodeFixed32(header + 2 * sizeof(uint32_t));
+    const size_t record_size = kRecordHeaderSize + key_size + data_size;
+    if (key_size > kMaxKeySize || offset + record_size > options_.file_size) {
+      break;
+    }
+    buffer.resize(key_size + data_size);
+    status = input->Read(buffer.size(), &slice, buffer.data());
+    if (!status.ok() || slice.size() != buffer.size()) {
+      break;
+    }
+    Slice key(slice.data(), key_size);
+    Slice data(slice.data() + key_size, data_size);
+    if (DecodeFixed32(header) != RecordChecksum(header, key, data)) {
+      break;
+    }
+    AddToIndex(key, file.get(), offset, data_size);
+    offset += record_size;
+  }
+
+  file->size = offset;
+  usage_ += file->size;
+  files_.emplace(id, std::move(file));
+  EvictFiles();
+  return Status::OK();
+}
+
+Status FilePersistentCache::StartNewFile(uint64_t id) {
+  if (writer_) {
+    RETURN_NOT_OK(FlushWriteBuffer());
+    RETURN_NOT_OK(writer_->Close());
+    writer_.reset();
+  }
+
+  const auto path = FilePath(id);
+  auto file = std::make_shared<CacheFile>();
+  file->id = id;
+  RETURN_NOT_OK(options_.env->NewWritableFile(path, &writer_, EnvOptions()));
+  RETURN_NOT_OK(options_.env->NewRandomAccessFile(path, &file->reader, EnvOptions()));
+
+  PutFixed64(&write_buffer_, kFileMagic);
+  flushed_size_ = 0;
+  file->size = kFileHeaderSize;
+  usage_ += file->size;
+  files_.emplace(id, std::move(file));
+  EvictFiles();
+  return Status::OK();
+}
+
+Status FilePersistentCache::FlushWriteBuffer() {
+  DCHECK(!flushing_);
+  if (write_buffer_.empty()) {
+    return Status::OK();
+  }
+  auto status = writer_->Append(write_buffer_);
+  if (status.ok()) {
+    status = writer_->Flush();
+  }
+  // Records that failed to be written will fail checksum verification when read.
+  flushed_size_ += write_buffer_.size();
+  write_buffer_.clear();
+  return status;
+}
+
+// NO_THREAD_SAFETY_ANALYSIS because this analysis does not work with unique_lock.
+Status FilePersistentCache::FlushFullWriteBuffer(std::unique_lock<std::mutex>* lock)
+    NO_THREAD_SAFETY_ANALYSIS {
+  // When previous flush is still in progress, records are accumulated in write buffer and will be
+  // written by the next insert after that flush.
+  if (flushing_ || write_buffer_.size() < kWriteBufferSize) {
+    return Status::OK();
+  }
+  flushing_ = true;
+  // Buffers are swapped, so memory of the previously flushed buffer is reused for new records.
+  flushing_buffer_.swap(write_buffer_);
+  // Writer is not replaced while flush is in progress, see AppendRecord.
+  auto* writer = writer_.get();
+  lock->unlock();
+  auto status = writer->Append(flushing_buffer_);
+  if (status.ok()) {
+    status = writer->Flush();
+  }
+  lock->lock();
+  // Records that failed to be written will fail checksum verification when read.
+  flushed_size_ += flushing_buffer_.size();
+  flushing_buffer_.clear();
+  flushing_ = false;
+  flush_done_cond_.notify_all();
+  return status;
+}
+
+void FilePersistentCache::WaitFlushDone(std::unique_lock<std::mutex>* lock)
+    NO_THREAD_SAFETY_ANALYSIS {
+  flush_done_cond_.wait(*lock, [this] { return !flushing_; });
+}
+
+void FilePersistentCache::EvictFiles() {
+  while (usage_ > options_.capacity && files_.size() > 1) {
+    auto& file = *files_.begin()->second;
+    for (const auto* key : file.keys) {
+      auto it = index_.find(*key);
+      if (it == index_.end() || it->second.file_id != file.id) {
+        // Block was stored to a newer file again.
+        continue;
+      }
+      const int64_t bytes = it->first.size() + kIndexEntryOverhead;
+      index_memory_ -= bytes;
+      if (options_.mem_tracker) {
+        options_.mem_tracker->Release(bytes);
+      }
+      index_.erase(it);
+    }
+    WARN_NOT_OK(options_.env->DeleteFile(FilePath(file.id)),
+                "Failed to delete block cache file");
+    usage_ -= file.size;
+    files_.erase(files_.begin());
+  }
+}
+
+void FilePersistentCache::AddToIndex(
+    const Slice& key, CacheFile* file, uint32_t offset, uint32_t size) {
+  auto emplace_result = index_.emplace(key.ToBuffer(), BlockLocation());
+  auto it = emplace_result.first;
+  if (emplace_result.second) {
+    const int64_t bytes = it->first.size() + kIndexEntryOverhead;
+    index_memory_ += bytes;
+    if (options_.mem_tracker) {
+      options_.mem_tracker->Consume(bytes);
+    }
+  }
+  it->second = BlockLocation {
+    .file_id = file->id,
+    .offset = offset,
+    .size = size,
+  };
+  // Pointers to keys of unordered_map are not invalidated by rehashing.
+  file->keys.push_back(&it->first);
+}
+
+Status FilePersistentCache::AppendRecord(
+    const Slice& key, const Slice& data, std::unique_lock<std::mutex>* lock) {
+  const size_t record_size = kRecordHeaderSize + key.size() + data.size();
+  if (key.size() > kMaxKeySize || kFileHeaderSize + record_size > options_.file_size) {
+    return Status::OK();
+  }
+
+  auto* file = files_.rbegin()->second.get();
+  if (file->size + record_size > options_.file_size) {
+    // Writer of the newest file is closed when new file is started, so wait for flush that uses
+    // it. Other thread could start new file while mutex is released, so the check is repeated.
+    WaitFlushDone(lock);
+    file = files_.rbegin()->second.get();
+    if (file->size + record_size > options_.file_size) {
+      RETURN_NOT_OK(StartNewFile(file->id + 1));
+      file = files_.rbegin()->second.get();
+    }
+  }
+
+  char header[kRecordHeaderSize];
+  EncodeFixed32(header + sizeof(uint32_t), static_cast<uint32_t>(key.size()));
+  EncodeFixed32(header + 2 * sizeof(uint32_t), static_cast<uint32_t>(data.size()));
+  EncodeFixed32(header, RecordChecksum(header, key, data));
+  write_buffer_.append(header, kRecordHeaderSize);
+  write_buffer_.append(key.cdata(), key.size());
+  write_buffer_.append(data.cdata(), data.size());
+
+  AddToIndex(key, file, static_cast<uint32_t>(file->size), static_cast<uint32_t>(data.size()));
+  file->size += record_size;
+  usage_ += record_size;
+
+  return FlushFullWriteBuffer(lock);
+}
+
+Status FilePersistentCache::Insert(const Slice& key, const Slice& data) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = index_.find(key.ToBuffer());
+  if (it != index_.end() && it->second.size != kInvalidSize) {
+    return Status::OK();
+  }
+  return AppendRecord(key, data, &lock);
+}
+
+Status FilePersistentCache::Lookup(
+    const Slice& key, std::unique_ptr<char[]>* data, size_t* size) {
+  const auto key_str = key.ToBuffer();
+  std::shared_ptr<CacheFile> file;
+  BlockLocation location;
+  bool promote;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key_str);
+    if (it == index_.end() || it->second.size == kInvalidSize) {
+      return STATUS(NotFound, "Block not found in persistent cache");
+    }
+    location = it->second;
+    const auto newest_id = files_.rbegin()->first;
+    if (location.file_id == newest_id && location.offset >= flushed_size_) {
+      // Block is not written to disk yet.
+      size_t buffer_offset = location.offset - flushed_size_;
+      const std::string* buffer = &flushing_buffer_;
+      if (buffer_offset >= flushing_buffer_.size()) {
+        buffer_offset -= flushing_buffer_.size();
+        buffer = &write_buffer_;
+      }
+      data->reset(new char[location.size]);
+      memcpy(data->get(),
+             buffer->data() + buffer_offset + kRecordHeaderSize + key.size(),
+             location.size);
+      *size = location.size;
+      return Status::OK();
+    }
+    file = files_[location.file_id];
+    const auto oldest_id = files_.begin()->first;
+    promote = (location.file_id - oldest_id) * kPromoteFraction < newest_id - oldest_id;
+  }
+
+  const size_t record_size = kRecordHeaderSize + key.size() + location.size;
+  std::unique_ptr<char[]> buffer(new char[record_size]);
+  Slice record;
+  auto status = file->reader->Read(location.offset, record_size, &record, buffer.get());
+  if (status.ok()) {
+    const char* header = record.cdata();
+    if (record.size() != record_size ||
+        DecodeFixed32(header + sizeof(uint32_t)) != key.size() ||
+        DecodeFixed32(header + 2 * sizeof(uint32_t)) != location.size ||
+        Slice(header + kRecordHeaderSize, key.size()) != key ||
+        DecodeFixed32(header) != RecordChecksum(
+            header, key, Slice(header + kRecordHeaderSize + key.size(), location.size))) {
+      status = STATUS_FORMAT(Corruption, "Corrupted block in $0", FilePath(location.file_id));
+    }
+  }
+  if (!status.ok()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key_str);
+    // Keep entry in index, so it is removed when the file is evicted, but ignore its data.
+    if (it != index_.end() && it->second.file_id == location.file_id &&
+        it->second.offset == location.offset) {
+      it->second.size = kInvalidSize;
+    }
+    return status;
+  }
+
+  if (record.cdata() != buffer.get()) {
+    memcpy(buffer.get(), record.cdata() + kRecordHeaderSize + key.size(), location.size);
+  } else {
+    memmove(buffer.get(), buffer.get() + kRecordHeaderSize + key.size(), location.size);
+  }
+  *data = std::move(buffer);
+  *size = location.size;
+
+  if (promote) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = index_.find(key_str);
+    if (it != index_.end() && it->second.file_id == location.file_id) {
+      WARN_NOT_OK(AppendRecord(key, Slice(data->get(), location.size), &lock),
+                  "Failed to rewrite block to persistent cache");
+    }
+  }
+  return Status::OK();
+}
+
+} // namespace
+
+yb::Result<std::shared_ptr<PersistentCache>> NewFilePersistentCache(
+    const FilePersistentCacheOptions& options) {
+  auto result = std::make_shared<FilePersistentCache>(options);
+  RETURN_NOT_OK(result->Open());
+  return result;
+}
+
+} // namespace rocksdb
@@ -0,0 +1,231 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/rocksdb/env.h"
+#include "yb/rocksdb/persistent_cache.h"
+#include "yb/rocksdb/util/random.h"
+#include "yb/rocksdb/util/testharness.h"
+
+#include "yb/util/mem_tracker.h"
+#include "yb/util/result.h"
+#include "yb/util/test_macros.h"
+
+namespace rocksdb {
+
+class FilePersistentCacheTest : public RocksDBTest {
+ protected:
+  void SetUp() override {
+    RocksDBTest::SetUp();
+    env_ = Env::Default();
+    path_ = test::TmpDir(env_) + "/file_persistent_cache_test";
+    ASSERT_OK(env_->CreateDirIfMissing(path_));
+    std::vector<std::string> children;
+    ASSERT_OK(env_->GetChildren(path_, &children));
+    for (const auto& child : children) {
+      if (child != "." && child != "..") {
+        ASSERT_OK(env_->DeleteFile(path_ + "/" + child));
+      }
+    }
+    mem_tracker_ = yb::MemTracker::CreateTracker("file_persistent_cache_test");
+  }
+
+  std::shared_ptr<PersistentCache> OpenCache(size_t capacity, size_t file_size) {
+    FilePersistentCacheOptions options;
+    options.env = env_;
+    options.path = path_;
+    options.capacity = capacity;
+    options.file_size = file_size;
+    options.mem_tracker = mem_tracker_;
+    auto result = NewFilePersistentCache(options);
+    if (!result.ok()) {
+      ADD_FAILURE() << result.status();
+      return nullptr;
+    }
+    return *result;
+  }
+
+  static std::string Key(int i) {
+    return "block-" + std::to_string(i);
+  }
+
+  // Returns block contents or empty string when block is not found.
+  static std::string Lookup(PersistentCache* cache, int i) {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    auto status = cache->Lookup(Key(i), &data, &size);
+    if (status.IsNotFound()) {
+      return std::string();
+    }
+    EXPECT_OK(status);
+    return std::string(data.get(), size);
+  }
+
+  std::vector<std::string> InsertBlocks(PersistentCache* cache, int count, int block_size) {
+    std::vector<std::string> result;
+    for (int i = 0; i != count; ++i) {
+      result.push_back(RandomString(&rnd_, block_size));
+      EXPECT_OK(cache->Insert(Key(i), result.back()));
+    }
+    return result;
+  }
+
+  Env* env_;
+  std::string path_;
+  std::shared_ptr<yb::MemTracker> mem_tracker_;
+  Random rnd_{301};
+};
+
+TEST_F(FilePersistentCacheTest, InsertAndLookup) {
+  constexpr int kBlocks = 200;
+  auto cache = OpenCache(100 * 1024 * 1024, 1024 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  auto blocks = InsertBlocks(cache.get(), kBlocks, 4096);
+
+  for (int i = 0; i != kBlocks; ++i) {
+    ASSERT_EQ(blocks[i], Lookup(cache.get(), i)) << i;
+  }
+  ASSERT_EQ("", Lookup(cache.get(), kBlocks));
+  ASSERT_GT(cache->GetUsage(), kBlocks * 4096);
+  ASSERT_GT(mem_tracker_->consumption(), 0);
+
+  // Inserting the same key again does not change stored data.
+  ASSERT_OK(cache->Insert(Key(0), "other"));
+  ASSERT_EQ(blocks[0], Lookup(cache.get(), 0));
+
+  cache.reset();
+  ASSERT_EQ(0, mem_tracker_->consumption());
+}
+
+// Lookups run while other threads insert blocks, so blocks are read from the buffer being written
+// to disk, from the buffer accumulating new records, and from disk, across file switches.
+TEST_F(FilePersistentCacheTest, ConcurrentInsertAndLookup) {
+  constexpr int kThreads = 4;
+  constexpr int kBlocksPerThread = 500;
+  constexpr int kBlockSize = 4096;
+  auto cache = OpenCache(100 * 1024 * 1024, 1024 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  std::vector<std::string> blocks;
+  for (int i = 0; i != kThreads * kBlocksPerThread; ++i) {
+    blocks.push_back(RandomString(&rnd_, kBlockSize));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([&cache, &blocks, t] {
+      for (int i = t; i < kThreads * kBlocksPerThread; i += kThreads) {
+        ASSERT_OK(cache->Insert(Key(i), blocks[i]));
+        ASSERT_EQ(blocks[i], Lookup(cache.get(), i)) << i;
+        // Block that was inserted earlier by this thread.
+        const int previous = i - kThreads * std::min(i % 7, i / kThreads);
+        ASSERT_EQ(blocks[previous], Lookup(cache.get(), previous)) << previous;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i != kThreads * kBlocksPerThread; ++i) {
+    ASSERT_EQ(blocks[i], Lookup(cache.get(), i)) << i;
+  }
+}
+
+TEST_F(FilePersistentCacheTest, Eviction) {
+  constexpr size_t kCapacity = 1024 * 1024;
+  constexpr size_t kFileSize = 256 * 1024;
+  constexpr int kBlocks = 1000;
+  auto cache = OpenCache(kCapacity, kFileSize);
+  ASSERT_TRUE(cache != nullptr);
+  auto blocks = InsertBlocks(cache.get(), kBlocks, 4096);
+
+  ASSERT_LE(cache->GetUsage(), kCapacity + kFileSize);
+  ASSERT_EQ("", Lookup(cache.get(), 0));
+  ASSERT_EQ(blocks[kBlocks - 1], Lookup(cache.get(), kBlocks - 1));
+  int found = 0;
+  for (int i = 0; i != kBlocks; ++i) {
+    auto value = Lookup(cache.get(), i);
+    if (!value.empty()) {
+      ASSERT_EQ(blocks[i], value);
+      ++found;
+    }
+  }
+  ASSERT_GE(found, (kCapacity - kFileSize) / 4096 / 2);
+  ASSERT_LE(found, (kCapacity + kFileSize) / 4096);
+}
+
+TEST_F(FilePersistentCacheTest, Reopen) {
+  constexpr int kBlocks = 300;
+  auto cache = OpenCache(100 * 1024 * 1024, 512 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  auto blocks = InsertBlocks(cache.get(), kBlocks, 4096);
+  cache.reset();
+
+  cache = OpenCache(100 * 1024 * 1024, 512 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  for (int i = 0; i != kBlocks; ++i) {
+    ASSERT_EQ(blocks[i], Lookup(cache.get(), i)) << i;
+  }
+
+  // New blocks are added after reopen, and old ones are still available.
+  ASSERT_OK(cache->Insert(Key(kBlocks), "new block"));
+  cache.reset();
+  cache = OpenCache(100 * 1024 * 1024, 512 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  ASSERT_EQ("new block", Lookup(cache.get(), kBlocks));
+  ASSERT_EQ(blocks[0], Lookup(cache.get(), 0));
+}
+
+TEST_F(FilePersistentCacheTest, TruncatedFile) {
+  constexpr int kBlocks = 10;
+  auto cache = OpenCache(100 * 1024 * 1024, 1024 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  auto blocks = InsertBlocks(cache.get(), kBlocks, 1000);
+  cache.reset();
+
+  // Simulate crash in the middle of writing the last block.
+  std::vector<std::string> children;
+  ASSERT_OK(env_->GetChildren(path_, &children));
+  std::string file_name;
+  for (const auto& child : children) {
+    if (child != "." && child != "..") {
+      file_name = path_ + "/" + child;
+    }
+  }
+  uint64_t file_size = 0;
+  ASSERT_OK(env_->GetFileSize(file_name, &file_size));
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, file_name, &contents));
+  contents.resize(file_size - 100);
+  ASSERT_OK(WriteStringToFile(env_, contents, file_name));
+
+  cache = OpenCache(100 * 1024 * 1024, 1024 * 1024);
+  ASSERT_TRUE(cache != nullptr);
+  for (int i = 0; i != kBlocks - 1; ++i) {
+    ASSERT_EQ(blocks[i], Lookup(cache.get(), i)) << i;
+  }
+  ASSERT_EQ("", Lookup(cache.get(), kBlocks - 1));
+}
+
+} // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
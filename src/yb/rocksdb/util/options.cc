@@ -345,6 +345,8 @@ void DBOptions::Dump(Logger* log) const {
       max_background_compactions);
   RHEADER(log, "                     Options.max_subcompactions: %" PRIu32,
       max_subcompactions);
+  RHEADER(log, "           Options.min_subcompaction_input_size: %" PRIu64,
+      min_subcompaction_input_size);
   RHEADER(log, "                 Options.max_background_flushes: %d",
       max_background_flushes);
   RHEADER(log, "                        Options.WAL_ttl_seconds: %" PRIu64,
@@ -460,6 +462,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
       compression_opts.level);
   RHEADER(log, "              Options.compression_opts.strategy: %d",
       compression_opts.strategy);
+  RHEADER(log, "        Options.compression_opts.max_dict_bytes: %" PRIu32,
+      compression_opts.max_dict_bytes);
+  RHEADER(log, "  Options.compression_opts.zstd_max_train_bytes: %" PRIu32,
+      compression_opts.zstd_max_train_bytes);
   RHEADER(log, "     Options.level0_file_num_compaction_trigger: %d",
       level0_file_num_compaction_trigger);
   RHEADER(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -1925,12 +1925,14 @@ TEST_F(OptionsParserTest, DBOptionsAllFieldsSettable) {
       BLACKLIST_ENTRY(DBOptions, db_paths),
       BLACKLIST_ENTRY(DBOptions, db_log_dir),
       BLACKLIST_ENTRY(DBOptions, wal_dir),
+      BLACKLIST_ENTRY(DBOptions, min_subcompaction_input_size),
       BLACKLIST_ENTRY(DBOptions, memory_monitor),
       BLACKLIST_ENTRY(DBOptions, listeners),
       BLACKLIST_ENTRY(DBOptions, row_cache),
       BLACKLIST_ENTRY(DBOptions, wal_filter),
       BLACKLIST_ENTRY(DBOptions, boundary_extractor),
       BLACKLIST_ENTRY(DBOptions, compaction_context_factory),
+      BLACKLIST_ENTRY(DBOptions, subcompaction_boundary_transform),
       BLACKLIST_ENTRY(DBOptions, max_file_size_for_compaction),
       BLACKLIST_ENTRY(DBOptions, mem_table_flush_filter_factory),
       BLACKLIST_ENTRY(DBOptions, log_prefix),
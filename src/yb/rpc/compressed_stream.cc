@@ -18,6 +18,11 @@
 #include <snappy.h>
 #include <zlib.h>
 
+#if defined(ZSTD)
+#include <zstd.h>
+#endif
+
+#include <boost/optional.hpp>
 #include <boost/preprocessor/cat.hpp>
 #include <boost/range/iterator_range.hpp>
 
@@ -27,15 +32,44 @@
 #include "yb/rpc/outbound_data.h"
 #include "yb/rpc/refined_stream.h"
 
+#include "yb/util/env.h"
 #include "yb/util/logging.h"
+#include "yb/util/mem_tracker.h"
+#include "yb/util/monotime.h"
 #include "yb/util/result.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/status_format.h"
 
 using namespace std::literals;
+using namespace yb::size_literals;
 
 DEFINE_int32(stream_compression_algo, 0, "Algorithm used for stream compression. "
-                                         "0 - no compression, 1 - gzip, 2 - snappy, 3 - lz4.");
+                                         "0 - no compression, 1 - gzip, 2 - snappy, 3 - lz4, "
+                                         "4 - zstd (when built with zstd support).");
+
+DEFINE_int32(stream_compression_zstd_level, 1,
+             "Compression level used by zstd stream compression. When adaptive compression is "
+             "enabled, it is the initial level of each connection.");
+
+DEFINE_string(stream_compression_zstd_dictionary_file, "",
+              "Path to the dictionary used by zstd stream compression, for instance trained on "
+              "typical RPC traffic with 'zstd --train'. All nodes should use the same dictionary.");
+
+DEFINE_bool(stream_compression_adaptive, false,
+            "Adjust zstd stream compression level for each connection, based on observed "
+            "compression ratio and link throughput. Data is sent uncompressed over connections "
+            "where compression does not pay off.");
+
+DEFINE_int32(stream_compression_adaptive_max_level, 9,
+             "Max zstd compression level that could be chosen by adaptive stream compression.");
+
+DEFINE_int64(stream_compression_adaptive_window_bytes, 4_MB,
+             "Number of bytes sent over the connection, after which adaptive stream compression "
+             "reconsiders compression level.");
+
+DEFINE_int32(stream_compression_adaptive_probe_windows, 16,
+             "Number of windows after which adaptive stream compression tries to enable "
+             "compression again on the connection where it was disabled.");
 
 namespace yb {
 namespace rpc {
@@ -728,8 +762,471 @@ class LZ4Compressor : public Compressor {
   ScopedTrackedConsumption consumption_;
 };
 
+#if defined(ZSTD)
+
+// Statistics of data sent by the compressor to the lower stream, used to estimate link
+// throughput. Bytes are pending from the moment they are passed to the lower stream, until they
+// are written to the socket. Link is considered busy while there are pending bytes, so dividing
+// transferred bytes by busy time gives the rate at which the link drains data.
+//
+// Accessed only from the reactor thread, but could outlive the compressor, since it is referenced
+// by sent data.
+class LinkThroughputTracker {
+ public:
+  void Sent(size_t bytes, MonoTime now) {
+    if (pending_bytes_ == 0) {
+      busy_start_ = now;
+    }
+    pending_bytes_ += bytes;
+  }
+
+  void Transferred(size_t bytes, MonoTime now) {
+    pending_bytes_ -= bytes;
+    transferred_bytes_ += bytes;
+    if (pending_bytes_ == 0) {
+      busy_time_ += now - busy_start_;
+    }
+  }
+
+  // Returns link throughput in bytes per second since the previous call, or 0 if the link did not
+  // transfer any data during this period, or transferred it too fast to measure.
+  double TakeThroughput(MonoTime now) {
+    auto busy_time = busy_time_;
+    if (pending_bytes_ != 0) {
+      busy_time += now - busy_start_;
+      busy_start_ = now;
+    }
+    auto bytes = transferred_bytes_;
+    busy_time_ = MonoDelta::kZero;
+    transferred_bytes_ = 0;
+    auto seconds = busy_time.ToSeconds();
+    return seconds > 0 ? bytes / seconds : 0;
+  }
+
+ private:
+  size_t pending_bytes_ = 0;
+  size_t transferred_bytes_ = 0;
+  MonoTime busy_start_;
+  MonoDelta busy_time_ = MonoDelta::kZero;
+};
+
+using LinkThroughputTrackerPtr = std::shared_ptr<LinkThroughputTracker>;
+
+class TrackedBufferOutboundData : public SingleBufferOutboundData {
+ public:
+  TrackedBufferOutboundData(
+      RefCntBuffer buffer, OutboundDataPtr lower_data, LinkThroughputTrackerPtr tracker)
+      : SingleBufferOutboundData(std::move(buffer), std::move(lower_data)),
+        tracker_(std::move(tracker)) {}
+
+  static OutboundDataPtr Create(
+      RefCntBuffer buffer, OutboundDataPtr lower_data, const LinkThroughputTrackerPtr& tracker) {
+    auto size = buffer.size();
+    tracker->Sent(size, MonoTime::Now());
+    auto result = std::make_shared<TrackedBufferOutboundData>(
+        std::move(buffer), std::move(lower_data), tracker);
+    result->size_ = size;
+    return result;
+  }
+
+  void Transferred(const Status& status, Connection* conn) override {
+    tracker_->Transferred(size_, MonoTime::Now());
+    SingleBufferOutboundData::Transferred(status, conn);
+  }
+
+ private:
+  LinkThroughputTrackerPtr tracker_;
+  size_t size_ = 0;
+};
+
+// Chooses compression level for a single connection.
+//
+// Sending compressed data pays off when CPU time spent on compression is less than the time
+// saved on transferring the data over the link. So after each window of
+// stream_compression_adaptive_window_bytes input bytes we compare compression time with the
+// transfer time of saved bytes at the measured link throughput, and increase or decrease the
+// level accordingly. When compression does not pay even at the lowest level, it is disabled, and
+// probed again after stream_compression_adaptive_probe_windows windows.
+class AdaptiveCompressionLevel {
+ public:
+  // Level used when compression is disabled.
+  static constexpr int kDisabled = 0;
+  static constexpr int kMinLevel = 1;
+
+  AdaptiveCompressionLevel(int level, LinkThroughputTrackerPtr tracker)
+      : level_(std::max(level, kMinLevel)), tracker_(std::move(tracker)) {}
+
+  int level() const {
+    return level_;
+  }
+
+  void Compressed(size_t input_bytes, size_t output_bytes, MonoDelta time) {
+    input_bytes_ += input_bytes;
+    output_bytes_ += output_bytes;
+    compression_time_ += time;
+    if (input_bytes_ >= implicit_cast<size_t>(FLAGS_stream_compression_adaptive_window_bytes)) {
+      WindowFinished();
+    }
+  }
+
+ private:
+  void WindowFinished() {
+    auto throughput = tracker_->TakeThroughput(MonoTime::Now());
+    auto old_level = level_;
+    if (level_ == kDisabled) {
+      if (++disabled_windows_ >= FLAGS_stream_compression_adaptive_probe_windows) {
+        disabled_windows_ = 0;
+        level_ = kMinLevel;
+      }
+    } else {
+      auto saved_bytes = input_bytes_ > output_bytes_ ? input_bytes_ - output_bytes_ : 0;
+      // Zero throughput means that the link was never busy, so compression does not save time.
+      auto saved_seconds = throughput > 0 ? saved_bytes / throughput : 0;
+      auto compression_seconds = compression_time_.ToSeconds();
+      if (compression_seconds > saved_seconds) {
+        level_ = level_ == kMinLevel ? kDisabled : level_ - 1;
+      } else if (compression_seconds * 2 < saved_seconds &&
+                 level_ < FLAGS_stream_compression_adaptive_max_level) {
+        ++level_;
+      }
+    }
+    VLOG_IF(1, level_ != old_level)
+        << "Change compression level " << old_level << " => " << level_ << ", input: "
+        << input_bytes_ << ", output: " << output_bytes_ << ", time: " << compression_time_
+        << ", link throughput: " << throughput;
+
+    input_bytes_ = 0;
+    output_bytes_ = 0;
+    compression_time_ = MonoDelta::kZero;
+  }
+
+  int level_;
+  LinkThroughputTrackerPtr tracker_;
+  size_t input_bytes_ = 0;
+  size_t output_bytes_ = 0;
+  MonoDelta compression_time_ = MonoDelta::kZero;
+  int disabled_windows_ = 0;
+};
+
+// Window is limited to bound memory used by compression and decompression contexts of each
+// connection.
+constexpr int kZstdWindowLog = 17;
+constexpr size_t kZstdMaxRawBlockSize = 1ULL << kZstdWindowLog;
+constexpr uint32_t kZstdMagicNumber = 0xFD2FB528;
+// Frame header descriptor without content size, checksum and dictionary id, followed by window
+// descriptor for kZstdWindowLog.
+constexpr uint8_t kZstdRawFrameHeader[] = {0, (kZstdWindowLog - 10) << 3};
+constexpr size_t kZstdBlockHeaderLen = 3;
+
+Status ZstdStatus(size_t code, const char* operation) {
+  if (ZSTD_isError(code)) {
+    return STATUS_FORMAT(RuntimeError, "$0 failed: $1", operation, ZSTD_getErrorName(code));
+  }
+  return Status::OK();
+}
+
+// Dictionary shared by all zstd compressed connections, see
+// stream_compression_zstd_dictionary_file.
+class ZstdStreamDictionary {
+ public:
+  // Returns nullptr when dictionary is not configured.
+  static Result<const ZstdStreamDictionary*> Get() {
+    static const Result<std::unique_ptr<ZstdStreamDictionary>> dictionary = Load();
+    RETURN_NOT_OK(dictionary);
+    return dictionary->get();
+  }
+
+  ~ZstdStreamDictionary() {
+    ZSTD_freeDDict(ddict_);
+  }
+
+  Slice data() const {
+    return data_;
+  }
+
+  const ZSTD_DDict* ddict() const {
+    return ddict_;
+  }
+
+ private:
+  static Result<std::unique_ptr<ZstdStreamDictionary>> Load() {
+    const auto& path = FLAGS_stream_compression_zstd_dictionary_file;
+    if (path.empty()) {
+      return nullptr;
+    }
+    auto result = std::make_unique<ZstdStreamDictionary>();
+    faststring data;
+    RETURN_NOT_OK_PREPEND(
+        ReadFileToString(Env::Default(), path, &data),
+        Format("Failed to read zstd dictionary from $0", path));
+    result->data_ = data.ToString();
+    result->ddict_ = ZSTD_createDDict(result->data_.data(), result->data_.size());
+    if (!result->ddict_) {
+      return STATUS_FORMAT(Corruption, "Failed to load zstd dictionary from $0", path);
+    }
+    LOG(INFO) << "Loaded zstd stream compression dictionary from " << path << ", size: "
+              << result->data_.size();
+    return result;
+  }
+
+  std::string data_;
+  ZSTD_DDict* ddict_ = nullptr;
+};
+
+// Zstd stream compression, each sent data is flushed, so could be decompressed by the receiver
+// without waiting for more data, while compression history is shared between all data sent over
+// the connection.
+//
+// Compression level could be changed only between frames, so frame is finished when level is
+// changed by adaptive compression. When compression is disabled, data is sent as raw zstd
+// blocks, so receiver does not need to know whether sender compresses data.
+class ZstdCompressor : public Compressor {
+ public:
+  static constexpr char kId = 'Z';
+  static constexpr int kIndex = 4;
+
+  explicit ZstdCompressor(MemTrackerPtr mem_tracker) : mem_tracker_(std::move(mem_tracker)) {}
+
+  ~ZstdCompressor() {
+    ZSTD_freeCCtx(cctx_);
+    ZSTD_freeDCtx(dctx_);
+  }
+
+  OutboundDataPtr ConnectionHeader() override {
+    return GetConnectionHeader<ZstdCompressor>();
+  }
+
+  Status Init() override {
+    cctx_ = ZSTD_createCCtx();
+    dctx_ = ZSTD_createDCtx();
+    if (!cctx_ || !dctx_) {
+      return STATUS(RuntimeError, "Cannot create zstd context");
+    }
+    RETURN_NOT_OK(ZstdStatus(
+        ZSTD_CCtx_setParameter(cctx_, ZSTD_c_windowLog, kZstdWindowLog), "Set window log"));
+    RETURN_NOT_OK(ZstdStatus(
+        ZSTD_DCtx_setParameter(dctx_, ZSTD_d_windowLogMax, kZstdWindowLog), "Set max window log"));
+    const auto* dictionary = VERIFY_RESULT(ZstdStreamDictionary::Get());
+    if (dictionary) {
+      RETURN_NOT_OK(ZstdStatus(ZSTD_CCtx_loadDictionary(
+          cctx_, dictionary->data().data(), dictionary->data().size()), "Load dictionary"));
+      RETURN_NOT_OK(ZstdStatus(ZSTD_DCtx_refDDict(dctx_, dictionary->ddict()), "Load dictionary"));
+    }
+
+    tracker_ = std::make_shared<LinkThroughputTracker>();
+    if (FLAGS_stream_compression_adaptive) {
+      adaptive_level_.emplace(FLAGS_stream_compression_zstd_level, tracker_);
+      level_ = adaptive_level_->level();
+    } else {
+      level_ = FLAGS_stream_compression_zstd_level;
+    }
+    RETURN_NOT_OK(ZstdStatus(
+        ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level_), "Set compression level"));
+    if (mem_tracker_) {
+      consumption_ = ScopedTrackedConsumption(mem_tracker_, 0);
+      UpdateConsumption();
+    }
+    return Status::OK();
+  }
+
+  std::string ToString() const override {
+    return adaptive_level_ ? Format("Zstd[$0]", level_) : "Zstd";
+  }
+
+  Status Compress(
+      const SmallRefCntBuffers& input, RefinedStream* stream, OutboundDataPtr data) override {
+    auto start = MonoTime::Now();
+    auto input_size = TotalLen(input);
+    size_t output_size = 0;
+    if (adaptive_level_ && adaptive_level_->level() != level_) {
+      RETURN_NOT_OK(ChangeLevel(adaptive_level_->level(), stream));
+    }
+    if (adaptive_level_ && level_ == AdaptiveCompressionLevel::kDisabled) {
+      RETURN_NOT_OK(SendRaw(input, input_size, stream, std::move(data), &output_size));
+    } else {
+      RETURN_NOT_OK(SendCompressed(input, input_size, stream, std::move(data), &output_size));
+    }
+    if (adaptive_level_) {
+      adaptive_level_->Compressed(input_size, output_size, MonoTime::Now() - start);
+    }
+    UpdateConsumption();
+    return Status::OK();
+  }
+
+  Result<ReadBufferFull> Decompress(StreamReadBuffer* inp, StreamReadBuffer* out) override {
+    auto inp_vecs = inp->AppendedVecs();
+    auto inp_it = inp_vecs.begin();
+    ZSTD_inBuffer input = {nullptr, 0, 0};
+    if (inp_it != inp_vecs.end()) {
+      input = {inp_it->iov_base, inp_it->iov_len, 0};
+    }
+    size_t consumed = 0;
+    // Decompressor could keep decompressed data that did not fit into output, so we continue
+    // while output has space, even when all input was consumed.
+    bool output_exhausted = true;
+    while (output_exhausted && !out->Full()) {
+      auto out_vecs = VERIFY_RESULT(out->PrepareAppend());
+      auto out_it = out_vecs.begin();
+      size_t appended = 0;
+      output_exhausted = false;
+      for (;;) {
+        ZSTD_outBuffer output = {out_it->iov_base, out_it->iov_len, 0};
+        auto input_pos = input.pos;
+        RETURN_NOT_OK(ZstdStatus(ZSTD_decompressStream(dctx_, &output, &input), "Decompress"));
+        consumed += input.pos - input_pos;
+        appended += output.pos;
+        IoVecRemovePrefix(output.pos, &*out_it);
+        if (out_it->iov_len == 0) {
+          if (++out_it == out_vecs.end()) {
+            output_exhausted = true;
+            break;
+          }
+          continue;
+        }
+        if (input.pos < input.size) {
+          // Frame finished in the middle of input, continue with the next one.
+          continue;
+        }
+        if (inp_it == inp_vecs.end() || ++inp_it == inp_vecs.end()) {
+          break;
+        }
+        input = {inp_it->iov_base, inp_it->iov_len, 0};
+      }
+      out->DataAppended(appended);
+    }
+    inp->Consume(consumed, Slice());
+    UpdateConsumption();
+    return ReadBufferFull(out->Full());
+  }
+
+ private:
+  Status SendCompressed(
+      const SmallRefCntBuffers& input, size_t input_size, RefinedStream* stream,
+      OutboundDataPtr data, size_t* output_size) {
+    RefCntBuffer output_buffer(ZSTD_compressBound(input_size) + kZstdBlockHeaderLen);
+    ZSTD_outBuffer output = {output_buffer.data(), output_buffer.size(), 0};
+    for (auto it = input.begin(); it != input.end();) {
+      ZSTD_inBuffer chunk = {it->data(), it->size(), 0};
+      ++it;
+      auto mode = it == input.end() ? ZSTD_e_flush : ZSTD_e_continue;
+      for (;;) {
+        auto res = ZSTD_compressStream2(cctx_, &output, &chunk, mode);
+        RETURN_NOT_OK(ZstdStatus(res, "Compress"));
+        if (mode == ZSTD_e_flush ? res == 0 : chunk.pos == chunk.size) {
+          break;
+        }
+        if (output.pos == output.size) {
+          // Output buffer is full, send it and continue with the new one.
+          *output_size += output.pos;
+          RETURN_NOT_OK(stream->SendToLower(TrackedBufferOutboundData::Create(
+              std::move(output_buffer), nullptr, tracker_)));
+          output_buffer = RefCntBuffer(ZSTD_CStreamOutSize());
+          output = {output_buffer.data(), output_buffer.size(), 0};
+        }
+      }
+    }
+    frame_started_ = true;
+    output_buffer.Shrink(output.pos);
+    *output_size += output.pos;
+    return stream->SendToLower(TrackedBufferOutboundData::Create(
+        std::move(output_buffer), std::move(data), tracker_));
+  }
+
+  // Sends input as a zstd frame of raw blocks.
+  Status SendRaw(
+      const SmallRefCntBuffers& input, size_t input_size, RefinedStream* stream,
+      OutboundDataPtr data, size_t* output_size) {
+    auto num_blocks = std::max<size_t>(
+        (input_size + kZstdMaxRawBlockSize - 1) / kZstdMaxRawBlockSize, 1);
+    RefCntBuffer output(
+        sizeof(kZstdMagicNumber) + sizeof(kZstdRawFrameHeader) +
+        num_blocks * kZstdBlockHeaderLen + input_size);
+    auto* out = output.udata();
+    LittleEndian::Store32(out, kZstdMagicNumber);
+    out += sizeof(kZstdMagicNumber);
+    memcpy(out, kZstdRawFrameHeader, sizeof(kZstdRawFrameHeader));
+    out += sizeof(kZstdRawFrameHeader);
+
+    auto it = input.begin();
+    size_t pos = 0;
+    for (size_t left = input_size;;) {
+      auto block_size = std::min(left, kZstdMaxRawBlockSize);
+      left -= block_size;
+      // Block header: last block flag, block type (0 - raw) and block size.
+      uint32_t block_header = (left == 0 ? 1 : 0) | (block_size << 3);
+      out[0] = block_header & 0xff;
+      out[1] = (block_header >> 8) & 0xff;
+      out[2] = (block_header >> 16) & 0xff;
+      out += kZstdBlockHeaderLen;
+      while (block_size != 0) {
+        auto len = std::min(block_size, it->size() - pos);
+        memcpy(out, it->udata() + pos, len);
+        out += len;
+        block_size -= len;
+        if ((pos += len) == it->size()) {
+          ++it;
+          pos = 0;
+        }
+      }
+      if (left == 0) {
+        break;
+      }
+    }
+    *output_size += output.size();
+    return stream->SendToLower(TrackedBufferOutboundData::Create(
+        std::move(output), std::move(data), tracker_));
+  }
+
+  Status ChangeLevel(int level, RefinedStream* stream) {
+    if (frame_started_) {
+      // Finish current frame, so new level could be applied.
+      RefCntBuffer output_buffer(ZSTD_CStreamOutSize());
+      ZSTD_outBuffer output = {output_buffer.data(), output_buffer.size(), 0};
+      ZSTD_inBuffer input = {nullptr, 0, 0};
+      // Data was already flushed, so frame end fits into the output buffer.
+      auto res = ZSTD_compressStream2(cctx_, &output, &input, ZSTD_e_end);
+      RETURN_NOT_OK(ZstdStatus(res, "Finish frame"));
+      if (res != 0) {
+        return STATUS_FORMAT(RuntimeError, "Frame was not finished, left: $0", res);
+      }
+      output_buffer.Shrink(output.pos);
+      RETURN_NOT_OK(stream->SendToLower(TrackedBufferOutboundData::Create(
+          std::move(output_buffer), nullptr, tracker_)));
+      frame_started_ = false;
+    }
+    if (level != AdaptiveCompressionLevel::kDisabled) {
+      RETURN_NOT_OK(ZstdStatus(
+          ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level), "Set compression level"));
+    }
+    level_ = level;
+    return Status::OK();
+  }
+
+  void UpdateConsumption() {
+    if (mem_tracker_) {
+      consumption_.Reset(ZSTD_sizeof_CCtx(cctx_) + ZSTD_sizeof_DCtx(dctx_));
+    }
+  }
+
+  MemTrackerPtr mem_tracker_;
+  ScopedTrackedConsumption consumption_;
+  ZSTD_CCtx* cctx_ = nullptr;
+  ZSTD_DCtx* dctx_ = nullptr;
+  int level_ = 0;
+  // Whether frame with compressed data was started and not yet finished.
+  bool frame_started_ = false;
+  LinkThroughputTrackerPtr tracker_;
+  boost::optional<AdaptiveCompressionLevel> adaptive_level_;
+};
+
+#endif // defined(ZSTD)
+
 #undef LZ4
+#if defined(ZSTD)
+#define YB_COMPRESSION_ALGORITHMS (Zlib)(Snappy)(LZ4)(Zstd)
+#else
 #define YB_COMPRESSION_ALGORITHMS (Zlib)(Snappy)(LZ4)
+#endif
 
 #define YB_CREATE_COMPRESSOR_CASE(r, data, name) \
   case BOOST_PP_CAT(name, Compressor)::data: \
@@ -77,8 +77,11 @@ class LocalYBInboundCall : public YBInboundCall, public RpcCallParams {
   size_t ObjectSize() const override { return sizeof(*this); }
 
   size_t AddRpcSidecar(Slice car) override {
-    auto buf = RefCntBuffer(car);
-    sidecars_.push_back(std::move(buf));
+    return AddRpcSidecar(RefCntBuffer(car));
+  }
+
+  size_t AddRpcSidecar(RefCntBuffer car) override {
+    sidecars_.push_back(std::move(car));
     return sidecars_.size() - 1;
   }
 
@@ -30,7 +30,10 @@
 // under the License.
 //
 
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -50,8 +53,14 @@
 #include "yb/util/test_util.h"
 #include "yb/util/thread.h"
 
+DECLARE_bool(rpc_priority_scheduling);
+DECLARE_int64(rpc_expected_queue_time_half_life_ms);
+DECLARE_int32(rpc_thread_pool_shards);
+DECLARE_string(rpc_priority_classes);
+
 METRIC_DECLARE_counter(rpc_connections_accepted);
 METRIC_DECLARE_counter(rpcs_queue_overflow);
+METRIC_DECLARE_counter(rpcs_rejected_before_deadline);
 
 using std::string;
 using std::shared_ptr;
@@ -134,6 +143,188 @@ TEST_F(MultiThreadedRpcTest, TestShutdownDuringService) {
   }
 }
 
+// Test concurrent calls to the server that uses sharded thread pool.
+TEST_F(MultiThreadedRpcTest, TestShardedThreadPool) {
+  FLAGS_rpc_thread_pool_shards = 4;
+  HostPort server_addr;
+  StartTestServer(&server_addr);
+
+  constexpr int kNumThreads = 16;
+  constexpr int kCallsPerThread = 200;
+  auto client_messenger = CreateAutoShutdownMessengerHolder("Client");
+  std::vector<std::thread> threads;
+  std::atomic<int> failed_calls{0};
+  for (int i = 0; i != kNumThreads; ++i) {
+    threads.emplace_back([this, &server_addr, &client_messenger, &failed_calls] {
+      CDSAttacher attacher;
+      Proxy p(client_messenger.get(), server_addr);
+      for (int j = 0; j != kCallsPerThread; ++j) {
+        auto status = DoTestSyncCall(&p, CalculatorServiceMethods::AddMethod());
+        if (!status.ok()) {
+          LOG(WARNING) << "Call failed: " << status;
+          ++failed_calls;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(failed_calls.load(), 0);
+}
+
+// Check that queued calls with higher priority class are executed first, when priority scheduling
+// is enabled.
+TEST_F(MultiThreadedRpcTest, TestPriorityScheduling) {
+  const std::string service_name = rpc_test::CalculatorServiceIf::static_service_name();
+  FLAGS_rpc_priority_scheduling = true;
+  FLAGS_rpc_priority_classes = Format(
+      "$0.$1:high,$0.$2:low", service_name, CalculatorServiceMethods::kAddMethodName,
+      CalculatorServiceMethods::kSleepMethodName);
+
+  TestServerOptions options;
+  options.n_worker_threads = 1;
+  HostPort server_addr;
+  StartTestServer(&server_addr, options);
+
+  auto client_messenger = CreateAutoShutdownMessengerHolder("Client");
+  Proxy p(client_messenger.get(), server_addr);
+
+  // Block the only worker, so following calls are queued.
+  rpc_test::SleepRequestPB blocking_req;
+  blocking_req.set_sleep_micros(narrow_cast<uint32_t>(ToMicroseconds(1s)));
+  rpc_test::SleepResponsePB blocking_resp;
+  RpcController blocking_controller;
+  CountDownLatch blocking_latch(1);
+  p.AsyncRequest(
+      CalculatorServiceMethods::SleepMethod(), /* method_metrics= */ nullptr, blocking_req,
+      &blocking_resp, &blocking_controller, blocking_latch.CountDownCallback());
+  std::this_thread::sleep_for(200ms);
+
+  constexpr size_t kCalls = 10;
+  struct Call {
+    RpcController controller;
+    rpc_test::SleepRequestPB sleep_req;
+    rpc_test::SleepResponsePB sleep_resp;
+    rpc_test::AddRequestPB add_req;
+    rpc_test::AddResponsePB add_resp;
+  };
+  std::vector<Call> calls(kCalls * 2);
+  std::mutex mutex;
+  std::vector<int> completion_order;
+  CountDownLatch latch(calls.size());
+  // Low priority calls are sent first, but should be executed after high priority calls.
+  for (size_t i = 0; i != calls.size(); ++i) {
+    auto& call = calls[i];
+    auto callback = [&mutex, &completion_order, &latch, i] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        completion_order.push_back(narrow_cast<int>(i));
+      }
+      latch.CountDown();
+    };
+    if (i < kCalls) {
+      call.sleep_req.set_sleep_micros(0);
+      p.AsyncRequest(
+          CalculatorServiceMethods::SleepMethod(), /* method_metrics= */ nullptr, call.sleep_req,
+          &call.sleep_resp, &call.controller, callback);
+    } else {
+      call.add_req.set_x(narrow_cast<uint32_t>(i));
+      call.add_req.set_y(1);
+      p.AsyncRequest(
+          CalculatorServiceMethods::AddMethod(), /* method_metrics= */ nullptr, call.add_req,
+          &call.add_resp, &call.controller, callback);
+    }
+  }
+
+  blocking_latch.Wait();
+  ASSERT_OK(blocking_controller.status());
+  latch.Wait();
+
+  for (const auto& call : calls) {
+    ASSERT_OK(call.controller.status());
+  }
+  LOG(INFO) << "Completion order: " << AsString(completion_order);
+  for (size_t i = 0; i != completion_order.size(); ++i) {
+    ASSERT_EQ(i >= kCalls, completion_order[i] < narrow_cast<int>(kCalls)) << AsString(completion_order);
+  }
+}
+
+// Check that calls rejected because of high expected queue time are admitted again after load
+// drops.
+TEST_F(MultiThreadedRpcTest, TestPriorityAdmissionRecovers) {
+  FLAGS_rpc_priority_scheduling = true;
+  FLAGS_rpc_expected_queue_time_half_life_ms = 200;
+
+  TestServerOptions options;
+  options.n_worker_threads = 1;
+  HostPort server_addr;
+  StartTestServer(&server_addr, options);
+
+  auto client_messenger = CreateAutoShutdownMessengerHolder("Client");
+  Proxy p(client_messenger.get(), server_addr);
+  auto* rejected = METRIC_rpcs_rejected_before_deadline.Instantiate(metric_entity()).get();
+
+  struct SleepCall {
+    rpc_test::SleepRequestPB req;
+    rpc_test::SleepResponsePB resp;
+    RpcController controller;
+    CountDownLatch latch{1};
+  };
+  std::vector<std::unique_ptr<SleepCall>> calls;
+  auto send_sleep = [&p, &calls](MonoDelta sleep, MonoDelta timeout) {
+    calls.push_back(std::make_unique<SleepCall>());
+    auto& call = *calls.back();
+    call.req.set_sleep_micros(narrow_cast<uint32_t>(sleep.ToMicroseconds()));
+    call.controller.set_timeout(timeout);
+    p.AsyncRequest(
+        CalculatorServiceMethods::SleepMethod(), /* method_metrics= */ nullptr, call.req,
+        &call.resp, &call.controller, call.latch.CountDownCallback());
+    return &call;
+  };
+  auto wait_calls = [&calls] {
+    for (auto& call : calls) {
+      call->latch.Wait();
+    }
+  };
+
+  // High load: calls wait in the queue for about a second, so expected queue time gets high.
+  send_sleep(1s, 10s);
+  std::this_thread::sleep_for(100ms);
+  for (int i = 0; i != 8; ++i) {
+    send_sleep(0s, 10s);
+  }
+  wait_calls();
+  for (auto& call : calls) {
+    ASSERT_OK(call->controller.status());
+  }
+  calls.clear();
+
+  // Call with short deadline is rejected while something is queued. Sleep here is shorter than
+  // half life of expected queue time, so it does not decay yet.
+  send_sleep(500ms, 10s);
+  std::this_thread::sleep_for(50ms);
+  send_sleep(0s, 10s);
+  auto* short_call = send_sleep(0s, 100ms);
+  wait_calls();
+  ASSERT_NOK(short_call->controller.status());
+  ASSERT_EQ(rejected->value(), 1);
+  calls.clear();
+
+  // Load dropped and nothing of this class left the queue for many half lives, so the same call
+  // is admitted now, while there is still something in the queue.
+  std::this_thread::sleep_for(2s);
+  send_sleep(300ms, 10s);
+  std::this_thread::sleep_for(50ms);
+  send_sleep(0s, 10s);
+  short_call = send_sleep(0s, 1s);
+  wait_calls();
+  for (auto& call : calls) {
+    ASSERT_OK(call->controller.status());
+  }
+  ASSERT_EQ(rejected->value(), 1);
+}
+
 // Test shutting down the client messenger exactly as a thread is about to start
 // a new connection. This is a regression test for KUDU-104.
 TEST_F(MultiThreadedRpcTest, TestShutdownClientWhileCallsPending) {
@@ -310,8 +310,12 @@ Result<size_t> RefinedStream::Read() {
       } while (upper_stream_bytes_to_skip_ > 0);
     }
 
+    auto read_buffer_full = ReadBufferFull::kFalse;
+    size_t refined_bytes = 0;
     if (upper_stream_bytes_to_skip_ == 0) {
-      auto read_buffer_full = VERIFY_RESULT(refiner_->Read(&out_buffer));
+      auto out_data_available_before_reading = out_buffer.DataAvailable();
+      read_buffer_full = VERIFY_RESULT(refiner_->Read(&out_buffer));
+      refined_bytes = out_buffer.DataAvailable() - out_data_available_before_reading;
       if (out_buffer.ReadyToRead()) {
         auto temp = VERIFY_RESULT(context_->ProcessReceived(read_buffer_full));
         upper_stream_bytes_to_skip_ = temp;
@@ -319,6 +323,12 @@ Result<size_t> RefinedStream::Read() {
       }
     }
 
+    // Refiner could keep refined data that did not fit into the full output buffer, so read it
+    // again after it was processed, even if all input was consumed.
+    if (read_buffer_full && refined_bytes != 0) {
+      continue;
+    }
+
     if (read_buffer_.Empty() || read_buffer_.DataAvailable() == data_available_before_reading) {
       break;
     }
@@ -30,6 +30,7 @@
 // under the License.
 //
 
+#include <algorithm>
 #include <string>
 #include <thread>
 
@@ -41,11 +42,16 @@
 #include "yb/rpc/rtest.proxy.h"
 
 #include "yb/util/countdown_latch.h"
+#include "yb/util/format.h"
 #include "yb/util/net/net_util.h"
+#include "yb/util/result.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/status_log.h"
 #include "yb/util/test_util.h"
 #include "yb/util/thread.h"
 
+DECLARE_int32(rpc_thread_pool_shards);
+
 using namespace std::literals; // NOLINT
 
 using std::string;
@@ -155,6 +161,135 @@ TEST_F(RpcBench, BenchmarkCalls) {
   LOG(INFO) << "Sys CPU per req:  " << sys_cpu_micros_per_req << "us";
 }
 
+// Benchmark of responses with large sidecars, with and without copying sidecar data into the
+// response.
+TEST_F(RpcBench, BenchmarkLargeSidecars) {
+  constexpr int kNumThreads = 4;
+  constexpr int kSidecarsPerCall = 2;
+
+  HostPort server_hostport;
+  StartTestServer(&server_hostport);
+
+  for (size_t sidecar_size : {1_MB, 4_MB}) {
+    for (bool zero_copy : {false, true}) {
+      should_run_.store(true, std::memory_order_release);
+      std::atomic<int64_t> total_calls{0};
+
+      Stopwatch sw(Stopwatch::ALL_THREADS);
+      sw.start();
+      std::vector<std::thread> threads;
+      for (int i = 0; i != kNumThreads; ++i) {
+        threads.emplace_back([this, &server_hostport, &total_calls, sidecar_size, zero_copy] {
+          CDSAttacher attacher;
+          auto client_messenger = CreateAutoShutdownMessengerHolder("Client");
+          Proxy proxy(client_messenger.get(), server_hostport);
+          rpc_test::SendStringsRequestPB req;
+          for (int j = 0; j != kSidecarsPerCall; ++j) {
+            req.add_sizes(sidecar_size);
+            req.add_zero_copy(zero_copy);
+          }
+          rpc_test::SendStringsResponsePB resp;
+          while (should_run_.load(std::memory_order_acquire)) {
+            RpcController controller;
+            controller.set_timeout(MonoDelta::FromSeconds(10));
+            CHECK_OK(proxy.SyncRequest(
+                CalculatorServiceMethods::SendStringsMethod(), /* method_metrics= */ nullptr, req,
+                &resp, &controller));
+            CHECK_EQ(sidecar_size, CHECK_RESULT(controller.GetSidecar(resp.sidecars(0))).size());
+            total_calls.fetch_add(1, std::memory_order_relaxed);
+          }
+        });
+      }
+
+      std::this_thread::sleep_for(5s);
+      should_run_.store(false, std::memory_order_release);
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      sw.stop();
+
+      auto calls = std::max<int64_t>(total_calls.load(), 1);
+      auto megabytes = calls * kSidecarsPerCall * sidecar_size / 1_MB;
+      LOG(INFO) << Format(
+          "Sidecar size: $0, zero copy: $1, calls/sec: $2, MB/sec: $3, CPU per call: $4us",
+          sidecar_size, zero_copy, calls / sw.elapsed().wall_seconds(),
+          megabytes / sw.elapsed().wall_seconds(),
+          (sw.elapsed().user + sw.elapsed().system) / 1000 / calls);
+    }
+  }
+}
+
+// Benchmark of many concurrent small calls, reports throughput and latency percentiles for
+// different number of RPC thread pool shards.
+TEST_F(RpcBench, BenchmarkThreadPoolShards) {
+#if defined(THREAD_SANITIZER) || defined(ADDRESS_SANITIZER)
+  constexpr int kNumThreads = 8;
+#else
+  constexpr int kNumThreads = 64;
+#endif
+  constexpr int kNumMessengers = 8;
+
+  // 0 - shard per NUMA node.
+  for (int shards : {1, 0, 4, 16}) {
+    FLAGS_rpc_thread_pool_shards = shards;
+    HostPort server_hostport;
+    StartTestServer(&server_hostport);
+
+    std::vector<AutoShutdownMessengerHolder> client_messengers;
+    for (int i = 0; i != kNumMessengers; ++i) {
+      client_messengers.push_back(CreateAutoShutdownMessengerHolder(Format("Client$0", i)));
+    }
+
+    should_run_.store(true, std::memory_order_release);
+    std::vector<std::vector<MonoDelta>> latencies(kNumThreads);
+    Stopwatch sw(Stopwatch::ALL_THREADS);
+    sw.start();
+    std::vector<std::thread> threads;
+    for (int i = 0; i != kNumThreads; ++i) {
+      threads.emplace_back([this, &server_hostport, &client_messengers, &latencies, i] {
+        CDSAttacher attacher;
+        Proxy proxy(client_messengers[i % kNumMessengers].get(), server_hostport);
+        rpc_test::AddRequestPB req;
+        rpc_test::AddResponsePB resp;
+        req.set_x(i);
+        req.set_y(i);
+        while (should_run_.load(std::memory_order_acquire)) {
+          RpcController controller;
+          controller.set_timeout(MonoDelta::FromSeconds(10));
+          auto start = MonoTime::Now();
+          CHECK_OK(proxy.SyncRequest(
+              CalculatorServiceMethods::AddMethod(), /* method_metrics= */ nullptr, req, &resp,
+              &controller));
+          latencies[i].push_back(MonoTime::Now() - start);
+        }
+      });
+    }
+
+    std::this_thread::sleep_for(5s);
+    should_run_.store(false, std::memory_order_release);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    sw.stop();
+
+    std::vector<MonoDelta> all_latencies;
+    for (const auto& thread_latencies : latencies) {
+      all_latencies.insert(all_latencies.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    ASSERT_FALSE(all_latencies.empty());
+    std::sort(all_latencies.begin(), all_latencies.end());
+    auto percentile = [&all_latencies](double p) {
+      return all_latencies[std::min<size_t>(
+          all_latencies.size() * p, all_latencies.size() - 1)].ToMicroseconds();
+    };
+    LOG(INFO) << Format(
+        "Shards: $0, calls/sec: $1, p50: $2us, p99: $3us, p99.9: $4us, CPU per call: $5us",
+        shards, all_latencies.size() / sw.elapsed().wall_seconds(), percentile(0.5),
+        percentile(0.99), percentile(0.999),
+        (sw.elapsed().user + sw.elapsed().system) / 1000 / all_latencies.size());
+  }
+}
+
 } // namespace rpc
 } // namespace yb
 
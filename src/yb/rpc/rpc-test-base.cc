@@ -162,10 +162,14 @@ void GenericCalculatorService::DoSendStrings(InboundCall* incoming) {
   Random r(req.random_seed());
   SendStringsResponsePB resp;
   auto* yb_call = down_cast<YBInboundCall*>(incoming);
-  for (auto size : req.sizes()) {
+  for (int i = 0; i != req.sizes_size(); ++i) {
+    auto size = req.sizes(i);
     auto sidecar = RefCntBuffer(size);
     RandomString(sidecar.udata(), size, &r);
-    resp.add_sidecars(narrow_cast<uint32_t>(yb_call->AddRpcSidecar(sidecar.as_slice())));
+    auto idx = i < req.zero_copy_size() && req.zero_copy(i)
+        ? yb_call->AddRpcSidecar(std::move(sidecar))
+        : yb_call->AddRpcSidecar(sidecar.AsSlice());
+    resp.add_sidecars(narrow_cast<uint32_t>(idx));
   }
 
   down_cast<YBInboundCall*>(incoming)->RespondSuccess(AnyMessageConstPtr(&resp));
@@ -492,13 +496,17 @@ Status RpcTestBase::DoTestSyncCall(Proxy* proxy, const RemoteMethod* method) {
 
 void RpcTestBase::DoTestSidecar(Proxy* proxy,
                                 std::vector<size_t> sizes,
-                                Status::Code expected_code) {
+                                Status::Code expected_code,
+                                std::vector<bool> zero_copy) {
   const uint32_t kSeed = 12345;
 
   SendStringsRequestPB req;
   for (auto size : sizes) {
     req.add_sizes(size);
   }
+  for (auto value : zero_copy) {
+    req.add_zero_copy(value);
+  }
   req.set_random_seed(kSeed);
 
   SendStringsResponsePB resp;
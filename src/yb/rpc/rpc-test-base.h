@@ -192,9 +192,11 @@ class RpcTestBase : public YBTest {
 
   Status DoTestSyncCall(Proxy* proxy, const RemoteMethod *method);
 
+  // zero_copy specifies which sidecars should be added by the server without copying.
   void DoTestSidecar(Proxy* proxy,
                      std::vector<size_t> sizes,
-                     Status::Code expected_code = Status::Code::kOk);
+                     Status::Code expected_code = Status::Code::kOk,
+                     std::vector<bool> zero_copy = {});
 
   void DoTestExpectTimeout(Proxy* proxy, const MonoDelta &timeout);
 
@@ -89,6 +89,9 @@ DECLARE_bool(binary_call_parser_reject_on_mem_tracker_hard_limit);
 DECLARE_bool(enable_rpc_keepalive);
 DECLARE_int32(num_connections_to_server);
 DECLARE_int64(rpc_throttle_threshold_bytes);
+DECLARE_bool(stream_compression_adaptive);
+DECLARE_int32(stream_compression_adaptive_probe_windows);
+DECLARE_int64(stream_compression_adaptive_window_bytes);
 DECLARE_int32(stream_compression_algo);
 DECLARE_int64(memory_limit_hard_bytes);
 DECLARE_string(vmodule);
@@ -487,6 +490,11 @@ TEST_F(TestRpc, TestRpcSidecar) {
   std::vector<size_t> sizes(20);
   std::fill(sizes.begin(), sizes.end(), 123);
   DoTestSidecar(&p, sizes);
+
+  // Test sidecars that reference existing buffers, mixed with copied ones.
+  DoTestSidecar(&p, {3_MB, 123, 456, 2_MB, 789}, Status::Code::kOk,
+                {true, false, false, true, true});
+  DoTestSidecar(&p, sizes, Status::Code::kOk, std::vector<bool>(sizes.size(), true));
 }
 
 // Test that timeouts are properly handled.
@@ -1276,6 +1284,23 @@ TEST_P(TestRpcCompression, CantAllocateReadBuffer) {
   RunCompressionTest(&TestCantAllocateReadBuffer, SetupServerForTestCantAllocateReadBuffer());
 }
 
+// Adaptive compression is used only by zstd. Small window makes it change level and disable
+// compression while ops are running, since compression never pays off on loopback.
+TEST_P(TestRpcCompression, AdaptiveManyOps) {
+  FLAGS_stream_compression_adaptive = true;
+  FLAGS_stream_compression_adaptive_window_bytes = 4_KB;
+  FLAGS_stream_compression_adaptive_probe_windows = 2;
+  RunCompressionTest(&TestManyOps);
+}
+
+TEST_P(TestRpcCompression, AdaptiveBigOp) {
+  FLAGS_stream_compression_adaptive = true;
+  FLAGS_stream_compression_adaptive_window_bytes = 4_KB;
+  FLAGS_stream_compression_adaptive_probe_windows = 2;
+  FLAGS_rpc_read_buffer_size = 128;
+  RunCompressionTest(&TestBigOp);
+}
+
 void TestCompression(CalculatorServiceProxy* proxy, const MetricEntityPtr& metric_entity) {
   constexpr size_t kStringLen = 4_KB;
 
@@ -1323,11 +1348,19 @@ std::string CompressionName(const testing::TestParamInfo<int>& info) {
     case 1: return "Zlib";
     case 2: return "Snappy";
     case 3: return "LZ4";
+    case 4: return "Zstd";
   }
   return Format("Unknown compression $0", info.param);
 }
 
-INSTANTIATE_TEST_CASE_P(, TestRpcCompression, testing::Range(1, 4), CompressionName);
+#if defined(ZSTD)
+constexpr int kMaxCompressionAlgo = 4;
+#else
+constexpr int kMaxCompressionAlgo = 3;
+#endif
+
+INSTANTIATE_TEST_CASE_P(
+    , TestRpcCompression, testing::Range(1, kMaxCompressionAlgo + 1), CompressionName);
 
 class TestRpcSecureCompression : public TestRpcSecure {
  public:
@@ -281,6 +281,15 @@ class RpcContext {
   // Returns the index of the sidecar.
   size_t AddRpcSidecar(const Slice& car);
 
+  // Adds an RpcSidecar that references the specified buffer. The buffer is written to the socket
+  // as is, so data is not copied into the response. Preferred for large sidecars that are already
+  // stored in a RefCntBuffer.
+  //
+  // Assumes no changes to the buffer are made after insertion.
+  //
+  // Returns the index of the sidecar.
+  size_t AddRpcSidecar(RefCntBuffer car);
+
   // Removes all RpcSidecars.
   void ResetRpcSidecars();
 
@@ -37,8 +37,10 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <boost/asio/strand.hpp>
@@ -49,13 +51,16 @@
 
 #include "yb/gutil/atomicops.h"
 #include "yb/gutil/ref_counted.h"
+#include "yb/gutil/strings/split.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/gutil/thread_annotations.h"
 
 #include "yb/rpc/inbound_call.h"
 #include "yb/rpc/scheduler.h"
 #include "yb/rpc/service_if.h"
 
 #include "yb/util/countdown_latch.h"
+#include "yb/util/enums.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/lockfree.h"
 #include "yb/util/logging.h"
@@ -85,6 +90,28 @@ DEFINE_test_flag(bool, enable_backpressure_mode_for_testing, false,
             "For testing purposes. Enables the rpc's to be considered timed out in the queue even "
             "when we have not had any backpressure in the recent past.");
 
+DEFINE_bool(rpc_priority_scheduling, false,
+            "Execute queued calls of each service in order of their priority class and client "
+            "deadline instead of FIFO, and reject calls that are not expected to leave the queue "
+            "before their deadline.");
+TAG_FLAG(rpc_priority_scheduling, advanced);
+
+DEFINE_string(rpc_priority_classes, "",
+              "Comma separated list of <service>[.<method>]:<class> entries, that specify "
+              "priority class used by rpc_priority_scheduling for calls of the service or method. "
+              "Class is one of high, normal, low and background. Calls that are not listed have "
+              "normal class. Example: yb.tserver.TabletServerService.Read:high,"
+              "yb.tserver.TabletServerService.GetSplitKey:background");
+TAG_FLAG(rpc_priority_classes, advanced);
+
+DEFINE_int64(rpc_expected_queue_time_half_life_ms, 1000,
+             "Expected queue time of a priority class, used by rpc_priority_scheduling to reject "
+             "calls before their deadline, is halved every specified amount of time (in ms) while "
+             "no calls of this class leave the queue. So calls are admitted again after load "
+             "drops. 0 disables decay.");
+TAG_FLAG(rpc_expected_queue_time_half_life_ms, advanced);
+TAG_FLAG(rpc_expected_queue_time_half_life_ms, runtime);
+
 METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time,
                         "RPC Queue Time",
                         yb::MetricUnit::kMicroseconds,
@@ -104,6 +131,36 @@ METRIC_DEFINE_counter(server, rpcs_timed_out_early_in_queue,
                       "in the service queue, and thus were not processed. "
                       "Timeout for those calls were detected before the calls tried to execute.");
 
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_high_priority,
+                        "RPC Queue Time of High Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming high priority RPC requests spend in the "
+                        "worker queue");
+
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_normal_priority,
+                        "RPC Queue Time of Normal Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming normal priority RPC requests spend in "
+                        "the worker queue");
+
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_low_priority,
+                        "RPC Queue Time of Low Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming low priority RPC requests spend in the "
+                        "worker queue");
+
+METRIC_DEFINE_coarse_histogram(server, rpc_incoming_queue_time_background_priority,
+                        "RPC Queue Time of Background Priority Calls",
+                        yb::MetricUnit::kMicroseconds,
+                        "Number of microseconds incoming background priority RPC requests spend "
+                        "in the worker queue");
+
+METRIC_DEFINE_counter(server, rpcs_rejected_before_deadline,
+                      "RPCs Rejected Before Deadline",
+                      yb::MetricUnit::kRequests,
+                      "Number of RPCs rejected when queued, because they were not expected to "
+                      "leave the service queue before their deadline.");
+
 METRIC_DEFINE_counter(server, rpcs_queue_overflow,
                       "RPC Queue Overflows",
                       yb::MetricUnit::kRequests,
@@ -118,6 +175,38 @@ namespace {
 const CoarseDuration kTimeoutCheckGranularity = 100ms;
 const char* const kTimedOutInQueue = "Call waited in the queue past deadline";
 
+YB_DEFINE_ENUM(RpcPriorityClass, (kHigh)(kNormal)(kLow)(kBackground));
+
+// Returns priority classes of the specified service and its methods, specified by
+// rpc_priority_classes. Entry with empty method name specifies class of the whole service.
+std::vector<std::pair<std::string, RpcPriorityClass>> ParsePriorityClasses(
+    const std::string& service_name) {
+  std::vector<std::pair<std::string, RpcPriorityClass>> result;
+  std::vector<std::string> entries = strings::Split(
+      FLAGS_rpc_priority_classes, ",", strings::SkipWhitespace());
+  for (const auto& entry : entries) {
+    auto colon = entry.rfind(':');
+    if (colon == std::string::npos) {
+      LOG(DFATAL) << "Invalid rpc priority class entry: " << entry;
+      continue;
+    }
+    auto name = entry.substr(0, colon);
+    auto priority_class = ParseEnumInsensitive<RpcPriorityClass>("k" + entry.substr(colon + 1));
+    if (!priority_class.ok()) {
+      LOG(DFATAL) << "Invalid rpc priority class entry " << entry << ": "
+                  << priority_class.status();
+      continue;
+    }
+    if (name == service_name) {
+      result.emplace_back(std::string(), *priority_class);
+    } else if (name.size() > service_name.size() + 1 && name[service_name.size()] == '.' &&
+               name.compare(0, service_name.size(), service_name) == 0) {
+      result.emplace_back(name.substr(service_name.size() + 1), *priority_class);
+    }
+  }
+  return result;
+}
+
 } // namespace
 
 class ServicePoolImpl final : public InboundCallHandler {
@@ -136,6 +225,15 @@ class ServicePoolImpl final : public InboundCallHandler {
         rpcs_timed_out_early_in_queue_(
             METRIC_rpcs_timed_out_early_in_queue.Instantiate(entity)),
         rpcs_queue_overflow_(METRIC_rpcs_queue_overflow.Instantiate(entity)),
+        rpcs_rejected_before_deadline_(
+            METRIC_rpcs_rejected_before_deadline.Instantiate(entity)),
+        priority_scheduling_(FLAGS_rpc_priority_scheduling),
+        priority_classes_(ParsePriorityClasses(service_->service_name())),
+        incoming_queue_time_per_class_{
+            METRIC_rpc_incoming_queue_time_high_priority.Instantiate(entity),
+            METRIC_rpc_incoming_queue_time_normal_priority.Instantiate(entity),
+            METRIC_rpc_incoming_queue_time_low_priority.Instantiate(entity),
+            METRIC_rpc_incoming_queue_time_background_priority.Instantiate(entity)},
         check_timeout_strand_(scheduler->io_service()),
         log_prefix_(Format("$0: ", service_->service_name())) {
 
@@ -185,6 +283,15 @@ class ServicePoolImpl final : public InboundCallHandler {
   void Enqueue(const InboundCallPtr& call) {
     TRACE_TO(call->trace(), "Inserting onto call queue");
 
+    auto priority_class = RpcPriorityClass::kNormal;
+    if (priority_scheduling_) {
+      priority_class = PriorityClass(*call);
+      if (!CouldLeaveQueueBeforeDeadline(*call, priority_class)) {
+        RejectBeforeDeadline(call, priority_class);
+        return;
+      }
+    }
+
     auto task = call->BindTask(this);
     if (!task) {
       Overflow(call, "service", queued_calls_.load(std::memory_order_relaxed));
@@ -197,6 +304,19 @@ class ServicePoolImpl final : public InboundCallHandler {
       ScheduleCheckTimeout(call_deadline);
     }
 
+    if (priority_scheduling_) {
+      // Task of the call is used only as a token, that executes the most prioritized queued call
+      // of this service. See PopScheduledCall.
+      std::lock_guard<std::mutex> lock(scheduled_calls_mutex_);
+      scheduled_calls_.push(ScheduledCall{
+          .priority_class = priority_class,
+          .deadline = call_deadline,
+          .serial_no = ++scheduled_calls_serial_no_,
+          .call = call,
+      });
+      num_scheduled_calls_.fetch_add(1, std::memory_order_release);
+    }
+
     thread_pool_.Enqueue(task);
   }
 
@@ -233,8 +353,9 @@ class ServicePoolImpl final : public InboundCallHandler {
         CoarseMonoClock::Now().time_since_epoch(), std::memory_order_release);
   }
 
-  void Failure(const InboundCallPtr& call, const Status& status) override {
-    if (!call->TryStartProcessing()) {
+  void Failure(const InboundCallPtr& token_call, const Status& status) override {
+    auto call = priority_scheduling_ ? PopScheduledCall() : token_call;
+    if (!call || !call->TryStartProcessing()) {
       return;
     }
 
@@ -254,8 +375,24 @@ class ServicePoolImpl final : public InboundCallHandler {
     service_->FillEndpoints(service, map);
   }
 
+  // Invoked by the task of the queued call.
   void Handle(InboundCallPtr incoming) override {
+    if (!priority_scheduling_) {
+      HandleCall(std::move(incoming));
+      return;
+    }
+    auto priority_class = RpcPriorityClass::kNormal;
+    incoming = PopScheduledCall(&priority_class);
+    if (incoming) {
+      HandleCall(std::move(incoming), &priority_class);
+    }
+  }
+
+  void HandleCall(InboundCallPtr incoming, const RpcPriorityClass* priority_class = nullptr) {
     incoming->RecordHandlingStarted(incoming_queue_time_);
+    if (priority_class) {
+      RecordQueueTime(*priority_class, incoming->GetTimeInQueue());
+    }
     ADOPT_TRACE(incoming->trace());
 
     const char* error_message;
@@ -282,6 +419,104 @@ class ServicePoolImpl final : public InboundCallHandler {
   }
 
  private:
+  struct ScheduledCall {
+    RpcPriorityClass priority_class;
+    CoarseTimePoint deadline;
+    // Used to keep FIFO order of calls with the same priority class and deadline.
+    uint64_t serial_no;
+    InboundCallPtr call;
+
+    // Priority queue puts the greatest value on top, so we invert comparison.
+    bool operator<(const ScheduledCall& rhs) const {
+      return std::tie(priority_class, deadline, serial_no) >
+             std::tie(rhs.priority_class, rhs.deadline, rhs.serial_no);
+    }
+  };
+
+  RpcPriorityClass PriorityClass(const InboundCall& call) const {
+    auto result = RpcPriorityClass::kNormal;
+    auto method_name = call.method_name();
+    for (const auto& p : priority_classes_) {
+      if (p.first.empty()) {
+        result = p.second;
+      } else if (method_name == Slice(p.first)) {
+        return p.second;
+      }
+    }
+    return result;
+  }
+
+  // Pops the most prioritized call, i.e. call with the highest priority class and the earliest
+  // deadline. Since each queued call has its own task in the thread pool, the number of popped
+  // calls matches the number of queued calls.
+  InboundCallPtr PopScheduledCall(RpcPriorityClass* priority_class = nullptr) {
+    InboundCallPtr result;
+    std::lock_guard<std::mutex> lock(scheduled_calls_mutex_);
+    if (scheduled_calls_.empty()) {
+      return result;
+    }
+    auto& top = scheduled_calls_.top();
+    if (priority_class) {
+      *priority_class = top.priority_class;
+    }
+    result = top.call;
+    scheduled_calls_.pop();
+    num_scheduled_calls_.fetch_sub(1, std::memory_order_release);
+    return result;
+  }
+
+  void RecordQueueTime(RpcPriorityClass priority_class, MonoDelta time_in_queue) {
+    auto queue_time = time_in_queue.ToMicroseconds();
+    auto index = to_underlying(priority_class);
+    incoming_queue_time_per_class_[index]->Increment(queue_time);
+    // Exponential moving average of the time spent in the queue.
+    auto now = CoarseMonoClock::Now();
+    auto old_value = ExpectedQueueTimeUs(priority_class, now);
+    expected_queue_time_us_[index].store(
+        old_value + (queue_time - old_value) / 8, std::memory_order_relaxed);
+    expected_queue_time_updated_at_[index].store(now.time_since_epoch(), std::memory_order_relaxed);
+  }
+
+  // Calls that are rejected before deadline do not update expected queue time, so it decays over
+  // time. Otherwise a class would stay rejected forever once its expected queue time got high,
+  // even after load drops.
+  int64_t ExpectedQueueTimeUs(RpcPriorityClass priority_class, CoarseTimePoint now) const {
+    auto index = to_underlying(priority_class);
+    auto result = expected_queue_time_us_[index].load(std::memory_order_relaxed);
+    auto half_life_ms = FLAGS_rpc_expected_queue_time_half_life_ms;
+    if (result <= 0 || half_life_ms <= 0) {
+      return result;
+    }
+    auto updated_at = CoarseTimePoint(
+        expected_queue_time_updated_at_[index].load(std::memory_order_relaxed));
+    auto half_lifes = ToMilliseconds(now - updated_at) / half_life_ms;
+    return half_lifes >= 63 ? 0 : result >> half_lifes;
+  }
+
+  bool CouldLeaveQueueBeforeDeadline(const InboundCall& call, RpcPriorityClass priority_class) {
+    auto deadline = call.GetClientDeadline();
+    // When queue is empty, call would be executed immediately. We also don't estimate queue time
+    // in this case, so it does not prevent queue time from being updated when load drops.
+    if (deadline == CoarseTimePoint::max() ||
+        num_scheduled_calls_.load(std::memory_order_acquire) == 0) {
+      return true;
+    }
+    auto now = CoarseMonoClock::Now();
+    return now + ExpectedQueueTimeUs(priority_class, now) * 1us <= deadline;
+  }
+
+  void RejectBeforeDeadline(const InboundCallPtr& call, RpcPriorityClass priority_class) {
+    const auto err_msg = Format(
+        "$0 request on $1 from $2 rejected, since it is not expected to leave the queue before "
+        "its deadline. Priority class: $3, expected queue time: $4us.",
+        call->method_name().ToBuffer(), service_->service_name(), call->remote_address(),
+        priority_class, ExpectedQueueTimeUs(priority_class, CoarseMonoClock::Now()));
+    YB_LOG_EVERY_N_SECS(WARNING, 3) << LogPrefix() << err_msg;
+    rpcs_rejected_before_deadline_->Increment();
+    call->RespondFailure(
+        ErrorStatusPB::ERROR_SERVER_TOO_BUSY, STATUS(ServiceUnavailable, err_msg));
+  }
+
   void TimedOut(InboundCall* call, const char* error_message, Counter* metric) {
     if (call->RespondTimedOutIfPending(error_message)) {
       metric->Increment();
@@ -416,7 +651,19 @@ class ServicePoolImpl final : public InboundCallHandler {
   scoped_refptr<Counter> rpcs_timed_out_in_queue_;
   scoped_refptr<Counter> rpcs_timed_out_early_in_queue_;
   scoped_refptr<Counter> rpcs_queue_overflow_;
+  scoped_refptr<Counter> rpcs_rejected_before_deadline_;
   scoped_refptr<AtomicGauge<int64_t>> rpcs_in_queue_;
+
+  // Priority scheduling, see rpc_priority_scheduling.
+  const bool priority_scheduling_;
+  const std::vector<std::pair<std::string, RpcPriorityClass>> priority_classes_;
+  scoped_refptr<Histogram> incoming_queue_time_per_class_[kRpcPriorityClassMapSize];
+  std::atomic<int64_t> expected_queue_time_us_[kRpcPriorityClassMapSize] = {};
+  std::atomic<CoarseDuration> expected_queue_time_updated_at_[kRpcPriorityClassMapSize] = {};
+  std::mutex scheduled_calls_mutex_;
+  std::priority_queue<ScheduledCall> scheduled_calls_ GUARDED_BY(scheduled_calls_mutex_);
+  uint64_t scheduled_calls_serial_no_ GUARDED_BY(scheduled_calls_mutex_) = 0;
+  std::atomic<size_t> num_scheduled_calls_{0};
   // Have to use CoarseDuration here, since CoarseTimePoint does not work with clang + libstdc++
   std::atomic<CoarseDuration> last_backpressure_at_{CoarseTimePoint().time_since_epoch()};
   std::atomic<int64_t> queued_calls_{0};
@@ -487,7 +734,7 @@ void ServicePool::QueueInboundCall(InboundCallPtr call) {
 }
 
 void ServicePool::Handle(InboundCallPtr call) {
-  impl_->Handle(std::move(call));
+  impl_->HandleCall(std::move(call));
 }
 
 void ServicePool::FillEndpoints(RpcEndpointMap* map) {
@@ -27,6 +27,7 @@
 #include "yb/util/tsan_util.h"
 
 DECLARE_int32(TEST_strand_done_inject_delay_ms);
+DECLARE_int32(rpc_thread_pool_shards);
 
 using namespace std::literals;
 
@@ -149,6 +150,64 @@ TEST_F(ThreadPoolTest, TestMultiProducers) {
   }
 }
 
+TEST_F(ThreadPoolTest, TestShardedMultiProducers) {
+  FLAGS_rpc_thread_pool_shards = 4;
+  constexpr size_t kTotalTasks = 10000;
+  constexpr size_t kTotalWorkers = 8;
+  constexpr size_t kProducers = 8;
+  ThreadPool pool("test", kTotalTasks, kTotalWorkers);
+
+  CountDownLatch latch(kTotalTasks);
+  std::vector<TestTask> tasks(kTotalTasks);
+  std::vector<std::thread> threads;
+  size_t begin = 0;
+  for (size_t i = 0; i != kProducers; ++i) {
+    size_t end = kTotalTasks * (i + 1) / kProducers;
+    threads.emplace_back([&pool, &latch, &tasks, begin, end] {
+      CDSAttacher attacher;
+      for (size_t i = begin; i != end; ++i) {
+        tasks[i].SetLatch(&latch);
+        ASSERT_TRUE(pool.Enqueue(&tasks[i]));
+      }
+    });
+    begin = end;
+  }
+  latch.Wait();
+  for (auto& task : tasks) {
+    ASSERT_TRUE(task.IsCompleted());
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Tasks queued from a single thread land in a single shard, check that workers of other shards
+// steal them, so they are executed concurrently.
+TEST_F(ThreadPoolTest, TestShardWorkStealing) {
+  FLAGS_rpc_thread_pool_shards = 4;
+  constexpr size_t kTotalTasks = 16;
+  constexpr size_t kTotalWorkers = 4;
+  ThreadPool pool("test", kTotalTasks, kTotalWorkers);
+
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  CountDownLatch latch(kTotalTasks);
+  for (size_t i = 0; i != kTotalTasks; ++i) {
+    pool.EnqueueFunctor([&running, &max_running, &latch] {
+      auto current = ++running;
+      auto old_max = max_running.load();
+      while (current > old_max && !max_running.compare_exchange_weak(old_max, current)) {
+      }
+      std::this_thread::sleep_for(50ms);
+      --running;
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  LOG(INFO) << "Max running: " << max_running.load();
+  ASSERT_GT(max_running.load(), 1);
+}
+
 TEST_F(ThreadPoolTest, TestQueueOverflow) {
   constexpr size_t kTotalTasks = 10000;
   constexpr size_t kTotalWorkers = 4;
@@ -15,16 +15,38 @@
 
 #include "yb/rpc/thread_pool.h"
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <condition_variable>
+#include <fstream>
 #include <mutex>
+#include <thread>
 
 #include <cds/container/basket_queue.h>
 #include <cds/gc/dhp.h>
 
+#include "yb/gutil/strings/split.h"
+#include "yb/gutil/sysinfo.h"
+
+#include "yb/util/flag_tags.h"
+#include "yb/util/format.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status_format.h"
 #include "yb/util/thread.h"
 
+DEFINE_int32(rpc_thread_pool_shards, 1,
+             "Number of shards in each RPC thread pool. Each shard has its own task queue and "
+             "workers. Task is queued to the shard of the CPU that queues it, and idle workers "
+             "steal tasks from other shards. 0 - use one shard per NUMA node.");
+TAG_FLAG(rpc_thread_pool_shards, advanced);
+
+DEFINE_bool(rpc_thread_pool_pin_shard_workers, false,
+            "Bind workers of RPC thread pool shard to CPUs of this shard.");
+TAG_FLAG(rpc_thread_pool_pin_shard_workers, advanced);
+
 namespace yb {
 namespace rpc {
 
@@ -35,13 +57,129 @@ class Worker;
 typedef cds::container::BasketQueue<cds::gc::DHP, ThreadPoolTask*> TaskQueue;
 typedef cds::container::BasketQueue<cds::gc::DHP, Worker*> WaitingWorkers;
 
-struct ThreadPoolShare {
-  ThreadPoolOptions options;
+// Parses list of CPUs in the format used by sysfs, for instance "0-3,8-11".
+std::vector<int> ParseCpuList(const std::string& input) {
+  std::vector<int> result;
+  std::vector<std::string> ranges = strings::Split(input, ",", strings::SkipWhitespace());
+  for (const auto& range : ranges) {
+    int first = 0;
+    int last = 0;
+    auto dash = range.find('-');
+    if (dash == std::string::npos) {
+      first = last = std::atoi(range.c_str());
+    } else {
+      first = std::atoi(range.substr(0, dash).c_str());
+      last = std::atoi(range.substr(dash + 1).c_str());
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      result.push_back(cpu);
+    }
+  }
+  return result;
+}
+
+std::string ReadSysFsLine(const std::string& path) {
+  std::ifstream input(path);
+  std::string result;
+  std::getline(input, result);
+  return result;
+}
+
+// Maps CPUs to thread pool shards.
+class CpuShards {
+ public:
+  // Returns CPUs of each NUMA node, or empty vector if NUMA topology is not available.
+  static std::vector<std::vector<int>> NumaNodes() {
+    std::vector<std::vector<int>> result;
+#if defined(__linux__)
+    for (auto node : ParseCpuList(ReadSysFsLine("/sys/devices/system/node/online"))) {
+      auto cpus = ParseCpuList(ReadSysFsLine(
+          Format("/sys/devices/system/node/node$0/cpulist", node)));
+      if (!cpus.empty()) {
+        result.push_back(std::move(cpus));
+      }
+    }
+#endif
+    return result;
+  }
+
+  explicit CpuShards(int num_shards) {
+    auto num_cpus = std::max(base::NumCPUs(), 1);
+    if (num_shards <= 0) {
+      shard_cpus_ = NumaNodes();
+    }
+    if (shard_cpus_.empty()) {
+      // Split CPUs into continuous ranges.
+      num_shards = std::max(std::min(num_shards, num_cpus), 1);
+      shard_cpus_.resize(num_shards);
+      for (int cpu = 0; cpu != num_cpus; ++cpu) {
+        shard_cpus_[cpu * num_shards / num_cpus].push_back(cpu);
+      }
+    }
+    for (size_t shard = 0; shard != shard_cpus_.size(); ++shard) {
+      for (auto cpu : shard_cpus_[shard]) {
+        if (implicit_cast<size_t>(cpu) >= cpu_to_shard_.size()) {
+          cpu_to_shard_.resize(cpu + 1);
+        }
+        cpu_to_shard_[cpu] = shard;
+      }
+    }
+  }
+
+  size_t num_shards() const {
+    return shard_cpus_.size();
+  }
+
+  const std::vector<int>& ShardCpus(size_t shard) const {
+    return shard_cpus_[shard];
+  }
+
+  size_t CurrentShard() const {
+    if (shard_cpus_.size() == 1) {
+      return 0;
+    }
+#if defined(__linux__)
+    auto cpu = sched_getcpu();
+    if (cpu >= 0 && implicit_cast<size_t>(cpu) < cpu_to_shard_.size()) {
+      return cpu_to_shard_[cpu];
+    }
+#endif
+    return std::hash<std::thread::id>()(std::this_thread::get_id()) % shard_cpus_.size();
+  }
+
+ private:
+  std::vector<std::vector<int>> shard_cpus_;
+  std::vector<size_t> cpu_to_shard_;
+};
+
+struct ThreadPoolShard {
   TaskQueue task_queue;
   WaitingWorkers waiting_workers;
+  // See ThreadPool::Impl::Enqueue for details.
+  std::atomic<size_t> created_workers{0};
+};
+
+struct ThreadPoolShare {
+  ThreadPoolOptions options;
+  CpuShards cpu_shards;
+  std::unique_ptr<ThreadPoolShard[]> shards;
 
   explicit ThreadPoolShare(ThreadPoolOptions o)
-      : options(std::move(o)) {}
+      : options(std::move(o)),
+        cpu_shards(FLAGS_rpc_thread_pool_shards),
+        shards(new ThreadPoolShard[num_shards()]) {}
+
+  size_t num_shards() const {
+    return cpu_shards.num_shards();
+  }
+
+  // Workers are split evenly between shards, and the first shard also gets the remainder, so the
+  // total number of workers does not exceed max_workers. Shards without workers are served by
+  // workers that steal tasks from other shards.
+  size_t max_workers_in_shard(size_t shard) const {
+    auto result = options.max_workers / num_shards();
+    return shard == 0 ? std::max<size_t>(result + options.max_workers % num_shards(), 1) : result;
+  }
 };
 
 namespace {
@@ -52,12 +190,14 @@ const std::string kRpcThreadCategory = "rpc_thread_pool";
 
 class Worker {
  public:
-  explicit Worker(ThreadPoolShare* share)
-      : share_(share) {
+  Worker(ThreadPoolShare* share, size_t shard)
+      : share_(share), shard_(shard) {
   }
 
   Status Start(size_t index) {
-    auto name = strings::Substitute("rpc_tp_$0_$1", share_->options.name, index);
+    auto name = share_->num_shards() == 1
+        ? strings::Substitute("rpc_tp_$0_$1", share_->options.name, index)
+        : strings::Substitute("rpc_tp_$0_$1_$2", share_->options.name, shard_, index);
     return yb::Thread::Create(kRpcThreadCategory, name, &Worker::Execute, this, &thread_);
   }
 
@@ -96,8 +236,13 @@ class Worker {
   // In other words, one of those queues should be empty.
   // Meaning that we does not have work (task queue empty) or
   // does not have free hands (worker queue empty)
+  //
+  // With multiple shards the invariant holds for union of all shards, since worker waits only
+  // after checking task queues of all shards, and task is never queued without checking waiting
+  // workers of all shards.
   void Execute() {
     Thread::current_thread()->SetUserData(share_);
+    PinToShardCpus();
     while (!stop_requested_) {
       ThreadPoolTask* task = nullptr;
       if (PopTask(&task)) {
@@ -107,10 +252,36 @@ class Worker {
     }
   }
 
+  void PinToShardCpus() {
+#if defined(__linux__)
+    if (!FLAGS_rpc_thread_pool_pin_shard_workers || share_->num_shards() == 1) {
+      return;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (auto cpu : share_->cpu_shards.ShardCpus(shard_)) {
+      CPU_SET(cpu, &cpu_set);
+    }
+    int res = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    LOG_IF(WARNING, res != 0) << "Failed to pin worker to CPUs of shard " << shard_ << ": " << res;
+#endif
+  }
+
+  // Pops task from the queue of our shard, or steals it from other shards.
+  bool TryPopTask(ThreadPoolTask** task) {
+    auto num_shards = share_->num_shards();
+    for (size_t i = 0; i != num_shards; ++i) {
+      if (share_->shards[(shard_ + i) % num_shards].task_queue.pop(*task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   bool PopTask(ThreadPoolTask** task) {
     // First of all we try to get already queued task, w/o locking.
     // If there is no task, so we could go to waiting state.
-    if (share_->task_queue.pop(*task)) {
+    if (TryPopTask(task)) {
       return true;
     }
     std::unique_lock<std::mutex> lock(mutex_);
@@ -126,7 +297,7 @@ class Worker {
       // the worker queue. So worker queue could be empty in this case, and nobody was notified
       // about new task. So we check there for this case. This technique is similar to
       // double check.
-      if (share_->task_queue.pop(*task)) {
+      if (TryPopTask(task)) {
         return true;
       }
 
@@ -134,7 +305,7 @@ class Worker {
 
       // Sometimes another worker could steal task before we wake up. In this case we will
       // just enqueue ourselves back.
-      if (share_->task_queue.pop(*task)) {
+      if (TryPopTask(task)) {
         return true;
       }
     }
@@ -143,13 +314,14 @@ class Worker {
 
   void AddToWaitingWorkers() {
     if (!added_to_waiting_workers_) {
-      auto pushed = share_->waiting_workers.push(this);
+      auto pushed = share_->shards[shard_].waiting_workers.push(this);
       DCHECK(pushed); // BasketQueue always succeed.
       added_to_waiting_workers_ = true;
     }
   }
 
   ThreadPoolShare* share_;
+  const size_t shard_;
   scoped_refptr<yb::Thread> thread_;
   std::mutex mutex_;
   std::condition_variable cond_;
@@ -167,7 +339,8 @@ class ThreadPool::Impl {
         queue_full_status_(STATUS_SUBSTITUTE(ServiceUnavailable,
                                              "Queue is full, max items: $0",
                                              share_.options.queue_limit)) {
-    LOG(INFO) << "Starting thread pool " << share_.options.ToString();
+    LOG(INFO) << "Starting thread pool " << share_.options.ToString() << ", shards: "
+              << share_.num_shards();
     workers_.reserve(share_.options.max_workers);
   }
 
@@ -182,47 +355,52 @@ class ThreadPool::Impl {
       task->Done(shutdown_status_);
       return false;
     }
-    bool added = share_.task_queue.push(task);
+    auto num_shards = share_.num_shards();
+    auto shard_idx = share_.cpu_shards.CurrentShard();
+    bool added = share_.shards[shard_idx].task_queue.push(task);
     DCHECK(added); // BasketQueue always succeed.
-    Worker* worker = nullptr;
-    while (share_.waiting_workers.pop(worker)) {
-      if (worker->Notify()) {
-        --adding_;
-        return true;
+    // Prefer worker of the same shard, then wake up worker of another shard to steal this task.
+    for (size_t i = 0; i != num_shards; ++i) {
+      auto& waiting_workers = share_.shards[(shard_idx + i) % num_shards].waiting_workers;
+      Worker* worker = nullptr;
+      while (waiting_workers.pop(worker)) {
+        if (worker->Notify()) {
+          --adding_;
+          return true;
+        }
       }
     }
     --adding_;
 
-    // We increment created_workers_ every time, the first max_worker increments would produce
-    // a new worker. And after that, we will just increment it doing nothing after that.
+    // We increment created_workers every time, the first max_workers_in_shard increments would
+    // produce a new worker. And after that, we will just increment it doing nothing after that.
     // So we could be lock free here.
-    auto index = created_workers_++;
-    if (index < share_.options.max_workers) {
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (!closing_) {
-        auto new_worker = std::make_unique<Worker>(&share_);
-        auto status = new_worker->Start(workers_.size());
-        if (status.ok()) {
-          workers_.push_back(std::move(new_worker));
-        } else if (workers_.empty()) {
-          LOG(FATAL) << "Unable to start first worker: " << status;
-        } else {
-          LOG(WARNING) << "Unable to start worker: " << status;
-        }
+    // When all workers of this shard were already created, the new worker is created in another
+    // shard, it will steal the task.
+    for (size_t i = 0; i != num_shards; ++i) {
+      auto worker_shard_idx = (shard_idx + i) % num_shards;
+      auto& worker_shard = share_.shards[worker_shard_idx];
+      auto index = worker_shard.created_workers++;
+      if (index < share_.max_workers_in_shard(worker_shard_idx)) {
+        StartWorker(worker_shard_idx, index);
+        break;
       }
-    } else {
-      --created_workers_;
+      --worker_shard.created_workers;
     }
     return true;
   }
 
   void Shutdown() {
     // Block creating new workers.
-    created_workers_ += share_.options.max_workers;
+    for (size_t i = 0; i != share_.num_shards(); ++i) {
+      share_.shards[i].created_workers += share_.max_workers_in_shard(i);
+    }
     {
       std::lock_guard<std::mutex> lock(mutex_);
       if (closing_) {
-        CHECK(share_.task_queue.empty());
+        for (size_t i = 0; i != share_.num_shards(); ++i) {
+          CHECK(share_.shards[i].task_queue.empty());
+        }
         CHECK(workers_.empty());
         return;
       }
@@ -240,9 +418,27 @@ class ThreadPool::Impl {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
     workers_.clear();
-    ThreadPoolTask* task = nullptr;
-    while (share_.task_queue.pop(task)) {
-      task->Done(shutdown_status_);
+    for (size_t i = 0; i != share_.num_shards(); ++i) {
+      ThreadPoolTask* task = nullptr;
+      while (share_.shards[i].task_queue.pop(task)) {
+        task->Done(shutdown_status_);
+      }
+    }
+  }
+
+  void StartWorker(size_t shard, size_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_) {
+      return;
+    }
+    auto new_worker = std::make_unique<Worker>(&share_, shard);
+    auto status = new_worker->Start(index);
+    if (status.ok()) {
+      workers_.push_back(std::move(new_worker));
+    } else if (workers_.empty()) {
+      LOG(FATAL) << "Unable to start first worker: " << status;
+    } else {
+      LOG(WARNING) << "Unable to start worker: " << status;
     }
   }
 
@@ -253,7 +449,6 @@ class ThreadPool::Impl {
  private:
   ThreadPoolShare share_;
   std::vector<std::unique_ptr<Worker>> workers_;
-  std::atomic<size_t> created_workers_ = {0};
   std::mutex mutex_;
   std::atomic<bool> closing_ = {false};
   std::atomic<size_t> adding_ = {0};
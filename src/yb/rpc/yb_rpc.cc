@@ -319,12 +319,30 @@ size_t YBInboundCall::AddRpcSidecar(Slice car) {
   return num_sidecars_++;
 }
 
+size_t YBInboundCall::AddRpcSidecar(RefCntBuffer car) {
+  sidecar_offsets_.Add(narrow_cast<uint32_t>(total_sidecars_size_));
+  total_sidecars_size_ += car.size();
+
+  // The buffer is sent as is, so unused space at the end of the last buffer should be cut off.
+  // Since the added buffer is full, following sidecars will be copied to a new buffer.
+  if (!sidecar_buffers_.empty()) {
+    sidecar_buffers_.back().Shrink(filled_bytes_in_last_sidecar_buffer_);
+  }
+  filled_bytes_in_last_sidecar_buffer_ = car.size();
+  if (consumption_) {
+    consumption_.Add(car.size());
+  }
+  sidecar_buffers_consumption_ += car.size();
+  sidecar_buffers_.push_back(std::move(car));
+
+  return num_sidecars_++;
+}
+
 void YBInboundCall::ResetRpcSidecars() {
   if (consumption_) {
-    for (const auto& buffer : sidecar_buffers_) {
-      consumption_.Add(-buffer.size());
-    }
+    consumption_.Add(-sidecar_buffers_consumption_);
   }
+  sidecar_buffers_consumption_ = 0;
   num_sidecars_ = 0;
   filled_bytes_in_last_sidecar_buffer_ = 0;
   total_sidecars_size_ = 0;
@@ -346,6 +364,7 @@ void YBInboundCall::AllocateSidecarBuffer(size_t size) {
   if (consumption_) {
     consumption_.Add(size);
   }
+  sidecar_buffers_consumption_ += size;
 }
 
 Status YBInboundCall::SerializeResponseBuffer(AnyMessageConstPtr response, bool is_success) {
@@ -139,6 +139,7 @@ class YBInboundCall : public InboundCall {
 
   // See RpcContext::AddRpcSidecar()
   virtual size_t AddRpcSidecar(Slice car);
+  virtual size_t AddRpcSidecar(RefCntBuffer car);
 
   // See RpcContext::ResetRpcSidecars()
   void ResetRpcSidecars();
@@ -198,6 +199,8 @@ class YBInboundCall : public InboundCall {
   size_t num_sidecars_ = 0;
   size_t filled_bytes_in_last_sidecar_buffer_ = 0;
   size_t total_sidecars_size_ = 0;
+  // Memory consumed by sidecar buffers, that is released by ResetRpcSidecars.
+  size_t sidecar_buffers_consumption_ = 0;
   boost::container::small_vector<RefCntBuffer, kMinBufferForSidecarSlices> sidecar_buffers_;
   google::protobuf::RepeatedField<uint32_t> sidecar_offsets_;
 
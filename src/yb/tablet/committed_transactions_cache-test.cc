@@ -0,0 +1,103 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "yb/common/transaction.h"
+
+#include "yb/tablet/committed_transactions_cache.h"
+
+#include "yb/util/metrics.h"
+#include "yb/util/test_util.h"
+
+METRIC_DECLARE_counter(committed_transactions_cache_hits);
+METRIC_DECLARE_counter(committed_transactions_cache_misses);
+
+namespace yb {
+namespace tablet {
+
+class CommittedTransactionsCacheTest : public YBTest {
+ protected:
+  void SetUp() override {
+    YBTest::SetUp();
+    entity_ = METRIC_ENTITY_server.Instantiate(&registry_, "committed_transactions_cache-test");
+  }
+
+  int64_t Hits() {
+    return METRIC_committed_transactions_cache_hits.Instantiate(entity_)->value();
+  }
+
+  int64_t Misses() {
+    return METRIC_committed_transactions_cache_misses.Instantiate(entity_)->value();
+  }
+
+  MetricRegistry registry_;
+  scoped_refptr<MetricEntity> entity_;
+};
+
+TEST_F(CommittedTransactionsCacheTest, Lookup) {
+  CommittedTransactionsCache cache(100, entity_);
+  auto id = TransactionId::GenerateRandom();
+  const HybridTime commit_ht(1000);
+
+  ASSERT_FALSE(cache.Lookup(id, commit_ht));
+  ASSERT_EQ(0, Hits());
+  ASSERT_EQ(1, Misses());
+
+  cache.Committed(id, commit_ht, AbortedSubTransactionSet());
+
+  auto result = cache.Lookup(id, commit_ht);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(TransactionStatus::COMMITTED, result->status);
+  ASSERT_EQ(commit_ht, result->status_time);
+
+  // Transaction is not committed yet at time before commit time.
+  result = cache.Lookup(id, HybridTime(commit_ht.ToUint64() - 1));
+  ASSERT_TRUE(result);
+  ASSERT_EQ(TransactionStatus::PENDING, result->status);
+  ASSERT_EQ(commit_ht, result->status_time);
+
+  ASSERT_FALSE(cache.Lookup(TransactionId::GenerateRandom(), commit_ht));
+  ASSERT_EQ(2, Hits());
+  ASSERT_EQ(2, Misses());
+}
+
+TEST_F(CommittedTransactionsCacheTest, Eviction) {
+  constexpr size_t kCapacity = 160;
+  constexpr size_t kNumTransactions = kCapacity * 10;
+
+  CommittedTransactionsCache cache(kCapacity, entity_);
+  std::vector<TransactionId> ids;
+  for (size_t i = 0; i != kNumTransactions; ++i) {
+    ids.push_back(TransactionId::GenerateRandom());
+    cache.Committed(ids.back(), HybridTime(i + 1), AbortedSubTransactionSet());
+    ASSERT_LE(cache.TEST_size(), kCapacity);
+  }
+
+  // The most recently committed transaction is always present.
+  auto result = cache.Lookup(ids.back(), HybridTime::kMax);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(HybridTime(kNumTransactions), result->status_time);
+
+  // Most of the old transactions should be evicted.
+  size_t found = 0;
+  for (size_t i = 0; i != kCapacity; ++i) {
+    found += cache.Lookup(ids[i], HybridTime::kMax) ? 1 : 0;
+  }
+  ASSERT_LT(found, kCapacity / 2);
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,155 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/tablet/committed_transactions_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "yb/gutil/port.h"
+#include "yb/gutil/thread_annotations.h"
+
+#include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+
+METRIC_DEFINE_counter(server, committed_transactions_cache_hits,
+                      "Committed Transactions Cache Hits",
+                      yb::MetricUnit::kRequests,
+                      "Number of transaction status requests served from the tablet server wide "
+                      "cache of committed transactions.");
+
+METRIC_DEFINE_counter(server, committed_transactions_cache_misses,
+                      "Committed Transactions Cache Misses",
+                      yb::MetricUnit::kRequests,
+                      "Number of transaction status requests that were not found in the tablet "
+                      "server wide cache of committed transactions.");
+
+namespace yb {
+namespace tablet {
+
+namespace {
+
+constexpr size_t kNumShards = 16;
+
+struct CommitData {
+  HybridTime commit_ht;
+  AbortedSubTransactionSet aborted_subtxn_set;
+};
+
+} // namespace
+
+class CommittedTransactionsCache::Impl {
+ public:
+  Impl(size_t capacity, const scoped_refptr<MetricEntity>& metric_entity)
+      : shard_capacity_(std::max<size_t>(capacity / kNumShards, 1)) {
+    if (metric_entity) {
+      hits_ = METRIC_committed_transactions_cache_hits.Instantiate(metric_entity);
+      misses_ = METRIC_committed_transactions_cache_misses.Instantiate(metric_entity);
+    }
+  }
+
+  void Committed(const TransactionId& id, HybridTime commit_ht,
+                 const AbortedSubTransactionSet& aborted_subtxn_set) {
+    auto& shard = ShardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto emplaced = shard.map.emplace(id, CommitData {
+      .commit_ht = commit_ht,
+      .aborted_subtxn_set = aborted_subtxn_set,
+    });
+    if (!emplaced.second) {
+      LOG_IF(DFATAL, emplaced.first->second.commit_ht != commit_ht)
+          << "Transaction " << id << " committed at " << commit_ht
+          << ", while cached commit time is " << emplaced.first->second.commit_ht;
+      return;
+    }
+    shard.order.push_back(id);
+    while (shard.order.size() > shard_capacity_) {
+      shard.map.erase(shard.order.front());
+      shard.order.pop_front();
+    }
+  }
+
+  boost::optional<TransactionStatusResult> Lookup(const TransactionId& id, HybridTime time) {
+    auto& shard = ShardFor(id);
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.map.find(id);
+      if (it != shard.map.end()) {
+        IncrementCounter(hits_);
+        // Same logic as in RunningTransaction::GetStatusAt for known COMMITTED status.
+        const auto& data = it->second;
+        return TransactionStatusResult(
+            data.commit_ht > time ? TransactionStatus::PENDING : TransactionStatus::COMMITTED,
+            data.commit_ht, data.aborted_subtxn_set);
+      }
+    }
+    IncrementCounter(misses_);
+    return boost::none;
+  }
+
+  size_t TEST_size() const {
+    size_t result = 0;
+    for (const auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      result += shard.map.size();
+    }
+    return result;
+  }
+
+ private:
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<TransactionId, CommitData, TransactionIdHash> map GUARDED_BY(mutex);
+    // Transaction ids in order of insertion, used to evict the oldest entries.
+    std::deque<TransactionId> order GUARDED_BY(mutex);
+  } CACHELINE_ALIGNED;
+
+  Shard& ShardFor(const TransactionId& id) {
+    return shards_[TransactionIdHash()(id) % kNumShards];
+  }
+
+  const size_t shard_capacity_;
+  std::array<Shard, kNumShards> shards_;
+
+  scoped_refptr<Counter> hits_;
+  scoped_refptr<Counter> misses_;
+};
+
+CommittedTransactionsCache::CommittedTransactionsCache(
+    size_t capacity, const scoped_refptr<MetricEntity>& metric_entity)
+    : impl_(new Impl(capacity, metric_entity)) {
+}
+
+CommittedTransactionsCache::~CommittedTransactionsCache() {
+}
+
+void CommittedTransactionsCache::Committed(
+    const TransactionId& id, HybridTime commit_ht,
+    const AbortedSubTransactionSet& aborted_subtxn_set) {
+  impl_->Committed(id, commit_ht, aborted_subtxn_set);
+}
+
+boost::optional<TransactionStatusResult> CommittedTransactionsCache::Lookup(
+    const TransactionId& id, HybridTime time) {
+  return impl_->Lookup(id, time);
+}
+
+size_t CommittedTransactionsCache::TEST_size() const {
+  return impl_->TEST_size();
+}
+
+} // namespace tablet
+} // namespace yb
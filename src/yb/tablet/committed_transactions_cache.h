@@ -0,0 +1,61 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_TABLET_COMMITTED_TRANSACTIONS_CACHE_H
+#define YB_TABLET_COMMITTED_TRANSACTIONS_CACHE_H
+
+#include <memory>
+
+#include <boost/optional/optional.hpp>
+
+#include "yb/common/transaction.h"
+
+#include "yb/util/metrics_fwd.h"
+
+namespace yb {
+namespace tablet {
+
+// Caches commit data of recently committed transactions. Single instance is shared by all tablets
+// of the tablet server, so when a transaction that wrote to many tablets of this server commits,
+// its status is requested from the transaction coordinator once instead of once per tablet.
+//
+// Only committed transactions are cached. Commit is final and commit time is the same for all
+// participants, while ABORTED response from coordinator could also mean that transaction was
+// already committed, applied and forgotten by the coordinator.
+//
+// Memory usage is bounded by the capacity, the oldest entries are evicted first.
+class CommittedTransactionsCache {
+ public:
+  CommittedTransactionsCache(size_t capacity, const scoped_refptr<MetricEntity>& metric_entity);
+  ~CommittedTransactionsCache();
+
+  // Remembers that transaction was committed at commit_ht.
+  void Committed(const TransactionId& id, HybridTime commit_ht,
+                 const AbortedSubTransactionSet& aborted_subtxn_set);
+
+  // Returns status of the transaction at specified time if it is known to be committed.
+  // I.e. COMMITTED if it was committed not later than time, PENDING otherwise.
+  // Returns boost::none if transaction is not present in the cache.
+  boost::optional<TransactionStatusResult> Lookup(const TransactionId& id, HybridTime time);
+
+  size_t TEST_size() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace tablet
+} // namespace yb
+
+#endif // YB_TABLET_COMMITTED_TRANSACTIONS_CACHE_H
@@ -42,6 +42,7 @@
 
 #include "yb/util/atomic.h"
 #include "yb/util/enums.h"
+#include "yb/util/format.h"
 #include "yb/util/random_util.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status.h"
@@ -367,5 +368,52 @@ TEST_F(MvccTest, WaitForSafeTime) {
   ASSERT_FALSE(manager_.SafeTime(ht3, CoarseMonoClock::now() + 100ms, FixedHybridTimeLease()));
 }
 
+// Measures safe time requests throughput for various number of reader threads, while a single
+// writer thread keeps adding and replicating operations, as it happens on a loaded leader.
+TEST_F(MvccTest, BenchmarkSafeTime) {
+  const auto kDuration = 1s;
+
+  int64_t op_index = 0;
+  for (int num_readers : {1, 2, 4, 8, 16, 32}) {
+    std::atomic<bool> stop_requested{false};
+    std::atomic<size_t> total_reads{0};
+    size_t writes = 0;
+    std::vector<std::thread> threads;
+    threads.emplace_back([this, &stop_requested, &writes, &op_index] {
+      while (!stop_requested.load(std::memory_order_acquire)) {
+        OpId op_id(1, ++op_index);
+        auto ht = manager_.AddLeaderPending(op_id);
+        manager_.Replicated(ht, op_id);
+        ++writes;
+      }
+    });
+    for (int i = 0; i != num_readers; ++i) {
+      threads.emplace_back([this, &stop_requested, &total_reads] {
+        size_t reads = 0;
+        HybridTime prev_safe_time = HybridTime::kMin;
+        while (!stop_requested.load(std::memory_order_acquire)) {
+          auto safe_time = manager_.SafeTime(FixedHybridTimeLease());
+          CHECK_GE(safe_time, prev_safe_time);
+          prev_safe_time = safe_time;
+          ++reads;
+        }
+        total_reads.fetch_add(reads, std::memory_order_acq_rel);
+      });
+    }
+
+    std::this_thread::sleep_for(kDuration);
+    stop_requested.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    auto reads = total_reads.load(std::memory_order_acquire);
+    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(kDuration).count();
+    LOG(INFO) << Format(
+        "Readers: $0, safe time reads/sec: $1, writes/sec: $2",
+        num_readers, reads * 1000 / duration_ms, writes * 1000 / duration_ms);
+  }
+}
+
 } // namespace tablet
 } // namespace yb
@@ -59,6 +59,10 @@ namespace tablet {
 
 namespace {
 
+// Number of attempts to calculate safe time without taking the mutex, before falling back to the
+// locking path. An attempt fails only when the state is concurrently modified.
+constexpr int kLockFreeSafeTimeAttempts = 3;
+
 struct SetLeaderOnlyModeTraceItem {
   bool leader_only;
 
@@ -201,10 +205,12 @@ class MvccManager::MvccOpTrace {
   ~MvccOpTrace() = default;
 
   void Add(TraceItemVariant v) {
+    std::lock_guard<std::mutex> lock(mutex_);
     items_.push_back(std::move(v));
   }
 
   void DumpTrace(ostream* out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (items_.empty()) {
       *out << "No MVCC operations" << std::endl;
       return;
@@ -218,6 +224,9 @@ class MvccManager::MvccOpTrace {
   }
 
  private:
+  // Trace has its own mutex, so safe time requests served without MvccManager::mutex_ are traced
+  // as well.
+  mutable std::mutex mutex_;
   boost::circular_buffer_space_optimized<TraceItemVariant, std::allocator<TraceItemVariant>> items_;
 };
 
@@ -242,6 +251,31 @@ std::string SafeTimeWithSource::ToString() const {
   return Format("{ safe_time: $0 source: $1 }", safe_time, source);
 }
 
+// ------------------------------------------------------------------------------------------------
+// AtomicSafeTimeWithSource
+// ------------------------------------------------------------------------------------------------
+
+SafeTimeWithSource AtomicSafeTimeWithSource::Load() const {
+  return SafeTimeWithSource {
+    .safe_time = safe_time_.load(std::memory_order_acquire),
+    .source = source_.load(std::memory_order_relaxed),
+  };
+}
+
+void AtomicSafeTimeWithSource::UpdateMax(const SafeTimeWithSource& value) {
+  auto current = safe_time_.load(std::memory_order_acquire);
+  while (current < value.safe_time) {
+    if (safe_time_.compare_exchange_weak(current, value.safe_time, std::memory_order_acq_rel)) {
+      source_.store(value.source, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+std::string AtomicSafeTimeWithSource::ToString() const {
+  return Load().ToString();
+}
+
 // ------------------------------------------------------------------------------------------------
 // MvccManager
 // ------------------------------------------------------------------------------------------------
@@ -270,8 +304,10 @@ void MvccManager::Replicated(HybridTime ht, const OpId& op_id) {
     CHECK(!queue_.empty()) << InvariantViolationLogPrefix();
     CHECK_EQ(queue_.front(),
              (QueueItem{ .hybrid_time = ht, .op_id = op_id })) << InvariantViolationLogPrefix();
+    BeginStateUpdate();
     queue_.pop_front();
     last_replicated_ = ht;
+    EndStateUpdate();
   }
   cond_.notify_all();
 }
@@ -288,7 +324,9 @@ void MvccManager::Aborted(HybridTime ht, const OpId& op_id) {
     CHECK_EQ(queue_.back(),
              (QueueItem{ .hybrid_time = ht, .op_id = op_id }))
         << InvariantViolationLogPrefix() << "It is allowed to abort only last operation";
+    BeginStateUpdate();
     queue_.pop_back();
+    EndStateUpdate();
   }
   cond_.notify_all();
 }
@@ -305,10 +343,14 @@ bool BadNextOpId(const OpId& prev, const OpId& next) {
 
 HybridTime MvccManager::AddLeaderPending(const OpId& op_id) {
   std::lock_guard<std::mutex> lock(mutex_);
+  // The state update should be started before reading the clock, so a lock-free reader that
+  // calculated safe time from the clock either picks a time below ht, or observes this update.
+  BeginStateUpdate();
   auto ht = clock_->Now();
   AtomicFlagSleepMs(&FLAGS_TEST_inject_mvcc_delay_add_leader_pending_ms);
   VLOG_WITH_PREFIX(1) << __func__ << "(" << op_id << "), time: " << ht;
   AddPending(ht, op_id, /* is_follower_side= */ false);
+  EndStateUpdate();
 
   if (op_trace_) {
     op_trace_->Add(AddLeaderPendingTraceItem {
@@ -324,7 +366,9 @@ void MvccManager::AddFollowerPending(HybridTime ht, const OpId& op_id) {
   std::lock_guard<std::mutex> lock(mutex_);
   VLOG_WITH_PREFIX(1) << __func__ << "(" << ht << ", " << op_id << ")";
 
+  BeginStateUpdate();
   AddPending(ht, op_id, /* is_follower_side= */ true);
+  EndStateUpdate();
 
   if (op_trace_) {
     op_trace_->Add(AddFollowerPendingTraceItem {
@@ -341,9 +385,9 @@ void MvccManager::AddPending(HybridTime ht, const OpId& op_id, bool is_follower_
 
   HybridTime sanity_check_lower_bound =
       std::max({
-          max_safe_time_returned_with_lease_.safe_time,
-          max_safe_time_returned_without_lease_.safe_time,
-          max_safe_time_returned_for_follower_.safe_time,
+          max_safe_time_returned_with_lease_.safe_time(),
+          max_safe_time_returned_without_lease_.safe_time(),
+          max_safe_time_returned_for_follower_.safe_time(),
           propagated_safe_time_,
           last_replicated_,
           last_ht_in_queue});
@@ -359,7 +403,8 @@ void MvccManager::AddPending(HybridTime ht, const OpId& op_id, bool is_follower_
           << "\n  " << EXPR_VALUE_FOR_LOG(ht.PhysicalDiff(safe_time)) \
           << "\n  "
 
-#define LOG_INFO_FOR_HT_LOWER_BOUND_WITH_SOURCE(t) LOG_INFO_FOR_HT_LOWER_BOUND_IMPL(t, t.safe_time)
+#define LOG_INFO_FOR_HT_LOWER_BOUND_WITH_SOURCE(t) \
+    LOG_INFO_FOR_HT_LOWER_BOUND_IMPL(t, t.safe_time())
 #define LOG_INFO_FOR_HT_LOWER_BOUND(t) LOG_INFO_FOR_HT_LOWER_BOUND_IMPL(t, t)
 
       ss << "New operation's hybrid time too low: " << ht << ", op id: " << op_id
@@ -414,7 +459,9 @@ void MvccManager::SetLastReplicated(HybridTime ht) {
     if (op_trace_) {
       op_trace_->Add(SetLastReplicatedTraceItem { .ht = ht });
     }
+    BeginStateUpdate();
     last_replicated_ = ht;
+    EndStateUpdate();
   }
   cond_.notify_all();
 }
@@ -428,7 +475,9 @@ void MvccManager::SetPropagatedSafeTimeOnFollower(HybridTime ht) {
       op_trace_->Add(SetPropagatedSafeTimeOnFollowerTraceItem { .ht = ht });
     }
     if (ht >= propagated_safe_time_) {
+      BeginStateUpdate();
       propagated_safe_time_ = ht;
+      EndStateUpdate();
     } else {
       LOG_WITH_PREFIX(WARNING)
           << "Received propagated safe time " << ht << " less than the old value: "
@@ -456,7 +505,9 @@ void MvccManager::UpdatePropagatedSafeTimeOnLeader(const FixedHybridTimeLease& h
     CHECK_GE(safe_time, propagated_safe_time_)
         << InvariantViolationLogPrefix()
         << "ht_lease: " << ht_lease;
+    BeginStateUpdate();
     propagated_safe_time_ = safe_time;
+    EndStateUpdate();
 #else
     // Do not crash in production.
     if (safe_time < propagated_safe_time_) {
@@ -464,7 +515,9 @@ void MvccManager::UpdatePropagatedSafeTimeOnLeader(const FixedHybridTimeLease& h
           << "Previously saw " << EXPR_VALUE_FOR_LOG(propagated_safe_time_)
           << ", but now safe time is " << safe_time;
     } else {
+      BeginStateUpdate();
       propagated_safe_time_ = safe_time;
+      EndStateUpdate();
     }
 #endif
 
@@ -485,12 +538,179 @@ void MvccManager::SetLeaderOnlyMode(bool leader_only) {
       .leader_only = leader_only
     });
   }
+  BeginStateUpdate();
   leader_only_mode_ = leader_only;
+  EndStateUpdate();
+}
+
+MvccManager::SafeTimeState MvccManager::LockedState() const {
+  return SafeTimeState {
+    .queue_front = queue_.empty() ? HybridTime::kInvalid : queue_.front().hybrid_time,
+    .last_replicated = last_replicated_,
+    .propagated_safe_time = propagated_safe_time_,
+    .leader_only_mode = leader_only_mode_,
+  };
+}
+
+MvccManager::SafeTimeState MvccManager::PublishedState() const {
+  return SafeTimeState {
+    .queue_front = published_queue_front_.load(std::memory_order_relaxed),
+    .last_replicated = published_last_replicated_.load(std::memory_order_relaxed),
+    .propagated_safe_time = published_propagated_safe_time_.load(std::memory_order_relaxed),
+    .leader_only_mode = published_leader_only_mode_.load(std::memory_order_relaxed),
+  };
+}
+
+void MvccManager::BeginStateUpdate() {
+  state_version_.fetch_add(1, std::memory_order_acq_rel);
+  // Pairs with the fence in ComputeWithPublishedState, so the following stores and the clock read
+  // in AddLeaderPending could not be reordered before the version increment.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void MvccManager::EndStateUpdate() {
+  auto state = LockedState();
+  published_queue_front_.store(state.queue_front, std::memory_order_relaxed);
+  published_last_replicated_.store(state.last_replicated, std::memory_order_relaxed);
+  published_propagated_safe_time_.store(state.propagated_safe_time, std::memory_order_relaxed);
+  published_leader_only_mode_.store(state.leader_only_mode, std::memory_order_relaxed);
+  state_version_.fetch_add(1, std::memory_order_release);
+}
+
+template <class Compute>
+bool MvccManager::ComputeWithPublishedState(
+    const Compute& compute, SafeTimeState* state, SafeTimeWithSource* result) const {
+  for (int attempt = 0; attempt != kLockFreeSafeTimeAttempts; ++attempt) {
+    auto version = state_version_.load(std::memory_order_acquire);
+    if (version & 1) {
+      continue;
+    }
+    *state = PublishedState();
+    *result = compute(*state);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (state_version_.load(std::memory_order_relaxed) == version) {
+      return true;
+    }
+  }
+  return false;
+}
+
+SafeTimeWithSource MvccManager::ComputeSafeTime(
+    const SafeTimeState& state, const FixedHybridTimeLease& ht_lease) const {
+  const bool has_lease = !ht_lease.empty();
+  // Because different calls that have current hybrid time leader lease as an argument can come to
+  // us out of order, we might see an older value of hybrid time leader lease expiration after a
+  // newer value. We mitigate this by always using the highest value we've seen.
+  const auto max_safe_time_returned_with_lease = max_safe_time_returned_with_lease_.safe_time();
+
+  SafeTimeWithSource result;
+  if (!state.queue_front.is_valid()) {
+    result.safe_time = ht_lease.time.is_valid()
+        ? std::max(max_safe_time_returned_with_lease, ht_lease.time)
+        : clock_->Now();
+    result.source = SafeTimeSource::kNow;
+    VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Now: " << result.safe_time;
+  } else {
+    result.safe_time = state.queue_front.Decremented();
+    result.source = SafeTimeSource::kNextInQueue;
+    VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Queue front (decremented): " << result.safe_time;
+  }
+
+  if (has_lease) {
+    auto used_lease = std::max({ht_lease.lease, max_safe_time_returned_with_lease});
+    if (result.safe_time > used_lease) {
+      result.safe_time = used_lease;
+      result.source = SafeTimeSource::kHybridTimeLease;
+    }
+  }
+
+  // This function could be invoked at a follower, so it has a very old ht_lease. In this case it
+  // is safe to read at least at last_replicated_.
+  result.safe_time = std::max(result.safe_time, state.last_replicated);
+  return result;
+}
+
+SafeTimeWithSource MvccManager::ComputeSafeTimeForFollower(const SafeTimeState& state) const {
+  SafeTimeWithSource result;
+  // last_replicated_ is updated earlier than propagated_safe_time_, so because of concurrency it
+  // could be greater than propagated_safe_time_.
+  if (state.propagated_safe_time > state.last_replicated) {
+    if (!state.queue_front.is_valid() || state.propagated_safe_time < state.queue_front) {
+      result.safe_time = state.propagated_safe_time;
+      result.source = SafeTimeSource::kPropagated;
+    } else {
+      result.safe_time = state.queue_front.Decremented();
+      result.source = SafeTimeSource::kNextInQueue;
+    }
+  } else {
+    result.safe_time = state.last_replicated;
+    result.source = SafeTimeSource::kLastReplicated;
+  }
+  return result;
+}
+
+// Safe time calculated from the clock by a concurrent lock-free request could be a bit greater
+// than the one we calculated. It is still safe to read at it while it is below the first pending
+// operation, so the result is raised to it, to keep returned safe time monotonic.
+// Returns false if the maximal returned safe time is not below the first pending operation.
+bool MvccManager::RaiseToMaxReturned(
+    const AtomicSafeTimeWithSource& max_returned, const SafeTimeState& state,
+    SafeTimeWithSource* result) {
+  auto max_returned_value = max_returned.Load();
+  if (result->safe_time >= max_returned_value.safe_time) {
+    return true;
+  }
+  if (state.queue_front.is_valid() && max_returned_value.safe_time >= state.queue_front) {
+    return false;
+  }
+  *result = max_returned_value;
+  return true;
+}
+
+AtomicSafeTimeWithSource& MvccManager::MaxSafeTimeReturned(
+    const FixedHybridTimeLease& ht_lease) const {
+  return ht_lease.empty() ? max_safe_time_returned_without_lease_
+                          : max_safe_time_returned_with_lease_;
+}
+
+SafeTimeWithSource MvccManager::TryGetSafeTimeForFollowerLockFree(HybridTime min_allowed) const {
+  SafeTimeState state;
+  SafeTimeWithSource result;
+  auto compute = [this](const SafeTimeState& published) {
+    // If there are no followers (RF == 1), use SafeTime() because propagated_safe_time_ might not
+    // have a valid value.
+    return published.leader_only_mode ? ComputeSafeTime(published, FixedHybridTimeLease())
+                                      : ComputeSafeTimeForFollower(published);
+  };
+  if (!ComputeWithPublishedState(compute, &state, &result)) {
+    return SafeTimeWithSource();
+  }
+  auto& max_returned = state.leader_only_mode ? max_safe_time_returned_without_lease_
+                                              : max_safe_time_returned_for_follower_;
+  if (!RaiseToMaxReturned(max_returned, state, &result) || result.safe_time < min_allowed) {
+    return SafeTimeWithSource();
+  }
+  max_returned.UpdateMax(result);
+  VTRACE(2, "Returning lock-free safe time $0. Source $1", yb::ToString(result.safe_time),
+         yb::ToString(result.source));
+  return result;
 }
 
 // NO_THREAD_SAFETY_ANALYSIS because this analysis does not work with unique_lock.
 HybridTime MvccManager::SafeTimeForFollower(
     HybridTime min_allowed, CoarseTimePoint deadline) const NO_THREAD_SAFETY_ANALYSIS {
+  auto lock_free_result = TryGetSafeTimeForFollowerLockFree(min_allowed);
+  if (lock_free_result.safe_time.is_valid()) {
+    if (op_trace_) {
+      op_trace_->Add(SafeTimeForFollowerTraceItem {
+        .min_allowed = min_allowed,
+        .deadline = deadline,
+        .safe_time_with_source = lock_free_result
+      });
+    }
+    return lock_free_result.safe_time;
+  }
+
   std::unique_lock<std::mutex> lock(mutex_);
 
   if (leader_only_mode_) {
@@ -499,22 +719,11 @@ HybridTime MvccManager::SafeTimeForFollower(
     return DoGetSafeTime(min_allowed, deadline, FixedHybridTimeLease(), &lock);
   }
 
+  SafeTimeState state;
   SafeTimeWithSource result;
-  auto predicate = [this, &result, min_allowed] {
-    // last_replicated_ is updated earlier than propagated_safe_time_, so because of concurrency it
-    // could be greater than propagated_safe_time_.
-    if (propagated_safe_time_ > last_replicated_) {
-      if (queue_.empty() || propagated_safe_time_ < queue_.front().hybrid_time) {
-        result.safe_time = propagated_safe_time_;
-        result.source = SafeTimeSource::kPropagated;
-      } else {
-        result.safe_time = queue_.front().hybrid_time.Decremented();
-        result.source = SafeTimeSource::kNextInQueue;
-      }
-    } else {
-      result.safe_time = last_replicated_;
-      result.source = SafeTimeSource::kLastReplicated;
-    }
+  auto predicate = [this, &state, &result, min_allowed] {
+    state = LockedState();
+    result = ComputeSafeTimeForFollower(state);
     VTRACE(3, "Current safe time $0. Source $1", yb::ToString(result.safe_time),
            yb::ToString(result.source));
     return result.safe_time >= min_allowed;
@@ -526,15 +735,19 @@ HybridTime MvccManager::SafeTimeForFollower(
   }
   VLOG_WITH_PREFIX(1) << "SafeTimeForFollower(" << min_allowed
                       << "), result = " << result.ToString();
-  CHECK_GE(result.safe_time, max_safe_time_returned_for_follower_.safe_time)
-      << InvariantViolationLogPrefix()
-      << "result: " << result.ToString()
-      << ", max_safe_time_returned_for_follower_: "
-      << max_safe_time_returned_for_follower_.ToString();
+  if (!RaiseToMaxReturned(max_safe_time_returned_for_follower_, state, &result)) {
+    // Safe time that covers a pending operation was returned earlier, keep the calculated one.
+    LOG_WITH_PREFIX(DFATAL)
+        << InvariantViolationLogPrefix()
+        << "result: " << result.ToString()
+        << ", max_safe_time_returned_for_follower_: "
+        << max_safe_time_returned_for_follower_.ToString()
+        << ", queue front: " << state.queue_front;
+  }
   VTRACE(2, "Min requested safe time was $0", yb::ToString(min_allowed));
   VTRACE(2, "Returning safe time $0. Source $1", yb::ToString(result.safe_time),
          yb::ToString(result.source));
-  max_safe_time_returned_for_follower_ = result;
+  max_safe_time_returned_for_follower_.UpdateMax(result);
   if (op_trace_) {
     op_trace_->Add(SafeTimeForFollowerTraceItem {
       .min_allowed = min_allowed,
@@ -545,13 +758,42 @@ HybridTime MvccManager::SafeTimeForFollower(
   return result.safe_time;
 }
 
+HybridTime MvccManager::TryGetSafeTimeLockFree(
+    HybridTime min_allowed, const FixedHybridTimeLease& ht_lease) const {
+  // Requests with bad arguments are checked and reported by the locking path.
+  if (!ht_lease.lease.is_valid() || min_allowed > ht_lease.lease ||
+      (!ht_lease.empty() && !ht_lease.time.is_valid())) {
+    return HybridTime::kInvalid;
+  }
+
+  SafeTimeState state;
+  SafeTimeWithSource result;
+  auto compute = [this, &ht_lease](const SafeTimeState& published) {
+    return ComputeSafeTime(published, ht_lease);
+  };
+  if (!ComputeWithPublishedState(compute, &state, &result)) {
+    return HybridTime::kInvalid;
+  }
+  auto& max_returned = MaxSafeTimeReturned(ht_lease);
+  if (!RaiseToMaxReturned(max_returned, state, &result) || result.safe_time < min_allowed) {
+    return HybridTime::kInvalid;
+  }
+  max_returned.UpdateMax(result);
+  VTRACE(2, "Returning lock-free safe time $0. Source $1", yb::ToString(result.safe_time),
+         yb::ToString(result.source));
+  return result.safe_time;
+}
+
 // NO_THREAD_SAFETY_ANALYSIS because this analysis does not work with unique_lock.
 HybridTime MvccManager::SafeTime(
     HybridTime min_allowed,
     CoarseTimePoint deadline,
     const FixedHybridTimeLease& ht_lease) const NO_THREAD_SAFETY_ANALYSIS {
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto safe_time = DoGetSafeTime(min_allowed, deadline, ht_lease, &lock);
+  auto safe_time = TryGetSafeTimeLockFree(min_allowed, ht_lease);
+  if (!safe_time.is_valid()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    safe_time = DoGetSafeTime(min_allowed, deadline, ht_lease, &lock);
+  }
   if (op_trace_) {
     op_trace_->Add(SafeTimeTraceItem {
       .min_allowed = min_allowed,
@@ -572,43 +814,19 @@ HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
   CHECK_LE(min_allowed, ht_lease.lease) << InvariantViolationLogPrefix();
 
   const bool has_lease = !ht_lease.empty();
-  // Because different calls that have current hybrid time leader lease as an argument can come to
-  // us out of order, we might see an older value of hybrid time leader lease expiration after a
-  // newer value. We mitigate this by always using the highest value we've seen.
   if (has_lease) {
     LOG_IF_WITH_PREFIX(DFATAL, !ht_lease.time.is_valid()) << "Bad ht lease: " << ht_lease;
   }
 
-  HybridTime result;
-  SafeTimeSource source = SafeTimeSource::kUnknown;
-  auto predicate = [this, &result, &source, min_allowed, ht_lease, has_lease] {
-    if (queue_.empty()) {
-      result = ht_lease.time.is_valid()
-          ? std::max(max_safe_time_returned_with_lease_.safe_time, ht_lease.time)
-          : clock_->Now();
-      source = SafeTimeSource::kNow;
-      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Now: " << result;
-    } else {
-      result = queue_.front().hybrid_time.Decremented();
-      source = SafeTimeSource::kNextInQueue;
-      VLOG_WITH_PREFIX(2) << "DoGetSafeTime, Queue front (decremented): " << result;
-    }
-
-    if (has_lease) {
-      auto used_lease = std::max({ht_lease.lease, max_safe_time_returned_with_lease_.safe_time});
-      if (result > used_lease) {
-        result = used_lease;
-        source = SafeTimeSource::kHybridTimeLease;
-      }
-    }
-
-    // This function could be invoked at a follower, so it has a very old ht_lease. In this case it
-    // is safe to read at least at last_replicated_.
-    result = std::max(result, last_replicated_);
-    VTRACE(3, "Current safe time $0. Source $1", yb::ToString(result),
-           yb::ToString(source));
+  SafeTimeState state;
+  SafeTimeWithSource result;
+  auto predicate = [this, &state, &result, min_allowed, &ht_lease] {
+    state = LockedState();
+    result = ComputeSafeTime(state, ht_lease);
+    VTRACE(3, "Current safe time $0. Source $1", yb::ToString(result.safe_time),
+           yb::ToString(result.source));
 
-    return result >= min_allowed;
+    return result.safe_time >= min_allowed;
   };
 
   // In the case of an empty queue, the safe hybrid time to read at is only limited by hybrid time
@@ -619,40 +837,38 @@ HybridTime MvccManager::DoGetSafeTime(const HybridTime min_allowed,
     return HybridTime::kInvalid;
   }
   VLOG_WITH_PREFIX_AND_FUNC(1)
-      << "(" << min_allowed << ", " << ht_lease << "),  result = " << result;
-
-  auto enforced_min_time = has_lease ? max_safe_time_returned_with_lease_.safe_time
-                                     : max_safe_time_returned_without_lease_.safe_time;
-  CHECK_GE(result, enforced_min_time)
-      << InvariantViolationLogPrefix()
-      << ": " << EXPR_VALUE_FOR_LOG(has_lease)
-      << ", " << EXPR_VALUE_FOR_LOG(enforced_min_time.ToUint64() - result.ToUint64())
-      << ", " << EXPR_VALUE_FOR_LOG(ht_lease)
-      << ", " << EXPR_VALUE_FOR_LOG(last_replicated_)
-      << ", " << EXPR_VALUE_FOR_LOG(clock_->Now())
-      << ", " << EXPR_VALUE_FOR_LOG(ToString(deadline))
-      << ", " << EXPR_VALUE_FOR_LOG(queue_.size())
-      << ", " << EXPR_VALUE_FOR_LOG(queue_);
+      << "(" << min_allowed << ", " << ht_lease << "),  result = " << result.safe_time;
 
-  if (has_lease) {
-    max_safe_time_returned_with_lease_ = { result, source };
-  } else {
-    max_safe_time_returned_without_lease_ = { result, source };
-  }
+  auto& max_returned = MaxSafeTimeReturned(ht_lease);
+  if (!RaiseToMaxReturned(max_returned, state, &result)) {
+    // Safe time that covers a pending operation was returned earlier, keep the calculated one.
+    LOG_WITH_PREFIX(DFATAL)
+        << InvariantViolationLogPrefix()
+        << ": " << EXPR_VALUE_FOR_LOG(result)
+        << ", " << EXPR_VALUE_FOR_LOG(max_returned)
+        << ", " << EXPR_VALUE_FOR_LOG(has_lease)
+        << ", " << EXPR_VALUE_FOR_LOG(ht_lease)
+        << ", " << EXPR_VALUE_FOR_LOG(last_replicated_)
+        << ", " << EXPR_VALUE_FOR_LOG(clock_->Now())
+        << ", " << EXPR_VALUE_FOR_LOG(ToString(deadline))
+        << ", " << EXPR_VALUE_FOR_LOG(queue_.size())
+        << ", " << EXPR_VALUE_FOR_LOG(queue_);
+  }
+  max_returned.UpdateMax(result);
   VTRACE(2, "Returning safe time $0. Source $1. Min requested safe time was $2",
-         yb::ToString(result), yb::ToString(source), yb::ToString(min_allowed));
-  return result;
+         yb::ToString(result.safe_time), yb::ToString(result.source), yb::ToString(min_allowed));
+  return result.safe_time;
 }
 
 HybridTime MvccManager::LastReplicatedHybridTime() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  VLOG_WITH_PREFIX(1) << __func__ << "(), result = " << last_replicated_;
+  auto result = published_last_replicated_.load(std::memory_order_acquire);
+  VLOG_WITH_PREFIX(1) << __func__ << "(), result = " << result;
   if (op_trace_) {
     op_trace_->Add(LastReplicatedHybridTimeTraceItem {
-      .last_replicated = last_replicated_
+      .last_replicated = result
     });
   }
-  return last_replicated_;
+  return result;
 }
 
 // Using NO_THREAD_SAFETY_ANALYSIS here because we're only reading op_trace_ here and it is set
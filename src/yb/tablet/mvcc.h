@@ -32,6 +32,7 @@
 #ifndef YB_TABLET_MVCC_H_
 #define YB_TABLET_MVCC_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <vector>
@@ -59,6 +60,25 @@ struct SafeTimeWithSource {
   std::string ToString() const;
 };
 
+// SafeTimeWithSource that could be updated concurrently, keeps the maximal safe time it was
+// updated with. Source is only used for logging, so it is updated on a best-effort basis.
+class AtomicSafeTimeWithSource {
+ public:
+  HybridTime safe_time() const {
+    return safe_time_.load(std::memory_order_acquire);
+  }
+
+  SafeTimeWithSource Load() const;
+
+  void UpdateMax(const SafeTimeWithSource& value);
+
+  std::string ToString() const;
+
+ private:
+  std::atomic<HybridTime> safe_time_{HybridTime::kMin};
+  std::atomic<SafeTimeSource> source_{SafeTimeSource::kUnknown};
+};
+
 struct FixedHybridTimeLease {
   HybridTime time;
   HybridTime lease = HybridTime::kMax;
@@ -80,6 +100,11 @@ inline std::ostream& operator<<(std::ostream& out, const FixedHybridTimeLease& h
 // methods.
 // Operations could be replicated only in the same order as they were added.
 // Time of newly added operation should be after time of all previously added operations.
+//
+// Operations are added and removed under the mutex, while safe time is usually calculated without
+// taking it. To do so the state used by safe time calculation is published to atomics, guarded by
+// a version counter that is odd while an update is in progress (seqlock). Readers retry or fall
+// back to the mutex when the version changes under them, and when they have to wait.
 class MvccManager {
  public:
   // `prefix` is used for logging.
@@ -152,11 +177,52 @@ class MvccManager {
   void TEST_DumpTrace(std::ostream* out);
 
  private:
+  // State used to calculate safe time.
+  struct SafeTimeState {
+    // Hybrid time of the first operation in queue, invalid if queue is empty.
+    HybridTime queue_front;
+    HybridTime last_replicated;
+    HybridTime propagated_safe_time;
+    bool leader_only_mode;
+  };
+
   HybridTime DoGetSafeTime(HybridTime min_allowed,
                            CoarseTimePoint deadline,
                            const FixedHybridTimeLease& ht_lease,
                            std::unique_lock<std::mutex>* lock) const REQUIRES(mutex_);
 
+  // Tries to calculate safe time using published state, without taking the mutex.
+  // Returns invalid hybrid time when state was concurrently modified, safe time is less than
+  // min_allowed, or it could not be kept monotonic, so caller should fall back to the locking path.
+  HybridTime TryGetSafeTimeLockFree(HybridTime min_allowed,
+                                    const FixedHybridTimeLease& ht_lease) const;
+  SafeTimeWithSource TryGetSafeTimeForFollowerLockFree(HybridTime min_allowed) const;
+
+  SafeTimeWithSource ComputeSafeTime(
+      const SafeTimeState& state, const FixedHybridTimeLease& ht_lease) const;
+  SafeTimeWithSource ComputeSafeTimeForFollower(const SafeTimeState& state) const;
+
+  static bool RaiseToMaxReturned(
+      const AtomicSafeTimeWithSource& max_returned, const SafeTimeState& state,
+      SafeTimeWithSource* result);
+
+  AtomicSafeTimeWithSource& MaxSafeTimeReturned(const FixedHybridTimeLease& ht_lease) const;
+
+  // Should be called while holding mutex_.
+  SafeTimeState LockedState() const;
+  SafeTimeState PublishedState() const;
+
+  // Invokes compute with a consistent copy of published state, storing used state and result to
+  // the provided pointers. Returns false if state was concurrently modified in all attempts.
+  template <class Compute>
+  bool ComputeWithPublishedState(
+      const Compute& compute, SafeTimeState* state, SafeTimeWithSource* result) const;
+
+  // All modifications of the state used by safe time calculation should be surrounded by
+  // BeginStateUpdate and EndStateUpdate.
+  void BeginStateUpdate() REQUIRES(mutex_);
+  void EndStateUpdate() REQUIRES(mutex_);
+
   const std::string& LogPrefix() const { return prefix_; }
 
   struct InvariantViolationLoggingHelper;
@@ -208,11 +274,20 @@ class MvccManager {
   // Special flag for RF==1 mode when propagated_safe_time_ can be not up-to-date.
   bool leader_only_mode_ = false;
 
-  mutable SafeTimeWithSource max_safe_time_returned_with_lease_;
-  mutable SafeTimeWithSource max_safe_time_returned_without_lease_;
-  mutable SafeTimeWithSource max_safe_time_returned_for_follower_ { HybridTime::kMin };
+  // Copy of the state above, that is read by lock-free safe time calculation.
+  // state_version_ is odd while the state is being updated.
+  std::atomic<uint64_t> state_version_{0};
+  std::atomic<HybridTime> published_queue_front_{HybridTime::kInvalid};
+  std::atomic<HybridTime> published_last_replicated_{HybridTime::kMin};
+  std::atomic<HybridTime> published_propagated_safe_time_{HybridTime::kMin};
+  std::atomic<bool> published_leader_only_mode_{false};
+
+  mutable AtomicSafeTimeWithSource max_safe_time_returned_with_lease_;
+  mutable AtomicSafeTimeWithSource max_safe_time_returned_without_lease_;
+  mutable AtomicSafeTimeWithSource max_safe_time_returned_for_follower_;
 
-  std::unique_ptr<MvccOpTrace> op_trace_ GUARDED_BY(mutex_);
+  // Set in the constructor, synchronizes access to its items itself.
+  std::unique_ptr<MvccOpTrace> op_trace_;
 };
 
 }  // namespace tablet
@@ -18,6 +18,7 @@
 #include "yb/common/hybrid_time.h"
 #include "yb/common/pgsql_error.h"
 
+#include "yb/tablet/committed_transactions_cache.h"
 #include "yb/tablet/transaction_participant_context.h"
 
 #include "yb/tserver/tserver_service.pb.h"
@@ -115,6 +116,19 @@ void RunningTransaction::RequestStatusAt(const StatusRequest& request,
       return;
     }
   }
+  if (last_known_status_ == TransactionStatus::PENDING && context_.committed_transactions_cache_) {
+    // Transaction could be already resolved by another tablet of this server.
+    auto cached = context_.committed_transactions_cache_->Lookup(id(), request.global_limit_ht);
+    if (cached) {
+      // Cached status_time is the commit time, regardless of status at requested time.
+      UpdateStatus(
+          TransactionStatus::COMMITTED, cached->status_time, HybridTime(),
+          cached->aborted_subtxn_set);
+      lock->unlock();
+      request.callback(*cached);
+      return;
+    }
+  }
   bool was_empty = status_waiters_.empty();
   status_waiters_.push_back(request);
   if (!was_empty) {
@@ -354,6 +368,10 @@ void RunningTransaction::DoStatusReceived(const Status& status,
       VLOG_WITH_PREFIX(4) << "Waiters still present, send new status request: " << new_request_id;
     }
   }
+  if (transaction_status == TransactionStatus::COMMITTED &&
+      context_.committed_transactions_cache_) {
+    context_.committed_transactions_cache_->Committed(id(), time_of_status, aborted_subtxn_set);
+  }
   if (new_request_id >= 0) {
     SendStatusRequest(new_request_id, shared_self);
   }
@@ -66,8 +66,10 @@ YB_DEFINE_ENUM(RemoveReason,
 class RunningTransactionContext {
  public:
   RunningTransactionContext(TransactionParticipantContext* participant_context,
-                            TransactionIntentApplier* applier)
-      : participant_context_(*participant_context), applier_(*applier) {
+                            TransactionIntentApplier* applier,
+                            CommittedTransactionsCache* committed_transactions_cache = nullptr)
+      : participant_context_(*participant_context), applier_(*applier),
+        committed_transactions_cache_(committed_transactions_cache) {
   }
 
   virtual ~RunningTransactionContext() {}
@@ -96,6 +98,8 @@ class RunningTransactionContext {
   rpc::Rpcs rpcs_;
   TransactionParticipantContext& participant_context_;
   TransactionIntentApplier& applier_;
+  // Tablet server wide cache of committed transactions, could be null.
+  CommittedTransactionsCache* const committed_transactions_cache_;
   int64_t request_serial_ = 0;
   std::mutex mutex_;
 
@@ -32,6 +32,7 @@
 
 #include "yb/tablet/tablet.h"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/container/static_vector.hpp>
 
 #include "yb/client/client.h"
@@ -73,7 +74,9 @@
 
 #include "yb/gutil/casts.h"
 
+#include "yb/rocksdb/db/filename.h"
 #include "yb/rocksdb/db/memtable.h"
+#include "yb/rocksdb/sst_file_writer.h"
 #include "yb/rocksdb/utilities/checkpoint.h"
 
 #include "yb/rocksutil/yb_rocksdb.h"
@@ -108,6 +111,7 @@
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
 #include "yb/util/net/net_util.h"
+#include "yb/util/path_util.h"
 #include "yb/util/pg_util.h"
 #include "yb/util/scope_exit.h"
 #include "yb/util/status_format.h"
@@ -259,11 +263,23 @@ DECLARE_int32(rocksdb_level0_stop_writes_trigger);
 DECLARE_uint64(rocksdb_max_file_size_for_compaction);
 DECLARE_int64(apply_intents_task_injected_delay_ms);
 DECLARE_string(regular_tablets_data_block_key_value_encoding);
+DECLARE_string(regular_tablets_memtable_rep);
 DECLARE_int64(cdc_intent_retention_ms);
 
 DEFINE_test_flag(uint64, inject_sleep_before_applying_intents_ms, 0,
                  "Sleep before applying intents to docdb after transaction commit");
 
+DEFINE_bool(apply_large_transactions_via_sst, false,
+            "When a transaction does not fit into a single apply batch, write its remaining "
+            "records to SST files that are ingested directly into the regular RocksDB, instead of "
+            "writing them through the memtable.");
+TAG_FLAG(apply_large_transactions_via_sst, advanced);
+TAG_FLAG(apply_large_transactions_via_sst, runtime);
+
+DEFINE_test_flag(uint64, inject_sleep_after_apply_sst_ingestion_ms, 0,
+                 "Sleep after ingesting SST file with applied records of a large transaction, "
+                 "before writing its apply state.");
+
 using namespace std::placeholders;
 
 using std::shared_ptr;
@@ -338,6 +354,22 @@ docdb::ConsensusFrontiers* InitFrontiers(
   return InitFrontiers(data.op_id, data.log_ht, HybridTime::kInvalid, frontiers);
 }
 
+// Prefix of SST files with applied records of large transactions, that are written to the regular
+// DB directory before ingestion.
+const std::string kApplySstFilePrefix = "apply-"s;
+
+// Removes SST files that were written, but not ingested because of restart.
+Status CleanupApplySstFiles(Env* env, const std::string& db_dir) {
+  std::vector<std::string> children;
+  RETURN_NOT_OK(env->GetChildren(db_dir, &children));
+  for (const auto& child : children) {
+    if (boost::starts_with(child, kApplySstFilePrefix)) {
+      RETURN_NOT_OK(env->DeleteFile(JoinPathSegments(db_dir, child)));
+    }
+  }
+  return Status::OK();
+}
+
 rocksdb::UserFrontierPtr MemTableFrontierFromDb(
     rocksdb::DB* db,
     rocksdb::UpdateUserValueType type) {
@@ -440,7 +472,8 @@ Tablet::Tablet(const TabletInitData& data)
       data.transaction_participant_context &&
       (is_sys_catalog_ || transactional)) {
     transaction_participant_ = std::make_unique<TransactionParticipant>(
-        data.transaction_participant_context, this, tablet_metrics_entity_);
+        data.transaction_participant_context, this, tablet_metrics_entity_,
+        data.committed_transactions_cache);
     if (data.waiting_txn_registry) {
       wait_queue_ = std::make_unique<docdb::WaitQueue>(
         transaction_participant_.get(), metadata_->fs_manager()->uuid(), data.waiting_txn_registry);
@@ -465,7 +498,8 @@ Tablet::Tablet(const TabletInitData& data)
     transaction_coordinator_ = std::make_unique<TransactionCoordinator>(
         metadata_->fs_manager()->uuid(),
         data.transaction_coordinator_context,
-        metrics_->expired_transactions.get());
+        metrics_->expired_transactions.get(),
+        metrics_->unreplicated_transaction_heartbeats.get());
   }
 
   snapshots_ = std::make_unique<TabletSnapshots>(this);
@@ -710,9 +744,13 @@ Status Tablet::OpenKeyValueTablet() {
   rocksdb::Options regular_rocksdb_options(rocksdb_options);
   regular_rocksdb_options.listeners.push_back(
       std::make_shared<RegularRocksDbListener>(this, regular_rocksdb_options.log_prefix));
+  // Intents DB keeps the default memtable, since intents cleanup relies on its in memory erase.
+  regular_rocksdb_options.memtable_factory = VERIFY_RESULT(
+      docdb::GetConfiguredMemTableRepFactory(FLAGS_regular_tablets_memtable_rep));
 
   const string db_dir = metadata()->rocksdb_dir();
   RETURN_NOT_OK(CreateTabletDirectories(db_dir, metadata()->fs_manager()));
+  RETURN_NOT_OK(CleanupApplySstFiles(metadata()->fs_manager()->env(), db_dir));
 
   LOG(INFO) << "Opening RocksDB at: " << db_dir;
   rocksdb::DB* db = nullptr;
@@ -1755,6 +1793,16 @@ Result<docdb::ApplyTransactionState> Tablet::ApplyIntents(const TransactionApply
   // transaction is done properly in the rare situation where the committed transaction's intents
   // are still in intents db and not yet in regular db.
   AtomicFlagSleepMs(&FLAGS_TEST_inject_sleep_before_applying_intents_ms);
+  // Presence of apply state means that the transaction did not fit into a single apply batch.
+  if (data.apply_state && GetAtomicFlag(&FLAGS_apply_large_transactions_via_sst)) {
+    auto result = ApplyIntentsViaSst(data);
+    if (result.ok()) {
+      return result;
+    }
+    // Nothing was written to the regular DB, so could just retry using memtable.
+    LOG_WITH_PREFIX(WARNING) << "Failed to apply intents of " << data.transaction_id
+                             << " via SST file, falling back to memtable: " << result.status();
+  }
   docdb::ApplyIntentsContext context(
       data.transaction_id, data.apply_state, data.aborted, data.commit_ht, data.log_ht,
       &key_bounds_, intents_db_.get());
@@ -1770,6 +1818,66 @@ Result<docdb::ApplyTransactionState> Tablet::ApplyIntents(const TransactionApply
   return context.apply_state();
 }
 
+// Keys of applied records contain commit hybrid time and write id, so records of other
+// transactions could not have the same keys. The same records are ingested again when restart
+// happens after ingestion, but before the following apply state is persisted. Ingestion is
+// idempotent in this case: duplicate keys at sequence number 0 have identical values. So the file
+// could be ingested, even though its key range overlaps existing data.
+Result<docdb::ApplyTransactionState> Tablet::ApplyIntentsViaSst(const TransactionApplyData& data) {
+  docdb::ApplyIntentsContext context(
+      data.transaction_id, data.apply_state, data.aborted, data.commit_ht, data.log_ht,
+      &key_bounds_, intents_db_.get());
+  docdb::IntentsWriter intents_writer(
+      data.apply_state ? data.apply_state->key : Slice(), intents_db_.get(), &context);
+  rocksdb::WriteBatch apply_state_write_batch;
+  docdb::ApplyIntentsCollector collector(&apply_state_write_batch);
+  RETURN_NOT_OK(intents_writer.Apply(&collector));
+
+  if (!collector.empty()) {
+    const auto& options = regular_db_->GetOptions();
+    auto* env = regular_db_->GetEnv();
+    const auto path = JoinPathSegments(
+        metadata()->rocksdb_dir(), Format("$0$1.sst", kApplySstFilePrefix, data.transaction_id));
+    // On success files are moved to the DB, so cleanup is required only in case of failure.
+    auto se = ScopeExit([env, &path] {
+      if (env->FileExists(path).ok()) {
+        env->CleanupFile(path);
+      }
+      auto data_path = rocksdb::TableBaseToDataFileName(path);
+      if (env->FileExists(data_path).ok()) {
+        env->CleanupFile(data_path);
+      }
+    });
+
+    rocksdb::SstFileWriter writer(
+        rocksdb::EnvOptions(), rocksdb::ImmutableCFOptions(options), options.comparator);
+    RETURN_NOT_OK(writer.Open(path));
+    RETURN_NOT_OK(collector.WriteTo(&writer));
+    rocksdb::ExternalSstFileInfo file_info;
+    RETURN_NOT_OK(writer.Finish(&file_info));
+
+    file_info.allow_overlapping_range = true;
+    // Op id is not set, so the file does not affect flushed frontier. So records of this
+    // transaction that were written to memtable are still replayed from WAL after restart.
+    docdb::ConsensusFrontier frontier(OpId(), data.commit_ht, HybridTime());
+    file_info.smallest_frontier = frontier.Clone();
+    file_info.largest_frontier = frontier.Clone();
+    RETURN_NOT_OK(regular_db_->AddFile(&file_info, /* move_file= */ true));
+
+    VLOG_WITH_PREFIX(2) << "Applied " << collector.num_records() << " records of "
+                        << data.transaction_id << " via SST file of " << file_info.file_size
+                        << " bytes";
+    AtomicFlagSleepMs(&FLAGS_TEST_inject_sleep_after_apply_sst_ingestion_ms);
+  }
+
+  // Apply state is written through memtable, so it is persisted only after all previously applied
+  // records of this transaction.
+  docdb::ConsensusFrontiers frontiers;
+  auto frontiers_ptr = data.op_id.empty() ? nullptr : InitFrontiers(data, &frontiers);
+  WriteToRocksDB(frontiers_ptr, &apply_state_write_batch, StorageDbType::kRegular);
+  return context.apply_state();
+}
+
 template <class Ids>
 Status Tablet::RemoveIntentsImpl(const RemoveIntentsData& data, const Ids& ids) {
   auto scoped_read_operation = CreateNonAbortableScopedRWOperation();
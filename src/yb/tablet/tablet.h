@@ -969,6 +969,9 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   Result<bool> IntentsDbFlushFilter(const rocksdb::MemTable& memtable);
 
+  // Applies next portion of a large transaction by ingesting SST file into the regular DB.
+  Result<docdb::ApplyTransactionState> ApplyIntentsViaSst(const TransactionApplyData& data);
+
   template <class Ids>
   Status RemoveIntentsImpl(const RemoveIntentsData& data, const Ids& ids);
 
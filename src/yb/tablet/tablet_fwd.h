@@ -27,6 +27,7 @@ namespace yb {
 namespace tablet {
 
 class AbstractTablet;
+class CommittedTransactionsCache;
 
 class OperationDriver;
 typedef scoped_refptr<OperationDriver> OperationDriverPtr;
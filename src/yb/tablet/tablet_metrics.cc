@@ -110,6 +110,12 @@ METRIC_DEFINE_counter(tablet, expired_transactions,
   yb::MetricUnit::kRequests,
   "Number of expired distributed transactions.");
 
+METRIC_DEFINE_counter(tablet, unreplicated_transaction_heartbeats,
+  "Unreplicated Transaction Heartbeats",
+  yb::MetricUnit::kRequests,
+  "Number of batched transaction heartbeats that refreshed transaction lease without "
+  "replicating it through RAFT.");
+
 METRIC_DEFINE_counter(tablet, restart_read_requests,
   "Read Requests Requiring Restart",
   yb::MetricUnit::kRequests,
@@ -148,6 +154,7 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& table_entity,
     MINIT(tablet_entity, majority_sst_files_rejections),
     MINIT(tablet_entity, transaction_conflicts),
     MINIT(tablet_entity, expired_transactions),
+    MINIT(tablet_entity, unreplicated_transaction_heartbeats),
     MINIT(tablet_entity, restart_read_requests),
     MINIT(tablet_entity, consistent_prefix_read_requests),
     MINIT(tablet_entity, pgsql_consistent_prefix_read_rows),
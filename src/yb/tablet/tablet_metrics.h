@@ -66,6 +66,7 @@ struct TabletMetrics {
   scoped_refptr<Counter> majority_sst_files_rejections;
   scoped_refptr<Counter> transaction_conflicts;
   scoped_refptr<Counter> expired_transactions;
+  scoped_refptr<Counter> unreplicated_transaction_heartbeats;
   scoped_refptr<Counter> restart_read_requests;
   scoped_refptr<Counter> consistent_prefix_read_requests;
   scoped_refptr<Counter> pgsql_consistent_prefix_read_rows;
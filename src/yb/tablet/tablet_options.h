@@ -34,6 +34,7 @@ namespace rocksdb {
 class Cache;
 class EventListener;
 class MemoryMonitor;
+class PersistentCache;
 class Env;
 
 struct RocksDBPriorityThreadPoolMetrics;
@@ -50,6 +51,7 @@ namespace tablet {
 // Common for all tablets within TabletManager.
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
+  std::shared_ptr<rocksdb::PersistentCache> persistent_block_cache;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
   yb::Env* env = Env::Default();
@@ -80,6 +82,7 @@ struct TabletInitData {
   std::function<HybridTime(RaftGroupMetadata*)> allowed_history_cutoff_provider;
   TransactionManagerProvider transaction_manager_provider;
   LocalWaitingTxnRegistry* waiting_txn_registry = nullptr;
+  CommittedTransactionsCache* committed_transactions_cache = nullptr;
 };
 
 } // namespace tablet
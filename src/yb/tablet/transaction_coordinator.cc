@@ -77,6 +77,31 @@ DEFINE_uint64(transaction_deadlock_detection_interval_usec, 60000000,
               "Deadlock detection interval in usec.");
 TAG_FLAG(transaction_deadlock_detection_interval_usec, advanced);
 
+DEFINE_int32(transaction_max_unreplicated_heartbeat_periods, 3,
+             "Batched heartbeats of pending transactions refresh transaction lease in memory of "
+             "the status tablet leader. But at least once per this number of heartbeat periods "
+             "heartbeat is replicated through RAFT, so a new leader would not expire the "
+             "transaction. 0 means that all heartbeats are replicated. Must be less than "
+             "transaction_max_missed_heartbeat_periods.");
+TAG_FLAG(transaction_max_unreplicated_heartbeat_periods, advanced);
+
+namespace {
+
+bool MaxUnreplicatedHeartbeatPeriodsValidator(const char* flag_name, int32_t value) {
+  if (value > 0 && value >= FLAGS_transaction_max_missed_heartbeat_periods) {
+    LOG(ERROR) << "Expect " << flag_name << " to be less than "
+               << "transaction_max_missed_heartbeat_periods value ("
+               << FLAGS_transaction_max_missed_heartbeat_periods << ")";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+DEFINE_validator(transaction_max_unreplicated_heartbeat_periods,
+                 &MaxUnreplicatedHeartbeatPeriodsValidator);
+
 DEFINE_int64(avoid_abort_after_sealing_ms, 20,
              "If transaction was only sealed, we will try to abort it not earlier than this "
                  "period in milliseconds.");
@@ -169,7 +194,8 @@ class TransactionState {
       : context_(*context),
         id_(id),
         log_prefix_(BuildLogPrefix(parent_log_prefix, id)),
-        last_touch_(last_touch) {
+        last_touch_(last_touch),
+        last_replicated_touch_(last_touch) {
   }
 
   ~TransactionState() {
@@ -184,7 +210,8 @@ class TransactionState {
   }
 
   // Time when we last heard from transaction. I.e. hybrid time of replicated raft log entry
-  // that updates status of this transaction.
+  // that updates status of this transaction, or time of the last heartbeat that refreshed
+  // transaction lease without replication.
   HybridTime last_touch() const {
     return last_touch_;
   }
@@ -218,6 +245,26 @@ class TransactionState {
     return false;
   }
 
+  // Refreshes transaction lease in memory, without replicating heartbeat through RAFT.
+  // Returns false if heartbeat should be replicated instead, i.e. transaction is not in a stable
+  // PENDING state, or was not refreshed through RAFT for so long that a new leader could expire it.
+  bool RefreshLease(HybridTime now) {
+    if (replicating_ || !request_queue_.empty() || status_ != TransactionStatus::PENDING ||
+        ExpiredAt(now)) {
+      return false;
+    }
+    const int64_t max_unreplicated_usec =
+        GetAtomicFlag(&FLAGS_transaction_max_unreplicated_heartbeat_periods) *
+        GetAtomicFlag(&FLAGS_transaction_heartbeat_usec);
+    const int64_t passed =
+        now.GetPhysicalValueMicros() - last_replicated_touch_.GetPhysicalValueMicros();
+    if (passed >= max_unreplicated_usec) {
+      return false;
+    }
+    last_touch_ = now;
+    return true;
+  }
+
   // Whether this transaction has completed.
   bool Completed() const {
     return status_ == TransactionStatus::ABORTED ||
@@ -796,6 +843,7 @@ class TransactionState {
       return Status::OK();
     }
     last_touch_ = data.hybrid_time;
+    last_replicated_touch_ = data.hybrid_time;
     first_entry_raft_index_ = data.op_id.index;
 
     // TODO(savepoints) -- consider swapping instead of copying here.
@@ -854,6 +902,9 @@ class TransactionState {
   const std::string log_prefix_;
   TransactionStatus status_ = TransactionStatus::PENDING;
   HybridTime last_touch_;
+  // Hybrid time of the last replicated PENDING or CREATED record, i.e. lease that would be seen
+  // by a new leader.
+  HybridTime last_replicated_touch_;
   // It should match last_touch_, but it is possible that because of some code errors it
   // would not be so. To add stability we introduce a separate field for it.
   HybridTime commit_time_;
@@ -931,6 +982,33 @@ struct PostponedLeaderActions {
   }
 };
 
+// Collects results of heartbeats from a single UpdateTransactionHeartbeats request, and invokes
+// callback when all of them are processed.
+class HeartbeatsBatch {
+ public:
+  HeartbeatsBatch(size_t size, TransactionHeartbeatsCallback callback)
+      : statuses_(size), pending_(size + 1), callback_(std::move(callback)) {
+  }
+
+  // Should be invoked exactly once for each heartbeat in the batch.
+  void SetStatus(size_t idx, const Status& status) {
+    statuses_[idx] = status;
+    Done();
+  }
+
+  // Should be invoked once after all heartbeats were dispatched.
+  void Done() {
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      callback_(statuses_);
+    }
+  }
+
+ private:
+  std::vector<Status> statuses_;
+  std::atomic<size_t> pending_;
+  TransactionHeartbeatsCallback callback_;
+};
+
 } // namespace
 
 std::string TransactionCoordinator::AbortedData::ToString() const {
@@ -943,9 +1021,11 @@ class TransactionCoordinator::Impl : public TransactionStateContext,
  public:
   Impl(const std::string& permanent_uuid,
        TransactionCoordinatorContext* context,
-       Counter* expired_metric)
+       Counter* expired_metric,
+       Counter* unreplicated_heartbeats_metric)
       : context_(*context),
         expired_metric_(*expired_metric),
+        unreplicated_heartbeats_metric_(*unreplicated_heartbeats_metric),
         log_prefix_(consensus::MakeTabletLogPrefix(context->tablet_id(), permanent_uuid)),
         deadlock_detector_(context->client_future(), this, context->tablet_id()),
         deadlock_detection_poller_(log_prefix_, std::bind(&Impl::PollDeadlockDetector, this)),
@@ -1296,6 +1376,53 @@ class TransactionCoordinator::Impl : public TransactionStateContext,
     ExecutePostponedLeaderActions(&actions);
   }
 
+  void HandleHeartbeats(
+      const google::protobuf::RepeatedPtrField<std::string>& transaction_ids, int64_t term,
+      TransactionHeartbeatsCallback callback) {
+    auto batch = std::make_shared<HeartbeatsBatch>(transaction_ids.size(), std::move(callback));
+    auto now = context_.clock().Now();
+    std::vector<int> to_replicate;
+    size_t refreshed = 0;
+    {
+      std::lock_guard<std::mutex> lock(managed_mutex_);
+      for (int idx = 0; idx != transaction_ids.size(); ++idx) {
+        auto id = FullyDecodeTransactionId(transaction_ids.Get(idx));
+        if (!id.ok()) {
+          batch->SetStatus(idx, id.status());
+          continue;
+        }
+        auto it = managed_transactions_.find(*id);
+        bool lease_refreshed = false;
+        if (it != managed_transactions_.end()) {
+          managed_transactions_.modify(it, [now, &lease_refreshed](TransactionState& state) {
+            lease_refreshed = state.RefreshLease(now);
+          });
+        }
+        if (lease_refreshed) {
+          batch->SetStatus(idx, Status::OK());
+          ++refreshed;
+        } else {
+          to_replicate.push_back(idx);
+        }
+      }
+    }
+    unreplicated_heartbeats_metric_.IncrementBy(refreshed);
+
+    // Heartbeats that could not refresh lease in memory are processed as regular PENDING
+    // UpdateTransaction requests, that also take care of unknown and expired transactions.
+    for (auto idx : to_replicate) {
+      TransactionStatePB state;
+      state.set_transaction_id(transaction_ids.Get(idx));
+      state.set_status(TransactionStatus::PENDING);
+      auto request = context_.CreateUpdateTransaction(&state);
+      request->set_completion_callback([batch, idx](const Status& status) {
+        batch->SetStatus(idx, status);
+      });
+      Handle(std::move(request), term);
+    }
+    batch->Done();
+  }
+
   int64_t PrepareGC(std::string* details) {
     std::lock_guard<std::mutex> lock(managed_mutex_);
     if (!managed_transactions_.empty()) {
@@ -1596,6 +1723,7 @@ class TransactionCoordinator::Impl : public TransactionStateContext,
 
   TransactionCoordinatorContext& context_;
   Counter& expired_metric_;
+  Counter& unreplicated_heartbeats_metric_;
   const std::string log_prefix_;
 
   std::mutex managed_mutex_;
@@ -1613,8 +1741,9 @@ class TransactionCoordinator::Impl : public TransactionStateContext,
 
 TransactionCoordinator::TransactionCoordinator(const std::string& permanent_uuid,
                                                TransactionCoordinatorContext* context,
-                                               Counter* expired_metric)
-    : impl_(new Impl(permanent_uuid, context, expired_metric)) {
+                                               Counter* expired_metric,
+                                               Counter* unreplicated_heartbeats_metric)
+    : impl_(new Impl(permanent_uuid, context, expired_metric, unreplicated_heartbeats_metric)) {
 }
 
 TransactionCoordinator::~TransactionCoordinator() {
@@ -1641,6 +1770,12 @@ void TransactionCoordinator::Handle(
   impl_->Handle(std::move(request), term);
 }
 
+void TransactionCoordinator::HandleHeartbeats(
+    const google::protobuf::RepeatedPtrField<std::string>& transaction_ids, int64_t term,
+    TransactionHeartbeatsCallback callback) {
+  impl_->HandleHeartbeats(transaction_ids, term, std::move(callback));
+}
+
 void TransactionCoordinator::Start() {
   impl_->Start();
 }
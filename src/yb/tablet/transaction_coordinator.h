@@ -18,6 +18,7 @@
 
 #include <future>
 #include <memory>
+#include <vector>
 
 #include "yb/client/client_fwd.h"
 
@@ -82,6 +83,9 @@ class TransactionCoordinatorContext {
 
 typedef std::function<void(Result<TransactionStatusResult>)> TransactionAbortCallback;
 
+// Receives status for each heartbeat of the batch, in the same order as in request.
+typedef std::function<void(const std::vector<Status>&)> TransactionHeartbeatsCallback;
+
 // Coordinates all transactions managed by specific tablet, i.e. all transactions
 // that selected this tablet as status tablet for it.
 // Also it handles running transactions, i.e. transactions that has intents in appropriate tablet.
@@ -90,7 +94,8 @@ class TransactionCoordinator {
  public:
   TransactionCoordinator(const std::string& permanent_uuid,
                          TransactionCoordinatorContext* context,
-                         Counter* expired_metric);
+                         Counter* expired_metric,
+                         Counter* unreplicated_heartbeats_metric);
   ~TransactionCoordinator();
 
   // Used to pass arguments to ProcessReplicated.
@@ -119,6 +124,12 @@ class TransactionCoordinator {
   // Handles new request for transaction update.
   void Handle(std::unique_ptr<tablet::UpdateTxnOperation> request, int64_t term);
 
+  // Handles batch of heartbeats from PENDING transactions. Lease of stable PENDING transaction is
+  // refreshed in memory, other heartbeats are handled as regular PENDING update requests.
+  void HandleHeartbeats(
+      const google::protobuf::RepeatedPtrField<std::string>& transaction_ids, int64_t term,
+      TransactionHeartbeatsCallback callback);
+
   // Prepares log garbage collection. Return min index that should be preserved.
   int64_t PrepareGC(std::string* details = nullptr);
 
@@ -37,6 +37,7 @@
 
 #include "yb/tablet/cleanup_aborts_task.h"
 #include "yb/tablet/cleanup_intents_task.h"
+#include "yb/tablet/committed_transactions_cache.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/remove_intents_task.h"
 #include "yb/tablet/running_transaction.h"
@@ -123,8 +124,9 @@ class TransactionParticipant::Impl
     : public RunningTransactionContext, public TransactionLoaderContext {
  public:
   Impl(TransactionParticipantContext* context, TransactionIntentApplier* applier,
-       const scoped_refptr<MetricEntity>& entity)
-      : RunningTransactionContext(context, applier),
+       const scoped_refptr<MetricEntity>& entity,
+       CommittedTransactionsCache* committed_transactions_cache)
+      : RunningTransactionContext(context, applier, committed_transactions_cache),
         log_prefix_(context->LogPrefix()),
         loader_(this, entity),
         poller_(log_prefix_, std::bind(&Impl::Poll, this)) {
@@ -632,6 +634,10 @@ class TransactionParticipant::Impl
       }
     }
 
+    if (committed_transactions_cache_ && !was_applied) {
+      committed_transactions_cache_->Committed(data.transaction_id, data.commit_ht, data.aborted);
+    }
+
     if (!was_applied) {
       auto apply_state = CHECK_RESULT(applier_.ApplyIntents(data));
 
@@ -1687,8 +1693,9 @@ class TransactionParticipant::Impl
 
 TransactionParticipant::TransactionParticipant(
     TransactionParticipantContext* context, TransactionIntentApplier* applier,
-    const scoped_refptr<MetricEntity>& entity)
-    : impl_(new Impl(context, applier, entity)) {
+    const scoped_refptr<MetricEntity>& entity,
+    CommittedTransactionsCache* committed_transactions_cache)
+    : impl_(new Impl(context, applier, entity, committed_transactions_cache)) {
 }
 
 TransactionParticipant::~TransactionParticipant() {
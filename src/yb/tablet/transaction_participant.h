@@ -110,7 +110,8 @@ class TransactionParticipant : public TransactionStatusManager {
  public:
   TransactionParticipant(
       TransactionParticipantContext* context, TransactionIntentApplier* applier,
-      const scoped_refptr<MetricEntity>& entity);
+      const scoped_refptr<MetricEntity>& entity,
+      CommittedTransactionsCache* committed_transactions_cache = nullptr);
   virtual ~TransactionParticipant();
 
   // Notify participant that this context is ready and it could start performing its requests.
@@ -29,6 +29,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/net/rate_limiter.h"
+#include "yb/util/result.h"
 #include "yb/util/size_literals.h"
 #include "yb/util/status_format.h"
 #include "yb/util/stopwatch.h"
@@ -189,6 +190,7 @@ Status RemoteBootstrapFileDownloader::DownloadFile(
     req.set_session_id(session_id_);
     req.mutable_data_id()->CopyFrom(data_id);
     req.set_offset(offset);
+    req.set_accept_data_sidecar(true);
     if (rate_limiter->active()) {
       auto max_size = rate_limiter->GetMaxSizeForNextTransmission();
       if (max_size > std::numeric_limits<decltype(max_length)>::max()) {
@@ -199,33 +201,40 @@ Status RemoteBootstrapFileDownloader::DownloadFile(
     req.set_max_length(max_length);
 
     FetchDataResponsePB resp;
-    auto status = rate_limiter->SendOrReceiveData([this, &req, &resp, &controller]() {
-      return proxy_->FetchData(req, &resp, &controller);
-    }, [&resp]() { return resp.ByteSize(); });
+    Slice data;
+    auto status = rate_limiter->SendOrReceiveData([this, &req, &resp, &controller, &data]() {
+      RETURN_NOT_OK(proxy_->FetchData(req, &resp, &controller));
+      // Servers that don't support sidecars send data in the response protobuf.
+      data = resp.chunk().has_data_sidecar()
+          ? VERIFY_RESULT(controller.GetSidecar(resp.chunk().data_sidecar()))
+          : Slice(resp.chunk().data());
+      return Status::OK();
+    }, [&resp, &data]() {
+      return resp.ByteSize() + (resp.chunk().has_data_sidecar() ? data.size() : 0);
+    });
     RETURN_NOT_OK_UNWIND_PREPEND(status, controller, "Unable to fetch data from remote");
-    DCHECK_LE(resp.chunk().data().size(), max_length);
+    DCHECK_LE(data.size(), max_length);
 
     // Sanity-check for corruption.
     verify_data_timer.resume();
-    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk()),
+    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk(), data),
                           Format("Error validating data item $0", data_id));
     verify_data_timer.stop();
 
     // Write the data.
     VLOG_WITH_PREFIX(3) << "Verifying received data";
     append_data_timer.resume();
-    RETURN_NOT_OK(appendable->Append(resp.chunk().data()));
+    RETURN_NOT_OK(appendable->Append(data));
     append_data_timer.stop();
     VLOG_WITH_PREFIX(3) << "Verified and appended successfully: resp size: " << resp.ByteSize()
-                        << ", chunk size: " << resp.chunk().data().size();
+                        << ", chunk size: " << data.size();
 
-    if (offset + resp.chunk().data().size() ==
-            implicit_cast<size_t>(resp.chunk().total_data_length())) {
+    if (offset + data.size() == implicit_cast<size_t>(resp.chunk().total_data_length())) {
       done = true;
     }
-    offset += resp.chunk().data().size();
+    offset += data.size();
     if (FLAGS_bytes_remote_bootstrap_durable_write_mb != 0) {
-      periodic_sync_unsynced_bytes += resp.chunk().data().size();
+      periodic_sync_unsynced_bytes += data.size();
       if (periodic_sync_unsynced_bytes > FLAGS_bytes_remote_bootstrap_durable_write_mb * 1_MB) {
         sync_timer.resume();
         RETURN_NOT_OK(appendable->Sync());
@@ -255,7 +264,8 @@ Status RemoteBootstrapFileDownloader::DownloadFile(
   return Status::OK();
 }
 
-Status RemoteBootstrapFileDownloader::VerifyData(uint64_t offset, const DataChunkPB& chunk) {
+Status RemoteBootstrapFileDownloader::VerifyData(
+    uint64_t offset, const DataChunkPB& chunk, Slice data) {
   // Verify the offset is what we expected.
   if (offset != chunk.offset()) {
     return STATUS_FORMAT(
@@ -264,11 +274,11 @@ Status RemoteBootstrapFileDownloader::VerifyData(uint64_t offset, const DataChun
   }
 
   // Verify the checksum.
-  uint32_t crc32 = crc::Crc32c(chunk.data().data(), chunk.data().length());
+  uint32_t crc32 = crc::Crc32c(data.data(), data.size());
   if (PREDICT_FALSE(crc32 != chunk.crc32())) {
     return STATUS_FORMAT(
         Corruption, "CRC32 does not match at offset $0 size $1: $2 vs $3",
-        offset, chunk.data().size(), crc32, chunk.crc32());
+        offset, data.size(), crc32, chunk.crc32());
   }
   return Status::OK();
 }
@@ -25,6 +25,7 @@
 #include "yb/tserver/remote_bootstrap.pb.h"
 
 #include "yb/util/monotime.h"
+#include "yb/util/slice.h"
 #include "yb/util/status_fwd.h"
 
 namespace yb {
@@ -67,7 +68,8 @@ class RemoteBootstrapFileDownloader {
   }
 
  private:
-  Status VerifyData(uint64_t offset, const DataChunkPB& resp);
+  // Verifies chunk data received in the response, or in its sidecar.
+  Status VerifyData(uint64_t offset, const DataChunkPB& chunk, Slice data);
 
   const std::string& LogPrefix() const {
     return log_prefix_;
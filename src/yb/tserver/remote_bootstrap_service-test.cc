@@ -136,7 +136,8 @@ class RemoteBootstrapServiceTest : public RemoteBootstrapTest {
   Status DoFetchData(const string& session_id, const DataIdPB& data_id,
                      uint64_t* offset, int64_t* max_length,
                      FetchDataResponsePB* resp,
-                     RpcController* controller) {
+                     RpcController* controller,
+                     bool accept_data_sidecar = false) {
     controller->set_timeout(MonoDelta::FromSeconds(1.0));
     FetchDataRequestPB req;
     req.set_session_id(session_id);
@@ -147,6 +148,7 @@ class RemoteBootstrapServiceTest : public RemoteBootstrapTest {
     if (max_length) {
       req.set_max_length(*max_length);
     }
+    req.set_accept_data_sidecar(accept_data_sidecar);
     return UnwindRemoteError(
         remote_bootstrap_proxy_->FetchData(req, resp, controller), controller);
   }
@@ -374,6 +376,18 @@ TEST_F(RemoteBootstrapServiceTest, TestFetchLog) {
   ASSERT_OK(ReadFully(segment->readable_file_checkpoint().get(), 0, size, &slice, scratch.data()));
 
   AssertDataEqual(slice.data(), slice.size(), resp.chunk());
+  ASSERT_FALSE(resp.chunk().has_data_sidecar());
+
+  // Fetch the same data as a sidecar.
+  resp.Clear();
+  controller.Reset();
+  ASSERT_OK(DoFetchData(
+      session_id, data_id, nullptr, nullptr, &resp, &controller, /* accept_data_sidecar= */ true));
+  ASSERT_TRUE(resp.chunk().has_data_sidecar());
+  ASSERT_TRUE(resp.chunk().data().empty());
+  auto sidecar = ASSERT_RESULT(controller.GetSidecar(resp.chunk().data_sidecar()));
+  ASSERT_EQ(slice.ToDebugHexString(), sidecar.ToDebugHexString());
+  ASSERT_EQ(crc::Crc32c(sidecar.data(), sidecar.size()), resp.chunk().crc32());
 }
 
 // Test that the remote bootstrap session timeout works properly.
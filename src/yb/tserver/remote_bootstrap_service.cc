@@ -295,7 +295,7 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
   GetDataPieceInfo info = {
     .offset = req->offset(),
     .client_maxlen = rate_limit == 0 ? req->max_length() : std::min(req->max_length(), rate_limit),
-    .data = std::string(),
+    .data = RefCntBuffer(),
     .data_size = 0,
     .error_code = RemoteBootstrapErrorPB::UNKNOWN_ERROR,
   };
@@ -310,11 +310,16 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
 
   session->rate_limiter().UpdateDataSizeAndMaybeSleep(info.data.size());
   session->crc_compute_timer().resume();
-  uint32_t crc32 = Crc32c(info.data.data(), info.data.length());
+  uint32_t crc32 = Crc32c(info.data.data(), info.data.size());
   session->crc_compute_timer().stop();
 
   DataChunkPB* data_chunk = resp->mutable_chunk();
-  *data_chunk->mutable_data() = std::move(info.data);
+  if (req->accept_data_sidecar()) {
+    data_chunk->mutable_data();
+    data_chunk->set_data_sidecar(narrow_cast<int32_t>(context.AddRpcSidecar(std::move(info.data))));
+  } else {
+    data_chunk->set_data(info.data.data(), info.data.size());
+  }
   data_chunk->set_total_data_length(info.data_size);
   data_chunk->set_offset(info.offset);
 
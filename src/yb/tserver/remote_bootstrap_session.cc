@@ -316,11 +316,9 @@ Status ReadFileChunkToBuf(RandomAccessFile* file, const string& data_name, GetDa
   Stopwatch chunk_timer(Stopwatch::THIS_THREAD);
   chunk_timer.start();
 
-  // Writing into a std::string buffer is basically guaranteed to work on C++11,
-  // however any modern compiler should be compatible with it.
-  // Violates the API contract, but avoids excessive copies.
-  info->data.resize(response_data_size);
-  auto buf = reinterpret_cast<uint8_t*>(const_cast<char*>(info->data.data()));
+  // Data is read directly into the buffer, that is sent as RPC sidecar, to avoid excessive copies.
+  info->data = RefCntBuffer(response_data_size);
+  auto buf = info->data.udata();
   Slice slice;
   Status s = env_util::ReadFully(file, info->offset, response_data_size, &slice, buf);
   if (PREDICT_FALSE(!s.ok())) {
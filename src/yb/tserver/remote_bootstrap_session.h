@@ -52,6 +52,7 @@
 #include "yb/util/stopwatch.h"
 #include "yb/util/locks.h"
 #include "yb/util/net/rate_limiter.h"
+#include "yb/util/ref_cnt_buffer.h"
 
 namespace yb {
 
@@ -73,7 +74,7 @@ struct GetDataPieceInfo {
   int64_t client_maxlen;
 
   // Output
-  std::string data;
+  RefCntBuffer data;
   uint64_t data_size;
   RemoteBootstrapErrorPB::Code error_code;
 
@@ -21,6 +21,7 @@
 
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/memory_monitor.h"
+#include "yb/rocksdb/persistent_cache.h"
 
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet_options.h"
@@ -30,10 +31,12 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/mem_tracker.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/status_log.h"
 
 using namespace std::literals;
 using namespace std::placeholders;
+using namespace yb::size_literals;
 
 DEFINE_bool(enable_log_cache_gc, true,
             "Set to true to enable log cache garbage collector.");
@@ -76,6 +79,36 @@ DEFINE_int32(db_block_cache_num_shard_bits, 4,
              "Number of bits to use for sharding the block cache (defaults to 4 bits)");
 TAG_FLAG(db_block_cache_num_shard_bits, advanced);
 
+DEFINE_string(db_block_cache_type, "lru",
+              "Replacement policy of the block cache. lru - LRU with single-touch and multi-touch "
+              "pools. clock - CLOCK with frequency based admission, which keeps frequently used "
+              "blocks during large scans and does not take exclusive shard lock on cache hits.");
+TAG_FLAG(db_block_cache_type, advanced);
+
+namespace {
+
+bool BlockCacheTypeValidator(const char* flag_name, const std::string& value) {
+  if (value == "lru" || value == "clock") {
+    return true;
+  }
+  LOG(ERROR) << flag_name << ": unknown block cache type: " << value;
+  return false;
+}
+
+} // namespace
+
+DEFINE_validator(db_block_cache_type, &BlockCacheTypeValidator);
+
+DEFINE_string(db_block_cache_secondary_path, "",
+              "Directory on a fast local disk for the second tier of block cache. Blocks read from "
+              "SST files are also stored there and reused after restart. Empty value disables "
+              "the second tier.");
+TAG_FLAG(db_block_cache_secondary_path, advanced);
+
+DEFINE_int64(db_block_cache_secondary_size_bytes, 10_GB,
+             "Size of the second tier of block cache, see db_block_cache_secondary_path.");
+TAG_FLAG(db_block_cache_secondary_size_bytes, advanced);
+
 DEFINE_test_flag(bool, pretend_memory_exceeded_enforce_flush, false,
                   "Always pretend memory has been exceeded to enforce background flush.");
 
@@ -100,9 +133,9 @@ class FunctorGC : public GarbageCollector {
   std::function<void(size_t)> impl_;
 };
 
-class LRUCacheGC : public GarbageCollector {
+class BlockCacheGC : public GarbageCollector {
  public:
-  explicit LRUCacheGC(std::shared_ptr<rocksdb::Cache> cache) : cache_(std::move(cache)) {}
+  explicit BlockCacheGC(std::shared_ptr<rocksdb::Cache> cache) : cache_(std::move(cache)) {}
 
   void CollectGarbage(size_t required) {
     if (!FLAGS_enable_block_based_table_cache_gc) {
@@ -115,7 +148,7 @@ class LRUCacheGC : public GarbageCollector {
               << ", required: " << HumanReadableNumBytes::ToString(required);
   }
 
-  virtual ~LRUCacheGC() = default;
+  virtual ~BlockCacheGC() = default;
 
  private:
   std::shared_ptr<rocksdb::Cache> cache_;
@@ -196,12 +229,38 @@ void TabletMemoryManager::InitBlockCache(
       server_mem_tracker_);
 
   if (block_cache_size_bytes != kDbCacheSizeCacheDisabled) {
-    options->block_cache = rocksdb::NewLRUCache(block_cache_size_bytes,
-                                                FLAGS_db_block_cache_num_shard_bits);
+    if (FLAGS_db_block_cache_type == "clock") {
+      options->block_cache = rocksdb::NewClockCache(block_cache_size_bytes,
+                                                    FLAGS_db_block_cache_num_shard_bits);
+    } else {
+      options->block_cache = rocksdb::NewLRUCache(block_cache_size_bytes,
+                                                  FLAGS_db_block_cache_num_shard_bits);
+    }
     options->block_cache->SetMetrics(metrics);
-    block_based_table_gc_ = std::make_shared<LRUCacheGC>(options->block_cache);
+    block_based_table_gc_ = std::make_shared<BlockCacheGC>(options->block_cache);
     block_based_table_mem_tracker_->AddGarbageCollector(block_based_table_gc_);
+
+    if (!FLAGS_db_block_cache_secondary_path.empty()) {
+      InitPersistentBlockCache(options);
+    }
+  }
+}
+
+void TabletMemoryManager::InitPersistentBlockCache(tablet::TabletOptions* options) {
+  rocksdb::FilePersistentCacheOptions cache_options;
+  cache_options.env = options->rocksdb_env;
+  cache_options.path = FLAGS_db_block_cache_secondary_path;
+  cache_options.capacity = FLAGS_db_block_cache_secondary_size_bytes;
+  cache_options.mem_tracker = MemTracker::FindOrCreateTracker(
+      "PersistentBlockCacheIndex", server_mem_tracker_);
+  auto cache = rocksdb::NewFilePersistentCache(cache_options);
+  if (!cache.ok()) {
+    // Second tier is an optimization, so the server could work without it.
+    LOG(WARNING) << "Failed to open block cache in " << cache_options.path << ": "
+                 << cache.status();
+    return;
   }
+  options->persistent_block_cache = std::move(*cache);
 }
 
 void TabletMemoryManager::InitLogCacheGC() {
@@ -73,6 +73,10 @@ class TabletMemoryManager {
       const int32_t default_block_cache_size_percentage,
       tablet::TabletOptions* options);
 
+  // Opens the second tier of block cache on a local disk, when it is configured with
+  // db_block_cache_secondary_path flag.
+  void InitPersistentBlockCache(tablet::TabletOptions* options);
+
   // Initializes the log cache garbage collector.
   void InitLogCacheGC();
 
@@ -1096,6 +1096,44 @@ void TabletServiceImpl::UpdateTransaction(const UpdateTransactionRequestPB* req,
   }
 }
 
+void TabletServiceImpl::UpdateTransactionHeartbeats(
+    const UpdateTransactionHeartbeatsRequestPB* req,
+    UpdateTransactionHeartbeatsResponsePB* resp,
+    rpc::RpcContext context) {
+  TRACE("UpdateTransactionHeartbeats");
+
+  VLOG(2) << "UpdateTransactionHeartbeats: " << req->tablet_id() << ", "
+          << req->transaction_id_size() << " transactions";
+  UpdateClock(*req, server_->Clock());
+
+  auto tablet = LookupLeaderTabletOrRespond(
+      server_->tablet_peer_lookup(), req->tablet_id(), resp, &context);
+  if (!tablet) {
+    return;
+  }
+
+  auto* coordinator = tablet.tablet->transaction_coordinator();
+  if (!coordinator) {
+    SetupErrorAndRespond(
+        resp->mutable_error(),
+        STATUS_FORMAT(InvalidArgument, "No transaction coordinator at tablet $0", req->tablet_id()),
+        &context);
+    return;
+  }
+
+  auto context_ptr = std::make_shared<rpc::RpcContext>(std::move(context));
+  coordinator->HandleHeartbeats(
+      req->transaction_id(), tablet.leader_term,
+      [resp, context_ptr, clock = server_->Clock()](const std::vector<Status>& statuses) {
+        resp->mutable_transaction_status()->Reserve(narrow_cast<int>(statuses.size()));
+        for (const auto& status : statuses) {
+          StatusToPB(status, resp->add_transaction_status());
+        }
+        resp->set_propagated_hybrid_time(clock->Now().ToUint64());
+        context_ptr->RespondSuccess();
+      });
+}
+
 template <class Req, class Resp, class Action>
 void TabletServiceImpl::PerformAtLeader(
     const Req& req, Resp* resp, rpc::RpcContext* context, const Action& action) {
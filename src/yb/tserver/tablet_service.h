@@ -116,6 +116,10 @@ class TabletServiceImpl : public TabletServerServiceIf, public ReadTabletProvide
                          UpdateTransactionResponsePB* resp,
                          rpc::RpcContext context) override;
 
+  void UpdateTransactionHeartbeats(const UpdateTransactionHeartbeatsRequestPB* req,
+                                   UpdateTransactionHeartbeatsResponsePB* resp,
+                                   rpc::RpcContext context) override;
+
   void GetTransactionStatus(const GetTransactionStatusRequestPB* req,
                             GetTransactionStatusResponsePB* resp,
                             rpc::RpcContext context) override;
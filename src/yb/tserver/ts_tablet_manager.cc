@@ -78,6 +78,7 @@
 #include "yb/rpc/messenger.h"
 #include "yb/rpc/poller.h"
 
+#include "yb/tablet/committed_transactions_cache.h"
 #include "yb/tablet/metadata.pb.h"
 #include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/tablet.h"
@@ -240,6 +241,12 @@ DEFINE_bool(enable_pessimistic_locking, false,
 TAG_FLAG(enable_pessimistic_locking, evolving);
 TAG_FLAG(enable_pessimistic_locking, hidden);
 
+DEFINE_uint64(committed_transactions_cache_size, 50000,
+              "Max number of recently committed transactions, whose commit time is cached by the "
+              "tablet server and shared by its tablets to avoid repeated transaction status "
+              "requests to the coordinator. 0 disables the cache.");
+TAG_FLAG(committed_transactions_cache_size, advanced);
+
 DECLARE_string(rocksdb_compact_flush_rate_limit_sharing_mode);
 
 namespace yb {
@@ -485,13 +492,19 @@ Status TSTabletManager::Init() {
 
   multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(server_->messenger(),
                                                                       &server_->proxy_cache(),
-                                                                      local_peer_pb_.cloud_info());
+                                                                      local_peer_pb_.cloud_info(),
+                                                                      server_->metric_entity());
 
   if (FLAGS_enable_pessimistic_locking) {
     waiting_txn_registry_ = std::make_unique<tablet::LocalWaitingTxnRegistry>(
         client_future(), scoped_refptr<server::Clock>(server_->clock()));
   }
 
+  if (FLAGS_committed_transactions_cache_size > 0) {
+    committed_transactions_cache_ = std::make_unique<tablet::CommittedTransactionsCache>(
+        FLAGS_committed_transactions_cache_size, server_->metric_entity());
+  }
+
   deque<RaftGroupMetadataPtr> metas;
 
   // First, load all of the tablet metadata. We do this before we start
@@ -1480,6 +1493,7 @@ void TSTabletManager::OpenTablet(const RaftGroupMetadataPtr& meta,
         return server->TransactionManager();
       },
       .waiting_txn_registry = waiting_txn_registry_.get(),
+      .committed_transactions_cache = committed_transactions_cache_.get(),
     };
     tablet::BootstrapTabletData data = {
       .tablet_init_data = tablet_init_data,
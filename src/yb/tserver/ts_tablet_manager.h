@@ -610,6 +610,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf, public tablet::Table
 
   std::unique_ptr<rpc::Poller> waiting_txn_registry_poller_;
 
+  // Shared by all tablets of this server, so status of committed transaction is requested once.
+  std::unique_ptr<tablet::CommittedTransactionsCache> committed_transactions_cache_;
+
   // For block cache and memory monitor shared across tablets
   tablet::TabletOptions tablet_options_;
 
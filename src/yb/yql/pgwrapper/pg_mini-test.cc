@@ -59,6 +59,7 @@ using namespace std::literals;
 
 DECLARE_bool(TEST_force_master_leader_resolution);
 DECLARE_bool(TEST_timeout_non_leader_master_rpcs);
+DECLARE_bool(apply_large_transactions_via_sst);
 DECLARE_bool(enable_automatic_tablet_splitting);
 DECLARE_bool(flush_rocksdb_on_shutdown);
 DECLARE_bool(rocksdb_use_logging_iterator);
@@ -86,6 +87,7 @@ DECLARE_int64(tablet_split_high_phase_size_threshold_bytes);
 DECLARE_int64(tablet_split_low_phase_shard_count_per_node);
 DECLARE_int64(tablet_split_low_phase_size_threshold_bytes);
 
+DECLARE_uint64(TEST_inject_sleep_after_apply_sst_ingestion_ms);
 DECLARE_uint64(max_clock_skew_usec);
 
 namespace yb {
@@ -1741,6 +1743,27 @@ TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(BigSelect)) {
   ASSERT_EQ(res, kRows);
 }
 
+// Secondary index returns ybctids in the order opposite to the order of the main table, so rows
+// of a ybctid batch are read in the order that differs from the order of the request.
+TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(IndexScanInReverseYbctidOrder)) {
+  constexpr int kRows = 1000;
+  auto conn = ASSERT_RESULT(Connect());
+
+  ASSERT_OK(conn.Execute("CREATE TABLE t (k INT, v INT, PRIMARY KEY (k ASC))"));
+  ASSERT_OK(conn.Execute("CREATE INDEX ON t (v ASC)"));
+  ASSERT_OK(conn.ExecuteFormat(
+      "INSERT INTO t SELECT s, $0 - s FROM generate_series(1, $0) AS s", kRows));
+
+  constexpr auto kQuery = "SELECT k, v FROM t WHERE v >= 0 ORDER BY v";
+  ASSERT_TRUE(ASSERT_RESULT(conn.HasIndexScan(kQuery)));
+  auto res = ASSERT_RESULT(conn.Fetch(kQuery));
+  ASSERT_EQ(PQntuples(res.get()), kRows);
+  for (int row = 0; row != kRows; ++row) {
+    ASSERT_EQ(ASSERT_RESULT(GetInt32(res.get(), row, 0)), kRows - row);
+    ASSERT_EQ(ASSERT_RESULT(GetInt32(res.get(), row, 1)), row);
+  }
+}
+
 TEST_F_EX(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(ManyRowsInsert), PgMiniSingleTServerTest) {
   constexpr int kRows = 100000;
   auto conn = ASSERT_RESULT(Connect());
@@ -2132,6 +2155,26 @@ TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(BigInsertWithRestart)) {
   TestBigInsert(/* restart= */ true);
 }
 
+TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(BigInsertViaSst)) {
+  FLAGS_apply_large_transactions_via_sst = true;
+  TestBigInsert(/* restart= */ false);
+}
+
+TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(BigInsertViaSstWithRestart)) {
+  FLAGS_apply_large_transactions_via_sst = true;
+  FLAGS_apply_intents_task_injected_delay_ms = 200;
+  TestBigInsert(/* restart= */ true);
+}
+
+// Restart happens after applied records were ingested, but before the apply state that follows
+// them is persisted. So the same records are ingested again after restart.
+TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(BigInsertViaSstWithRestartAfterIngestion)) {
+  FLAGS_apply_large_transactions_via_sst = true;
+  FLAGS_TEST_inject_sleep_after_apply_sst_ingestion_ms = 1000;
+  FLAGS_flush_rocksdb_on_shutdown = false;
+  TestBigInsert(/* restart= */ true);
+}
+
 TEST_F(PgMiniTest, YB_DISABLE_TEST_IN_TSAN(BigInsertWithDropTable)) {
   constexpr int kNumRows = 10000;
   FLAGS_txn_max_apply_batch_records = kNumRows / 10;
@@ -34,6 +34,7 @@ using namespace std::literals;
 DECLARE_bool(ysql_enable_packed_row);
 DECLARE_int32(history_cutoff_propagation_interval_ms);
 DECLARE_int32(timestamp_history_retention_interval_sec);
+DECLARE_uint64(ysql_packed_row_scan_batch_size);
 DECLARE_uint64(ysql_packed_row_size_limit);
 
 namespace yb {
@@ -42,6 +43,7 @@ namespace pgwrapper {
 class PgPackedRowTest : public PackedRowTestBase<PgMiniTestBase> {
  protected:
   void TestCompaction(const std::string& expr_suffix);
+  void TestBatchedScanTupleId(const std::string& expr_suffix);
 };
 
 TEST_F(PgPackedRowTest, YB_DISABLE_TEST_IN_TSAN(Simple)) {
@@ -571,5 +573,50 @@ TEST_F(PgPackedRowTest, YB_DISABLE_TEST_IN_TSAN(CoveringIndex)) {
   ASSERT_OK(conn.Execute("INSERT INTO t (key, v1, v2) VALUES (1, 'one', 'odin')"));
 }
 
+// Check that ybctid projected by a scan that decodes packed rows by batches belongs to the row
+// itself, instead of the last row of the batch. Both the row by row and the vectorized evaluation
+// of batched rows are checked.
+void PgPackedRowTest::TestBatchedScanTupleId(const std::string& expr_suffix) {
+  constexpr int kKeys = 100;
+  constexpr int kVectorizedDeleteLimit = 50;
+
+  ANNOTATE_UNPROTECTED_WRITE(FLAGS_ysql_packed_row_scan_batch_size) = 16;
+
+  auto conn = ASSERT_RESULT(ConnectToDB("test"));
+  ASSERT_OK(conn.ExecuteFormat(
+      "CREATE TABLE t (key INT PRIMARY KEY, value INT) $0", expr_suffix));
+  ASSERT_OK(conn.ExecuteFormat(
+      "INSERT INTO t SELECT i, i FROM generate_series(0, $0) AS i", kKeys - 1));
+  ASSERT_OK(cluster_->FlushTablets());
+
+  auto count = ASSERT_RESULT(conn.FetchValue<int64_t>("SELECT COUNT(DISTINCT ybctid) FROM t"));
+  ASSERT_EQ(count, kKeys);
+
+  // DELETE locates rows to remove by ybctid fetched with the scan.
+  ASSERT_OK(conn.Execute("DELETE FROM t WHERE key % 2 = 0"));
+  // Pushed down comparison of non key column is evaluated over batches in columnar form.
+  ASSERT_OK(conn.Execute("SET yb_enable_expression_pushdown TO true"));
+  ASSERT_OK(conn.ExecuteFormat("DELETE FROM t WHERE value < $0", kVectorizedDeleteLimit));
+
+  auto value = ASSERT_RESULT(conn.FetchAllAsString("SELECT key FROM t ORDER BY key", ",", ";"));
+  std::string expected;
+  for (auto key = kVectorizedDeleteLimit + 1; key < kKeys; key += 2) {
+    expected += Format(expected.empty() ? "$0" : ";$0", key);
+  }
+  ASSERT_EQ(value, expected);
+}
+
+TEST_F(PgPackedRowTest, YB_DISABLE_TEST_IN_TSAN(BatchedScanTupleId)) {
+  auto conn = ASSERT_RESULT(Connect());
+  ASSERT_OK(conn.Execute("CREATE DATABASE test"));
+  TestBatchedScanTupleId("");
+}
+
+TEST_F(PgPackedRowTest, YB_DISABLE_TEST_IN_TSAN(BatchedScanTupleIdColocated)) {
+  auto conn = ASSERT_RESULT(Connect());
+  ASSERT_OK(conn.Execute("CREATE DATABASE test WITH colocated = true"));
+  TestBatchedScanTupleId("WITH (colocated = true)");
+}
+
 } // namespace pgwrapper
 } // namespace yb